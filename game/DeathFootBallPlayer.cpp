@@ -0,0 +1,106 @@
+#include "DeathFootBallPlayer.h"
+#include "physics/PhysicsWorld.h"
+#include "physics/RagdollSystem.h"
+#include "core/StateHash.h"
+
+namespace
+{
+    // Speed change within one tick, in m/s, that knocks a player out.
+    const float KNOCKOUT_SPEED_CHANGE = 3.0f;
+    const float KNOCKOUT_SECONDS = 3.0f;
+    const float PLAYER_HEIGHT = 0.8f;
+
+    // Running pushes with RUN_FORCE newtons until the player moves at
+    // MAX_RUN_SPEED along the stick; a charge is a single impulse.
+    const float RUN_FORCE = 640.0f;
+    const float MAX_RUN_SPEED = 5.0f;
+    const float CHARGE_IMPULSE = 600.0f;
+}
+
+DeathFootBallPlayer::DeathFootBallPlayer(unsigned int body, unsigned int team)
+    : m_body(body),
+      m_team(team),
+      m_lastVelocity(0.0f),
+      m_ragdoll(NO_RAGDOLL),
+      m_knockedOutTime(0.0f),
+      m_lastButtons(0)
+{
+}
+
+void DeathFootBallPlayer::Charge(PhysicsWorld& rWorld, const glm::vec3& rDirection, float impulse)
+{
+    if (IsKnockedOut())
+        return;
+
+    rWorld.ApplyImpulse(m_body, rDirection * impulse);
+    m_lastVelocity = rWorld.GetVelocity(m_body);
+}
+
+bool DeathFootBallPlayer::ApplyInput(PhysicsWorld& rWorld, const PlayerInput& rInput, const glm::vec3& rChargeAt, float dt)
+{
+    bool chargePressed = (rInput.buttons & BUTTON_CHARGE) && !(m_lastButtons & BUTTON_CHARGE);
+    m_lastButtons = rInput.buttons;
+    if (IsKnockedOut())
+        return false;
+
+    if (rInput.moveX != 0 || rInput.moveZ != 0)
+    {
+        glm::vec3 direction(rInput.moveX / 127.0f, 0.0f, rInput.moveZ / 127.0f);
+        float length = glm::length(direction);
+        if (length > 1.0f)
+        {
+            direction /= length;
+            length = 1.0f;
+        }
+        if (glm::dot(rWorld.GetVelocity(m_body), direction) < MAX_RUN_SPEED * length)
+            Charge(rWorld, direction, RUN_FORCE * dt);
+    }
+
+    if (chargePressed)
+    {
+        glm::vec3 direction = rChargeAt - rWorld.GetPosition(m_body);
+        direction.y = 0.0f;
+        if (glm::length(direction) > 0.001f)
+            Charge(rWorld, glm::normalize(direction), CHARGE_IMPULSE);
+    }
+    return chargePressed;
+}
+
+void DeathFootBallPlayer::Update(PhysicsWorld& rWorld, RagdollSystem& rRagdolls, float dt)
+{
+    glm::vec3 velocity = rWorld.GetVelocity(m_body);
+
+    if (IsKnockedOut())
+    {
+        m_knockedOutTime += dt;
+        if (m_knockedOutTime >= KNOCKOUT_SECONDS)
+        {
+            rRagdolls.Despawn(m_ragdoll);
+            m_ragdoll = NO_RAGDOLL;
+        }
+    }
+    else
+    {
+        glm::vec3 change = velocity - m_lastVelocity;
+        change.y = 0.0f;
+        if (glm::length(change) > KNOCKOUT_SPEED_CHANGE)
+        {
+            glm::vec3 feet = rWorld.GetPosition(m_body);
+            feet.y = 0.0f;
+            m_ragdoll = rRagdolls.Spawn(feet, velocity, PLAYER_HEIGHT);
+            m_knockedOutTime = 0.0f;
+        }
+    }
+
+    m_lastVelocity = velocity;
+}
+
+void DeathFootBallPlayer::HashState(StateHash& rHash) const
+{
+    rHash.Add(m_body);
+    rHash.Add(m_team);
+    rHash.Add(m_lastVelocity);
+    rHash.Add(m_ragdoll);
+    rHash.Add(m_knockedOutTime);
+    rHash.Add(m_lastButtons);
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "IControl.h"
+
+#include <glm/glm.hpp>
+
+class PhysicsWorld;
+class RagdollSystem;
+class StateHash;
+
+// A player on the pitch: a sphere in the physics world while standing, a
+// ragdoll for a few seconds after being flattened by a hard enough hit.
+class DeathFootBallPlayer
+{
+public:
+    DeathFootBallPlayer(unsigned int body, unsigned int team);
+
+    // Pushes the player towards rDirection. Self-inflicted speed changes do
+    // not count as hits.
+    void Charge(PhysicsWorld& rWorld, const glm::vec3& rDirection, float impulse);
+
+    // Call once per physics tick before the world steps: runs along the move
+    // stick and charges at rChargeAt when the charge button goes down.
+    // Returns true on the tick the player charged.
+    bool ApplyInput(PhysicsWorld& rWorld, const PlayerInput& rInput, const glm::vec3& rChargeAt, float dt);
+
+    // Call once per physics tick after the world has stepped.
+    void Update(PhysicsWorld& rWorld, RagdollSystem& rRagdolls, float dt);
+
+    void HashState(StateHash& rHash) const;
+
+    // Sets the buttons the next ApplyInput() compares against to find presses.
+    void SetLastButtons(unsigned char buttons)
+    {
+        m_lastButtons = buttons;
+    }
+
+    bool IsKnockedOut() const
+    {
+        return m_ragdoll != NO_RAGDOLL;
+    }
+
+    unsigned int GetBody() const
+    {
+        return m_body;
+    }
+
+    // The RagdollSystem handle while knocked out.
+    unsigned int GetRagdoll() const
+    {
+        return m_ragdoll;
+    }
+
+    unsigned int GetTeam() const
+    {
+        return m_team;
+    }
+
+private:
+    static const unsigned int NO_RAGDOLL = 0xFFFFFFFFu;
+
+    unsigned int m_body;
+    unsigned int m_team;
+    glm::vec3 m_lastVelocity;
+    unsigned int m_ragdoll;
+    float m_knockedOutTime;
+    unsigned char m_lastButtons;
+};
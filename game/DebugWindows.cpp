@@ -0,0 +1,148 @@
+#include "DebugWindows.h"
+#include "physics/PhysicsWorld.h"
+#include "physics/RagdollSystem.h"
+#include "physics/ClothNet.h"
+#include "net/GameClient.h"
+#include "net/RollbackSession.h"
+#include "imgui/imgui.h"
+
+void ShowPhysicsDebugWindow(const PhysicsWorld& rWorld, unsigned int ticksThisFrame, unsigned int subStepsThisFrame)
+{
+    const SolverStats& rStats = rWorld.GetSolverStats();
+    const SubStepStats& rSubSteps = rWorld.GetSubStepStats();
+
+    ImGui::Begin("Physics");
+    ImGui::Text("Bodies: %u  Contacts: %u  Threads: %u", rWorld.GetBodyCount(), rStats.contactCount, rStats.threadCount);
+    ImGui::Text("Awake: %u  Asleep: %u", rWorld.GetAwakeCount(), rWorld.GetSleepingCount());
+    ImGui::Text("Broadphase: %.3f ms", rStats.broadphaseMs);
+    ImGui::Text("Islands + colouring: %.3f ms", rStats.islandBuildMs);
+    ImGui::Text("Solve: %.3f ms", rStats.solveMs);
+
+    ImGui::Separator();
+    ImGui::Text("Ticks this frame: %u  Island sub-steps this frame: %u", ticksThisFrame, subStepsThisFrame);
+    ImGui::Text("Motion islands: %u (%u calm)  Max sub-steps: %u", rSubSteps.motionIslands, rSubSteps.calmIslands, rSubSteps.maxSubSteps);
+    ImGui::Text("Pipeline runs: %u  Budget used: %u  Clamped islands: %u", rSubSteps.pipelineRuns, rSubSteps.budgetCost, rSubSteps.clampedIslands);
+
+    if (ImGui::CollapsingHeader("Islands"))
+    {
+        ImGui::Columns(5, "islands");
+        ImGui::Text("Island"); ImGui::NextColumn();
+        ImGui::Text("Bodies"); ImGui::NextColumn();
+        ImGui::Text("Constraints"); ImGui::NextColumn();
+        ImGui::Text("Colours"); ImGui::NextColumn();
+        ImGui::Text("Solve ms"); ImGui::NextColumn();
+        ImGui::Separator();
+        for (unsigned int i = 0; i < rStats.islands.size(); ++i)
+        {
+            const IslandTiming& rIsland = rStats.islands[i];
+            ImGui::PushID(i);
+            bool open = ImGui::TreeNode("island", "%u [%u/%u]%s", i, rIsland.subStep + 1, rIsland.subStepCount, rIsland.parallel ? " (parallel)" : "");
+            ImGui::NextColumn();
+            ImGui::Text("%u", rIsland.bodyCount); ImGui::NextColumn();
+            ImGui::Text("%u", rIsland.constraintCount); ImGui::NextColumn();
+            ImGui::Text("%u", rIsland.colourCount); ImGui::NextColumn();
+            ImGui::Text("%.3f", rIsland.solveMs); ImGui::NextColumn();
+            if (open)
+            {
+                for (unsigned int c = 0; c < rIsland.colourCount; ++c)
+                {
+                    ImGui::Text("colour %u", c); ImGui::NextColumn();
+                    ImGui::NextColumn();
+                    ImGui::NextColumn();
+                    ImGui::NextColumn();
+                    ImGui::Text("%.3f", rStats.colourMs[rIsland.firstColourTiming + c]); ImGui::NextColumn();
+                }
+                ImGui::TreePop();
+            }
+            ImGui::PopID();
+        }
+        ImGui::Columns(1);
+    }
+    ImGui::End();
+}
+
+void ShowRagdollDebugWindow(const RagdollSystem& rRagdolls)
+{
+    ImGui::Begin("Ragdolls");
+    ImGui::Text("Active: %u", rRagdolls.GetActiveCount());
+    ImGui::Text("Step: %.3f ms", rRagdolls.GetLastStepMs());
+    if (rRagdolls.GetLastStepMs() > 0.0f)
+        ImGui::Text("Ragdolls per ms: %.1f", rRagdolls.GetActiveCount() / rRagdolls.GetLastStepMs());
+    ImGui::End();
+}
+
+void ShowClothDebugWindow(const std::vector<ClothNet*>& rNets, bool uploadedThisFrame)
+{
+    unsigned int sleeping = 0;
+    unsigned int vertices = 0;
+    for (unsigned int i = 0; i < rNets.size(); ++i)
+    {
+        if (rNets[i]->IsSleeping())
+            ++sleeping;
+        vertices += rNets[i]->GetVertexCount();
+    }
+
+    ImGui::Begin("Goal nets");
+    ImGui::Text("Nets: %u  Asleep: %u  Particles: %u", (unsigned int)rNets.size(), sleeping, vertices);
+    ImGui::Text("Vertex upload this frame: %s", uploadedThisFrame ? "yes" : "no");
+    ImGui::End();
+}
+
+void ShowRollbackDebugWindow(RollbackSession& rSession)
+{
+    const RollbackStats& rStats = rSession.GetStats();
+    LinkConditioner& rLink = rSession.GetConditioner();
+
+    ImGui::Begin("Rollback");
+    ImGui::Text("Rollback depth: %u ticks  Re-sim: %.3f ms", rStats.rollbackDepth, rStats.resimMs);
+    ImGui::Text("Max depth: %u ticks  Max re-sim: %.3f ms", rStats.maxRollbackDepth, rStats.maxResimMs);
+    ImGui::Text("Rollbacks: %u  Stalls: %u  Predicted ticks: %u", rStats.rollbacks, rStats.stalls, rStats.predictedTicks);
+    ImGui::Text("Packets sent: %u  received: %u  dropped: %u", rStats.packetsSent, rStats.packetsReceived, rLink.GetDroppedCount());
+
+    float latencyMs = rLink.GetLatencyMs();
+    float jitterMs = rLink.GetJitterMs();
+    float lossPercent = rLink.GetLossPercent();
+    bool changed = ImGui::SliderFloat(IM_HASHED("Latency ms"), &latencyMs, 0.0f, 250.0f);
+    changed |= ImGui::SliderFloat(IM_HASHED("Jitter ms"), &jitterMs, 0.0f, 50.0f);
+    changed |= ImGui::SliderFloat(IM_HASHED("Loss %"), &lossPercent, 0.0f, 30.0f);
+    if (changed)
+        rLink.SetConditions(latencyMs, jitterMs, lossPercent);
+
+    if (rStats.desyncTick != RollbackSession::NO_TICK)
+        ImGui::TextColored(ImVec4(1.0f, 0.3f, 0.3f, 1.0f), "DESYNC at tick %u", rStats.desyncTick);
+    else if (rStats.checkedTick != RollbackSession::NO_TICK)
+        ImGui::Text("In sync up to tick %u", rStats.checkedTick);
+    ImGui::End();
+}
+
+void ShowPredictionDebugWindow(GameClient& rClient)
+{
+    const ClientStats& rStats = rClient.GetStats();
+    LinkConditioner& rLink = rClient.GetConditioner();
+
+    ImGui::Begin("Prediction");
+    if (!rClient.IsConnected())
+    {
+        ImGui::Text("Connecting...");
+        ImGui::End();
+        return;
+    }
+    ImGui::Text("Player %u  Snapshot tick %u", rClient.GetPlayer(), rClient.GetSnapshotTick());
+    ImGui::Text("Round trip: %.1f ms  Unacknowledged inputs: %u", rStats.rttMs, rStats.unackedInputs);
+    ImGui::Text("Correction: %.3f m  Max: %.3f m", rStats.lastCorrection, rStats.maxCorrection);
+    ImGui::Text("Snapshots: %u  Undecodable: %u", rStats.snapshotsReceived, rStats.decodeFailures);
+
+    bool predict = rClient.IsPredictionEnabled();
+    if (ImGui::Checkbox(IM_HASHED("Predict local player"), &predict))
+        rClient.SetPredictionEnabled(predict);
+
+    float latencyMs = rLink.GetLatencyMs();
+    float jitterMs = rLink.GetJitterMs();
+    float lossPercent = rLink.GetLossPercent();
+    bool changed = ImGui::SliderFloat(IM_HASHED("Latency ms"), &latencyMs, 0.0f, 250.0f);
+    changed |= ImGui::SliderFloat(IM_HASHED("Jitter ms"), &jitterMs, 0.0f, 50.0f);
+    changed |= ImGui::SliderFloat(IM_HASHED("Loss %"), &lossPercent, 0.0f, 30.0f);
+    if (changed)
+        rLink.SetConditions(latencyMs, jitterMs, lossPercent);
+    ImGui::End();
+}
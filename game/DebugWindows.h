@@ -0,0 +1,18 @@
+#pragma once
+
+#include <vector>
+
+class PhysicsWorld;
+class RagdollSystem;
+class ClothNet;
+class GameClient;
+class RollbackSession;
+
+// ImGui windows showing runtime statistics of the game subsystems.
+
+// subStepsThisFrame sums SubStepStats::islandSubSteps over every tick run this frame.
+void ShowPhysicsDebugWindow(const PhysicsWorld& rWorld, unsigned int ticksThisFrame, unsigned int subStepsThisFrame);
+void ShowRagdollDebugWindow(const RagdollSystem& rRagdolls);
+void ShowClothDebugWindow(const std::vector<ClothNet*>& rNets, bool uploadedThisFrame);
+void ShowRollbackDebugWindow(RollbackSession& rSession);
+void ShowPredictionDebugWindow(GameClient& rClient);
@@ -0,0 +1,25 @@
+#pragma once
+
+// One tick of a player's controls. Quantised and POD so it can be logged,
+// sent over the network and compared byte for byte.
+struct PlayerInput
+{
+    signed char moveX;        // run direction, -127..127 per axis
+    signed char moveZ;
+    unsigned char buttons;    // PlayerButton bits
+    unsigned char target;     // set by the server only: entity + 1 a charge hit, 0 for none
+};
+
+enum PlayerButton
+{
+    BUTTON_CHARGE = 1 << 0    // charge at the ball, on the tick the button goes down
+};
+
+// Source of one player's input, polled once per simulation tick. Keyboard,
+// AI and recorded or remote input all reach the match through this interface.
+class IControl
+{
+public:
+    virtual ~IControl() {}
+    virtual PlayerInput Poll(unsigned int tick) = 0;
+};
@@ -0,0 +1,149 @@
+#include "Match.h"
+#include "core/StateHash.h"
+#include "core/StateStream.h"
+
+#include <type_traits>
+
+// Contracted or reassociated float maths would round differently per compiler
+// and instruction set; the build keeps both off for the simulation.
+#if defined(__FAST_MATH__)
+#error "The match simulation must not be built with -ffast-math"
+#endif
+
+// Players are saved and restored with a plain memcpy.
+static_assert(std::is_trivially_copyable<DeathFootBallPlayer>::value, "DeathFootBallPlayer must stay trivially copyable");
+
+namespace
+{
+    const float HALF_LENGTH = 6.0f;
+    const float HALF_WIDTH = 4.0f;
+    const float BOUNDS_MARGIN = 1.0f;
+    const float CEILING = 15.0f;
+    const unsigned int BODY_CAPACITY = 256;
+    const unsigned int RAGDOLL_CAPACITY = 64;
+
+    // Impulses of a charge the server confirmed as a hit. A tackled player
+    // changes speed by TACKLE_IMPULSE / 80 kg, enough to be knocked out.
+    const float TACKLE_IMPULSE = 320.0f;
+    const float KICK_IMPULSE = 3.0f;
+}
+
+Match::Match()
+    : m_world(BODY_CAPACITY),
+      m_ragdolls(RAGDOLL_CAPACITY),
+      m_ball(0),
+      m_tick(0),
+      m_stateHash(0)
+{
+    // the ball on the centre spot and two teams of eleven facing each other
+    AddPitchWalls(m_world);
+    m_ragdolls.SetPitchBounds(HALF_LENGTH, HALF_WIDTH);
+    m_ball = m_world.AddBody(BodyKind::Ball, glm::vec3(0.0f, 0.1f, 0.0f), 0.1f, 0.45f);
+
+    for (unsigned int i = 0; i < PLAYER_COUNT; ++i)
+    {
+        float side = i < PLAYER_COUNT / 2 ? -1.0f : 1.0f;
+        unsigned int slot = i % (PLAYER_COUNT / 2);
+        glm::vec3 position(side * (1.0f + 1.2f * (slot / 4)), 0.2f, -3.0f + 2.0f * (slot % 4));
+        m_players.push_back(DeathFootBallPlayer(m_world.AddBody(BodyKind::Player, position, GetPlayerRadius(), GetPlayerMass()), i < PLAYER_COUNT / 2 ? 0 : 1));
+    }
+
+    m_stateHash = HashState();
+}
+
+void Match::GetPitchBounds(glm::vec3& rMin, glm::vec3& rMax)
+{
+    rMin = glm::vec3(-HALF_LENGTH - BOUNDS_MARGIN, -BOUNDS_MARGIN, -HALF_WIDTH - BOUNDS_MARGIN);
+    rMax = glm::vec3(HALF_LENGTH + BOUNDS_MARGIN, CEILING, HALF_WIDTH + BOUNDS_MARGIN);
+}
+
+void Match::AddPitchWalls(PhysicsWorld& rWorld)
+{
+    rWorld.AddPitchWalls(HALF_LENGTH, HALF_WIDTH);
+}
+
+void Match::Tick(const PlayerInput* pInputs, WorkerPool& rPool)
+{
+    const float dt = GetTickSeconds();
+
+    // hits land after every player moved, so a victim's own running does
+    // not absorb the impulse as self-inflicted
+    glm::vec3 ball = m_world.GetPosition(m_ball);
+    bool hit[PLAYER_COUNT];
+    for (unsigned int i = 0; i < PLAYER_COUNT; ++i)
+    {
+        const unsigned int target = pInputs[i].target;
+        const bool targetsPlayer = target >= 2 && target - 2 < PLAYER_COUNT;
+        const glm::vec3 chargeAt = targetsPlayer ? m_world.GetPosition(m_players[target - 2].GetBody()) : ball;
+        hit[i] = m_players[i].ApplyInput(m_world, pInputs[i], chargeAt, dt) && (target == 1 || targetsPlayer);
+    }
+    for (unsigned int i = 0; i < PLAYER_COUNT; ++i)
+    {
+        if (hit[i])
+            ApplyHit(i, pInputs[i].target);
+    }
+
+    m_world.Step(dt, rPool);
+    for (unsigned int i = 0; i < PLAYER_COUNT; ++i)
+        m_players[i].Update(m_world, m_ragdolls, dt);
+    m_ragdolls.Step(dt, rPool);
+
+    ++m_tick;
+    m_stateHash = HashState();
+}
+
+void Match::ApplyHit(unsigned int attacker, unsigned int target)
+{
+    const glm::vec3 from = m_world.GetPosition(m_players[attacker].GetBody());
+    unsigned int body = m_ball;
+    float impulse = KICK_IMPULSE;
+    if (target >= 2)
+    {
+        const DeathFootBallPlayer& rVictim = m_players[target - 2];
+        if (target - 2 == attacker || rVictim.GetTeam() == m_players[attacker].GetTeam() || rVictim.IsKnockedOut())
+            return;
+        body = rVictim.GetBody();
+        impulse = TACKLE_IMPULSE;
+    }
+
+    glm::vec3 direction = m_world.GetPosition(body) - from;
+    direction.y = 0.0f;
+    if (glm::length(direction) > 0.001f)
+        m_world.ApplyImpulse(body, glm::normalize(direction) * impulse);
+}
+
+uint64_t Match::HashState() const
+{
+    StateHash hash;
+    hash.Add(m_tick);
+    m_world.HashState(hash);
+    m_ragdolls.HashState(hash);
+    for (unsigned int i = 0; i < m_players.size(); ++i)
+        m_players[i].HashState(hash);
+    return hash.GetValue();
+}
+
+size_t Match::SaveState(unsigned char* pOut) const
+{
+    StateWriter out(pOut);
+    out.Write(m_tick);
+    m_world.SaveState(out);
+    m_ragdolls.SaveState(out);
+    out.Write(&m_players[0], m_players.size() * sizeof(DeathFootBallPlayer));
+    return out.GetSize();
+}
+
+void Match::LoadState(const unsigned char* pIn, size_t size)
+{
+    StateReader in(pIn, size);
+    in.Read(m_tick);
+    m_world.LoadState(in);
+    m_ragdolls.LoadState(in);
+    in.Read(&m_players[0], m_players.size() * sizeof(DeathFootBallPlayer));
+    m_stateHash = HashState();
+}
+
+size_t Match::GetMaxStateSize() const
+{
+    return sizeof(m_tick) + m_world.GetMaxStateSize() + m_ragdolls.GetMaxStateSize() + m_players.size() * sizeof(DeathFootBallPlayer);
+}
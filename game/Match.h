@@ -0,0 +1,113 @@
+#pragma once
+
+#include "DeathFootBallPlayer.h"
+#include "IControl.h"
+#include "physics/PhysicsWorld.h"
+#include "physics/RagdollSystem.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class WorkerPool;
+
+// The gameplay state of one match, advanced only by Tick() with one input per
+// player. The tick length is fixed, players react to nothing but their
+// PlayerInput, and every system steps in a fixed order with deterministic
+// parallel work, so two matches fed the same inputs stay bit-identical for
+// any worker count. The state hash taken after every tick makes a desync
+// visible on the tick it happens.
+class Match
+{
+public:
+    static const unsigned int PLAYER_COUNT = 22;
+    static const unsigned int TICK_RATE = 60;
+
+    static float GetTickSeconds()
+    {
+        return 1.0f / TICK_RATE;
+    }
+
+    static float GetPlayerRadius()
+    {
+        return 0.2f;
+    }
+
+    static float GetPlayerMass()
+    {
+        return 80.0f;
+    }
+
+    Match();
+
+    // Box every body stays inside: the walled pitch with a margin, from
+    // slightly below the ground up to the highest a ball is expected to fly.
+    static void GetPitchBounds(glm::vec3& rMin, glm::vec3& rMax);
+
+    // Adds the match's ground and walls to rWorld, for worlds that mirror part
+    // of the match such as a client's prediction.
+    static void AddPitchWalls(PhysicsWorld& rWorld);
+
+    // pInputs holds PLAYER_COUNT inputs, indexed like GetPlayers(). A charge
+    // with a target is a hit the server already validated: the player charges
+    // at the target and the ball is kicked or the opponent tackled, wherever
+    // they are now.
+    void Tick(const PlayerInput* pInputs, WorkerPool& rPool);
+
+    unsigned int GetTick() const
+    {
+        return m_tick;
+    }
+
+    // Hash of the full state after the last Tick().
+    uint64_t GetStateHash() const
+    {
+        return m_stateHash;
+    }
+
+    uint64_t HashState() const;
+
+    // Writes the whole gameplay state and returns its size; with a null
+    // pOut only the size is computed. Never larger than GetMaxStateSize().
+    size_t SaveState(unsigned char* pOut) const;
+    void LoadState(const unsigned char* pIn, size_t size);
+    size_t GetMaxStateSize() const;
+
+    PhysicsWorld& GetWorld()
+    {
+        return m_world;
+    }
+
+    const PhysicsWorld& GetWorld() const
+    {
+        return m_world;
+    }
+
+    const RagdollSystem& GetRagdolls() const
+    {
+        return m_ragdolls;
+    }
+
+    const std::vector<DeathFootBallPlayer>& GetPlayers() const
+    {
+        return m_players;
+    }
+
+    unsigned int GetBall() const
+    {
+        return m_ball;
+    }
+
+private:
+    Match(const Match&);
+    Match& operator=(const Match&);
+
+    void ApplyHit(unsigned int attacker, unsigned int target);
+
+    PhysicsWorld m_world;
+    RagdollSystem m_ragdolls;
+    std::vector<DeathFootBallPlayer> m_players;
+    unsigned int m_ball;
+    unsigned int m_tick;
+    uint64_t m_stateHash;
+};
@@ -0,0 +1,57 @@
+#include "Benchmarks.h"
+
+#include <cstring>
+#include <iostream>
+
+namespace
+{
+    struct Suite
+    {
+        const char* pName;
+        int (*pRun)();
+    };
+
+    const Suite SUITES[] = {
+        { "ragdoll", RunRagdollBench },
+        { "lockstep", RunLockstepBench },
+        { "replay", RunReplayBench },
+        { "rollback", RunRollbackBench },
+        { "snapshot", RunSnapshotBench },
+        { "prediction", RunPredictionBench },
+        { "lagcomp", RunLagCompensationBench },
+        { "udp", RunUdpBench },
+        { "matchhost", RunMatchHostBench },
+        { "spectators", RunSpectatorBench },
+        { "interest", RunInterestBench },
+        { "imhash", RunImHashBench },
+        { "storage", RunStorageBench },
+        { "fontatlas", RunFontAtlasBench },
+        { "dynatlas", RunDynamicAtlasBench },
+        { "sdffont", RunSdfFontBench },
+        { "textcache", RunTextCacheBench },
+        { "tessellation", RunTessellationBench }
+    };
+
+    const unsigned int SUITE_COUNT = sizeof(SUITES) / sizeof(SUITES[0]);
+}
+
+// DeathBallBench [suite...] - runs the named suites, or all of them.
+int main(int argc, char** argv)
+{
+    int result = 0;
+    for (unsigned int i = 0; i < SUITE_COUNT; ++i)
+    {
+        bool selected = argc < 2;
+        for (int arg = 1; arg < argc; ++arg)
+        {
+            if (std::strcmp(argv[arg], SUITES[i].pName) == 0)
+                selected = true;
+        }
+        if (!selected)
+            continue;
+
+        std::cout << "== " << SUITES[i].pName << " ==" << std::endl;
+        result |= SUITES[i].pRun();
+    }
+    return result;
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+// Entry points of the individual benchmark suites run by DeathBallBench.
+// Each prints its results to stdout and returns 0 on success.
+
+int RunRagdollBench();
+int RunLockstepBench();
+int RunReplayBench();
+int RunRollbackBench();
+int RunSnapshotBench();
+int RunPredictionBench();
+int RunLagCompensationBench();
+int RunUdpBench();
+int RunMatchHostBench();
+int RunSpectatorBench();
+int RunInterestBench();
+int RunImHashBench();
+int RunStorageBench();
+int RunFontAtlasBench();
+int RunDynamicAtlasBench();
+int RunSdfFontBench();
+int RunTextCacheBench();
+int RunTessellationBench();
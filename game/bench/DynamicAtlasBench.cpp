@@ -0,0 +1,220 @@
+#include "Benchmarks.h"
+#include "imgui/imgui.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+    const unsigned int FRAMES = 600;
+    const unsigned int IDEOGRAPHS_PER_FRAME = 300;
+    const unsigned int LATIN_PER_FRAME = 100;
+
+    // Distinct ideographs of the text, ranked by how often they appear. The
+    // rank is mapped onto the CJK block with a prime stride so that common
+    // ideographs are not neighbours.
+    const unsigned int VOCABULARY = 4000;
+    const unsigned int CJK_FIRST = 0x4E00;
+    const unsigned int CJK_COUNT = 0x9FAF - 0x4E00 + 1;
+    const unsigned int CJK_STRIDE = 7919;
+
+    typedef std::chrono::steady_clock Clock;
+
+    struct PageCase
+    {
+        const char* pName;
+        int pageHeight;
+        int pageCount;
+    };
+
+    struct DrawnGlyph
+    {
+        const ImFont* pFont;
+        const ImFontGlyph* pGlyph;
+        ImWchar codepoint;
+    };
+
+    // The embedded font at two sizes with the Chinese ranges. It has no CJK
+    // glyphs, so every ideograph rasterizes its fallback outline, which costs
+    // about as much as a real one.
+    void AddFonts(ImFontAtlas& rAtlas)
+    {
+        ImFontConfig config;
+        config.SizePixels = 13.0f;
+        rAtlas.AddFontDefault(&config);
+        config.SizePixels = 26.0f;
+        rAtlas.AddFontDefault(&config);
+        for (int i = 0; i < rAtlas.ConfigData.Size; ++i)
+            rAtlas.ConfigData[i].GlyphRanges = rAtlas.GetGlyphRangesChinese();
+    }
+
+    double Milliseconds(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    // Chat-like text: ideograph ranks follow a Zipf distribution, so a few
+    // hundred make up most of the text and the rest turn up now and then.
+    class TextSource
+    {
+    public:
+        TextSource()
+            : m_state(0x1234567u)
+        {
+            double sum = 0.0;
+            for (unsigned int rank = 0; rank < VOCABULARY; ++rank)
+            {
+                sum += 1.0 / (rank + 1);
+                m_cumulative.push_back(sum);
+            }
+        }
+
+        ImWchar NextIdeograph()
+        {
+            const double pick = Next() * m_cumulative.back();
+            const unsigned int rank = (unsigned int)(std::upper_bound(m_cumulative.begin(), m_cumulative.end(), pick) - m_cumulative.begin());
+            return (ImWchar)(CJK_FIRST + (std::min(rank, VOCABULARY - 1) * CJK_STRIDE) % CJK_COUNT);
+        }
+
+        ImWchar NextLatin()
+        {
+            return (ImWchar)(33 + (unsigned int)(Next() * 94.0));
+        }
+
+    private:
+        double Next()
+        {
+            m_state = m_state * 1664525u + 1013904223u;
+            return (m_state >> 8) / 16777216.0;
+        }
+
+        unsigned int m_state;
+        std::vector<double> m_cumulative;
+    };
+
+    // Same layout as the prebuilt glyph, and the same pixels under its
+    // texture coordinates.
+    bool SameGlyph(const ImFontAtlas& rAtlas, const ImFontGlyph& rGlyph, const ImFontAtlas& rReferenceAtlas, const ImFontGlyph& rReference)
+    {
+        if (rGlyph.Codepoint != rReference.Codepoint || rGlyph.AdvanceX != rReference.AdvanceX
+            || rGlyph.X0 != rReference.X0 || rGlyph.Y0 != rReference.Y0 || rGlyph.X1 != rReference.X1 || rGlyph.Y1 != rReference.Y1)
+            return false;
+
+        const int x = (int)std::lround(rGlyph.U0 * rAtlas.TexWidth);
+        const int y = (int)std::lround(rGlyph.V0 * rAtlas.TexHeight);
+        const int width = (int)std::lround(rGlyph.U1 * rAtlas.TexWidth) - x;
+        const int height = (int)std::lround(rGlyph.V1 * rAtlas.TexHeight) - y;
+        const int referenceX = (int)std::lround(rReference.U0 * rReferenceAtlas.TexWidth);
+        const int referenceY = (int)std::lround(rReference.V0 * rReferenceAtlas.TexHeight);
+        if (width != (int)std::lround(rReference.U1 * rReferenceAtlas.TexWidth) - referenceX
+            || height != (int)std::lround(rReference.V1 * rReferenceAtlas.TexHeight) - referenceY)
+            return false;
+        for (int row = 0; row < height; ++row)
+        {
+            const unsigned char* pRow = rAtlas.TexPixelsAlpha8 + (y + row) * rAtlas.TexWidth + x;
+            const unsigned char* pReferenceRow = rReferenceAtlas.TexPixelsAlpha8 + (referenceY + row) * rReferenceAtlas.TexWidth + referenceX;
+            if (std::memcmp(pRow, pReferenceRow, (size_t)width) != 0)
+                return false;
+        }
+        return true;
+    }
+}
+
+// Draws chat-like Chinese text from an atlas rasterizing glyphs on first use,
+// with tight to roomy pages, against one prebuilding every glyph of the
+// ranges. Reports build time, texture size, misses, evictions, occupancy and
+// upload rows, and checks every glyph drawn against the prebuilt one.
+int RunDynamicAtlasBench()
+{
+    const PageCase cases[] = {
+        { "4 pages x 64 rows", 64, 4 },
+        { "8 pages x 128 rows", 128, 8 },
+        { "12 pages x 256 rows", 256, 12 }
+    };
+
+    Clock::time_point start = Clock::now();
+    ImFontAtlas reference;
+    AddFonts(reference);
+    reference.Build();
+    std::printf("prebuilt: %6.1f ms, %4dx%-5d %6d KB\n", Milliseconds(start), reference.TexWidth, reference.TexHeight, reference.TexWidth * reference.TexHeight / 1024);
+
+    int result = 0;
+    for (unsigned int c = 0; c < sizeof(cases) / sizeof(cases[0]); ++c)
+    {
+        ImFontAtlas atlas;
+        AddFonts(atlas);
+        atlas.Flags |= ImFontAtlasFlags_DynamicGlyphs;
+        atlas.DynamicPageHeight = cases[c].pageHeight;
+        atlas.DynamicPageCount = cases[c].pageCount;
+        start = Clock::now();
+        atlas.Build();
+        const double buildMs = Milliseconds(start);
+
+        TextSource text;
+        std::vector<DrawnGlyph> drawn;
+        double frameMs = 0.0;
+        double maxFrameMs = 0.0;
+        int firstFrameMisses = 0;
+        int lateMisses = 0;
+        int mismatches = 0;
+        int y = 0;
+        int height = 0;
+        for (unsigned int frame = 0; frame < FRAMES; ++frame)
+        {
+            // the text is drawn first, as ImGui would between NewFrame() and Render()
+            drawn.clear();
+            start = Clock::now();
+            atlas.DynamicGlyphsNewFrame();
+            for (unsigned int i = 0; i < IDEOGRAPHS_PER_FRAME + LATIN_PER_FRAME; ++i)
+            {
+                const ImFont* pFont = atlas.Fonts[(i % 4 == 0) ? 1 : 0];
+                const ImWchar codepoint = i < IDEOGRAPHS_PER_FRAME ? text.NextIdeograph() : text.NextLatin();
+                const DrawnGlyph glyph = { pFont, pFont->FindGlyph(codepoint), codepoint };
+                drawn.push_back(glyph);
+            }
+            const double ms = Milliseconds(start);
+            frameMs += ms;
+            maxFrameMs = std::max(maxFrameMs, ms);
+            while (atlas.DynamicGlyphsTakeDirtyRows(&y, &height))
+                ;
+
+            ImFontAtlasDynamicGlyphsStats stats;
+            atlas.GetDynamicGlyphsStats(&stats);
+            if (frame == 0)
+                firstFrameMisses = stats.GlyphMissesFrame;
+            if (frame >= FRAMES / 2)
+                lateMisses += stats.GlyphMissesFrame;
+
+            // glyphs drawn earlier in the frame must not have been evicted by later misses
+            for (size_t i = 0; i < drawn.size(); ++i)
+            {
+                const ImFont* pFont = drawn[i].pFont;
+                if (drawn[i].pGlyph < pFont->Glyphs.begin() || drawn[i].pGlyph >= pFont->Glyphs.end())
+                    continue; // drawn blank
+                const ImFont* pReferenceFont = reference.Fonts[pFont == atlas.Fonts[0] ? 0 : 1];
+                if (!SameGlyph(atlas, *drawn[i].pGlyph, reference, *pReferenceFont->FindGlyph(drawn[i].codepoint)))
+                    ++mismatches;
+            }
+        }
+
+        ImFontAtlasDynamicGlyphsStats stats;
+        atlas.GetDynamicGlyphsStats(&stats);
+        std::printf("%-19s build %5.1f ms, %4dx%-4d %4d KB, frame %.3f ms (max %.3f), misses %d first frame, %.1f/frame later, %d drawn blank\n",
+                    cases[c].pName, buildMs, atlas.TexWidth, atlas.TexHeight, atlas.TexWidth * atlas.TexHeight / 1024,
+                    frameMs / FRAMES, maxFrameMs, firstFrameMisses, (double)lateMisses / (FRAMES - FRAMES / 2), stats.GlyphsDropped);
+        std::printf("%-19s resident %d/%d glyphs, %d/%d pages, %.1f%% of page area, evicted %d pages (%d glyphs), uploaded %.1f rows/frame in %d bands\n",
+                    "", stats.GlyphsResident, stats.GlyphsTotal, stats.PagesUsed, stats.PagesCount,
+                    100.0 * stats.PixelsUsed / stats.PixelsTotal, stats.PagesEvicted, stats.GlyphsEvicted,
+                    (double)stats.RowsUploaded / FRAMES, stats.Uploads);
+        if (mismatches > 0)
+        {
+            std::printf("  FAILED (%d glyphs drawn differ from the prebuilt atlas)\n", mismatches);
+            result = 1;
+        }
+    }
+    return result;
+}
@@ -0,0 +1,137 @@
+#include "Benchmarks.h"
+#include "core/WorkerPool.h"
+#include "imgui/imgui.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+
+namespace
+{
+    const char* const CACHE_PATH = "fontatlas_bench.cache";
+
+    typedef std::chrono::steady_clock Clock;
+
+    struct FontCase
+    {
+        const char* pName;
+        float sizePixels;
+        bool chinese;
+    };
+
+    enum Mode
+    {
+        MODE_SERIAL,
+        MODE_PARALLEL,
+        MODE_CACHE_MISS,
+        MODE_CACHE_HIT,
+        MODE_COUNT
+    };
+
+    // The embedded font at two sizes, as the debug UI loads it. It has no CJK
+    // glyphs, so the Chinese ranges rasterize its fallback outline for every
+    // code point, which costs about as much as real ideographs.
+    void AddFonts(ImFontAtlas& rAtlas, const FontCase& rCase)
+    {
+        ImFontConfig config;
+        config.SizePixels = rCase.sizePixels;
+        rAtlas.AddFontDefault(&config);
+        config.SizePixels = rCase.sizePixels * 2.0f;
+        rAtlas.AddFontDefault(&config);
+        // AddFontDefault() always asks for the default ranges
+        if (rCase.chinese)
+        {
+            for (int i = 0; i < rAtlas.ConfigData.Size; ++i)
+                rAtlas.ConfigData[i].GlyphRanges = rAtlas.GetGlyphRangesChinese();
+        }
+    }
+
+    bool SameOutput(const ImFontAtlas& rA, const ImFontAtlas& rB)
+    {
+        if (rA.TexWidth != rB.TexWidth || rA.TexHeight != rB.TexHeight || rA.Fonts.Size != rB.Fonts.Size
+            || std::memcmp(rA.TexPixelsAlpha8, rB.TexPixelsAlpha8, (size_t)rA.TexWidth * rA.TexHeight) != 0)
+            return false;
+        for (int i = 0; i < rA.Fonts.Size; ++i)
+        {
+            const ImFont& rFontA = *rA.Fonts[i];
+            const ImFont& rFontB = *rB.Fonts[i];
+            if (rFontA.Ascent != rFontB.Ascent || rFontA.Descent != rFontB.Descent || rFontA.Glyphs.Size != rFontB.Glyphs.Size)
+                return false;
+            // field by field, ImFontGlyph has padding after the code point
+            for (int g = 0; g < rFontA.Glyphs.Size; ++g)
+            {
+                const ImFontGlyph& rGlyphA = rFontA.Glyphs[g];
+                const ImFontGlyph& rGlyphB = rFontB.Glyphs[g];
+                if (rGlyphA.Codepoint != rGlyphB.Codepoint || rGlyphA.AdvanceX != rGlyphB.AdvanceX
+                    || rGlyphA.X0 != rGlyphB.X0 || rGlyphA.Y0 != rGlyphB.Y0 || rGlyphA.X1 != rGlyphB.X1 || rGlyphA.Y1 != rGlyphB.Y1
+                    || rGlyphA.U0 != rGlyphB.U0 || rGlyphA.V0 != rGlyphB.V0 || rGlyphA.U1 != rGlyphB.U1 || rGlyphA.V1 != rGlyphB.V1)
+                    return false;
+            }
+        }
+        return true;
+    }
+}
+
+// Builds font atlases with the Latin and the Chinese glyph ranges serially,
+// with the glyphs rasterized on a worker pool, and through the disk cache,
+// and checks that all four give the same pixels and glyph tables.
+int RunFontAtlasBench()
+{
+    const FontCase cases[] = {
+        { "latin 13+26 px", 13.0f, false },
+        { "chinese 13+26 px", 13.0f, true }
+    };
+    const char* const MODE_NAMES[MODE_COUNT] = { "serial", "parallel", "cache miss", "cache hit" };
+
+    WorkerPool pool(std::max(1u, std::thread::hardware_concurrency()));
+    std::printf("%u worker threads\n", pool.GetThreadCount());
+
+    int result = 0;
+    for (unsigned int c = 0; c < sizeof(cases) / sizeof(cases[0]); ++c)
+    {
+        std::remove(CACHE_PATH);
+        ImFontAtlas atlases[MODE_COUNT];
+        double ms[MODE_COUNT];
+        for (unsigned int mode = 0; mode < MODE_COUNT; ++mode)
+        {
+            ImFontAtlas& rAtlas = atlases[mode];
+            AddFonts(rAtlas, cases[c]);
+            if (mode != MODE_SERIAL)
+            {
+                rAtlas.BuildParallelForFn = ParallelForOnPool;
+                rAtlas.BuildParallelForUserData = &pool;
+            }
+            if (mode == MODE_CACHE_MISS || mode == MODE_CACHE_HIT)
+                rAtlas.BuildCacheFilename = CACHE_PATH;
+
+            const Clock::time_point start = Clock::now();
+            const bool built = rAtlas.Build();
+            ms[mode] = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+            if (!built || rAtlas.BuildFromCache != (mode == MODE_CACHE_HIT))
+            {
+                std::printf("  FAILED (%s build %s)\n", MODE_NAMES[mode], built ? "did not use the cache as expected" : "failed");
+                result = 1;
+            }
+        }
+
+        int glyphs = 0;
+        for (int i = 0; i < atlases[MODE_SERIAL].Fonts.Size; ++i)
+            glyphs += atlases[MODE_SERIAL].Fonts[i]->Glyphs.Size;
+        std::printf("%-18s %6d glyphs, %4dx%-5d", cases[c].pName, glyphs, atlases[MODE_SERIAL].TexWidth, atlases[MODE_SERIAL].TexHeight);
+        for (unsigned int mode = 0; mode < MODE_COUNT; ++mode)
+            std::printf("  %s %7.2f ms", MODE_NAMES[mode], ms[mode]);
+        for (unsigned int mode = 1; mode < MODE_COUNT; ++mode)
+        {
+            if (!SameOutput(atlases[MODE_SERIAL], atlases[mode]))
+            {
+                std::printf("  FAILED (%s output differs)", MODE_NAMES[mode]);
+                result = 1;
+            }
+        }
+        std::printf("\n");
+    }
+    std::remove(CACHE_PATH);
+    return result;
+}
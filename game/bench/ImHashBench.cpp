@@ -0,0 +1,154 @@
+#include "Benchmarks.h"
+#include "imgui/imgui.h"
+#include "imgui/imgui_internal.h"
+
+#include <chrono>
+#include <cstdio>
+
+namespace
+{
+    const unsigned int IDS_PER_CASE = 4000000;
+
+    typedef std::chrono::steady_clock Clock;
+
+    // Labels as the debug windows and the demo submit them.
+    const ImHashedStr SHORT_LABELS[] = {
+        IM_HASHED("OK"), IM_HASHED("X"), IM_HASHED("Apply"), IM_HASHED("Reset"),
+        IM_HASHED("Play"), IM_HASHED("Pause"), IM_HASHED("Speed"), IM_HASHED("Close")
+    };
+    const ImHashedStr MEDIUM_LABELS[] = {
+        IM_HASHED("Translation X"), IM_HASHED("Enable shadows"), IM_HASHED("Show ragdolls"), IM_HASHED("Camera distance"),
+        IM_HASHED("Ball##spawn"), IM_HASHED("Interest budget"), IM_HASHED("Link latency ms"), IM_HASHED("Frames per mode")
+    };
+    const ImHashedStr LONG_LABELS[] = {
+        IM_HASHED("Use the declared host state instead of reading it back"),
+        IM_HASHED("Draw the broadphase grid cells of the physics world"),
+        IM_HASHED("Keep the snapshot history of every connected client"),
+        IM_HASHED("Render the spectator camera path##replay timeline"),
+        IM_HASHED("Record the match to a replay file on the next kickoff"),
+        IM_HASHED("Show the round trip time and loss of every client link"),
+        IM_HASHED("Interpolate remote players between the last two snapshots"),
+        IM_HASHED("Freeze the simulation when a desync is detected")
+    };
+    const ImHashedStr TRIPLE_HASH_LABELS[] = {
+        IM_HASHED("Score 3 - 1###score"), IM_HASHED("Tick 18231###tick"), IM_HASHED("42 fps###fps"),
+        IM_HASHED("Ping 38 ms###ping"), IM_HASHED("Players 8/8###players"), IM_HASHED("Ball 12.5 m/s###ball"),
+        IM_HASHED("Stress 17###window"), IM_HASHED("Replay 00:41###replay")
+    };
+
+    const unsigned int LABELS_PER_SET = sizeof(SHORT_LABELS) / sizeof(SHORT_LABELS[0]);
+
+    struct LabelSet
+    {
+        const char* pName;
+        const ImHashedStr* pLabels;
+    };
+
+    // ImHash() as shipped with dear imgui: a bytewise CRC32 over the whole
+    // label, seeded with the ID stack.
+    ImU32 ReferenceHash(const char* pLabel, ImU32 seed)
+    {
+        static ImU32 table[256] = { 0 };
+        if (!table[1])
+        {
+            for (ImU32 i = 0; i < 256; ++i)
+            {
+                ImU32 crc = i;
+                for (unsigned int bit = 0; bit < 8; ++bit)
+                    crc = (crc >> 1) ^ (ImU32(-int(crc & 1)) & 0xEDB88320);
+                table[i] = crc;
+            }
+        }
+
+        seed = ~seed;
+        ImU32 crc = seed;
+        const unsigned char* pCurrent = (const unsigned char*)pLabel;
+        while (unsigned char c = *pCurrent++)
+        {
+            if (c == '#' && pCurrent[0] == '#' && pCurrent[1] == '#')
+                crc = seed;
+            crc = (crc >> 8) ^ table[(crc & 0xFF) ^ c];
+        }
+        return ~crc;
+    }
+
+    ImU32 HashReference(const ImHashedStr& rLabel, ImU32 seed)
+    {
+        return ReferenceHash(rLabel.Str, seed);
+    }
+
+    ImU32 HashRuntime(const ImHashedStr& rLabel, ImU32 seed)
+    {
+        return ImHash(rLabel.Str, 0, seed);
+    }
+
+#ifdef IMGUI_USE_FAST_HASH
+    ImU32 HashPrecomputed(const ImHashedStr& rLabel, ImU32 seed)
+    {
+        return ImHashCombine(seed, rLabel.Hash);
+    }
+#endif
+
+    // IDs per second over the labels, each seeded with the previous ID as a
+    // stand-in for the ID stack so that no call can be skipped.
+    double MeasureIdsPerSecond(ImU32 (*pHash)(const ImHashedStr&, ImU32), const ImHashedStr* pLabels, ImU32& rChecksum)
+    {
+        ImU32 seed = 0;
+        const Clock::time_point start = Clock::now();
+        for (unsigned int i = 0; i < IDS_PER_CASE; ++i)
+            seed = pHash(pLabels[i % LABELS_PER_SET], seed);
+        const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        rChecksum += seed;
+        return IDS_PER_CASE / seconds;
+    }
+}
+
+// Hashes widget labels of typical lengths into IDs with the reference CRC32,
+// the runtime ImHash() and, with IMGUI_USE_FAST_HASH, labels hashed at
+// compile time, and checks that the compile-time hashes give the same IDs.
+int RunImHashBench()
+{
+    const LabelSet sets[] = {
+        { "short (1-5 chars)", SHORT_LABELS },
+        { "medium (11-15 chars)", MEDIUM_LABELS },
+        { "long (47-57 chars)", LONG_LABELS },
+        { "label###id", TRIPLE_HASH_LABELS }
+    };
+
+    int result = 0;
+    ImU32 checksum = 0;
+    for (unsigned int s = 0; s < sizeof(sets) / sizeof(sets[0]); ++s)
+    {
+        const ImHashedStr* pLabels = sets[s].pLabels;
+        for (unsigned int i = 0; i < LABELS_PER_SET; ++i)
+        {
+            if (ImHash(pLabels[i].Str, 0, 0) == ImHash(pLabels[i].Str, 0, 1))
+            {
+                std::printf("  FAILED: \"%s\" hashes the same under two seeds\n", pLabels[i].Str);
+                result = 1;
+            }
+#ifdef IMGUI_USE_FAST_HASH
+            for (ImU32 seed = 0; seed < 4; ++seed)
+            {
+                if (ImHashCombine(seed, pLabels[i].Hash) != ImHash(pLabels[i].Str, 0, seed))
+                {
+                    std::printf("  FAILED: compile-time hash of \"%s\" differs from ImHash()\n", pLabels[i].Str);
+                    result = 1;
+                }
+            }
+#endif
+        }
+
+        const double reference = MeasureIdsPerSecond(HashReference, pLabels, checksum);
+        const double runtime = MeasureIdsPerSecond(HashRuntime, pLabels, checksum);
+        std::printf("%-22s reference CRC32 %7.1f M IDs/s, ImHash %7.1f M IDs/s (%.2fx)",
+                    sets[s].pName, reference / 1e6, runtime / 1e6, runtime / reference);
+#ifdef IMGUI_USE_FAST_HASH
+        const double precomputed = MeasureIdsPerSecond(HashPrecomputed, pLabels, checksum);
+        std::printf(", IM_HASHED %7.1f M IDs/s (%.2fx)", precomputed / 1e6, precomputed / reference);
+#endif
+        std::printf("\n");
+    }
+    std::printf("  checksum %08x\n", checksum);
+    return result;
+}
@@ -0,0 +1,286 @@
+#include "Benchmarks.h"
+#include "Match.h"
+#include "core/WorkerPool.h"
+#include "net/BotClient.h"
+#include "net/GameServer.h"
+#include "net/InterestManager.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+namespace
+{
+    // Brawl: every entity is a player with a client, wandering a square
+    // field at a fixed density whatever their number.
+    const unsigned int BRAWL_SIZES[] = { 125, 250, 500, 1000, 2000 };
+    const float BRAWL_DENSITY = 0.25f;               // players per square metre
+    const unsigned int BRAWL_BUDGET = 24;
+    const unsigned int BRAWL_TICKS = 600;            // every tick a snapshot
+    const unsigned int BRUTE_FORCE_TICKS = 8;
+    const float MAX_SECOND_SCALING = 2.0f;           // per-client cost, largest over smallest
+
+    // Loopback match: the 22 bots of a match, every entity or a third of them.
+    const unsigned int MATCH_BUDGET = 8;
+    const unsigned int MATCH_TICKS = 20 * Match::TICK_RATE;
+    const unsigned int SNAPSHOT_INTERVAL = 2;
+
+    typedef std::chrono::steady_clock Clock;
+
+    double MsSince(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    unsigned int NextRandom(unsigned int& rState)
+    {
+        rState ^= rState << 13;
+        rState ^= rState >> 17;
+        rState ^= rState << 5;
+        return rState;
+    }
+
+    float RandomFloat(unsigned int& rState)
+    {
+        return (NextRandom(rState) >> 8) / 16777216.0f;
+    }
+
+    // What a selection without the grid costs: every entity scored with the
+    // same priorities, the best ones picked.
+    struct BruteForce
+    {
+        std::vector<uint32_t> lastSent;
+        std::vector<std::pair<float, unsigned int> > scores;
+
+        unsigned int Select(unsigned int client, const std::vector<glm::vec3>& rPositions, const glm::vec3& rForward,
+                            const InterestSettings& rSettings, uint32_t tick, unsigned int* pOut)
+        {
+            const unsigned int count = (unsigned int)rPositions.size();
+            uint32_t* pLastSent = &lastSent[client * count];
+            const glm::vec3& rViewer = rPositions[client];
+            scores.clear();
+            for (unsigned int entity = 0; entity < count; ++entity)
+            {
+                if (entity == client)
+                    continue;
+                const float dx = rPositions[entity].x - rViewer.x;
+                const float dz = rPositions[entity].z - rViewer.z;
+                const float distance = std::sqrt(dx * dx + dz * dz);
+                float priority = distance > rSettings.viewRadius ? 0.01f : 1.0f / (1.0f + distance / rSettings.falloff);
+                if (dx * rForward.x + dz * rForward.z < 0.0f)
+                    priority *= rSettings.behindFactor;
+                scores.push_back(std::make_pair(-priority * (float)(tick - pLastSent[entity] + 1), entity));
+            }
+            const unsigned int chosen = std::min((unsigned int)scores.size(), rSettings.budget - 1);
+            std::nth_element(scores.begin(), scores.begin() + chosen, scores.end());
+            pOut[0] = client;
+            for (unsigned int i = 0; i < chosen; ++i)
+            {
+                pOut[i + 1] = scores[i].second;
+                pLastSent[scores[i].second] = tick;
+            }
+            return chosen + 1;
+        }
+    };
+
+    struct BrawlResult
+    {
+        double usPerClient;
+        double bruteUsPerClient;
+        double candidatesPerClient;
+        double meanCloseAge;       // ticks, entities within the falloff
+        unsigned int maxCloseAge;
+        double meanFarAge;         // ticks, entities beyond the view radius
+        unsigned int maxFarAge;
+        double neighbours;         // entities in view per client
+    };
+
+    BrawlResult RunBrawl(unsigned int count)
+    {
+        const InterestSettings settings = CreateMatchInterestSettings(BRAWL_BUDGET);
+        const float side = std::sqrt(count / BRAWL_DENSITY);
+        std::vector<glm::vec3> positions(count);
+        std::vector<glm::vec3> velocities(count, glm::vec3(0.0f));
+        unsigned int random = 0x9E3779B9u ^ count;
+        for (unsigned int i = 0; i < count; ++i)
+            positions[i] = glm::vec3(RandomFloat(random) * side, 0.2f, RandomFloat(random) * side);
+
+        InterestManager interest(count, count, settings);
+        BruteForce bruteForce;
+        bruteForce.lastSent.assign(count * count, 0);
+        std::vector<unsigned int> chosen(BRAWL_BUDGET);
+        const float dt = Match::GetTickSeconds();
+        double selectMs = 0.0;
+        double bruteMs = 0.0;
+        for (uint32_t tick = 1; tick <= BRAWL_TICKS; ++tick)
+        {
+            for (unsigned int i = 0; i < count; ++i)
+            {
+                if (NextRandom(random) % 30 == 0)
+                    velocities[i] = glm::vec3(RandomFloat(random) * 8.0f - 4.0f, 0.0f, RandomFloat(random) * 8.0f - 4.0f);
+                positions[i] += velocities[i] * dt;
+                positions[i].x = std::min(std::max(positions[i].x, 0.0f), side);
+                positions[i].z = std::min(std::max(positions[i].z, 0.0f), side);
+            }
+
+            Clock::time_point start = Clock::now();
+            interest.Update(&positions[0], tick);
+            for (unsigned int client = 0; client < count; ++client)
+                interest.Select(client, positions[client], velocities[client], &client, 1, &chosen[0]);
+            selectMs += MsSince(start);
+
+            if (tick <= BRUTE_FORCE_TICKS)
+            {
+                start = Clock::now();
+                for (unsigned int client = 0; client < count; ++client)
+                    bruteForce.Select(client, positions, velocities[client], settings, tick, &chosen[0]);
+                bruteMs += MsSince(start);
+            }
+        }
+
+        BrawlResult result;
+        result.usPerClient = selectMs * 1000.0 / BRAWL_TICKS / count;
+        result.bruteUsPerClient = bruteMs * 1000.0 / BRUTE_FORCE_TICKS / count;
+        result.candidatesPerClient = (double)interest.GetCandidatesScored() / BRAWL_TICKS / count;
+        uint64_t closeAges = 0;
+        uint64_t farAges = 0;
+        unsigned int closeCount = 0;
+        unsigned int farCount = 0;
+        unsigned int inView = 0;
+        result.maxCloseAge = 0;
+        result.maxFarAge = 0;
+        for (unsigned int client = 0; client < count; ++client)
+        {
+            for (unsigned int entity = 0; entity < count; ++entity)
+            {
+                if (entity == client)
+                    continue;
+                const float dx = positions[entity].x - positions[client].x;
+                const float dz = positions[entity].z - positions[client].z;
+                const float distance = std::sqrt(dx * dx + dz * dz);
+                const unsigned int age = interest.GetAge(client, entity);
+                if (distance <= settings.falloff)
+                {
+                    closeAges += age;
+                    ++closeCount;
+                    result.maxCloseAge = std::max(result.maxCloseAge, age);
+                }
+                if (distance <= settings.viewRadius)
+                {
+                    ++inView;
+                }
+                else
+                {
+                    farAges += age;
+                    ++farCount;
+                    result.maxFarAge = std::max(result.maxFarAge, age);
+                }
+            }
+        }
+        result.meanCloseAge = closeCount > 0 ? (double)closeAges / closeCount : 0.0;
+        result.meanFarAge = farCount > 0 ? (double)farAges / farCount : 0.0;
+        result.neighbours = (double)inView / count;
+        return result;
+    }
+
+    struct MatchResult
+    {
+        double kbitPerClient;
+        double entitiesPerSnapshot;
+        double relevancyUsPerSnapshot;
+        unsigned int snapshots;
+        unsigned int decodeFailures;
+    };
+
+    // Server and bots over loopback in simulated time.
+    MatchResult RunMatch(unsigned int budget)
+    {
+        MatchResult result = {};
+        WorkerPool pool(1);
+        Match match;
+        GameServer server(match, SNAPSHOT_INTERVAL);
+        server.SetInterestBudget(budget);
+        if (!server.Open(NET_LOOPBACK, 0, UDP_BACKEND_SINGLE))
+            return result;
+        const NetAddress address = { NET_LOOPBACK, server.GetLocalAddress().port };
+
+        std::vector<BotClient*> bots;
+        for (unsigned int i = 0; i < Match::PLAYER_COUNT; ++i)
+        {
+            bots.push_back(new BotClient(i + 1));
+            bots.back()->Open(address);
+        }
+
+        const double tickMs = 1000.0 / Match::TICK_RATE;
+        for (unsigned int tick = 0; tick < MATCH_TICKS; ++tick)
+        {
+            const double nowMs = tick * tickMs;
+            if (tick == Match::TICK_RATE)
+                server.ResetStats();
+            server.Update(pool, nowMs);
+            for (unsigned int i = 0; i < bots.size(); ++i)
+                bots[i]->Update(nowMs);
+        }
+
+        const ServerStats& rStats = server.GetStats();
+        const unsigned int snapshots = rStats.ticks / SNAPSHOT_INTERVAL * Match::PLAYER_COUNT;
+        const double seconds = rStats.ticks * tickMs / 1000.0;
+        result.kbitPerClient = rStats.bytesSent * 8.0 / 1000.0 / seconds / Match::PLAYER_COUNT;
+        result.entitiesPerSnapshot = (double)rStats.entitiesSent / snapshots;
+        result.relevancyUsPerSnapshot = rStats.relevancyMs * 1000.0 / snapshots;
+        for (unsigned int i = 0; i < bots.size(); ++i)
+        {
+            result.snapshots += bots[i]->GetSnapshotsReceived();
+            result.decodeFailures += bots[i]->GetDecodeFailures();
+            delete bots[i];
+        }
+        return result;
+    }
+}
+
+// Relevancy filtering with InterestManager. Brawls of growing size at a fixed
+// density time a selection per client against scoring every entity, and
+// report how stale the entities near and far from each client are after
+// the budget has been spread over them. A loopback match then compares the
+// bandwidth of GameServer with and without a budget, every snapshot
+// decoding on its bots.
+int RunInterestBench()
+{
+    const unsigned int sizeCount = sizeof(BRAWL_SIZES) / sizeof(BRAWL_SIZES[0]);
+    const double tickMs = 1000.0 / Match::TICK_RATE;
+    std::printf("brawl: %.2f players per m^2, budget %u entities per client per tick, %u ticks\n",
+                BRAWL_DENSITY, BRAWL_BUDGET, BRAWL_TICKS);
+    std::vector<BrawlResult> results;
+    for (unsigned int i = 0; i < sizeCount; ++i)
+    {
+        const BrawlResult result = RunBrawl(BRAWL_SIZES[i]);
+        std::printf("  %4u players: %.2f us per client (%.1f candidates, %.1f in view), brute force %.2f us (x%.1f), "
+                    "age within 3 m %.0f ms avg %.0f max, beyond view %.0f ms avg %.0f max\n",
+                    BRAWL_SIZES[i], result.usPerClient, result.candidatesPerClient, result.neighbours,
+                    result.bruteUsPerClient, result.bruteUsPerClient / result.usPerClient,
+                    result.meanCloseAge * tickMs, result.maxCloseAge * tickMs, result.meanFarAge * tickMs,
+                    result.maxFarAge * tickMs);
+        results.push_back(result);
+    }
+    const double scaling = results.back().usPerClient / results.front().usPerClient;
+    std::printf("  per-client cost x%.2f from %u to %u players\n", scaling, BRAWL_SIZES[0], BRAWL_SIZES[sizeCount - 1]);
+
+    const MatchResult all = RunMatch(0);
+    const MatchResult relevant = RunMatch(MATCH_BUDGET);
+    std::printf("loopback match, %u bots, snapshot every %u ticks:\n", Match::PLAYER_COUNT, SNAPSHOT_INTERVAL);
+    std::printf("  every entity: %.1f kbit/s per client, %.1f entities per snapshot, %u snapshots, %u undecodable\n",
+                all.kbitPerClient, all.entitiesPerSnapshot, all.snapshots, all.decodeFailures);
+    std::printf("  budget %u:     %.1f kbit/s per client, %.1f entities per snapshot, %.2f us choosing each, "
+                "%u snapshots, %u undecodable\n",
+                MATCH_BUDGET, relevant.kbitPerClient, relevant.entitiesPerSnapshot, relevant.relevancyUsPerSnapshot,
+                relevant.snapshots, relevant.decodeFailures);
+
+    const bool passed = scaling < MAX_SECOND_SCALING && all.snapshots > 0 && relevant.snapshots > 0 &&
+                        all.decodeFailures == 0 && relevant.decodeFailures == 0 &&
+                        relevant.kbitPerClient < all.kbitPerClient;
+    if (!passed)
+        std::printf("FAILED\n");
+    return passed ? 0 : 1;
+}
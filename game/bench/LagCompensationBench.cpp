@@ -0,0 +1,323 @@
+#include "Benchmarks.h"
+#include "Match.h"
+#include "core/WorkerPool.h"
+#include "net/GameClient.h"
+#include "net/GameServer.h"
+#include "net/HitHistory.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+namespace
+{
+    // Rewind queries: 64 players and the ball, every player charging every tick.
+    const unsigned int QUERY_ENTITIES = 65;
+    const unsigned int QUERY_TICKS = 6000;
+    const float QUERY_RADIUS = 0.55f;
+
+    // Loopback chase: the attacker charges when the drawn victim is within
+    // CHARGE_DISTANCE, at most once every CHARGE_COOLDOWN_MS.
+    const double CHASE_MS = 300000.0;
+    const float CHARGE_DISTANCE = 0.70f;
+    const double CHARGE_COOLDOWN_MS = 400.0;
+    const double STRAFE_MS = 350.0;
+    const float LANE_X = 4.8f;
+    const double SEAT_RETRY_MS = 1000.0;
+
+    typedef std::chrono::steady_clock Clock;
+
+    double MsSince(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    unsigned int NextRandom(unsigned int& rState)
+    {
+        rState ^= rState << 13;
+        rState ^= rState >> 17;
+        rState ^= rState << 5;
+        return rState;
+    }
+
+    float RandomFloat(unsigned int& rState)
+    {
+        return (NextRandom(rState) >> 8) / 16777216.0f;
+    }
+
+    // Entities wander a 100 x 60 m field. Queries are centred on an entity at
+    // a random view up to a second old; every one is checked against a
+    // brute-force scan of GetSphere() before the timed pass.
+    int RunQueryCase()
+    {
+        HitHistory history(QUERY_ENTITIES);
+        std::vector<glm::vec3> centres(QUERY_ENTITIES);
+        std::vector<glm::vec3> velocities(QUERY_ENTITIES, glm::vec3(0.0f));
+        std::vector<float> radii(QUERY_ENTITIES, Match::GetPlayerRadius());
+        radii[0] = 0.1f;
+        unsigned int random = 0x2545F491u;
+        for (unsigned int i = 0; i < QUERY_ENTITIES; ++i)
+            centres[i] = glm::vec3(RandomFloat(random) * 100.0f - 50.0f, 0.2f, RandomFloat(random) * 60.0f - 30.0f);
+
+        std::vector<HitHistory::Hit> hits(QUERY_ENTITIES);
+        unsigned int queries = 0;
+        unsigned int mismatches = 0;
+        unsigned long long found = 0;
+        double queryMs = 0.0;
+        const float dt = Match::GetTickSeconds();
+        for (uint32_t tick = 0; tick < QUERY_TICKS; ++tick)
+        {
+            for (unsigned int i = 0; i < QUERY_ENTITIES; ++i)
+            {
+                if (NextRandom(random) % 30 == 0)
+                    velocities[i] = glm::vec3(RandomFloat(random) * 10.0f - 5.0f, 0.0f, RandomFloat(random) * 10.0f - 5.0f);
+                centres[i] += velocities[i] * dt;
+            }
+            history.Record(tick, &centres[0], &radii[0], QUERY_ENTITIES);
+            if (tick < HitHistory::HISTORY_TICKS)
+                continue;
+
+            uint32_t views[QUERY_ENTITIES];
+            float fractions[QUERY_ENTITIES];
+            for (unsigned int i = 0; i < QUERY_ENTITIES; ++i)
+            {
+                views[i] = tick - NextRandom(random) % HitHistory::HISTORY_TICKS;
+                fractions[i] = RandomFloat(random);
+            }
+
+            Clock::time_point start = Clock::now();
+            for (unsigned int i = 1; i < QUERY_ENTITIES; ++i)
+                found += history.Query(views[i], fractions[i], centres[i], QUERY_RADIUS, &hits[0], QUERY_ENTITIES);
+            queryMs += MsSince(start);
+            queries += QUERY_ENTITIES - 1;
+
+            for (unsigned int i = 1; i < QUERY_ENTITIES; ++i)
+            {
+                const unsigned int count = history.Query(views[i], fractions[i], centres[i], QUERY_RADIUS, &hits[0], QUERY_ENTITIES);
+                unsigned int next = 0;
+                for (unsigned int entity = 0; entity < QUERY_ENTITIES; ++entity)
+                {
+                    glm::vec3 centre;
+                    float radius;
+                    history.GetSphere(entity, views[i], fractions[i], centre, radius);
+                    const glm::vec3 offset = centre - centres[i];
+                    const float distanceSq = offset.x * offset.x + offset.y * offset.y + offset.z * offset.z;
+                    const float limit = radius + QUERY_RADIUS;
+                    if (!(distanceSq < limit * limit))
+                        continue;
+                    if (next >= count || hits[next].entity != entity || hits[next].distanceSq != distanceSq)
+                        ++mismatches;
+                    ++next;
+                }
+                if (next != count)
+                    ++mismatches;
+            }
+        }
+
+        const double nsPerQuery = queryMs * 1e6 / queries;
+        std::printf("rewind queries: %u entities, %u queries, %.1f ns each (%.0f per ms), %.2f hits each, "
+                    "64 per tick cost %.4f ms, history %zu bytes, %u mismatches vs brute force%s\n",
+                    QUERY_ENTITIES, queries, nsPerQuery, 1e6 / nsPerQuery, (double)found / queries,
+                    nsPerQuery * 64.0 / 1e6, history.GetMemoryBytes(), mismatches, mismatches == 0 ? "" : "  FAILED");
+        return mismatches == 0 ? 0 : 1;
+    }
+
+    // Holds a seat on the server so the next client lands on the other team:
+    // it only ever connects, which also keeps it from timing out.
+    struct Seat
+    {
+        UdpSocket socket;
+        double nextMs;
+
+        Seat() : nextMs(0.0) {}
+
+        void Update(const NetAddress& rServer, double nowMs)
+        {
+            if (nowMs < nextMs)
+                return;
+            PacketHeader header = { SERVER_PACKET_MAGIC, PACKET_CONNECT, SERVER_NO_PLAYER, 0 };
+            socket.Send(rServer, &header, sizeof(header));
+            unsigned char buffer[64];
+            NetAddress from;
+            while (socket.Receive(buffer, sizeof(buffer), from) >= 0)
+            {
+            }
+            nextMs = nowMs + SEAT_RETRY_MS;
+        }
+    };
+
+    glm::vec3 Flat(const glm::vec3& rVector)
+    {
+        return glm::vec3(rVector.x, 0.0f, rVector.z);
+    }
+
+    PlayerInput Steer(const glm::vec3& rDirection)
+    {
+        PlayerInput input = PlayerInput();
+        const float length = glm::length(rDirection);
+        if (length > 0.001f)
+        {
+            input.moveX = (signed char)(127.0f * rDirection.x / std::max(length, 1.0f));
+            input.moveZ = (signed char)(127.0f * rDirection.z / std::max(length, 1.0f));
+        }
+        return input;
+    }
+
+    struct ChaseResult
+    {
+        unsigned int attacks;
+        unsigned int hits;
+        double averageRewind;
+        unsigned int maxRewind;
+        double checkUs;
+    };
+
+    // A GameServer with an attacking client on player 0 and a victim client
+    // on the first player of the other team, the seats in between held. The
+    // victim strafes along z in a free lane; the attacker runs at where it
+    // draws the victim and charges when it looks close enough.
+    bool RunChase(float latencyMs, bool compensate, ChaseResult& rResult)
+    {
+        WorkerPool pool(1);
+        Match match;
+        GameServer server(match, 2);
+        if (!server.Open(NET_LOOPBACK, 0))
+        {
+            std::printf("cannot open server socket\n");
+            return false;
+        }
+        server.SetLagCompensation(compensate);
+        server.GetConditioner().SetConditions(latencyMs, 0.0f, 0.0f);
+        const NetAddress address = { NET_LOOPBACK, server.GetLocalAddress().port };
+
+        GameClient attacker;
+        attacker.Open(address);
+        attacker.GetConditioner().SetConditions(latencyMs, 0.0f, 0.0f);
+        const double tickMs = 1000.0 / Match::TICK_RATE;
+        double nextTickMs = 0.0;
+        double nowMs = 0.0;
+        for (; nowMs < 1000.0 && !attacker.IsConnected(); nowMs += 1.0)
+        {
+            if (nowMs >= nextTickMs)
+            {
+                server.Update(pool, nowMs);
+                nextTickMs += tickMs;
+            }
+            attacker.Update(PlayerInput(), nowMs);
+        }
+
+        std::vector<Seat> seats(Match::PLAYER_COUNT / 2 - 1);
+        for (unsigned int i = 0; i < seats.size(); ++i)
+            seats[i].socket.Open(0, 0);
+        GameClient victim;
+        for (; nowMs < 2000.0 && server.GetClientCount() < seats.size() + 1; nowMs += 1.0)
+        {
+            if (nowMs >= nextTickMs)
+            {
+                server.Update(pool, nowMs);
+                nextTickMs += tickMs;
+            }
+            attacker.Update(PlayerInput(), nowMs);
+            for (unsigned int i = 0; i < seats.size(); ++i)
+                seats[i].Update(address, nowMs);
+        }
+        victim.Open(address);
+        victim.GetConditioner().SetConditions(latencyMs, 0.0f, 0.0f);
+        const unsigned int victimEntity = Match::PLAYER_COUNT / 2 + 1;
+
+        double lastChargeMs = -CHARGE_COOLDOWN_MS;
+        bool charging = false;
+        const double startMs = nowMs;
+        for (; nowMs < startMs + CHASE_MS; nowMs += 1.0)
+        {
+            if (nowMs >= nextTickMs)
+            {
+                server.Update(pool, nowMs);
+                nextTickMs += tickMs;
+                // measure from the first tick with both clients in play
+                if (nowMs - startMs < 2000.0)
+                    server.ResetStats();
+            }
+            for (unsigned int i = 0; i < seats.size(); ++i)
+                seats[i].Update(address, nowMs);
+
+            PlayerInput victimInput = PlayerInput();
+            if (victim.HasSnapshot())
+            {
+                const glm::vec3 position = victim.GetDrawPosition(victim.GetPlayer() + 1, nowMs);
+                const bool up = (unsigned int)(nowMs / STRAFE_MS) % 2 == 0;
+                victimInput = Steer(glm::vec3((LANE_X - position.x) * 2.0f, 0.0f, up ? 1.0f : -1.0f));
+            }
+            victim.Update(victimInput, nowMs);
+
+            PlayerInput attackerInput = PlayerInput();
+            if (attacker.HasSnapshot() && victim.GetPlayer() + 1 == victimEntity)
+            {
+                const unsigned int self = attacker.GetPlayer() + 1;
+                const glm::vec3 toVictim = Flat(attacker.GetDrawPosition(victimEntity, nowMs) - attacker.GetDrawPosition(self, nowMs));
+                const bool victimDown = (attacker.GetEntityFlags(victimEntity) & ENTITY_KNOCKED_OUT) != 0;
+                const bool selfDown = (attacker.GetEntityFlags(self) & ENTITY_KNOCKED_OUT) != 0;
+                if (!victimDown && !selfDown)
+                {
+                    attackerInput = Steer(toVictim * 4.0f);
+                    // one tick held down, so the server sees a single press
+                    if (charging && nowMs - lastChargeMs < tickMs * 2.0)
+                        attackerInput.buttons = BUTTON_CHARGE;
+                    else
+                        charging = false;
+                    if (!charging && glm::length(toVictim) < CHARGE_DISTANCE && nowMs - lastChargeMs >= CHARGE_COOLDOWN_MS)
+                    {
+                        attackerInput.buttons = BUTTON_CHARGE;
+                        charging = true;
+                        lastChargeMs = nowMs;
+                    }
+                }
+            }
+            attacker.Update(attackerInput, nowMs);
+        }
+
+        const ServerStats& rStats = server.GetStats();
+        rResult.attacks = rStats.attacks;
+        rResult.hits = rStats.hits;
+        rResult.averageRewind = rStats.attacks > 0 ? (double)rStats.rewoundTicks / rStats.attacks : 0.0;
+        rResult.maxRewind = rStats.maxRewindTicks;
+        rResult.checkUs = rStats.attacks > 0 ? rStats.attackCheckMs * 1000.0 / rStats.attacks : 0.0;
+        attacker.Disconnect();
+        victim.Disconnect();
+        return true;
+    }
+
+    int RunChaseCase(float latencyMs)
+    {
+        ChaseResult results[2];
+        if (!RunChase(latencyMs, true, results[0]) || !RunChase(latencyMs, false, results[1]))
+            return 1;
+
+        double rates[2];
+        for (unsigned int i = 0; i < 2; ++i)
+            rates[i] = results[i].attacks > 0 ? 100.0 * results[i].hits / results[i].attacks : 0.0;
+        // compensation must never make things worse, and at a real latency
+        // it has to confirm clearly more of what the attacker saw connect
+        const bool better = results[0].attacks > 0 && rates[0] >= rates[1] && (latencyMs == 0.0f || rates[0] > rates[1] + 10.0);
+        std::printf("latency %3.0f ms: compensated %3u/%3u hits (%5.1f%%), rewind %.1f ticks avg %u max, %.2f us per check; "
+                    "present-time %3u/%3u hits (%5.1f%%)%s\n",
+                    latencyMs, results[0].hits, results[0].attacks, rates[0], results[0].averageRewind, results[0].maxRewind,
+                    results[0].checkUs, results[1].hits, results[1].attacks, rates[1], better ? "" : "  FAILED");
+        return better ? 0 : 1;
+    }
+}
+
+// Times rewind queries on a HitHistory at 64 players and checks them against
+// a brute-force scan, then plays a chase over loopback: how many of the
+// charges the attacker saw connect the server confirms, with lag
+// compensation and with checks against the present.
+int RunLagCompensationBench()
+{
+    int result = RunQueryCase();
+    const float latencies[] = { 0.0f, 50.0f, 100.0f };
+    for (unsigned int i = 0; i < sizeof(latencies) / sizeof(latencies[0]); ++i)
+        result |= RunChaseCase(latencies[i]);
+    return result;
+}
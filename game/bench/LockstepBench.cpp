@@ -0,0 +1,90 @@
+#include "Benchmarks.h"
+#include "ScriptedControl.h"
+#include "Match.h"
+#include "core/WorkerPool.h"
+
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    const unsigned int TICKS = 1800;
+
+    // Plays the scripted match and returns the state hash after every tick.
+    std::vector<uint64_t> PlayMatch(unsigned int threads, double& rMsPerTick)
+    {
+        WorkerPool pool(threads);
+        Match match;
+        std::vector<ScriptedControl> controls;
+        for (unsigned int i = 0; i < Match::PLAYER_COUNT; ++i)
+            controls.push_back(ScriptedControl(i));
+
+        std::vector<PlayerInput> inputs(Match::PLAYER_COUNT);
+        std::vector<uint64_t> hashes;
+        hashes.reserve(TICKS);
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (unsigned int tick = 0; tick < TICKS; ++tick)
+        {
+            for (unsigned int i = 0; i < Match::PLAYER_COUNT; ++i)
+                inputs[i] = controls[i].Poll(tick);
+            match.Tick(&inputs[0], pool);
+            hashes.push_back(match.GetStateHash());
+        }
+        rMsPerTick = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / TICKS;
+        return hashes;
+    }
+}
+
+// Runs one input log on several worker counts and fails on the first tick
+// whose state hash differs from the single-threaded run.
+int RunLockstepBench()
+{
+    std::vector<unsigned int> threadCounts;
+    threadCounts.push_back(1);
+    threadCounts.push_back(2);
+    threadCounts.push_back(3);
+    threadCounts.push_back(4);
+    unsigned int hardwareThreads = std::thread::hardware_concurrency();
+    if (hardwareThreads > 4)
+        threadCounts.push_back(hardwareThreads);
+
+    double msPerTick = 0.0;
+    std::vector<uint64_t> reference = PlayMatch(1, msPerTick);
+    std::printf("%2u threads: %8.4f ms/tick, final hash %016llx\n", 1u, msPerTick, (unsigned long long)reference.back());
+
+    int result = 0;
+    for (unsigned int i = 1; i < threadCounts.size(); ++i)
+    {
+        std::vector<uint64_t> hashes = PlayMatch(threadCounts[i], msPerTick);
+        unsigned int tick = 0;
+        while (tick < TICKS && hashes[tick] == reference[tick])
+            ++tick;
+
+        std::printf("%2u threads: %8.4f ms/tick, final hash %016llx", threadCounts[i], msPerTick, (unsigned long long)hashes.back());
+        if (tick < TICKS)
+        {
+            std::printf("  DESYNC at tick %u\n", tick);
+            result = 1;
+        }
+        else
+        {
+            std::printf("  identical\n");
+        }
+    }
+
+    // The per-tick hash is paid by every tick above; time it on its own.
+    {
+        Match match;
+        const unsigned int repeats = 1000;
+        uint64_t sink = 0;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (unsigned int i = 0; i < repeats; ++i)
+            sink ^= match.HashState();
+        double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / repeats;
+        std::printf("state hash: %.2f us (%llx)\n", us, (unsigned long long)(sink & 0xF));
+    }
+    return result;
+}
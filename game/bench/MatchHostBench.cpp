@@ -0,0 +1,127 @@
+#include "Benchmarks.h"
+#include "Match.h"
+#include "net/BotClient.h"
+#include "net/MatchHost.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    const unsigned int BOTS_PER_MATCH = 4;
+    const double WARMUP_MS = 1000.0;
+    const double MEASURE_MS = 3000.0;
+    const double MAX_MISSED_FRACTION = 0.01;
+    const double MIN_TICK_FRACTION = 0.9;    // of the ticks the measured time holds
+
+    typedef std::chrono::steady_clock Clock;
+
+    double MsSince(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    void PlayBots(std::vector<BotClient*>& rBots, Clock::time_point start, double untilMs)
+    {
+        while (MsSince(start) < untilMs)
+        {
+            const double nowMs = MsSince(start);
+            for (unsigned int i = 0; i < rBots.size(); ++i)
+                rBots[i]->Update(nowMs);
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    // Hosts the matches with bots playing every one of them from this thread,
+    // and returns whether every match kept its tick rate.
+    bool RunCase(unsigned int matchCount, unsigned int workerCount, size_t arenaBytes)
+    {
+        MatchHost host(matchCount, workerCount, 2, arenaBytes);
+        if (!host.Open(NET_LOOPBACK, 0))
+        {
+            std::printf("cannot open %u loopback ports\n", matchCount);
+            return false;
+        }
+
+        std::vector<BotClient*> bots;
+        for (unsigned int match = 0; match < matchCount; ++match)
+        {
+            const NetAddress address = { NET_LOOPBACK, host.GetLocalAddress(match).port };
+            for (unsigned int i = 0; i < BOTS_PER_MATCH; ++i)
+            {
+                bots.push_back(new BotClient(match * BOTS_PER_MATCH + i + 1));
+                bots.back()->Open(address);
+            }
+        }
+
+        const Clock::time_point start = Clock::now();
+        host.Start();
+        PlayBots(bots, start, WARMUP_MS);
+        host.ResetStats();
+        PlayBots(bots, start, WARMUP_MS + MEASURE_MS);
+        host.Stop();
+
+        std::vector<float> p50s;
+        float worstP99 = 0.0f;
+        float worstMax = 0.0f;
+        float worstLateness = 0.0f;
+        unsigned int ticks = 0;
+        unsigned int fewestTicks = 0xFFFFFFFFu;
+        unsigned int missed = 0;
+        unsigned int clients = 0;
+        size_t arenaUsed = 0;
+        size_t overflow = 0;
+        for (unsigned int match = 0; match < matchCount; ++match)
+        {
+            const MatchTickStats stats = host.GetTickStats(match);
+            p50s.push_back(stats.p50Ms);
+            worstP99 = std::max(worstP99, stats.p99Ms);
+            worstMax = std::max(worstMax, stats.maxMs);
+            worstLateness = std::max(worstLateness, stats.maxLatenessMs);
+            ticks += stats.ticks;
+            fewestTicks = std::min(fewestTicks, stats.ticks);
+            missed += stats.missedDeadlines;
+            clients += stats.clients;
+            arenaUsed = std::max(arenaUsed, stats.arenaBytes);
+            overflow += stats.overflowBytes;
+        }
+        for (unsigned int i = 0; i < bots.size(); ++i)
+            delete bots[i];
+
+        std::sort(p50s.begin(), p50s.end());
+        const unsigned int expectedTicks = (unsigned int)(MEASURE_MS * Match::TICK_RATE / 1000.0);
+        const bool kept = missed <= ticks * MAX_MISSED_FRACTION && fewestTicks >= expectedTicks * MIN_TICK_FRACTION;
+        std::printf("%3u matches, %u workers (%u pinned), %-5s  %3u clients  tick ms: median p50 %.3f  worst p99 %.3f  "
+                    "worst max %.3f  latest start %.2f  missed %u of %u  fewest ticks %u/%u  %s\n",
+                    matchCount, host.GetWorkerCount(), host.GetPinnedCount(), arenaBytes > 0 ? "arena" : "heap",
+                    clients, p50s[p50s.size() / 2], worstP99, worstMax, worstLateness, missed, ticks,
+                    fewestTicks, expectedTicks, kept ? "ok" : "FAILED");
+        if (arenaBytes > 0)
+        {
+            std::printf("                 arena %.0f KB used of %.0f KB per match, %.0f KB overflowed\n",
+                        arenaUsed / 1024.0, arenaBytes / 1024.0, overflow / 1024.0);
+        }
+        return kept;
+    }
+}
+
+// Load test of MatchHost: several counts of matches in one process, each
+// with bots playing over loopback, scheduled earliest deadline first on one
+// pinned worker per core. Reports the spread of per-match tick times and the
+// ticks that finished after the next was due, with each match's state in an
+// arena and, for comparison, on the heap.
+int RunMatchHostBench()
+{
+    const unsigned int cores = std::max(1u, std::thread::hardware_concurrency());
+    std::printf("%u bots per match, %u Hz, %.1f ms tick budget, %u cores\n",
+                BOTS_PER_MATCH, Match::TICK_RATE, 1000.0 / Match::TICK_RATE, cores);
+
+    bool kept = true;
+    kept &= RunCase(8, cores, MatchHost::DEFAULT_ARENA_BYTES);
+    kept &= RunCase(32, cores, MatchHost::DEFAULT_ARENA_BYTES);
+    kept &= RunCase(32, cores, 0);
+    return kept ? 0 : 1;
+}
@@ -0,0 +1,184 @@
+#include "Benchmarks.h"
+#include "Match.h"
+#include "core/WorkerPool.h"
+#include "net/GameClient.h"
+#include "net/GameServer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+namespace
+{
+    const double FIRST_PRESS_MS = 1000.0;
+    const double TRIAL_MS = 1200.0;
+    const double PRESS_MS = 300.0;
+    const unsigned int TRIALS = 8;
+    const double RUN_MS = FIRST_PRESS_MS + TRIALS * TRIAL_MS;
+    // how far the player must have moved to count as responding
+    const float RESPONSE_DISTANCE = 0.05f;
+
+    // Each trial starts from rest: run along +z (or -z on odd trials) for
+    // PRESS_MS, brake with the opposite input for as long, then coast.
+    PlayerInput ScheduledInput(double nowMs)
+    {
+        PlayerInput input = PlayerInput();
+        if (nowMs < FIRST_PRESS_MS)
+            return input;
+        const unsigned int trial = (unsigned int)((nowMs - FIRST_PRESS_MS) / TRIAL_MS);
+        const double intoTrial = nowMs - FIRST_PRESS_MS - trial * TRIAL_MS;
+        const signed char direction = trial % 2 ? -127 : 127;
+        if (trial < TRIALS && intoTrial < PRESS_MS)
+            input.moveZ = direction;
+        else if (trial < TRIALS && intoTrial < 2 * PRESS_MS)
+            input.moveZ = (signed char)-direction;
+        return input;
+    }
+
+    struct ResponseTracker
+    {
+        std::vector<double> responseMs;
+        unsigned int trial;
+        glm::vec3 start;
+        bool waiting;
+
+        ResponseTracker() : trial(0), waiting(false) {}
+
+        // Feed once per millisecond with the drawn position of the player.
+        void Sample(double nowMs, const glm::vec3& rPosition)
+        {
+            const double pressMs = FIRST_PRESS_MS + trial * TRIAL_MS;
+            if (trial < TRIALS && !waiting && nowMs >= pressMs)
+            {
+                start = rPosition;
+                waiting = true;
+            }
+            if (waiting && std::fabs(rPosition.z - start.z) >= RESPONSE_DISTANCE)
+            {
+                responseMs.push_back(nowMs - pressMs);
+                waiting = false;
+                ++trial;
+            }
+            else if (waiting && nowMs >= pressMs + TRIAL_MS)
+            {
+                waiting = false;
+                ++trial;
+            }
+        }
+
+        double GetAverage() const
+        {
+            double sum = 0.0;
+            for (unsigned int i = 0; i < responseMs.size(); ++i)
+                sum += responseMs[i];
+            return responseMs.empty() ? 0.0 : sum / responseMs.size();
+        }
+    };
+
+    // The same schedule played straight into a Match, drawn every millisecond
+    // from the latest tick: what a player gets without a network.
+    double MeasureLocal()
+    {
+        WorkerPool pool(1);
+        Match match;
+        std::vector<PlayerInput> inputs(Match::PLAYER_COUNT);
+        ResponseTracker tracker;
+        const double tickMs = 1000.0 / Match::TICK_RATE;
+        double nextTickMs = 0.0;
+        for (double nowMs = 0.0; nowMs < RUN_MS; nowMs += 1.0)
+        {
+            if (nowMs >= nextTickMs)
+            {
+                inputs[0] = ScheduledInput(nowMs);
+                match.Tick(&inputs[0], pool);
+                nextTickMs += tickMs;
+            }
+            tracker.Sample(nowMs, match.GetWorld().GetPosition(match.GetPlayers()[0].GetBody()));
+        }
+        return tracker.GetAverage();
+    }
+
+    // A GameServer and two clients on loopback, both controlling their player
+    // with the schedule, one predicting and one drawing snapshots only. The
+    // link delays both directions by latencyMs on a virtual clock.
+    int RunCase(float latencyMs, float jitterMs, double localMs)
+    {
+        WorkerPool pool(1);
+        Match match;
+        GameServer server(match, 2);
+        if (!server.Open(NET_LOOPBACK, 0))
+        {
+            std::printf("cannot open server socket\n");
+            return 1;
+        }
+        server.GetConditioner().SetConditions(latencyMs, jitterMs, 0.0f);
+
+        GameClient predicted;
+        GameClient unpredicted;
+        unpredicted.SetPredictionEnabled(false);
+        NetAddress address = { NET_LOOPBACK, server.GetLocalAddress().port };
+        predicted.Open(address);
+        predicted.GetConditioner().SetConditions(latencyMs, jitterMs, 0.0f);
+        // a head start so the predicting client gets player 0
+        predicted.Update(PlayerInput(), 0.0);
+        unpredicted.Open(address);
+        unpredicted.GetConditioner().SetConditions(latencyMs, jitterMs, 0.0f);
+
+        ResponseTracker predictedTracker;
+        ResponseTracker unpredictedTracker;
+        const double tickMs = 1000.0 / Match::TICK_RATE;
+        double nextTickMs = 0.0;
+        float maxStep = 0.0f;
+        glm::vec3 lastDrawn(0.0f);
+        bool drawn = false;
+        for (double nowMs = 0.0; nowMs < RUN_MS; nowMs += 1.0)
+        {
+            if (nowMs >= nextTickMs)
+            {
+                server.Update(pool, nowMs);
+                nextTickMs += tickMs;
+            }
+            const PlayerInput input = ScheduledInput(nowMs);
+            predicted.Update(input, nowMs);
+            unpredicted.Update(input, nowMs);
+            if (!predicted.HasSnapshot() || !unpredicted.HasSnapshot())
+                continue;
+
+            const glm::vec3 position = predicted.GetDrawPosition(predicted.GetPlayer() + 1, nowMs);
+            predictedTracker.Sample(nowMs, position);
+            unpredictedTracker.Sample(nowMs, unpredicted.GetDrawPosition(unpredicted.GetPlayer() + 1, nowMs));
+            if (drawn)
+                maxStep = std::max(maxStep, glm::length(position - lastDrawn));
+            lastDrawn = position;
+            drawn = true;
+        }
+
+        const ClientStats& rStats = predicted.GetStats();
+        const double predictedMs = predictedTracker.GetAverage();
+        const bool responsive = predictedTracker.responseMs.size() == TRIALS && predictedMs <= localMs + tickMs;
+        std::printf("latency %3.0f ms + %2.0f jitter: response %5.1f ms predicted, %5.1f ms unpredicted (local %.1f), "
+                    "rtt %5.1f ms, %2u unacked, correction %.3f m last %.3f m max, largest drawn step %.3f m%s\n",
+                    latencyMs, jitterMs, predictedMs, unpredictedTracker.GetAverage(), localMs,
+                    rStats.rttMs, rStats.unackedInputs, rStats.lastCorrection, rStats.maxCorrection, maxStep,
+                    responsive ? "" : "  FAILED");
+        predicted.Disconnect();
+        unpredicted.Disconnect();
+        return responsive ? 0 : 1;
+    }
+}
+
+// Measures how long the local player takes to visibly respond to input when
+// playing against a server over loopback with injected latency, with and
+// without prediction, against local play. Predicted play has to stay within
+// a tick of local play.
+int RunPredictionBench()
+{
+    const double localMs = MeasureLocal();
+    const float latencies[] = { 0.0f, 25.0f, 50.0f, 100.0f, 150.0f };
+
+    int result = 0;
+    for (unsigned int i = 0; i < sizeof(latencies) / sizeof(latencies[0]); ++i)
+        result |= RunCase(latencies[i], latencies[i] * 0.1f, localMs);
+    return result;
+}
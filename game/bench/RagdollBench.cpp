@@ -0,0 +1,52 @@
+#include "Benchmarks.h"
+#include "core/WorkerPool.h"
+#include "physics/RagdollSystem.h"
+
+#include <chrono>
+#include <cstdio>
+#include <thread>
+
+namespace
+{
+    const unsigned int TICKS = 600;
+    const float STEP = 1.0f / 60.0f;
+
+    // Spawns count ragdolls tumbling in random-ish directions and reports how
+    // many ragdoll ticks are solved per millisecond.
+    void RunCase(unsigned int count, unsigned int threads)
+    {
+        WorkerPool pool(threads);
+        RagdollSystem ragdolls(count);
+        ragdolls.SetPitchBounds(30.0f, 20.0f);
+        for (unsigned int i = 0; i < count; ++i)
+        {
+            glm::vec3 feet((float)(i % 32) - 16.0f, 0.0f, (float)(i / 32) - 16.0f);
+            glm::vec3 velocity((float)(i % 7) - 3.0f, 2.0f, (float)(i % 5) - 2.0f);
+            ragdolls.Spawn(feet, velocity, 0.8f);
+        }
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (unsigned int tick = 0; tick < TICKS; ++tick)
+        {
+            ragdolls.Step(STEP, pool);
+        }
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        std::printf("%6u ragdolls, %2u threads: %8.4f ms/tick, %10.1f ragdolls/ms\n",
+                    count, threads, ms / TICKS, count * TICKS / ms);
+    }
+}
+
+int RunRagdollBench()
+{
+    const unsigned int counts[] = { 50, 256, 1024, 4096 };
+    unsigned int hardwareThreads = std::thread::hardware_concurrency();
+
+    for (unsigned int i = 0; i < sizeof(counts) / sizeof(counts[0]); ++i)
+    {
+        RunCase(counts[i], 1);
+        if (hardwareThreads > 1)
+            RunCase(counts[i], hardwareThreads);
+    }
+    return 0;
+}
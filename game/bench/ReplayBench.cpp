@@ -0,0 +1,123 @@
+#include "Benchmarks.h"
+#include "ScriptedControl.h"
+#include "Match.h"
+#include "core/WorkerPool.h"
+#include "replay/ReplayPlayer.h"
+#include "replay/ReplayRecorder.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+namespace
+{
+    const unsigned int MATCH_MINUTES = 90;
+    const unsigned int TICKS = MATCH_MINUTES * 60 * Match::TICK_RATE;
+    const unsigned int SEEKS = 200;
+    const char* REPLAY_PATH = "deathball_bench.replay";
+
+    typedef std::chrono::steady_clock Clock;
+
+    double MsSince(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+}
+
+// Records a full scripted match, then seeks to random ticks and checks the
+// restored state hash against the one seen while recording.
+int RunReplayBench()
+{
+    WorkerPool pool(1);
+    std::vector<uint64_t> hashes;
+    hashes.reserve(TICKS + 1);
+
+    double tickMs = 0.0;
+    double recordMs = 0.0;
+    ReplayRecorder recorder;
+    {
+        Match match;
+        std::vector<ScriptedControl> controls;
+        for (unsigned int i = 0; i < Match::PLAYER_COUNT; ++i)
+            controls.push_back(ScriptedControl(i));
+        std::vector<PlayerInput> inputs(Match::PLAYER_COUNT);
+
+        if (!recorder.Begin(REPLAY_PATH, match))
+        {
+            std::printf("cannot write %s\n", REPLAY_PATH);
+            return 1;
+        }
+        hashes.push_back(match.GetStateHash());
+        for (unsigned int tick = 0; tick < TICKS; ++tick)
+        {
+            for (unsigned int i = 0; i < Match::PLAYER_COUNT; ++i)
+                inputs[i] = controls[i].Poll(tick);
+
+            Clock::time_point start = Clock::now();
+            recorder.RecordTick(match, &inputs[0]);
+            Clock::time_point recorded = Clock::now();
+            match.Tick(&inputs[0], pool);
+            tickMs += MsSince(recorded);
+            recordMs += std::chrono::duration<double, std::milli>(recorded - start).count();
+
+            hashes.push_back(match.GetStateHash());
+        }
+        recorder.End();
+    }
+
+    std::printf("%u ticks (%u min): %.4f ms/tick simulating, %.5f ms/tick recording (%.2f%%)\n",
+                TICKS, MATCH_MINUTES, tickMs / TICKS, recordMs / TICKS, 100.0 * recordMs / tickMs);
+    std::printf("file: %.2f MB, %u keyframes, %.1f bytes/tick\n",
+                recorder.GetBytesWritten() / (1024.0 * 1024.0), recorder.GetKeyframeCount(),
+                (double)recorder.GetBytesWritten() / TICKS);
+
+    int result = 0;
+    ReplayPlayer player;
+    Clock::time_point openStart = Clock::now();
+    if (!player.Open(REPLAY_PATH))
+    {
+        std::printf("cannot open %s\n", REPLAY_PATH);
+        return 1;
+    }
+    std::printf("open: %.3f ms\n", MsSince(openStart));
+
+    Match match;
+    double totalMs = 0.0;
+    double worstMs = 0.0;
+    unsigned int seed = 12345;
+    for (unsigned int i = 0; i < SEEKS; ++i)
+    {
+        seed = seed * 1664525u + 1013904223u;
+        unsigned int tick = (seed >> 8) % (TICKS + 1);
+
+        Clock::time_point start = Clock::now();
+        player.Seek(match, tick, pool);
+        double ms = MsSince(start);
+        totalMs += ms;
+        worstMs = std::max(worstMs, ms);
+
+        if (match.GetTick() != tick || match.GetStateHash() != hashes[tick])
+        {
+            std::printf("seek to tick %u restored the wrong state\n", tick);
+            result = 1;
+        }
+    }
+    std::printf("%u seeks: %.3f ms average, %.3f ms worst\n", SEEKS, totalMs / SEEKS, worstMs);
+
+    // Straight playback from the start must follow the recording tick for tick.
+    player.Seek(match, 0, pool);
+    for (unsigned int tick = 1; tick <= 3600 && player.Advance(match, pool); ++tick)
+    {
+        if (match.GetStateHash() != hashes[tick])
+        {
+            std::printf("playback diverged at tick %u\n", tick);
+            result = 1;
+            break;
+        }
+    }
+
+    player.Close();
+    std::remove(REPLAY_PATH);
+    return result;
+}
@@ -0,0 +1,103 @@
+#include "Benchmarks.h"
+#include "ScriptedControl.h"
+#include "Match.h"
+#include "core/WorkerPool.h"
+#include "net/RollbackSession.h"
+
+#include <cstdio>
+#include <vector>
+
+namespace
+{
+    const unsigned int FRAMES = 3600;
+    const double FRAME_MS = 1000.0 / 60.0;
+
+    struct Conditions
+    {
+        float latencyMs;
+        float jitterMs;
+        float lossPercent;
+    };
+
+    // Two peers in one process, talking over loopback UDP through link
+    // conditioners on a virtual clock, so the run is not paced by real time.
+    int RunCase(const Conditions& rConditions, WorkerPool& rPool)
+    {
+        Match matches[2];
+        RollbackSession peer0(matches[0], 0);
+        RollbackSession peer1(matches[1], 1);
+        RollbackSession* peers[2] = { &peer0, &peer1 };
+        for (unsigned int p = 0; p < 2; ++p)
+        {
+            if (!peers[p]->Open(0))
+            {
+                std::printf("cannot open a loopback socket\n");
+                return 1;
+            }
+            peers[p]->GetConditioner().SetConditions(rConditions.latencyMs, rConditions.jitterMs, rConditions.lossPercent);
+        }
+        peer0.SetRemote(peer1.GetLocalAddress());
+        peer1.SetRemote(peer0.GetLocalAddress());
+
+        std::vector<ScriptedControl> controls;
+        for (unsigned int i = 0; i < Match::PLAYER_COUNT; ++i)
+            controls.push_back(ScriptedControl(i));
+        PlayerInput inputs[RollbackSession::PLAYERS_PER_PEER];
+
+        unsigned int depthSum[2] = { 0, 0 };
+        double resimSum[2] = { 0.0, 0.0 };
+        for (unsigned int frame = 0; frame < FRAMES; ++frame)
+        {
+            const double nowMs = frame * FRAME_MS;
+            for (unsigned int p = 0; p < 2; ++p)
+            {
+                const unsigned int first = p * RollbackSession::PLAYERS_PER_PEER;
+                for (unsigned int i = 0; i < RollbackSession::PLAYERS_PER_PEER; ++i)
+                    inputs[i] = controls[first + i].Poll(matches[p].GetTick());
+                peers[p]->AdvanceFrame(inputs, rPool, nowMs);
+                depthSum[p] += peers[p]->GetStats().rollbackDepth;
+                resimSum[p] += peers[p]->GetStats().resimMs;
+            }
+        }
+
+        int result = 0;
+        for (unsigned int p = 0; p < 2; ++p)
+        {
+            const RollbackStats& rStats = peers[p]->GetStats();
+            std::printf("  peer %u: tick %5u, %4u rollbacks, depth %.2f avg %2u max, re-sim %.3f ms/frame avg %.3f max, %3u stalls, %u/%u packets, checked tick %u",
+                        p, matches[p].GetTick(), rStats.rollbacks, (double)depthSum[p] / FRAMES, rStats.maxRollbackDepth,
+                        resimSum[p] / FRAMES, rStats.maxResimMs, rStats.stalls, rStats.packetsReceived, rStats.packetsSent,
+                        rStats.checkedTick);
+            if (rStats.desyncTick != RollbackSession::NO_TICK || rStats.checkedTick == RollbackSession::NO_TICK
+                || rStats.checkedTick + 2 * RollbackSession::MAX_PREDICTION + 60 < matches[p].GetTick())
+            {
+                std::printf("  FAILED (desync at %u)", rStats.desyncTick);
+                result = 1;
+            }
+            std::printf("\n");
+        }
+        return result;
+    }
+}
+
+// Plays a scripted match between two rollback peers under increasingly bad
+// links and checks that their confirmed state hashes keep agreeing.
+int RunRollbackBench()
+{
+    const Conditions cases[] = {
+        { 0.0f, 0.0f, 0.0f },
+        { 30.0f, 5.0f, 1.0f },
+        { 60.0f, 10.0f, 5.0f },
+        { 100.0f, 20.0f, 10.0f },
+        { 150.0f, 30.0f, 20.0f }
+    };
+
+    WorkerPool pool(1);
+    int result = 0;
+    for (unsigned int i = 0; i < sizeof(cases) / sizeof(cases[0]); ++i)
+    {
+        std::printf("latency %.0f ms, jitter %.0f ms, loss %.0f%%\n", cases[i].latencyMs, cases[i].jitterMs, cases[i].lossPercent);
+        result |= RunCase(cases[i], pool);
+    }
+    return result;
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "IControl.h"
+
+// Input that depends only on the player and the tick, so every run of a
+// benchmark plays the same match: players change direction every half
+// second and everybody charges the ball every TACKLE_PERIOD ticks.
+class ScriptedControl : public IControl
+{
+public:
+    static const unsigned int TACKLE_PERIOD = 240;
+
+    explicit ScriptedControl(unsigned int player) : m_player(player) {}
+
+    PlayerInput Poll(unsigned int tick) override
+    {
+        unsigned int bits = (tick / 30) * 2654435761u ^ (m_player + 1) * 40503u;
+        bits ^= bits >> 13;
+        bits *= 0x5bd1e995u;
+        bits ^= bits >> 15;
+
+        PlayerInput input;
+        input.moveX = (signed char)((int)(bits & 0xFF) - 128 + ((bits & 0xFF) == 0));
+        input.moveZ = (signed char)((int)((bits >> 8) & 0xFF) - 128 + (((bits >> 8) & 0xFF) == 0));
+        input.buttons = tick % TACKLE_PERIOD == TACKLE_PERIOD - 1 ? BUTTON_CHARGE : 0;
+        input.target = 0;
+        return input;
+    }
+
+private:
+    unsigned int m_player;
+};
@@ -0,0 +1,165 @@
+#include "Benchmarks.h"
+#include "imgui/imgui.h"
+#include "imgui/imgui_internal.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+namespace
+{
+    // Sizes the HUD draws text at, from the kill feed to the goal banner
+    const float HUD_SIZES[] = { 13.0f, 18.0f, 24.0f, 32.0f, 48.0f, 64.0f, 96.0f };
+    const unsigned int HUD_SIZE_COUNT = sizeof(HUD_SIZES) / sizeof(HUD_SIZES[0]);
+
+    // The distance field atlas is rasterized once at this size and scaled
+    const float SDF_BASE_SIZE = 32.0f;
+
+    const char* const HUD_LINES[] = {
+        "Score 3 - 1", "02:41", "Ping 38 ms", "GOAL!", "Player 7 scored from 31 m",
+        "Overtime", "Ball 12.5 m/s", "Red team wins the match"
+    };
+    const unsigned int HUD_LINE_COUNT = sizeof(HUD_LINES) / sizeof(HUD_LINES[0]);
+
+    const unsigned int FRAMES = 20000;
+
+    typedef std::chrono::steady_clock Clock;
+
+    double Milliseconds(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    // Every HUD line at one size per frame, into a draw list cleared as
+    // ImGui clears its own; returns glyphs per second.
+    double MeasureGlyphsPerSecond(ImDrawList& rList, ImFont* const* ppFonts, const float* pFontSizes, unsigned int& rChecksum)
+    {
+        const ImTextureID texture = ppFonts[0]->ContainerAtlas->TexID;
+        unsigned int glyphs = 0;
+        const Clock::time_point start = Clock::now();
+        for (unsigned int frame = 0; frame < FRAMES; ++frame)
+        {
+            const unsigned int sizeIndex = frame % HUD_SIZE_COUNT;
+            rList.Clear();
+            rList.PushTextureID(texture);
+            rList.PushClipRect(ImVec2(0.0f, 0.0f), ImVec2(8192.0f, 8192.0f));
+            float y = 0.0f;
+            for (unsigned int line = 0; line < HUD_LINE_COUNT; ++line)
+            {
+                rList.AddText(ppFonts[sizeIndex], pFontSizes[sizeIndex], ImVec2(8.0f, y), IM_COL32_WHITE, HUD_LINES[line]);
+                y += pFontSizes[sizeIndex];
+            }
+            glyphs += (unsigned int)rList.VtxBuffer.Size / 4;
+            rChecksum += (unsigned int)rList.IdxBuffer.Size;
+        }
+        return glyphs / (Milliseconds(start) / 1000.0);
+    }
+
+    // Inside the outline somewhere, and clear of it along the top row where
+    // the padding is, for every glyph with pixels
+    bool FieldsLookRight(const ImFontAtlas& rAtlas, const ImFont& rFont)
+    {
+        for (int g = 0; g < rFont.Glyphs.Size; ++g)
+        {
+            const ImFontGlyph& rGlyph = rFont.Glyphs[g];
+            const int x0 = (int)(rGlyph.U0 * rAtlas.TexWidth + 0.5f);
+            const int y0 = (int)(rGlyph.V0 * rAtlas.TexHeight + 0.5f);
+            const int x1 = (int)(rGlyph.U1 * rAtlas.TexWidth + 0.5f);
+            const int y1 = (int)(rGlyph.V1 * rAtlas.TexHeight + 0.5f);
+            if (x0 == x1 || y0 == y1)
+                continue;
+            unsigned char inside = 0;
+            unsigned char topRow = 0;
+            for (int y = y0; y < y1; ++y)
+            {
+                for (int x = x0; x < x1; ++x)
+                {
+                    const unsigned char value = rAtlas.TexPixelsAlpha8[y * rAtlas.TexWidth + x];
+                    inside = std::max(inside, value);
+                    if (y == y0)
+                        topRow = std::max(topRow, value);
+                }
+            }
+            if (inside < 128 || topRow >= 128)
+                return false;
+        }
+        return true;
+    }
+}
+
+// Builds the embedded font as one bitmap font per HUD size and as a single
+// signed distance field font, compares build time and texture memory as the
+// GL3 backend uploads them (RGBA for bitmaps, one channel for the field), then
+// times laying out HUD text with each. Checks that the scaled field font
+// measures text like the bitmap fonts and that its fields have an outline.
+// Only the CPU side: the distance field shader's fill cost needs a GPU.
+int RunSdfFontBench()
+{
+    ImFontAtlas bitmapAtlas;
+    ImFont* bitmapFonts[HUD_SIZE_COUNT];
+    for (unsigned int i = 0; i < HUD_SIZE_COUNT; ++i)
+    {
+        ImFontConfig config;
+        config.SizePixels = HUD_SIZES[i];
+        bitmapFonts[i] = bitmapAtlas.AddFontDefault(&config);
+    }
+    Clock::time_point start = Clock::now();
+    const bool bitmapBuilt = bitmapAtlas.Build();
+    const double bitmapMs = Milliseconds(start);
+
+    ImFontAtlas sdfAtlas;
+    sdfAtlas.Flags |= ImFontAtlasFlags_SignedDistanceField;
+    ImFontConfig config;
+    config.SizePixels = SDF_BASE_SIZE;
+    ImFont* pSdfFont = sdfAtlas.AddFontDefault(&config);
+    start = Clock::now();
+    const bool sdfBuilt = sdfAtlas.Build();
+    const double sdfMs = Milliseconds(start);
+
+    if (!bitmapBuilt || !sdfBuilt)
+    {
+        std::printf("  FAILED (%s atlas did not build)\n", bitmapBuilt ? "distance field" : "bitmap");
+        return 1;
+    }
+
+    const size_t bitmapPixels = (size_t)bitmapAtlas.TexWidth * bitmapAtlas.TexHeight;
+    const size_t sdfPixels = (size_t)sdfAtlas.TexWidth * sdfAtlas.TexHeight;
+    std::printf("bitmap, %u sizes     %4dx%-5d build %7.2f ms  texture %6zu KB RGBA (%5zu KB alpha)\n",
+                HUD_SIZE_COUNT, bitmapAtlas.TexWidth, bitmapAtlas.TexHeight, bitmapMs, bitmapPixels * 4 / 1024, bitmapPixels / 1024);
+    std::printf("distance field %2.0f px %4dx%-5d build %7.2f ms  texture %6zu KB R8   (%.1fx smaller)\n",
+                SDF_BASE_SIZE, sdfAtlas.TexWidth, sdfAtlas.TexHeight, sdfMs, sdfPixels / 1024, (double)(bitmapPixels * 4) / sdfPixels);
+
+    int result = 0;
+    if (!FieldsLookRight(sdfAtlas, *pSdfFont))
+    {
+        std::printf("  FAILED (a glyph field has no inside or no padding)\n");
+        result = 1;
+    }
+    for (unsigned int i = 0; i < HUD_SIZE_COUNT; ++i)
+    {
+        for (unsigned int line = 0; line < HUD_LINE_COUNT; ++line)
+        {
+            const float bitmapWidth = bitmapFonts[i]->CalcTextSizeA(HUD_SIZES[i], FLT_MAX, 0.0f, HUD_LINES[line]).x;
+            const float sdfWidth = pSdfFont->CalcTextSizeA(HUD_SIZES[i], FLT_MAX, 0.0f, HUD_LINES[line]).x;
+            if (std::fabs(bitmapWidth - sdfWidth) > 0.5f)
+            {
+                std::printf("  FAILED (\"%s\" at %.0f px is %.2f px wide, %.2f px with bitmaps)\n", HUD_LINES[line], HUD_SIZES[i], sdfWidth, bitmapWidth);
+                result = 1;
+            }
+        }
+    }
+
+    ImDrawListSharedData sharedData;
+    ImDrawList list(&sharedData);
+    ImFont* sdfFonts[HUD_SIZE_COUNT];
+    std::fill(sdfFonts, sdfFonts + HUD_SIZE_COUNT, pSdfFont);
+    unsigned int checksum = 0;
+    const double bitmapRate = MeasureGlyphsPerSecond(list, bitmapFonts, HUD_SIZES, checksum);
+    const double sdfRate = MeasureGlyphsPerSecond(list, sdfFonts, HUD_SIZES, checksum);
+    std::printf("text layout: bitmap %6.1f M glyphs/s, distance field %6.1f M glyphs/s (%.2fx)  checksum %u\n",
+                bitmapRate / 1e6, sdfRate / 1e6, sdfRate / bitmapRate, checksum);
+    return result;
+}
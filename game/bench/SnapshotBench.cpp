@@ -0,0 +1,194 @@
+#include "Benchmarks.h"
+#include "ScriptedControl.h"
+#include "Match.h"
+#include "core/WorkerPool.h"
+#include "net/SnapshotCodec.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+    const unsigned int SNAPSHOT_INTERVAL = 2;
+    const unsigned int SNAPSHOTS = 1800;
+    // baseline age: about 130 ms of acknowledgement round trip at 30 snapshots/s
+    const unsigned int ACK_DELAY = 4;
+    const unsigned int CROWD_SIZE = 1000;
+    const unsigned int PAYLOAD_CAPACITY = 64 * 1024;
+
+    typedef std::chrono::steady_clock Clock;
+
+    double MsSince(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    // Snapshot sequence of a scripted 22-player match.
+    void CaptureMatch(std::vector<EntityState>& rStates)
+    {
+        WorkerPool pool(1);
+        Match match;
+        std::vector<ScriptedControl> controls;
+        for (unsigned int i = 0; i < Match::PLAYER_COUNT; ++i)
+            controls.push_back(ScriptedControl(i));
+        std::vector<PlayerInput> inputs(Match::PLAYER_COUNT);
+
+        const unsigned int entityCount = Match::PLAYER_COUNT + 1;
+        rStates.resize(SNAPSHOTS * entityCount);
+        for (unsigned int snapshot = 0; snapshot < SNAPSHOTS; ++snapshot)
+        {
+            for (unsigned int step = 0; step < SNAPSHOT_INTERVAL; ++step)
+            {
+                for (unsigned int i = 0; i < Match::PLAYER_COUNT; ++i)
+                    inputs[i] = controls[i].Poll(match.GetTick());
+                match.Tick(&inputs[0], pool);
+            }
+            CaptureEntities(match, &rStates[snapshot * entityCount]);
+        }
+    }
+
+    // Synthetic crowd for scenes the match cannot produce yet: about half of
+    // the entities stand still at any time, the rest wander, and a few tumble as
+    // knocked out with a spinning orientation.
+    void CaptureCrowd(const glm::vec3& rMin, const glm::vec3& rMax, std::vector<EntityState>& rStates)
+    {
+        unsigned int random = 0x9E3779B9u;
+        struct Local
+        {
+            static float Next(unsigned int& rRandom)
+            {
+                rRandom ^= rRandom << 13;
+                rRandom ^= rRandom >> 17;
+                rRandom ^= rRandom << 5;
+                return (rRandom & 0xFFFFFF) / 16777216.0f;
+            }
+        };
+
+        std::vector<EntityState> crowd(CROWD_SIZE);
+        std::vector<float> spin(CROWD_SIZE, 0.0f);
+        for (unsigned int i = 0; i < CROWD_SIZE; ++i)
+        {
+            EntityState& rEntity = crowd[i];
+            rEntity.position = glm::vec3(rMin.x + (rMax.x - rMin.x) * Local::Next(random), 0.2f,
+                                         rMin.z + (rMax.z - rMin.z) * Local::Next(random));
+            rEntity.velocity = glm::vec3(0.0f);
+            rEntity.orientation = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+            rEntity.flags = 0;
+        }
+
+        const float dt = Match::GetTickSeconds() * SNAPSHOT_INTERVAL;
+        rStates.resize(SNAPSHOTS * CROWD_SIZE);
+        for (unsigned int snapshot = 0; snapshot < SNAPSHOTS; ++snapshot)
+        {
+            for (unsigned int i = 0; i < CROWD_SIZE; ++i)
+            {
+                EntityState& rEntity = crowd[i];
+                if (Local::Next(random) < 0.02f)
+                    rEntity.flags ^= ENTITY_AWAKE;
+                if (Local::Next(random) < 0.002f)
+                    rEntity.flags ^= ENTITY_KNOCKED_OUT;
+
+                if (!(rEntity.flags & ENTITY_AWAKE))
+                {
+                    rEntity.velocity = glm::vec3(0.0f);
+                    continue;
+                }
+                rEntity.velocity += glm::vec3(Local::Next(random) - 0.5f, 0.0f, Local::Next(random) - 0.5f);
+                if (glm::length(rEntity.velocity) > 5.0f)
+                    rEntity.velocity *= 5.0f / glm::length(rEntity.velocity);
+                rEntity.position = glm::clamp(rEntity.position + rEntity.velocity * dt, rMin, rMax);
+
+                if (rEntity.flags & ENTITY_KNOCKED_OUT)
+                {
+                    spin[i] += 6.0f * dt;
+                    rEntity.orientation = glm::vec4(std::sin(spin[i] * 0.5f), 0.0f, 0.0f, std::cos(spin[i] * 0.5f));
+                }
+                else
+                {
+                    rEntity.orientation = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+                }
+            }
+            std::copy(crowd.begin(), crowd.end(), rStates.begin() + snapshot * CROWD_SIZE);
+        }
+    }
+
+    // Quantises, encodes against the snapshot ACK_DELAY earlier and decodes
+    // every snapshot, checking that decoding restores the quantised state.
+    int RunScene(const char* pName, const SnapshotCodec& rCodec, const std::vector<EntityState>& rStates)
+    {
+        const unsigned int entityCount = rCodec.GetEntityCount();
+        const unsigned int snapshots = (unsigned int)(rStates.size() / entityCount);
+        std::vector<NetEntity> quantised(rStates.size());
+        std::vector<NetEntity> decoded(entityCount);
+        std::vector<unsigned char> payload(PAYLOAD_CAPACITY);
+
+        Clock::time_point start = Clock::now();
+        for (unsigned int snapshot = 0; snapshot < snapshots; ++snapshot)
+            rCodec.Quantise(&rStates[snapshot * entityCount], &quantised[snapshot * entityCount]);
+        const double quantiseMs = MsSince(start);
+
+        double encodeMs = 0.0;
+        double decodeMs = 0.0;
+        size_t deltaBytes = 0;
+        size_t fullBytes = 0;
+        unsigned int mismatches = 0;
+        for (unsigned int snapshot = 0; snapshot < snapshots; ++snapshot)
+        {
+            const NetEntity* pCurrent = &quantised[snapshot * entityCount];
+            const NetEntity* pBaseline = snapshot >= ACK_DELAY ? &quantised[(snapshot - ACK_DELAY) * entityCount] : 0;
+
+            fullBytes += rCodec.Encode(pCurrent, 0, &payload[0], payload.size());
+
+            Clock::time_point encodeStart = Clock::now();
+            const size_t bytes = rCodec.Encode(pCurrent, pBaseline, &payload[0], payload.size());
+            Clock::time_point decodeStart = Clock::now();
+            const bool ok = rCodec.Decode(&payload[0], bytes, pBaseline, &decoded[0]);
+            decodeMs += MsSince(decodeStart);
+            encodeMs += std::chrono::duration<double, std::milli>(decodeStart - encodeStart).count();
+
+            deltaBytes += bytes;
+            if (!ok || bytes == 0 || std::memcmp(&decoded[0], pCurrent, entityCount * sizeof(NetEntity)) != 0)
+                ++mismatches;
+        }
+
+        // the position error of quantisation itself, worst over the last snapshot
+        std::vector<EntityState> restored(entityCount);
+        rCodec.Dequantise(&quantised[(snapshots - 1) * entityCount], &restored[0]);
+        float maxError = 0.0f;
+        for (unsigned int i = 0; i < entityCount; ++i)
+        {
+            const glm::vec3 error = glm::abs(restored[i].position - rStates[(snapshots - 1) * entityCount + i].position);
+            maxError = std::max(maxError, std::max(error.x, std::max(error.y, error.z)));
+        }
+
+        const double rawBytes = (double)entityCount * sizeof(EntityState);
+        std::printf("%s: %u entities, %u snapshots\n", pName, entityCount, snapshots);
+        std::printf("  bytes/snapshot: %.1f delta, %.1f full, %.0f raw floats (%.1fx smaller)\n",
+                    (double)deltaBytes / snapshots, (double)fullBytes / snapshots, rawBytes,
+                    rawBytes * snapshots / std::max<size_t>(deltaBytes, 1));
+        std::printf("  quantise %.2f us, encode %.2f us, decode %.2f us per snapshot (%.1f / %.1f M entities/s)\n",
+                    1000.0 * quantiseMs / snapshots, 1000.0 * encodeMs / snapshots, 1000.0 * decodeMs / snapshots,
+                    entityCount * snapshots / encodeMs / 1000.0, entityCount * snapshots / decodeMs / 1000.0);
+        std::printf("  max position error %.4f m, round-trip mismatches %u%s\n",
+                    maxError, mismatches, mismatches ? "  FAILED" : "");
+        return mismatches ? 1 : 0;
+    }
+}
+
+int RunSnapshotBench()
+{
+    glm::vec3 min, max;
+    Match::GetPitchBounds(min, max);
+
+    std::vector<EntityState> states;
+    CaptureMatch(states);
+    int result = RunScene("match", CreateMatchCodec(), states);
+
+    CaptureCrowd(min, max, states);
+    result |= RunScene("crowd", SnapshotCodec(min, max, CROWD_SIZE), states);
+    return result;
+}
@@ -0,0 +1,157 @@
+#include "Benchmarks.h"
+#include "Match.h"
+#include "ScriptedControl.h"
+#include "core/WorkerPool.h"
+#include "net/SpectatorClient.h"
+#include "net/SpectatorRelay.h"
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+namespace
+{
+    const unsigned int SPECTATORS = 5000;
+    const unsigned int LATE_JOINERS = 1000;          // of them, joining at LATE_JOIN_TICK
+    const unsigned int FRAME_INTERVAL = 2;
+    const unsigned int KEYFRAME_INTERVAL = 30;       // frames, one second
+    const unsigned int DELAY_TICKS = 2 * Match::TICK_RATE;
+    const unsigned int TICKS = 12 * Match::TICK_RATE;
+    const unsigned int LATE_JOIN_TICK = 6 * Match::TICK_RATE + 7;
+    const unsigned int JOINS_PER_TICK = 100;         // before that, the audience arriving
+
+    typedef std::chrono::steady_clock Clock;
+
+    // Five thousand sockets are more than the usual default descriptor limit.
+    void RaiseDescriptorLimit()
+    {
+#ifndef _WIN32
+        rlimit limit;
+        if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max)
+        {
+            limit.rlim_cur = limit.rlim_max;
+            setrlimit(RLIMIT_NOFILE, &limit);
+        }
+#endif
+    }
+}
+
+// Load test of SpectatorRelay: a scripted match broadcast over loopback to
+// 5000 spectators, a fifth of them joining halfway, in simulated time as
+// fast as the machine goes. Reports the relay's CPU time and memory per
+// spectator, against encoding a stream per spectator, and checks that every
+// spectator decodes every frame it gets and is on the newest released one.
+int RunSpectatorBench()
+{
+    RaiseDescriptorLimit();
+
+    SpectatorRelay relay(SPECTATORS, FRAME_INTERVAL, KEYFRAME_INTERVAL, DELAY_TICKS);
+    if (!relay.Open(NET_LOOPBACK, 0))
+    {
+        std::printf("cannot open the relay socket\n");
+        return 1;
+    }
+    const NetAddress address = { NET_LOOPBACK, relay.GetLocalAddress().port };
+
+    std::vector<SpectatorClient*> spectators;
+    for (unsigned int i = 0; i < SPECTATORS; ++i)
+        spectators.push_back(new SpectatorClient());
+
+    WorkerPool pool(1);
+    Match match;
+    std::vector<ScriptedControl> controls;
+    for (unsigned int i = 0; i < Match::PLAYER_COUNT; ++i)
+        controls.push_back(ScriptedControl(i));
+    std::vector<PlayerInput> inputs(Match::PLAYER_COUNT);
+
+    const double tickMs = 1000.0 / Match::TICK_RATE;
+    double relayMs = 0.0;
+    unsigned int opened = 0;
+    for (unsigned int tick = 0; tick < TICKS; ++tick)
+    {
+        const double nowMs = tick * tickMs;
+        const unsigned int arrived = tick < LATE_JOIN_TICK ? SPECTATORS - LATE_JOINERS : SPECTATORS;
+        const unsigned int toOpen = tick < LATE_JOIN_TICK ? std::min(arrived, opened + JOINS_PER_TICK) : arrived;
+        for (; opened < toOpen; ++opened)
+        {
+            if (!spectators[opened]->Open(address))
+            {
+                std::printf("cannot open spectator socket %u\n", opened);
+                for (unsigned int i = 0; i < SPECTATORS; ++i)
+                    delete spectators[i];
+                return 1;
+            }
+        }
+
+        for (unsigned int i = 0; i < Match::PLAYER_COUNT; ++i)
+            inputs[i] = controls[i].Poll(match.GetTick());
+        match.Tick(&inputs[0], pool);
+
+        const Clock::time_point start = Clock::now();
+        relay.Publish(match);
+        relay.Update(nowMs);
+        relayMs += std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+        if (tick % FRAME_INTERVAL == 0 || tick + 1 == TICKS || tick == LATE_JOIN_TICK)
+        {
+            for (unsigned int i = 0; i < opened; ++i)
+                spectators[i]->Update(nowMs);
+        }
+    }
+
+    unsigned int watching = 0;
+    unsigned int current = 0;
+    unsigned int failures = 0;
+    uint64_t frames = 0;
+    uint64_t bytesReceived = 0;
+    std::vector<double> lateJoinMs;
+    for (unsigned int i = 0; i < SPECTATORS; ++i)
+    {
+        const SpectatorClient& rSpectator = *spectators[i];
+        watching += rSpectator.IsWatching();
+        current += rSpectator.GetLastTick() == relay.GetReleasedTick();
+        failures += rSpectator.GetDecodeFailures();
+        frames += rSpectator.GetFramesReceived();
+        bytesReceived += rSpectator.GetBytesReceived();
+        if (i >= SPECTATORS - LATE_JOINERS)
+            lateJoinMs.push_back(rSpectator.GetJoinMs());
+    }
+    for (unsigned int i = 0; i < SPECTATORS; ++i)
+        delete spectators[i];
+    std::sort(lateJoinMs.begin(), lateJoinMs.end());
+
+    const RelayStats& rStats = relay.GetStats();
+    const double seconds = TICKS * tickMs / 1000.0;
+    const double encodeMsPerFrame = rStats.encodeMs / rStats.frames;
+    std::printf("%u spectators (%u joining at %.1f s), a frame every %u ticks, keyframe every %u frames, %.1f s delay, "
+                "%s datagram I/O\n",
+                SPECTATORS, LATE_JOINERS, LATE_JOIN_TICK * tickMs / 1000.0, FRAME_INTERVAL, KEYFRAME_INTERVAL,
+                DELAY_TICKS * tickMs / 1000.0, BatchedUdpSocket::GetBackendName(relay.GetBackend()));
+    std::printf("  relay: %u frames (%u keyframes) encoded once, %.1f bytes avg, %.4f ms to encode each\n",
+                rStats.frames, rStats.keyframes, (double)rStats.bytesEncoded / rStats.frames, encodeMsPerFrame);
+    std::printf("  relay: %.0f ms for %.0f s of match (%.1f%% of a core), %.2f us per spectator per second, "
+                "fan-out %.0f ns per datagram\n",
+                relayMs, seconds, relayMs / (seconds * 10.0), relayMs * 1000.0 / seconds / SPECTATORS,
+                rStats.fanOutMs * 1e6 / rStats.packetsSent);
+    std::printf("  encoding per spectator instead: %.1f ms per frame, %.1f%% of a core\n",
+                encodeMsPerFrame * SPECTATORS, encodeMsPerFrame * SPECTATORS * rStats.frames / (seconds * 10.0));
+    std::printf("  memory: %.1f KB in the relay, %.1f bytes per spectator\n",
+                relay.GetMemoryBytes() / 1024.0, (double)relay.GetMemoryBytes() / SPECTATORS);
+    std::printf("  spectators: %u watching, %u on the released tick %u (match tick %u), %.1f frames and "
+                "%.1f kbit/s each, %u undecodable\n",
+                watching, current, relay.GetReleasedTick(), match.GetTick(), (double)frames / SPECTATORS,
+                bytesReceived * 8.0 / 1000.0 / seconds / SPECTATORS, failures);
+    std::printf("  late joiners: %u from the latest keyframe, first frame after %.1f ms median %.1f ms max\n",
+                rStats.lateJoins, lateJoinMs[lateJoinMs.size() / 2], lateJoinMs.back());
+
+    const bool delayed = relay.GetReleasedTick() + DELAY_TICKS <= match.GetTick();
+    const bool passed = watching == SPECTATORS && current == SPECTATORS && failures == 0 && delayed;
+    if (!passed)
+        std::printf("FAILED\n");
+    return passed ? 0 : 1;
+}
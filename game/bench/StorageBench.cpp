@@ -0,0 +1,187 @@
+#include "Benchmarks.h"
+#include "imgui/imgui.h"
+#include "imgui/imgui_internal.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+namespace
+{
+    const unsigned int KEY_COUNTS[] = { 100, 1000, 10000, 100000 };
+    const unsigned int MIN_OPERATIONS = 100000;
+
+    // Steps through the keys in an order unrelated to their insertion; prime, so
+    // it reaches every key of the power of ten counts.
+    const unsigned int LOOKUP_STRIDE = 7919;
+
+    typedef std::chrono::steady_clock Clock;
+
+    // ImGuiStorage as shipped with dear imgui: pairs sorted by key, found by
+    // binary search and inserted in place.
+    class SortedStorage
+    {
+    public:
+        int GetInt(ImGuiID key, int defaultValue) const
+        {
+            const Pair* pPair = LowerBound(key);
+            if (pPair == m_pairs.end() || pPair->key != key)
+                return defaultValue;
+            return pPair->val_i;
+        }
+
+        void SetInt(ImGuiID key, int value)
+        {
+            Pair* pPair = const_cast<Pair*>(LowerBound(key));
+            if (pPair == m_pairs.end() || pPair->key != key)
+            {
+                m_pairs.insert(pPair, Pair(key, value));
+                return;
+            }
+            pPair->val_i = value;
+        }
+
+    private:
+        typedef ImGuiStorage::Pair Pair;
+
+        const Pair* LowerBound(ImGuiID key) const
+        {
+            const Pair* pFirst = m_pairs.begin();
+            size_t count = (size_t)m_pairs.Size;
+            while (count > 0)
+            {
+                const size_t half = count >> 1;
+                const Pair* pMiddle = pFirst + half;
+                if (pMiddle->key < key)
+                {
+                    pFirst = pMiddle + 1;
+                    count -= half + 1;
+                }
+                else
+                {
+                    count = half;
+                }
+            }
+            return pFirst;
+        }
+
+        ImVector<Pair> m_pairs;
+    };
+
+    struct Timing
+    {
+        double insertNs;
+        double lookupNs;
+        double missNs;
+    };
+
+    // Inserts the keys in the order tree nodes are first opened, then looks
+    // them all up in another order, then looks up keys that are not there.
+    // Small key counts are repeated so that every timing covers about
+    // MIN_OPERATIONS operations.
+    template<typename Storage>
+    Timing Measure(const std::vector<ImGuiID>& rKeys, const std::vector<ImGuiID>& rLookups,
+                   const std::vector<ImGuiID>& rMisses, int& rChecksum)
+    {
+        const unsigned int repeats = std::max(1u, MIN_OPERATIONS / (unsigned int)rKeys.size());
+        const unsigned int lookupRepeats = repeats * 4;
+        Timing timing = { 0.0, 0.0, 0.0 };
+        std::vector<Storage> storages(repeats);
+
+        Clock::time_point start = Clock::now();
+        for (unsigned int r = 0; r < repeats; ++r)
+        {
+            for (size_t i = 0; i < rKeys.size(); ++i)
+                storages[r].SetInt(rKeys[i], (int)i);
+        }
+        timing.insertNs = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / (repeats * rKeys.size());
+
+        const Storage& rStorage = storages[0];
+        start = Clock::now();
+        for (unsigned int r = 0; r < lookupRepeats; ++r)
+        {
+            for (size_t i = 0; i < rLookups.size(); ++i)
+                rChecksum += rStorage.GetInt(rLookups[i], -1);
+        }
+        timing.lookupNs = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / (lookupRepeats * rLookups.size());
+
+        start = Clock::now();
+        for (unsigned int r = 0; r < lookupRepeats; ++r)
+        {
+            for (size_t i = 0; i < rMisses.size(); ++i)
+                rChecksum += rStorage.GetInt(rMisses[i], -1);
+        }
+        timing.missNs = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / (lookupRepeats * rMisses.size());
+        return timing;
+    }
+
+    // Tree node IDs of an entity inspector: "entity %u" pushed, then the
+    // nodes under it.
+    void MakeKeys(unsigned int count, std::vector<ImGuiID>& rKeys, std::vector<ImGuiID>& rMisses)
+    {
+        rKeys.clear();
+        rMisses.clear();
+        const char* const NODES[] = { "Transform", "Physics", "Ragdoll", "Network" };
+        const unsigned int nodeCount = sizeof(NODES) / sizeof(NODES[0]);
+        char label[32];
+        for (unsigned int i = 0; i < count; ++i)
+        {
+            ImFormatString(label, sizeof(label), "entity %u", i / nodeCount);
+            const ImGuiID entity = ImHash(label, 0, 0x5EED);
+            rKeys.push_back(ImHash(NODES[i % nodeCount], 0, entity));
+            rMisses.push_back(ImHash("Scripts", 0, entity + i));
+        }
+    }
+}
+
+// Fills ImGuiStorage and the sorted-vector storage it replaces with 100 to
+// 100k keys and times inserts, lookups of present keys and lookups of
+// missing ones, checking that both give back the same values.
+int RunStorageBench()
+{
+#ifdef IMGUI_USE_HASHED_STORAGE
+    const char* pBackend = "hashed";
+#else
+    const char* pBackend = "sorted";
+#endif
+    std::printf("ImGuiStorage backend: %s\n", pBackend);
+
+    int result = 0;
+    std::vector<ImGuiID> keys;
+    std::vector<ImGuiID> misses;
+    for (unsigned int c = 0; c < sizeof(KEY_COUNTS) / sizeof(KEY_COUNTS[0]); ++c)
+    {
+        MakeKeys(KEY_COUNTS[c], keys, misses);
+        std::vector<ImGuiID> lookups(keys.size());
+        for (size_t i = 0; i < keys.size(); ++i)
+            lookups[i] = keys[(i * LOOKUP_STRIDE) % keys.size()];
+
+        int referenceChecksum = 0;
+        int checksum = 0;
+        const Timing reference = Measure<SortedStorage>(keys, lookups, misses, referenceChecksum);
+        const Timing timing = Measure<ImGuiStorage>(keys, lookups, misses, checksum);
+        std::printf("%6u keys: insert %6.1f -> %5.1f ns, lookup %5.1f -> %5.1f ns, miss %5.1f -> %5.1f ns",
+                    KEY_COUNTS[c], reference.insertNs, timing.insertNs, reference.lookupNs, timing.lookupNs,
+                    reference.missNs, timing.missNs);
+
+        // duplicate IDs keep their last value in both
+        SortedStorage sorted;
+        ImGuiStorage storage;
+        for (size_t i = 0; i < keys.size(); ++i)
+        {
+            sorted.SetInt(keys[i], (int)i);
+            storage.SetInt(keys[i], (int)i);
+        }
+        bool same = checksum == referenceChecksum;
+        for (size_t i = 0; i < keys.size(); ++i)
+            same &= storage.GetInt(keys[i], -1) == sorted.GetInt(keys[i], -1) && storage.GetInt(misses[i], -1) == sorted.GetInt(misses[i], -1);
+        if (!same)
+        {
+            std::printf("  FAILED (values differ from the sorted storage)");
+            result = 1;
+        }
+        std::printf("\n");
+    }
+    return result;
+}
@@ -0,0 +1,412 @@
+#include "Benchmarks.h"
+#include "imgui/imgui.h"
+#define IMGUI_DEFINE_MATH_OPERATORS
+#include "imgui/imgui_internal.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#ifdef _WIN32
+#include <malloc.h>     // alloca
+#else
+#include <alloca.h>     // alloca
+#endif
+
+namespace
+{
+    const unsigned int FRAMES = 200;
+    const unsigned int TRAILS = 2000;
+    const unsigned int TRAIL_POINTS = 48;
+    const unsigned int MARKERS = 500;
+    const unsigned int ZONES = 40;
+
+    typedef std::chrono::steady_clock Clock;
+
+    // The anti-aliased stroke and fill tessellation as shipped with dear imgui,
+    // one point at a time with a cosf() and a sinf() per arc point. Both
+    // anti-aliasing flags stay on, so only those paths are kept.
+    struct StockDrawList : public ImDrawList
+    {
+        explicit StockDrawList(const ImDrawListSharedData* pData) : ImDrawList(pData) {}
+
+        void AddPolyline(const ImVec2* points, const int points_count, ImU32 col, bool closed, float thickness)
+        {
+            if (points_count < 2)
+                return;
+
+            const ImVec2 uv = _Data->TexUvWhitePixel;
+
+            int count = points_count;
+            if (!closed)
+                count = points_count-1;
+
+            const bool thick_line = thickness > 1.0f;
+            if (Flags & ImDrawListFlags_AntiAliasedLines)
+            {
+                // Anti-aliased stroke
+                const float AA_SIZE = 1.0f;
+                const ImU32 col_trans = col & ~IM_COL32_A_MASK;
+
+                const int idx_count = thick_line ? count*18 : count*12;
+                const int vtx_count = thick_line ? points_count*4 : points_count*3;
+                PrimReserve(idx_count, vtx_count);
+
+                // Temporary buffer
+                ImVec2* temp_normals = (ImVec2*)alloca(points_count * (thick_line ? 5 : 3) * sizeof(ImVec2));
+                ImVec2* temp_points = temp_normals + points_count;
+
+                for (int i1 = 0; i1 < count; i1++)
+                {
+                    const int i2 = (i1+1) == points_count ? 0 : i1+1;
+                    ImVec2 diff = points[i2] - points[i1];
+                    diff *= ImInvLength(diff, 1.0f);
+                    temp_normals[i1].x = diff.y;
+                    temp_normals[i1].y = -diff.x;
+                }
+                if (!closed)
+                    temp_normals[points_count-1] = temp_normals[points_count-2];
+
+                if (!thick_line)
+                {
+                    if (!closed)
+                    {
+                        temp_points[0] = points[0] + temp_normals[0] * AA_SIZE;
+                        temp_points[1] = points[0] - temp_normals[0] * AA_SIZE;
+                        temp_points[(points_count-1)*2+0] = points[points_count-1] + temp_normals[points_count-1] * AA_SIZE;
+                        temp_points[(points_count-1)*2+1] = points[points_count-1] - temp_normals[points_count-1] * AA_SIZE;
+                    }
+
+                    // FIXME-OPT: Merge the different loops, possibly remove the temporary buffer.
+                    unsigned int idx1 = _VtxCurrentIdx;
+                    for (int i1 = 0; i1 < count; i1++)
+                    {
+                        const int i2 = (i1+1) == points_count ? 0 : i1+1;
+                        unsigned int idx2 = (i1+1) == points_count ? _VtxCurrentIdx : idx1+3;
+
+                        // Average normals
+                        ImVec2 dm = (temp_normals[i1] + temp_normals[i2]) * 0.5f;
+                        float dmr2 = dm.x*dm.x + dm.y*dm.y;
+                        if (dmr2 > 0.000001f)
+                        {
+                            float scale = 1.0f / dmr2;
+                            if (scale > 100.0f) scale = 100.0f;
+                            dm *= scale;
+                        }
+                        dm *= AA_SIZE;
+                        temp_points[i2*2+0] = points[i2] + dm;
+                        temp_points[i2*2+1] = points[i2] - dm;
+
+                        // Add indexes
+                        _IdxWritePtr[0] = (ImDrawIdx)(idx2+0); _IdxWritePtr[1] = (ImDrawIdx)(idx1+0); _IdxWritePtr[2] = (ImDrawIdx)(idx1+2);
+                        _IdxWritePtr[3] = (ImDrawIdx)(idx1+2); _IdxWritePtr[4] = (ImDrawIdx)(idx2+2); _IdxWritePtr[5] = (ImDrawIdx)(idx2+0);
+                        _IdxWritePtr[6] = (ImDrawIdx)(idx2+1); _IdxWritePtr[7] = (ImDrawIdx)(idx1+1); _IdxWritePtr[8] = (ImDrawIdx)(idx1+0);
+                        _IdxWritePtr[9] = (ImDrawIdx)(idx1+0); _IdxWritePtr[10]= (ImDrawIdx)(idx2+0); _IdxWritePtr[11]= (ImDrawIdx)(idx2+1);
+                        _IdxWritePtr += 12;
+
+                        idx1 = idx2;
+                    }
+
+                    // Add vertexes
+                    for (int i = 0; i < points_count; i++)
+                    {
+                        _VtxWritePtr[0].pos = points[i];          _VtxWritePtr[0].uv = uv; _VtxWritePtr[0].col = col;
+                        _VtxWritePtr[1].pos = temp_points[i*2+0]; _VtxWritePtr[1].uv = uv; _VtxWritePtr[1].col = col_trans;
+                        _VtxWritePtr[2].pos = temp_points[i*2+1]; _VtxWritePtr[2].uv = uv; _VtxWritePtr[2].col = col_trans;
+                        _VtxWritePtr += 3;
+                    }
+                }
+                else
+                {
+                    const float half_inner_thickness = (thickness - AA_SIZE) * 0.5f;
+                    if (!closed)
+                    {
+                        temp_points[0] = points[0] + temp_normals[0] * (half_inner_thickness + AA_SIZE);
+                        temp_points[1] = points[0] + temp_normals[0] * (half_inner_thickness);
+                        temp_points[2] = points[0] - temp_normals[0] * (half_inner_thickness);
+                        temp_points[3] = points[0] - temp_normals[0] * (half_inner_thickness + AA_SIZE);
+                        temp_points[(points_count-1)*4+0] = points[points_count-1] + temp_normals[points_count-1] * (half_inner_thickness + AA_SIZE);
+                        temp_points[(points_count-1)*4+1] = points[points_count-1] + temp_normals[points_count-1] * (half_inner_thickness);
+                        temp_points[(points_count-1)*4+2] = points[points_count-1] - temp_normals[points_count-1] * (half_inner_thickness);
+                        temp_points[(points_count-1)*4+3] = points[points_count-1] - temp_normals[points_count-1] * (half_inner_thickness + AA_SIZE);
+                    }
+
+                    // FIXME-OPT: Merge the different loops, possibly remove the temporary buffer.
+                    unsigned int idx1 = _VtxCurrentIdx;
+                    for (int i1 = 0; i1 < count; i1++)
+                    {
+                        const int i2 = (i1+1) == points_count ? 0 : i1+1;
+                        unsigned int idx2 = (i1+1) == points_count ? _VtxCurrentIdx : idx1+4;
+
+                        // Average normals
+                        ImVec2 dm = (temp_normals[i1] + temp_normals[i2]) * 0.5f;
+                        float dmr2 = dm.x*dm.x + dm.y*dm.y;
+                        if (dmr2 > 0.000001f)
+                        {
+                            float scale = 1.0f / dmr2;
+                            if (scale > 100.0f) scale = 100.0f;
+                            dm *= scale;
+                        }
+                        ImVec2 dm_out = dm * (half_inner_thickness + AA_SIZE);
+                        ImVec2 dm_in = dm * half_inner_thickness;
+                        temp_points[i2*4+0] = points[i2] + dm_out;
+                        temp_points[i2*4+1] = points[i2] + dm_in;
+                        temp_points[i2*4+2] = points[i2] - dm_in;
+                        temp_points[i2*4+3] = points[i2] - dm_out;
+
+                        // Add indexes
+                        _IdxWritePtr[0]  = (ImDrawIdx)(idx2+1); _IdxWritePtr[1]  = (ImDrawIdx)(idx1+1); _IdxWritePtr[2]  = (ImDrawIdx)(idx1+2);
+                        _IdxWritePtr[3]  = (ImDrawIdx)(idx1+2); _IdxWritePtr[4]  = (ImDrawIdx)(idx2+2); _IdxWritePtr[5]  = (ImDrawIdx)(idx2+1);
+                        _IdxWritePtr[6]  = (ImDrawIdx)(idx2+1); _IdxWritePtr[7]  = (ImDrawIdx)(idx1+1); _IdxWritePtr[8]  = (ImDrawIdx)(idx1+0);
+                        _IdxWritePtr[9]  = (ImDrawIdx)(idx1+0); _IdxWritePtr[10] = (ImDrawIdx)(idx2+0); _IdxWritePtr[11] = (ImDrawIdx)(idx2+1);
+                        _IdxWritePtr[12] = (ImDrawIdx)(idx2+2); _IdxWritePtr[13] = (ImDrawIdx)(idx1+2); _IdxWritePtr[14] = (ImDrawIdx)(idx1+3);
+                        _IdxWritePtr[15] = (ImDrawIdx)(idx1+3); _IdxWritePtr[16] = (ImDrawIdx)(idx2+3); _IdxWritePtr[17] = (ImDrawIdx)(idx2+2);
+                        _IdxWritePtr += 18;
+
+                        idx1 = idx2;
+                    }
+
+                    // Add vertexes
+                    for (int i = 0; i < points_count; i++)
+                    {
+                        _VtxWritePtr[0].pos = temp_points[i*4+0]; _VtxWritePtr[0].uv = uv; _VtxWritePtr[0].col = col_trans;
+                        _VtxWritePtr[1].pos = temp_points[i*4+1]; _VtxWritePtr[1].uv = uv; _VtxWritePtr[1].col = col;
+                        _VtxWritePtr[2].pos = temp_points[i*4+2]; _VtxWritePtr[2].uv = uv; _VtxWritePtr[2].col = col;
+                        _VtxWritePtr[3].pos = temp_points[i*4+3]; _VtxWritePtr[3].uv = uv; _VtxWritePtr[3].col = col_trans;
+                        _VtxWritePtr += 4;
+                    }
+                }
+                _VtxCurrentIdx += (ImDrawIdx)vtx_count;
+            }
+        }
+
+        void AddConvexPolyFilled(const ImVec2* points, const int points_count, ImU32 col)
+        {
+            const ImVec2 uv = _Data->TexUvWhitePixel;
+
+            // Anti-aliased Fill
+            const float AA_SIZE = 1.0f;
+            const ImU32 col_trans = col & ~IM_COL32_A_MASK;
+            const int idx_count = (points_count-2)*3 + points_count*6;
+            const int vtx_count = (points_count*2);
+            PrimReserve(idx_count, vtx_count);
+
+            // Add indexes for fill
+            unsigned int vtx_inner_idx = _VtxCurrentIdx;
+            unsigned int vtx_outer_idx = _VtxCurrentIdx+1;
+            for (int i = 2; i < points_count; i++)
+            {
+                _IdxWritePtr[0] = (ImDrawIdx)(vtx_inner_idx); _IdxWritePtr[1] = (ImDrawIdx)(vtx_inner_idx+((i-1)<<1)); _IdxWritePtr[2] = (ImDrawIdx)(vtx_inner_idx+(i<<1));
+                _IdxWritePtr += 3;
+            }
+
+            // Compute normals
+            ImVec2* temp_normals = (ImVec2*)alloca(points_count * sizeof(ImVec2));
+            for (int i0 = points_count-1, i1 = 0; i1 < points_count; i0 = i1++)
+            {
+                const ImVec2& p0 = points[i0];
+                const ImVec2& p1 = points[i1];
+                ImVec2 diff = p1 - p0;
+                diff *= ImInvLength(diff, 1.0f);
+                temp_normals[i0].x = diff.y;
+                temp_normals[i0].y = -diff.x;
+            }
+
+            for (int i0 = points_count-1, i1 = 0; i1 < points_count; i0 = i1++)
+            {
+                // Average normals
+                const ImVec2& n0 = temp_normals[i0];
+                const ImVec2& n1 = temp_normals[i1];
+                ImVec2 dm = (n0 + n1) * 0.5f;
+                float dmr2 = dm.x*dm.x + dm.y*dm.y;
+                if (dmr2 > 0.000001f)
+                {
+                    float scale = 1.0f / dmr2;
+                    if (scale > 100.0f) scale = 100.0f;
+                    dm *= scale;
+                }
+                dm *= AA_SIZE * 0.5f;
+
+                // Add vertices
+                _VtxWritePtr[0].pos = (points[i1] - dm); _VtxWritePtr[0].uv = uv; _VtxWritePtr[0].col = col;        // Inner
+                _VtxWritePtr[1].pos = (points[i1] + dm); _VtxWritePtr[1].uv = uv; _VtxWritePtr[1].col = col_trans;  // Outer
+                _VtxWritePtr += 2;
+
+                // Add indexes for fringes
+                _IdxWritePtr[0] = (ImDrawIdx)(vtx_inner_idx+(i1<<1)); _IdxWritePtr[1] = (ImDrawIdx)(vtx_inner_idx+(i0<<1)); _IdxWritePtr[2] = (ImDrawIdx)(vtx_outer_idx+(i0<<1));
+                _IdxWritePtr[3] = (ImDrawIdx)(vtx_outer_idx+(i0<<1)); _IdxWritePtr[4] = (ImDrawIdx)(vtx_outer_idx+(i1<<1)); _IdxWritePtr[5] = (ImDrawIdx)(vtx_inner_idx+(i1<<1));
+                _IdxWritePtr += 6;
+            }
+            _VtxCurrentIdx += (ImDrawIdx)vtx_count;
+        }
+
+        void PathArcTo(const ImVec2& centre, float radius, float a_min, float a_max, int num_segments)
+        {
+            if (radius == 0.0f)
+            {
+                _Path.push_back(centre);
+                return;
+            }
+            _Path.reserve(_Path.Size + (num_segments + 1));
+            for (int i = 0; i <= num_segments; i++)
+            {
+                const float a = a_min + ((float)i / (float)num_segments) * (a_max - a_min);
+                _Path.push_back(ImVec2(centre.x + cosf(a) * radius, centre.y + sinf(a) * radius));
+            }
+        }
+
+        void AddCircle(const ImVec2& centre, float radius, ImU32 col, int num_segments, float thickness)
+        {
+            const float a_max = IM_PI*2.0f * ((float)num_segments - 1.0f) / (float)num_segments;
+            PathArcTo(centre, radius-0.5f, 0.0f, a_max, num_segments);
+            AddPolyline(_Path.Data, _Path.Size, col, true, thickness);
+            PathClear();
+        }
+
+        void AddCircleFilled(const ImVec2& centre, float radius, ImU32 col, int num_segments)
+        {
+            const float a_max = IM_PI*2.0f * ((float)num_segments - 1.0f) / (float)num_segments;
+            PathArcTo(centre, radius, 0.0f, a_max, num_segments);
+            AddConvexPolyFilled(_Path.Data, _Path.Size, col);
+            PathClear();
+        }
+    };
+
+    struct Workload
+    {
+        std::vector<ImVec2> trails;     // TRAILS of TRAIL_POINTS
+        std::vector<ImVec2> markers;
+        std::vector<ImVec2> zones;      // ZONES hexagons
+    };
+
+    struct Result
+    {
+        double ms;
+        unsigned int verticesPerFrame;
+        std::vector<ImDrawVert> vertices;
+        std::vector<ImDrawIdx> indices;
+    };
+
+    // Players wandering the pitch, turning a little every sample. Some stand
+    // still for a few samples (zero length segments) and some turn back on
+    // themselves (averaged normals cancelling out).
+    void MakeWorkload(Workload& rWorkload)
+    {
+        unsigned int seed = 0x7AC71C5u;
+        for (unsigned int t = 0; t < TRAILS; ++t)
+        {
+            seed = seed * 1664525u + 1013904223u;
+            ImVec2 position((float)(seed % 1000), (float)((seed >> 10) % 600));
+            float heading = (float)(seed % 628) * 0.01f;
+            for (unsigned int p = 0; p < TRAIL_POINTS; ++p)
+            {
+                seed = seed * 1664525u + 1013904223u;
+                const unsigned int action = seed >> 28;
+                if (action == 0)
+                    heading += IM_PI;
+                else if (action != 1)
+                    heading += ((float)((seed >> 8) % 100) - 50.0f) * 0.01f;
+                const float step = action == 1 ? 0.0f : 2.0f + (float)((seed >> 16) % 40) * 0.1f;
+                position.x += std::cos(heading) * step;
+                position.y += std::sin(heading) * step;
+                rWorkload.trails.push_back(position);
+            }
+        }
+        for (unsigned int m = 0; m < MARKERS; ++m)
+            rWorkload.markers.push_back(ImVec2(20.0f + (float)((m * 37) % 960), 20.0f + (float)((m * 53) % 560)));
+        for (unsigned int z = 0; z < ZONES; ++z)
+        {
+            const ImVec2 centre(50.0f + (float)((z * 97) % 900), 50.0f + (float)((z * 61) % 500));
+            for (unsigned int corner = 0; corner < 6; ++corner)
+            {
+                const float a = (float)corner * IM_PI / 3.0f + (float)z * 0.1f;
+                rWorkload.zones.push_back(ImVec2(centre.x + std::cos(a) * 40.0f, centre.y + std::sin(a) * 30.0f));
+            }
+        }
+    }
+
+    // A tactics board frame: every trail thin and the last few hundred thick,
+    // closed zone outlines and fills, player markers filled and outlined.
+    template<typename DrawList>
+    void DrawBoard(DrawList& rList, const Workload& rWorkload)
+    {
+        const ImU32 trailColour = IM_COL32(255, 220, 40, 160);
+        for (unsigned int t = 0; t < TRAILS; ++t)
+        {
+            const ImVec2* pTrail = &rWorkload.trails[t * TRAIL_POINTS];
+            rList.AddPolyline(pTrail, TRAIL_POINTS, trailColour, false, 1.0f);
+            if (t >= TRAILS - TRAILS / 8)
+                rList.AddPolyline(pTrail, TRAIL_POINTS, trailColour, false, 3.0f);
+        }
+        for (unsigned int z = 0; z < ZONES; ++z)
+        {
+            const ImVec2* pZone = &rWorkload.zones[z * 6];
+            rList.AddConvexPolyFilled(pZone, 6, IM_COL32(40, 120, 255, 60));
+            rList.AddPolyline(pZone, 6, IM_COL32(40, 120, 255, 255), true, 2.0f);
+        }
+        for (unsigned int m = 0; m < MARKERS; ++m)
+        {
+            rList.AddCircleFilled(rWorkload.markers[m], 6.0f, IM_COL32(230, 40, 40, 255), 16);
+            rList.AddCircle(rWorkload.markers[m], 8.0f, IM_COL32_WHITE, 24, 1.0f);
+        }
+    }
+
+    template<typename DrawList>
+    Result Run(const Workload& rWorkload)
+    {
+        ImDrawListSharedData sharedData;
+        sharedData.TexUvWhitePixel = ImVec2(0.5f / 512.0f, 0.5f / 64.0f);
+        DrawList list(&sharedData);
+
+        Result result;
+        const Clock::time_point start = Clock::now();
+        for (unsigned int frame = 0; frame < FRAMES; ++frame)
+        {
+            list.Clear();
+            list.PushTextureID(NULL);
+            list.PushClipRect(ImVec2(0.0f, 0.0f), ImVec2(1024.0f, 640.0f));
+            DrawBoard(list, rWorkload);
+        }
+        result.ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        result.verticesPerFrame = (unsigned int)list.VtxBuffer.Size;
+        result.vertices.assign(list.VtxBuffer.Data, list.VtxBuffer.Data + list.VtxBuffer.Size);
+        result.indices.assign(list.IdxBuffer.Data, list.IdxBuffer.Data + list.IdxBuffer.Size);
+        return result;
+    }
+}
+
+// Tessellates a tactics board of player trails, zones and markers with the
+// stock one point at a time code and with ImDrawList, and checks that both
+// write the same vertices and indices. Reports vertices generated per second.
+int RunTessellationBench()
+{
+#ifdef IMGUI_USE_SIMD_TESSELLATION
+    const char* pTessellation = "SIMD";
+#else
+    const char* pTessellation = "scalar";
+#endif
+    std::printf("ImDrawList tessellation: %s\n", pTessellation);
+
+    Workload workload;
+    MakeWorkload(workload);
+    const Result reference = Run<StockDrawList>(workload);
+    const Result current = Run<ImDrawList>(workload);
+
+    const double referenceRate = (double)reference.verticesPerFrame * FRAMES / (reference.ms / 1000.0);
+    const double currentRate = (double)current.verticesPerFrame * FRAMES / (current.ms / 1000.0);
+    std::printf("%u vertices/frame: stock %7.1f us/frame %6.1f M vertices/s, ImDrawList %7.1f us/frame %6.1f M vertices/s (%.2fx)\n",
+                current.verticesPerFrame, 1000.0 * reference.ms / FRAMES, referenceRate / 1e6,
+                1000.0 * current.ms / FRAMES, currentRate / 1e6, currentRate / referenceRate);
+
+    const bool sameVertices = reference.vertices.size() == current.vertices.size()
+        && std::memcmp(reference.vertices.data(), current.vertices.data(), reference.vertices.size() * sizeof(ImDrawVert)) == 0;
+    const bool sameIndices = reference.indices == current.indices;
+    if (!sameVertices || !sameIndices)
+    {
+        std::printf("  FAILED (%s differ from the stock tessellation)\n", sameVertices ? "indices" : "vertices");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,163 @@
+#include "Benchmarks.h"
+#include "imgui/imgui.h"
+#include "imgui/imgui_internal.h"
+
+#include <cfloat>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace
+{
+    const unsigned int FRAMES = 1000;
+    const unsigned int LOG_LINES = 300;
+    const float FONT_SIZE = 13.0f;
+    const float VIEW_HEIGHT = 600.0f;
+
+    typedef std::chrono::steady_clock Clock;
+
+    // Labels of the debug windows, measured for layout every frame
+    const char* const LABELS[] = {
+        "OK", "Apply", "Reset", "Speed", "Camera distance", "Enable shadows", "Show ragdolls",
+        "Interest budget", "Link latency ms", "Frames per mode", "Draw the broadphase grid",
+        "Use the declared host state instead of reading it back",
+        "Keep the snapshot history of every connected client",
+        "Record the match to a replay file on the next kickoff",
+        "Interpolate remote players between the last two snapshots",
+        "Freeze the simulation when a desync is detected",
+        "Rollback frames", "Prediction error (m)", "Server tick rate", "Spectator delay (s)"
+    };
+    const unsigned int LABEL_COUNT = sizeof(LABELS) / sizeof(LABELS[0]);
+
+    // Events of the match log, with a long word and accented names among them
+    const char* const EVENTS[] = {
+        "tackled %s hard enough to send the ragdoll over the advertising boards",
+        "passed to %s, who controlled the ball on the chest and volleyed it wide",
+        "scored! %s celebrates in front of the away end while the keeper protests",
+        "was booked for a sliding tackle on %s from behind",
+        "lost the ball to %s: Überraschungsangriff über die linke Seite",
+        "shouted %s's name: aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa"
+    };
+    const char* const NAMES[] = { "Kowalski", "Müller", "Dupont", "Rossi", "Yamada", "Okafor", "Lindqvist", "García" };
+
+    struct Workload
+    {
+        std::vector<std::string> logLines;
+        std::vector<std::string> counters;  // Two per frame, changing every frame
+    };
+
+    struct Result
+    {
+        double ms;
+        double sizeChecksum;
+        std::vector<ImDrawVert> lastFrameVertices;
+    };
+
+    void MakeWorkload(Workload& rWorkload)
+    {
+        char line[256];
+        const unsigned int eventCount = sizeof(EVENTS) / sizeof(EVENTS[0]);
+        const unsigned int nameCount = sizeof(NAMES) / sizeof(NAMES[0]);
+        for (unsigned int i = 0; i < LOG_LINES; ++i)
+        {
+            const int length = std::snprintf(line, sizeof(line), "%02u:%02u %s ", 10 + i / 60, i % 60, NAMES[(i * 3) % nameCount]);
+            std::snprintf(line + length, sizeof(line) - length, EVENTS[(i * 7) % eventCount], NAMES[(i * 5 + 1) % nameCount]);
+            rWorkload.logLines.push_back(line);
+        }
+        for (unsigned int frame = 0; frame < FRAMES; ++frame)
+        {
+            std::snprintf(line, sizeof(line), "Tick %u, ball at %.2f m/s", 18000 + frame, 12.5f + 0.01f * frame);
+            rWorkload.counters.push_back(line);
+            std::snprintf(line, sizeof(line), "Render %.3f ms, %u draw calls", 1.0f + 0.001f * frame, 40 + frame % 7);
+            rWorkload.counters.push_back(line);
+        }
+    }
+
+    // What the debug windows and a scrolled match log window ask of the font
+    // each frame: labels and counters measured, every log line measured
+    // wrapped for the scroll height, the visible ones drawn wrapped.
+    Result Run(ImFontAtlas& rAtlas, const Workload& rWorkload, float wrapWidth)
+    {
+        ImFont* pFont = rAtlas.Fonts[0];
+        ImDrawListSharedData sharedData;
+        ImDrawList list(&sharedData);
+        const ImVec4 clipRect(0.0f, 0.0f, wrapWidth + 16.0f, VIEW_HEIGHT);
+
+        Result result;
+        result.sizeChecksum = 0.0;
+        const Clock::time_point start = Clock::now();
+        for (unsigned int frame = 0; frame < FRAMES; ++frame)
+        {
+            rAtlas.TextCacheNewFrame();
+            list.Clear();
+            list.PushTextureID(rAtlas.TexID);
+            list.PushClipRect(ImVec2(clipRect.x, clipRect.y), ImVec2(clipRect.z, clipRect.w));
+
+            for (unsigned int i = 0; i < LABEL_COUNT; ++i)
+                result.sizeChecksum += pFont->CalcTextSizeA(FONT_SIZE, FLT_MAX, 0.0f, LABELS[i]).x;
+            for (unsigned int i = 0; i < 2; ++i)
+                result.sizeChecksum += pFont->CalcTextSizeA(FONT_SIZE, FLT_MAX, 0.0f, rWorkload.counters[frame * 2 + i].c_str()).x;
+
+            float y = 0.0f;
+            for (size_t i = 0; i < rWorkload.logLines.size(); ++i)
+            {
+                const char* pLine = rWorkload.logLines[i].c_str();
+                const ImVec2 size = pFont->CalcTextSizeA(FONT_SIZE, FLT_MAX, wrapWidth, pLine);
+                if (y < VIEW_HEIGHT)
+                    pFont->RenderText(&list, FONT_SIZE, ImVec2(4.0f, y), IM_COL32_WHITE, clipRect, pLine, NULL, wrapWidth);
+                y += size.y;
+                result.sizeChecksum += size.x + size.y;
+            }
+        }
+        result.ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        result.lastFrameVertices.assign(list.VtxBuffer.Data, list.VtxBuffer.Data + list.VtxBuffer.Size);
+        return result;
+    }
+}
+
+// Measures the labels of the debug windows and lays out a wrapped match log
+// every frame with and without the font atlas text cache, checking that both
+// give the same sizes and vertices, at a normal and at a one character wrap
+// width. Reports the time per frame, the time saved and the cache counters.
+int RunTextCacheBench()
+{
+    Workload workload;
+    MakeWorkload(workload);
+
+    const float wrapWidths[] = { 420.0f, 4.0f };
+    int result = 0;
+    for (unsigned int w = 0; w < sizeof(wrapWidths) / sizeof(wrapWidths[0]); ++w)
+    {
+        ImFontAtlas uncachedAtlas;
+        uncachedAtlas.AddFontDefault();
+        uncachedAtlas.Build();
+        ImFontAtlas cachedAtlas;
+        cachedAtlas.AddFontDefault();
+        cachedAtlas.TextCacheCapacity = 2048;
+        cachedAtlas.TextCacheMaxAge = 2;
+        cachedAtlas.Build();
+
+        const Result reference = Run(uncachedAtlas, workload, wrapWidths[w]);
+        const Result cached = Run(cachedAtlas, workload, wrapWidths[w]);
+        ImFontAtlasTextCacheStats stats;
+        cachedAtlas.GetTextCacheStats(&stats);
+
+        std::printf("wrap %5.0f px: uncached %7.1f us/frame, cached %7.1f us/frame (%.2fx, %.1f us saved)\n",
+                    wrapWidths[w], 1000.0 * reference.ms / FRAMES, 1000.0 * cached.ms / FRAMES, reference.ms / cached.ms,
+                    1000.0 * (reference.ms - cached.ms) / FRAMES);
+        std::printf("  hits %.1f%% (%d of %d lookups), %d entries, %d breaks, %d evicted, %d rejected, %.1f MB of text not measured again\n",
+                    stats.Lookups ? 100.0 * stats.Hits / stats.Lookups : 0.0, stats.Hits, stats.Lookups, stats.Entries, stats.Breaks,
+                    stats.Evicted, stats.Rejected, (double)stats.BytesSaved / (1024.0 * 1024.0));
+
+        const bool sameVertices = reference.lastFrameVertices.size() == cached.lastFrameVertices.size()
+            && std::memcmp(reference.lastFrameVertices.data(), cached.lastFrameVertices.data(), reference.lastFrameVertices.size() * sizeof(ImDrawVert)) == 0;
+        if (reference.sizeChecksum != cached.sizeChecksum || !sameVertices)
+        {
+            std::printf("  FAILED (%s differ from the uncached layout)\n", sameVertices ? "sizes" : "vertices");
+            result = 1;
+        }
+    }
+    return result;
+}
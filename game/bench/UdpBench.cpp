@@ -0,0 +1,138 @@
+#include "Benchmarks.h"
+#include "net/BatchedUdpSocket.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+    const unsigned int BATCH_SIZE = 64;
+    const unsigned int SENDERS = 4;
+    const unsigned int BURST = 32;   // per sender, within the default socket buffers
+    const unsigned int PAYLOAD = 200;
+    const unsigned int ROUNDS = 4000;
+    const unsigned int WAIT_MS = 20;
+
+    typedef std::chrono::steady_clock Clock;
+
+    struct EchoResult
+    {
+        uint64_t received;
+        uint64_t sent;
+        uint64_t systemCalls;
+        uint64_t lost;
+        double serverSeconds;
+    };
+
+    // Answers every datagram of a burst back to its sender and returns how
+    // many arrived.
+    unsigned int EchoBurst(BatchedUdpSocket& rServer, unsigned int expected)
+    {
+        unsigned int echoed = 0;
+        while (echoed < expected)
+        {
+            const unsigned int count = rServer.Receive();
+            if (count == 0)
+            {
+                if (!rServer.Wait(WAIT_MS))
+                    break;
+                continue;
+            }
+            for (unsigned int i = 0; i < count; ++i)
+            {
+                unsigned int size;
+                NetAddress from;
+                const unsigned char* pData = rServer.GetReceived(i, size, from);
+                rServer.Send(from, pData, size);
+            }
+            rServer.Flush();
+            echoed += count;
+        }
+        return echoed;
+    }
+
+    // Every round the senders fire a burst at the echo server, which answers
+    // it in batches while the clock runs, and then collect their echoes.
+    // Everything runs on one thread, so the server's time is one core's.
+    void RunRounds(BatchedUdpSocket& rServer, UdpBackend senderBackend, EchoResult& rResult)
+    {
+        std::vector<BatchedUdpSocket*> senders;
+        for (unsigned int i = 0; i < SENDERS; ++i)
+        {
+            BatchedUdpSocket* pSender = new BatchedUdpSocket(BURST);
+            if (!pSender->Open(NET_LOOPBACK, 0, senderBackend))
+                pSender->Open(NET_LOOPBACK, 0, UDP_BACKEND_SINGLE);
+            senders.push_back(pSender);
+        }
+
+        unsigned char payload[PAYLOAD];
+        std::memset(payload, 0x5A, sizeof(payload));
+        const NetAddress address = { NET_LOOPBACK, rServer.GetLocalAddress().port };
+        rServer.ResetStats();
+        rResult.serverSeconds = 0.0;
+        rResult.lost = 0;
+        for (unsigned int round = 0; round < ROUNDS; ++round)
+        {
+            for (unsigned int i = 0; i < SENDERS; ++i)
+            {
+                for (unsigned int packet = 0; packet < BURST; ++packet)
+                    senders[i]->Send(address, payload, sizeof(payload));
+                senders[i]->Flush();
+            }
+
+            Clock::time_point start = Clock::now();
+            rResult.lost += SENDERS * BURST - EchoBurst(rServer, SENDERS * BURST);
+            rResult.serverSeconds += std::chrono::duration<double>(Clock::now() - start).count();
+
+            for (unsigned int i = 0; i < SENDERS; ++i)
+            {
+                unsigned int echoes = 0;
+                while (echoes < BURST)
+                {
+                    const unsigned int count = senders[i]->Receive();
+                    if (count == 0 && !senders[i]->Wait(WAIT_MS))
+                        break;
+                    echoes += count;
+                }
+            }
+        }
+
+        rResult.received = rServer.GetStats().packetsReceived;
+        rResult.sent = rServer.GetStats().packetsSent;
+        rResult.systemCalls = rServer.GetStats().systemCalls;
+        for (unsigned int i = 0; i < SENDERS; ++i)
+            delete senders[i];
+    }
+
+    void RunCase(UdpBackend backend)
+    {
+        BatchedUdpSocket server(BATCH_SIZE);
+        if (!server.Open(NET_LOOPBACK, 0, backend))
+        {
+            std::printf("%-8s  not available here\n", BatchedUdpSocket::GetBackendName(backend));
+            return;
+        }
+
+        EchoResult result;
+        RunRounds(server, backend == UDP_BACKEND_SINGLE ? UDP_BACKEND_SINGLE : UDP_BACKEND_MMSG, result);
+        const double packets = (double)(result.received + result.sent);
+        std::printf("%-8s  %9.0f packets per core-second (%.0f ns each), %5.1f packets per system call, %llu lost\n",
+                    BatchedUdpSocket::GetBackendName(backend), packets / result.serverSeconds,
+                    result.serverSeconds * 1e9 / packets, packets / result.systemCalls, (unsigned long long)result.lost);
+    }
+}
+
+// Loopback echo load test of BatchedUdpSocket: the time an echo server
+// spends receiving and answering bursts of 200-byte datagrams, as datagrams
+// in and out per core-second, for each backend available here.
+int RunUdpBench()
+{
+    std::printf("echo server, %u senders x %u-datagram bursts of %u bytes, batches of %u\n",
+                SENDERS, BURST, PAYLOAD, BATCH_SIZE);
+    RunCase(UDP_BACKEND_SINGLE);
+    RunCase(UDP_BACKEND_MMSG);
+    RunCase(UDP_BACKEND_IO_URING);
+    return 0;
+}
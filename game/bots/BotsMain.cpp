@@ -0,0 +1,468 @@
+#include "Match.h"
+#include "core/Histogram.h"
+#include "net/BotClient.h"
+#include "net/MatchHost.h"
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    const double WARMUP_SECONDS = 2.0;
+    const unsigned int CHARGE_PERIOD = 180;
+
+    typedef std::chrono::steady_clock Clock;
+
+    enum InputMode
+    {
+        INPUT_RANDOM,
+        INPUT_SCRIPTED
+    };
+
+    struct Options
+    {
+        unsigned int matches;
+        unsigned int players;            // clients per match
+        unsigned int processes;
+        unsigned int threads;            // workers of the hosted matches
+        unsigned int snapshotInterval;
+        unsigned int port;
+        unsigned int connectPort;        // 0 hosts the matches here
+        double seconds;
+        InputMode input;
+        UdpBackend backend;
+    };
+
+    // What one process of bots measured after the warm-up, sent to the
+    // parent as it is in memory.
+    struct BotReport
+    {
+        unsigned int clients;
+        unsigned int playing;
+        unsigned int rejected;
+        uint64_t snapshots;
+        uint64_t lateSnapshots;
+        uint64_t decodeFailures;
+        uint64_t inputsSent;
+        uint64_t bytesSent;
+        uint64_t bytesReceived;
+        double seconds;
+        LatencyHistogram latency;        // input sent to the snapshot that shows it applied
+    };
+
+    // Runs in circles of its own size and phase and charges every few
+    // seconds, the same inputs every run.
+    class CircleControl : public IControl
+    {
+    public:
+        explicit CircleControl(unsigned int client)
+            : m_period(120 + (client * 37) % 240),
+              m_phase(client * 7919)
+        {
+        }
+
+        PlayerInput Poll(unsigned int tick) override
+        {
+            const float angle = (float)((tick + m_phase) % m_period) * 6.2831853f / m_period;
+            PlayerInput input;
+            input.moveX = (signed char)(127.0f * std::cos(angle));
+            input.moveZ = (signed char)(127.0f * std::sin(angle));
+            input.buttons = (tick + m_phase) % CHARGE_PERIOD == 0 ? BUTTON_CHARGE : 0;
+            input.target = 0;
+            return input;
+        }
+
+    private:
+        unsigned int m_period;
+        unsigned int m_phase;
+    };
+
+    bool ParseOptions(int argc, char** argv, Options& rOptions)
+    {
+        rOptions.matches = 4;
+        rOptions.players = Match::PLAYER_COUNT;
+        rOptions.processes = 4;
+        rOptions.threads = std::max(1u, std::thread::hardware_concurrency());
+        rOptions.snapshotInterval = 2;
+        rOptions.port = 0;
+        rOptions.connectPort = 0;
+        rOptions.seconds = 20.0;
+        rOptions.input = INPUT_RANDOM;
+        rOptions.backend = UDP_BACKEND_MMSG;
+        for (int arg = 1; arg + 1 < argc; arg += 2)
+        {
+            const char* pValue = argv[arg + 1];
+            if (std::strcmp(argv[arg], "--matches") == 0)
+                rOptions.matches = (unsigned int)std::atoi(pValue);
+            else if (std::strcmp(argv[arg], "--players") == 0)
+                rOptions.players = (unsigned int)std::atoi(pValue);
+            else if (std::strcmp(argv[arg], "--processes") == 0)
+                rOptions.processes = (unsigned int)std::atoi(pValue);
+            else if (std::strcmp(argv[arg], "--threads") == 0)
+                rOptions.threads = (unsigned int)std::atoi(pValue);
+            else if (std::strcmp(argv[arg], "--snapshot-interval") == 0)
+                rOptions.snapshotInterval = (unsigned int)std::atoi(pValue);
+            else if (std::strcmp(argv[arg], "--port") == 0)
+                rOptions.port = (unsigned int)std::atoi(pValue);
+            else if (std::strcmp(argv[arg], "--connect") == 0)
+                rOptions.connectPort = (unsigned int)std::atoi(pValue);
+            else if (std::strcmp(argv[arg], "--seconds") == 0)
+                rOptions.seconds = std::atof(pValue);
+            else if (std::strcmp(argv[arg], "--input") == 0 && std::strcmp(pValue, "random") == 0)
+                rOptions.input = INPUT_RANDOM;
+            else if (std::strcmp(argv[arg], "--input") == 0 && std::strcmp(pValue, "scripted") == 0)
+                rOptions.input = INPUT_SCRIPTED;
+            else if (std::strcmp(argv[arg], "--io") == 0 && std::strcmp(pValue, "single") == 0)
+                rOptions.backend = UDP_BACKEND_SINGLE;
+            else if (std::strcmp(argv[arg], "--io") == 0 && std::strcmp(pValue, "mmsg") == 0)
+                rOptions.backend = UDP_BACKEND_MMSG;
+            else if (std::strcmp(argv[arg], "--io") == 0 && std::strcmp(pValue, "io_uring") == 0)
+                rOptions.backend = UDP_BACKEND_IO_URING;
+            else
+                return false;
+        }
+        return (argc % 2) == 1 && rOptions.matches > 0 && rOptions.players > 0 &&
+               rOptions.players <= Match::PLAYER_COUNT && rOptions.processes > 0 &&
+               rOptions.seconds > WARMUP_SECONDS;
+    }
+
+    // Thousands of client sockets are more than the usual default descriptor limit.
+    void RaiseDescriptorLimit()
+    {
+#ifndef _WIN32
+        rlimit limit;
+        if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max)
+        {
+            limit.rlim_cur = limit.rlim_max;
+            setrlimit(RLIMIT_NOFILE, &limit);
+        }
+#endif
+    }
+
+    void SumCounters(const std::vector<BotClient*>& rBots, BotReport& rReport)
+    {
+        rReport.snapshots = 0;
+        rReport.lateSnapshots = 0;
+        rReport.decodeFailures = 0;
+        rReport.inputsSent = 0;
+        rReport.bytesSent = 0;
+        rReport.bytesReceived = 0;
+        for (unsigned int i = 0; i < rBots.size(); ++i)
+        {
+            rReport.snapshots += rBots[i]->GetSnapshotsReceived();
+            rReport.lateSnapshots += rBots[i]->GetLateSnapshots();
+            rReport.decodeFailures += rBots[i]->GetDecodeFailures();
+            rReport.inputsSent += rBots[i]->GetInputsSent();
+            rReport.bytesSent += rBots[i]->GetBytesSent();
+            rReport.bytesReceived += rBots[i]->GetBytesReceived();
+        }
+    }
+
+    // Plays clients [first, first + count) from this thread until the time
+    // is up; client c plays in match c / players.
+    void RunClients(const Options& rOptions, const std::vector<uint16_t>& rPorts, unsigned int first,
+                    unsigned int count, BotReport& rReport)
+    {
+        std::vector<BotClient*> bots;
+        std::vector<CircleControl*> controls;
+        for (unsigned int i = 0; i < count; ++i)
+        {
+            const unsigned int client = first + i;
+            const NetAddress address = { NET_LOOPBACK, rPorts[client / rOptions.players] };
+            bots.push_back(new BotClient(client + 1));
+            if (rOptions.input == INPUT_SCRIPTED)
+            {
+                controls.push_back(new CircleControl(client));
+                bots.back()->SetControl(controls.back());
+            }
+            bots.back()->SetLatencyHistogram(&rReport.latency);
+            bots.back()->Open(address);
+        }
+
+        BotReport warm;
+        SumCounters(bots, warm);
+        const Clock::time_point start = Clock::now();
+        Clock::time_point measureStart = start;
+        bool warmedUp = false;
+        for (;;)
+        {
+            const Clock::time_point now = Clock::now();
+            const double seconds = std::chrono::duration<double>(now - start).count();
+            if (seconds >= rOptions.seconds)
+                break;
+            if (!warmedUp && seconds >= WARMUP_SECONDS)
+            {
+                SumCounters(bots, warm);
+                rReport.latency.Clear();
+                measureStart = now;
+                warmedUp = true;
+            }
+
+            const double nowMs = seconds * 1000.0;
+            for (unsigned int i = 0; i < bots.size(); ++i)
+                bots[i]->Update(nowMs);
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        SumCounters(bots, rReport);
+        rReport.snapshots -= warm.snapshots;
+        rReport.lateSnapshots -= warm.lateSnapshots;
+        rReport.decodeFailures -= warm.decodeFailures;
+        rReport.inputsSent -= warm.inputsSent;
+        rReport.bytesSent -= warm.bytesSent;
+        rReport.bytesReceived -= warm.bytesReceived;
+        rReport.seconds = std::chrono::duration<double>(Clock::now() - measureStart).count();
+        rReport.clients = count;
+        rReport.playing = 0;
+        rReport.rejected = 0;
+        for (unsigned int i = 0; i < bots.size(); ++i)
+        {
+            rReport.playing += bots[i]->IsConnected() && bots[i]->GetSnapshotsReceived() > 0;
+            rReport.rejected += bots[i]->WasRejected();
+            bots[i]->Disconnect();
+            delete bots[i];
+        }
+        for (unsigned int i = 0; i < controls.size(); ++i)
+            delete controls[i];
+    }
+
+    void PrintServerReport(MatchHost& rHost)
+    {
+        std::vector<float> p50s;
+        float worstP99 = 0.0f;
+        float worstMax = 0.0f;
+        float latestStart = 0.0f;
+        unsigned int ticks = 0;
+        unsigned int overruns = 0;
+        unsigned int worstMatch = 0;
+        for (unsigned int i = 0; i < rHost.GetMatchCount(); ++i)
+        {
+            const MatchTickStats stats = rHost.GetTickStats(i);
+            p50s.push_back(stats.p50Ms);
+            if (stats.p99Ms > worstP99)
+            {
+                worstP99 = stats.p99Ms;
+                worstMatch = i;
+            }
+            worstMax = std::max(worstMax, stats.maxMs);
+            latestStart = std::max(latestStart, stats.maxLatenessMs);
+            ticks += stats.ticks;
+            overruns += stats.missedDeadlines;
+        }
+        std::sort(p50s.begin(), p50s.end());
+        std::printf("server: %u matches on %u workers (%u pinned), %u ticks, %u overran their deadline (%.3f%%)\n",
+                    rHost.GetMatchCount(), rHost.GetWorkerCount(), rHost.GetPinnedCount(), ticks, overruns,
+                    ticks ? 100.0 * overruns / ticks : 0.0);
+        std::printf("  tick ms: median p50 %.3f, worst p99 %.3f (match %u), worst max %.3f, latest start %.2f, "
+                    "budget %.3f\n",
+                    p50s[p50s.size() / 2], worstP99, worstMatch, worstMax, latestStart, 1000.0f / Match::TICK_RATE);
+    }
+
+    void PrintClientReport(const BotReport& rTotal, unsigned int processes)
+    {
+        const double seconds = rTotal.seconds;
+        std::printf("clients: %u in %u processes, %u playing, %u rejected\n",
+                    rTotal.clients, processes, rTotal.playing, rTotal.rejected);
+        std::printf("  throughput: %.0f snapshots/s, %.0f inputs/s, %.2f Mbit/s down, %.2f Mbit/s up\n",
+                    rTotal.snapshots / seconds, rTotal.inputsSent / seconds,
+                    rTotal.bytesReceived * 8.0 / 1e6 / seconds, rTotal.bytesSent * 8.0 / 1e6 / seconds);
+        std::printf("  input to acknowledging snapshot ms: mean %.2f  p50 %.2f  p90 %.2f  p99 %.2f  p99.9 %.2f  max %.2f "
+                    "(%llu samples)\n",
+                    rTotal.latency.GetMeanMs(), rTotal.latency.Percentile(0.50f), rTotal.latency.Percentile(0.90f),
+                    rTotal.latency.Percentile(0.99f), rTotal.latency.Percentile(0.999f), rTotal.latency.GetMaxMs(),
+                    (unsigned long long)rTotal.latency.GetCount());
+        std::printf("  late snapshots: %llu (%.3f%%), undecodable: %llu\n",
+                    (unsigned long long)rTotal.lateSnapshots,
+                    rTotal.snapshots ? 100.0 * rTotal.lateSnapshots / rTotal.snapshots : 0.0,
+                    (unsigned long long)rTotal.decodeFailures);
+    }
+
+    void AddReport(BotReport& rTotal, const BotReport& rReport)
+    {
+        rTotal.clients += rReport.clients;
+        rTotal.playing += rReport.playing;
+        rTotal.rejected += rReport.rejected;
+        rTotal.snapshots += rReport.snapshots;
+        rTotal.lateSnapshots += rReport.lateSnapshots;
+        rTotal.decodeFailures += rReport.decodeFailures;
+        rTotal.inputsSent += rReport.inputsSent;
+        rTotal.bytesSent += rReport.bytesSent;
+        rTotal.bytesReceived += rReport.bytesReceived;
+        rTotal.seconds = std::max(rTotal.seconds, rReport.seconds);
+        rTotal.latency.Merge(rReport.latency);
+    }
+}
+
+// DeathBallBots [--matches N] [--players N] [--processes N] [--threads N] [--seconds S]
+//               [--snapshot-interval TICKS] [--port N] [--connect PORT] [--input random|scripted]
+//               [--io single|mmsg|io_uring]
+//
+// Capacity test on localhost: hosts --matches matches in a MatchHost and
+// plays them with --players BotClients each, spread over --processes child
+// processes (threads on Windows). Inputs wander at random or follow a
+// script. With --connect the bots play a DeathBallServer already running on
+// ports PORT up instead. After a warm-up it reports the server's tick times
+// and overruns, the latency from each input to the snapshot showing it
+// applied, and the traffic both ways.
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!ParseOptions(argc, argv, options))
+    {
+        std::printf("usage: DeathBallBots [--matches N] [--players N] [--processes N] [--threads N] [--seconds S] "
+                    "[--snapshot-interval TICKS] [--port N] [--connect PORT] [--input random|scripted] "
+                    "[--io single|mmsg|io_uring]\n");
+        return 1;
+    }
+    RaiseDescriptorLimit();
+
+    MatchHost* pHost = nullptr;
+    std::vector<uint16_t> ports;
+    if (options.connectPort == 0)
+    {
+        pHost = new MatchHost(options.matches, options.threads, options.snapshotInterval);
+        if (!pHost->Open(NET_LOOPBACK, (uint16_t)options.port, options.backend))
+        {
+            std::printf("cannot bind %u UDP ports\n", options.matches);
+            delete pHost;
+            return 1;
+        }
+        for (unsigned int i = 0; i < options.matches; ++i)
+            ports.push_back(pHost->GetLocalAddress(i).port);
+    }
+    else
+    {
+        for (unsigned int i = 0; i < options.matches; ++i)
+            ports.push_back((uint16_t)(options.connectPort + i));
+    }
+
+    const unsigned int clients = options.matches * options.players;
+    const unsigned int processes = std::min(options.processes, clients);
+    std::printf("DeathBallBots: %u clients (%u per match, %s input) in %u processes against %u %s matches, "
+                "%.0f s with %.0f s warm-up\n",
+                clients, options.players, options.input == INPUT_SCRIPTED ? "scripted" : "random", processes,
+                options.matches, pHost ? "hosted" : "external", options.seconds, WARMUP_SECONDS);
+
+    std::vector<BotReport> reports(processes);
+    std::vector<unsigned int> firsts;
+    for (unsigned int p = 0; p <= processes; ++p)
+        firsts.push_back((unsigned int)((uint64_t)clients * p / processes));
+
+#ifndef _WIN32
+    // forked before the host starts its threads, so each child has only the one
+    std::vector<int> pipes;
+    std::vector<pid_t> children;
+    for (unsigned int p = 0; p < processes; ++p)
+    {
+        int ends[2];
+        if (pipe(ends) != 0)
+            break;
+        const pid_t child = fork();
+        if (child == 0)
+        {
+            close(ends[0]);
+            BotReport* pReport = new BotReport();
+            RunClients(options, ports, firsts[p], firsts[p + 1] - firsts[p], *pReport);
+            const char* pBytes = reinterpret_cast<const char*>(pReport);
+            for (size_t written = 0; written < sizeof(BotReport);)
+            {
+                const ssize_t count = write(ends[1], pBytes + written, sizeof(BotReport) - written);
+                if (count <= 0)
+                    break;
+                written += (size_t)count;
+            }
+            _exit(0);
+        }
+        close(ends[1]);
+        if (child < 0)
+        {
+            close(ends[0]);
+            break;
+        }
+        pipes.push_back(ends[0]);
+        children.push_back(child);
+    }
+#else
+    std::vector<std::thread> children;
+    for (unsigned int p = 0; p < processes; ++p)
+    {
+        children.push_back(std::thread(RunClients, std::cref(options), std::cref(ports), firsts[p],
+                                       firsts[p + 1] - firsts[p], std::ref(reports[p])));
+    }
+#endif
+
+    if (pHost)
+    {
+        pHost->Start();
+        std::this_thread::sleep_for(std::chrono::duration<double>(WARMUP_SECONDS));
+        pHost->ResetStats();
+    }
+
+    std::vector<bool> received(processes, false);
+#ifndef _WIN32
+    for (unsigned int p = 0; p < children.size(); ++p)
+    {
+        char* pBytes = reinterpret_cast<char*>(&reports[p]);
+        size_t got = 0;
+        while (got < sizeof(BotReport))
+        {
+            const ssize_t count = read(pipes[p], pBytes + got, sizeof(BotReport) - got);
+            if (count <= 0)
+                break;
+            got += (size_t)count;
+        }
+        close(pipes[p]);
+        waitpid(children[p], nullptr, 0);
+        received[p] = got == sizeof(BotReport);
+    }
+#else
+    for (unsigned int p = 0; p < children.size(); ++p)
+    {
+        children[p].join();
+        received[p] = true;
+    }
+#endif
+
+    if (pHost)
+    {
+        pHost->Stop();
+        PrintServerReport(*pHost);
+        delete pHost;
+    }
+    else
+    {
+        std::printf("server: external, tick times are in its own report\n");
+    }
+
+    BotReport total;
+    total.clients = total.playing = total.rejected = 0;
+    total.snapshots = total.lateSnapshots = total.decodeFailures = 0;
+    total.inputsSent = total.bytesSent = total.bytesReceived = 0;
+    total.seconds = 0.0;
+    unsigned int reported = 0;
+    for (unsigned int p = 0; p < processes; ++p)
+    {
+        if (received[p])
+        {
+            AddReport(total, reports[p]);
+            ++reported;
+        }
+    }
+    if (reported < processes)
+        std::printf("%u of %u bot processes did not report\n", processes - reported, processes);
+    if (reported > 0)
+        PrintClientReport(total, reported);
+    return reported == processes ? 0 : 1;
+}
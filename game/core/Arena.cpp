@@ -0,0 +1,87 @@
+#include "Arena.h"
+
+#include <cstdint>
+#include <cstdlib>
+
+namespace
+{
+    // Every aligned block is preceded by a line whose last word holds the
+    // heap allocation to free, or null for arena memory.
+    const size_t HEADER = Arena::ALIGNMENT;
+
+    thread_local Arena* g_pCurrentArena = nullptr;
+
+    unsigned char* AlignUp(unsigned char* p)
+    {
+        return reinterpret_cast<unsigned char*>((reinterpret_cast<uintptr_t>(p) + Arena::ALIGNMENT - 1) &
+                                                ~uintptr_t(Arena::ALIGNMENT - 1));
+    }
+
+    void*& HeapPointer(void* pBlock)
+    {
+        return static_cast<void**>(pBlock)[-1];
+    }
+}
+
+Arena::Arena(size_t capacity)
+    : m_pStorage(static_cast<unsigned char*>(std::malloc(capacity + ALIGNMENT))),
+      m_pBase(AlignUp(m_pStorage)),
+      m_capacity(capacity),
+      m_used(0),
+      m_overflowBytes(0)
+{
+}
+
+Arena::~Arena()
+{
+    std::free(m_pStorage);
+}
+
+void* Arena::Allocate(size_t bytes)
+{
+    const size_t rounded = (bytes + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+    if (m_pStorage == nullptr || rounded > m_capacity - m_used)
+        return nullptr;
+
+    void* pBlock = m_pBase + m_used;
+    m_used += rounded;
+    return pBlock;
+}
+
+ArenaScope::ArenaScope(Arena& rArena)
+    : m_pPrevious(g_pCurrentArena)
+{
+    g_pCurrentArena = &rArena;
+}
+
+ArenaScope::~ArenaScope()
+{
+    g_pCurrentArena = m_pPrevious;
+}
+
+void* AllocateAligned(size_t bytes)
+{
+    if (g_pCurrentArena != nullptr)
+    {
+        unsigned char* pLine = static_cast<unsigned char*>(g_pCurrentArena->Allocate(HEADER + bytes));
+        if (pLine != nullptr)
+        {
+            HeapPointer(pLine + HEADER) = nullptr;
+            return pLine + HEADER;
+        }
+        g_pCurrentArena->m_overflowBytes += bytes;
+    }
+
+    unsigned char* pHeap = static_cast<unsigned char*>(std::malloc(bytes + HEADER + Arena::ALIGNMENT - 1));
+    if (pHeap == nullptr)
+        return nullptr;
+    unsigned char* pBlock = AlignUp(pHeap + HEADER);
+    HeapPointer(pBlock) = pHeap;
+    return pBlock;
+}
+
+void FreeAligned(void* pBlock)
+{
+    if (pBlock != nullptr)
+        std::free(HeapPointer(pBlock));
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+
+// One fixed block handed out front to back and released all at once, so
+// that everything one owner allocates sits together in memory.
+class Arena
+{
+public:
+    static const size_t ALIGNMENT = 64;    // a cache line
+
+    explicit Arena(size_t capacity);
+    ~Arena();
+
+    // Returns null once the block is used up.
+    void* Allocate(size_t bytes);
+
+    size_t GetCapacity() const
+    {
+        return m_capacity;
+    }
+
+    size_t GetUsed() const
+    {
+        return m_used;
+    }
+
+    // Bytes AllocateAligned() had to take from the heap while this arena
+    // was current, because it was full.
+    size_t GetOverflowBytes() const
+    {
+        return m_overflowBytes;
+    }
+
+private:
+    Arena(const Arena&);
+    Arena& operator=(const Arena&);
+
+    friend void* AllocateAligned(size_t bytes);
+
+    unsigned char* m_pStorage;
+    unsigned char* m_pBase;
+    size_t m_capacity;
+    size_t m_used;
+    size_t m_overflowBytes;
+};
+
+// Makes rArena the one AllocateAligned() uses on this thread until the scope
+// ends. Scopes nest.
+class ArenaScope
+{
+public:
+    explicit ArenaScope(Arena& rArena);
+    ~ArenaScope();
+
+private:
+    ArenaScope(const ArenaScope&);
+    ArenaScope& operator=(const ArenaScope&);
+
+    Arena* m_pPrevious;
+};
+
+// Cache line aligned storage for the simulation's big blocks: from the
+// thread's current arena when there is one with room, otherwise from the
+// heap. FreeAligned() releases heap blocks and ignores arena ones, which go
+// with their arena, so it works from any thread.
+void* AllocateAligned(size_t bytes);
+void FreeAligned(void* pBlock);
@@ -0,0 +1,77 @@
+#pragma once
+
+// Four float lanes processed together. Maps onto SSE when the compiler
+// targets it and falls back to plain scalar code otherwise, so kernels are
+// written once. Division and square root are the IEEE ones in both paths,
+// which keeps SIMD and scalar results identical.
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define DEATHBALL_SSE 1
+#include <xmmintrin.h>
+#else
+#define DEATHBALL_SSE 0
+#include <cmath>
+#endif
+
+struct Float4
+{
+#if DEATHBALL_SSE
+    __m128 v;
+
+    Float4() {}
+    explicit Float4(__m128 value) : v(value) {}
+    explicit Float4(float value) : v(_mm_set1_ps(value)) {}
+
+    static Float4 Load(const float* p)               { return Float4(_mm_load_ps(p)); }
+    static Float4 LoadUnaligned(const float* p)      { return Float4(_mm_loadu_ps(p)); }
+    void Store(float* p) const                       { _mm_store_ps(p, v); }
+    void StoreUnaligned(float* p) const              { _mm_storeu_ps(p, v); }
+
+    friend Float4 operator+(Float4 a, Float4 b)      { return Float4(_mm_add_ps(a.v, b.v)); }
+    friend Float4 operator-(Float4 a, Float4 b)      { return Float4(_mm_sub_ps(a.v, b.v)); }
+    friend Float4 operator*(Float4 a, Float4 b)      { return Float4(_mm_mul_ps(a.v, b.v)); }
+    friend Float4 operator/(Float4 a, Float4 b)      { return Float4(_mm_div_ps(a.v, b.v)); }
+    friend Float4 Sqrt(Float4 a)                     { return Float4(_mm_sqrt_ps(a.v)); }
+    friend Float4 Min(Float4 a, Float4 b)            { return Float4(_mm_min_ps(a.v, b.v)); }
+    friend Float4 Max(Float4 a, Float4 b)            { return Float4(_mm_max_ps(a.v, b.v)); }
+    // All bits set in lanes where a < b.
+    friend Float4 Less(Float4 a, Float4 b)           { return Float4(_mm_cmplt_ps(a.v, b.v)); }
+    friend Float4 Select(Float4 mask, Float4 a, Float4 b)
+    {
+        return Float4(_mm_or_ps(_mm_and_ps(mask.v, a.v), _mm_andnot_ps(mask.v, b.v)));
+    }
+    // Bit i set when lane i of a Less() mask is set.
+    friend int MoveMask(Float4 mask)                 { return _mm_movemask_ps(mask.v); }
+#else
+    float v[4];
+
+    Float4() {}
+    explicit Float4(float value) { v[0] = v[1] = v[2] = v[3] = value; }
+
+    static Float4 Load(const float* p)               { Float4 r; for (int i = 0; i < 4; ++i) r.v[i] = p[i]; return r; }
+    static Float4 LoadUnaligned(const float* p)      { return Load(p); }
+    void Store(float* p) const                       { for (int i = 0; i < 4; ++i) p[i] = v[i]; }
+    void StoreUnaligned(float* p) const              { Store(p); }
+
+    friend Float4 operator+(Float4 a, Float4 b)      { for (int i = 0; i < 4; ++i) a.v[i] += b.v[i]; return a; }
+    friend Float4 operator-(Float4 a, Float4 b)      { for (int i = 0; i < 4; ++i) a.v[i] -= b.v[i]; return a; }
+    friend Float4 operator*(Float4 a, Float4 b)      { for (int i = 0; i < 4; ++i) a.v[i] *= b.v[i]; return a; }
+    friend Float4 operator/(Float4 a, Float4 b)      { for (int i = 0; i < 4; ++i) a.v[i] /= b.v[i]; return a; }
+    friend Float4 Sqrt(Float4 a)                     { for (int i = 0; i < 4; ++i) a.v[i] = std::sqrt(a.v[i]); return a; }
+    friend Float4 Min(Float4 a, Float4 b)            { for (int i = 0; i < 4; ++i) a.v[i] = a.v[i] < b.v[i] ? a.v[i] : b.v[i]; return a; }
+    friend Float4 Max(Float4 a, Float4 b)            { for (int i = 0; i < 4; ++i) a.v[i] = a.v[i] > b.v[i] ? a.v[i] : b.v[i]; return a; }
+    // Lanes are 1.0 where a < b and 0.0 elsewhere.
+    friend Float4 Less(Float4 a, Float4 b)           { for (int i = 0; i < 4; ++i) a.v[i] = a.v[i] < b.v[i] ? 1.0f : 0.0f; return a; }
+    friend Float4 Select(Float4 mask, Float4 a, Float4 b)
+    {
+        for (int i = 0; i < 4; ++i) a.v[i] = mask.v[i] != 0.0f ? a.v[i] : b.v[i];
+        return a;
+    }
+    friend int MoveMask(Float4 mask)
+    {
+        int bits = 0;
+        for (int i = 0; i < 4; ++i) bits |= (mask.v[i] != 0.0f) << i;
+        return bits;
+    }
+#endif
+};
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+// Counts of millisecond samples in fixed quarter-millisecond buckets up to
+// one second, with one more for everything beyond. Cheap to add to and to
+// merge, and plain memory, so it can be collected from other processes.
+class LatencyHistogram
+{
+public:
+    static const unsigned int BUCKETS = 4000;
+    static const unsigned int BUCKETS_PER_MS = 4;
+
+    LatencyHistogram()
+    {
+        Clear();
+    }
+
+    void Clear()
+    {
+        std::memset(m_counts, 0, sizeof(m_counts));
+        m_count = 0;
+        m_sumMs = 0.0;
+        m_maxMs = 0.0f;
+    }
+
+    void Add(float ms)
+    {
+        if (ms < 0.0f)
+            ms = 0.0f;
+        const unsigned int bucket = (unsigned int)(ms * BUCKETS_PER_MS);
+        ++m_counts[bucket < BUCKETS ? bucket : BUCKETS];
+        ++m_count;
+        m_sumMs += ms;
+        if (ms > m_maxMs)
+            m_maxMs = ms;
+    }
+
+    void Merge(const LatencyHistogram& rOther)
+    {
+        for (unsigned int i = 0; i <= BUCKETS; ++i)
+            m_counts[i] += rOther.m_counts[i];
+        m_count += rOther.m_count;
+        m_sumMs += rOther.m_sumMs;
+        if (rOther.m_maxMs > m_maxMs)
+            m_maxMs = rOther.m_maxMs;
+    }
+
+    uint64_t GetCount() const
+    {
+        return m_count;
+    }
+
+    double GetMeanMs() const
+    {
+        return m_count > 0 ? m_sumMs / m_count : 0.0;
+    }
+
+    float GetMaxMs() const
+    {
+        return m_maxMs;
+    }
+
+    // Upper edge of the bucket below which the given fraction of samples
+    // lies; 0 when there are none.
+    float Percentile(float fraction) const
+    {
+        if (m_count == 0)
+            return 0.0f;
+        const uint64_t rank = (uint64_t)(fraction * (m_count - 1) + 0.5f);
+        uint64_t seen = 0;
+        for (unsigned int i = 0; i < BUCKETS; ++i)
+        {
+            seen += m_counts[i];
+            if (seen > rank)
+                return (float)(i + 1) / BUCKETS_PER_MS;
+        }
+        return m_maxMs;
+    }
+
+private:
+    uint32_t m_counts[BUCKETS + 1];
+    uint64_t m_count;
+    double m_sumMs;
+    float m_maxMs;
+};
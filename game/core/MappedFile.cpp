@@ -0,0 +1,121 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+MappedFile::MappedFile()
+    : m_pData(nullptr),
+      m_size(0),
+      m_file(INVALID_HANDLE_VALUE),
+      m_mapping(nullptr)
+{
+}
+
+bool MappedFile::Open(const char* pPath)
+{
+    Close();
+
+    m_file = CreateFileA(pPath, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (m_file == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(m_file, &size) || size.QuadPart == 0)
+    {
+        Close();
+        return false;
+    }
+
+    m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!m_mapping)
+    {
+        Close();
+        return false;
+    }
+
+    m_pData = static_cast<const unsigned char*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+    if (!m_pData)
+    {
+        Close();
+        return false;
+    }
+    m_size = (size_t)size.QuadPart;
+    return true;
+}
+
+void MappedFile::Close()
+{
+    if (m_pData)
+        UnmapViewOfFile(m_pData);
+    if (m_mapping)
+        CloseHandle(m_mapping);
+    if (m_file != INVALID_HANDLE_VALUE)
+        CloseHandle(m_file);
+
+    m_pData = nullptr;
+    m_size = 0;
+    m_mapping = nullptr;
+    m_file = INVALID_HANDLE_VALUE;
+}
+
+#else
+
+MappedFile::MappedFile()
+    : m_pData(nullptr),
+      m_size(0),
+      m_file(-1)
+{
+}
+
+bool MappedFile::Open(const char* pPath)
+{
+    Close();
+
+    m_file = open(pPath, O_RDONLY);
+    if (m_file < 0)
+        return false;
+
+    struct stat info;
+    if (fstat(m_file, &info) != 0 || info.st_size == 0)
+    {
+        Close();
+        return false;
+    }
+
+    void* pData = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, m_file, 0);
+    if (pData == MAP_FAILED)
+    {
+        Close();
+        return false;
+    }
+    m_pData = static_cast<const unsigned char*>(pData);
+    m_size = (size_t)info.st_size;
+    return true;
+}
+
+void MappedFile::Close()
+{
+    if (m_pData)
+        munmap(const_cast<unsigned char*>(m_pData), m_size);
+    if (m_file >= 0)
+        close(m_file);
+
+    m_pData = nullptr;
+    m_size = 0;
+    m_file = -1;
+}
+
+#endif
+
+MappedFile::~MappedFile()
+{
+    Close();
+}
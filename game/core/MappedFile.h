@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+
+// Read-only memory mapping of a whole file: mmap on POSIX, MapViewOfFile on
+// Windows. Pages are faulted in on first touch, so opening a large file is
+// cheap and random access costs only the pages actually read.
+class MappedFile
+{
+public:
+    MappedFile();
+    ~MappedFile();
+
+    bool Open(const char* pPath);
+    void Close();
+
+    bool IsOpen() const
+    {
+        return m_pData != nullptr;
+    }
+
+    const unsigned char* GetData() const
+    {
+        return m_pData;
+    }
+
+    size_t GetSize() const
+    {
+        return m_size;
+    }
+
+private:
+    MappedFile(const MappedFile&);
+    MappedFile& operator=(const MappedFile&);
+
+    const unsigned char* m_pData;
+    size_t m_size;
+#ifdef _WIN32
+    void* m_file;
+    void* m_mapping;
+#else
+    int m_file;
+#endif
+};
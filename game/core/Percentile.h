@@ -0,0 +1,15 @@
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+// Value below which the given fraction of rSamples lies. Reorders rSamples;
+// returns 0 when there are none.
+inline float Percentile(std::vector<float>& rSamples, float fraction)
+{
+    if (rSamples.empty())
+        return 0.0f;
+    size_t index = (size_t)(fraction * (rSamples.size() - 1) + 0.5f);
+    std::nth_element(rSamples.begin(), rSamples.begin() + index, rSamples.end());
+    return rSamples[index];
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// FNV-1a style 64-bit hash over raw bytes, consumed a word at a time so the
+// whole match state can be hashed every tick. Floats are hashed by their bit
+// patterns: two states hash equal only when they are bit-identical.
+class StateHash
+{
+public:
+    StateHash() : m_value(14695981039346656037ull) {}
+
+    void Add(const void* pData, size_t bytes)
+    {
+        const unsigned char* pBytes = static_cast<const unsigned char*>(pData);
+        size_t i = 0;
+        for (; i + 8 <= bytes; i += 8)
+        {
+            uint64_t word;
+            std::memcpy(&word, pBytes + i, 8);
+            Mix(word);
+        }
+        if (i < bytes)
+        {
+            uint64_t tail = 0;
+            std::memcpy(&tail, pBytes + i, bytes - i);
+            Mix(tail ^ ((uint64_t)(bytes - i) << 56));
+        }
+    }
+
+    template <typename T>
+    void Add(const T& rValue)
+    {
+        Add(&rValue, sizeof(T));
+    }
+
+    template <typename T>
+    void Add(const std::vector<T>& rValues)
+    {
+        Add((unsigned int)rValues.size());
+        if (!rValues.empty())
+            Add(&rValues[0], rValues.size() * sizeof(T));
+    }
+
+    uint64_t GetValue() const
+    {
+        return m_value;
+    }
+
+private:
+    void Mix(uint64_t word)
+    {
+        // The rotate feeds high bits back down, which a plain multiply never does.
+        uint64_t value = (m_value ^ word) * 1099511628211ull;
+        m_value = (value << 31) | (value >> 33);
+    }
+
+    uint64_t m_value;
+};
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <vector>
+
+// Flat byte serialisation of simulation state for keyframes and snapshots.
+// Values are copied raw, so a state written on one machine is only read back
+// by the same build. A writer without an output buffer only measures.
+class StateWriter
+{
+public:
+    explicit StateWriter(unsigned char* pOut) : m_pOut(pOut), m_size(0) {}
+
+    void Write(const void* pData, size_t bytes)
+    {
+        if (m_pOut)
+            std::memcpy(m_pOut + m_size, pData, bytes);
+        m_size += bytes;
+    }
+
+    template <typename T>
+    void Write(const T& rValue)
+    {
+        Write(&rValue, sizeof(T));
+    }
+
+    template <typename T>
+    void Write(const std::vector<T>& rValues)
+    {
+        Write((unsigned int)rValues.size());
+        if (!rValues.empty())
+            Write(&rValues[0], rValues.size() * sizeof(T));
+    }
+
+    size_t GetSize() const
+    {
+        return m_size;
+    }
+
+private:
+    unsigned char* m_pOut;
+    size_t m_size;
+};
+
+class StateReader
+{
+public:
+    StateReader(const unsigned char* pIn, size_t size) : m_pIn(pIn), m_size(size), m_offset(0) {}
+
+    // Reads past the end, from a truncated state, give zeros rather than
+    // bytes from outside the buffer.
+    void Read(void* pData, size_t bytes)
+    {
+        assert(bytes <= m_size - m_offset);
+        if (bytes > m_size - m_offset)
+        {
+            std::memset(pData, 0, bytes);
+            m_offset = m_size;
+            return;
+        }
+        std::memcpy(pData, m_pIn + m_offset, bytes);
+        m_offset += bytes;
+    }
+
+    template <typename T>
+    void Read(T& rValue)
+    {
+        Read(&rValue, sizeof(T));
+    }
+
+    // Resizes rValues without releasing capacity, so steady-state reads do not allocate.
+    template <typename T>
+    void Read(std::vector<T>& rValues)
+    {
+        unsigned int count = 0;
+        Read(count);
+        rValues.resize(count);
+        if (count)
+            Read(&rValues[0], count * sizeof(T));
+    }
+
+    size_t GetOffset() const
+    {
+        return m_offset;
+    }
+
+private:
+    const unsigned char* m_pIn;
+    size_t m_size;
+    size_t m_offset;
+};
@@ -0,0 +1,144 @@
+#include "WorkerPool.h"
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace
+{
+    // Workers spin this many times before going to sleep; solver batches are
+    // short and come back to back, so a sleeping worker would cost more than it saves.
+    const unsigned int SPIN_COUNT = 4000;
+}
+
+WorkerPool::WorkerPool(unsigned int threadCount)
+    : m_threadCount(threadCount == 0 ? 1 : threadCount),
+      m_generation(0),
+      m_pending(0),
+      m_quit(false),
+      m_pJob(nullptr),
+      m_jobCount(0)
+{
+    for (unsigned int worker = 1; worker < m_threadCount; ++worker)
+    {
+        m_threads.push_back(std::thread(&WorkerPool::WorkerLoop, this, worker));
+    }
+}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_quit = true;
+        m_generation.fetch_add(1);
+    }
+    m_wakeCondition.notify_all();
+
+    for (unsigned int i = 0; i < m_threads.size(); ++i)
+    {
+        m_threads[i].join();
+    }
+}
+
+void WorkerPool::ParallelFor(unsigned int count, const RangeJob& rJob)
+{
+    if (count == 0)
+        return;
+
+    if (m_threadCount == 1 || count == 1)
+    {
+        rJob(0, count, 0);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_pJob = &rJob;
+        m_jobCount = count;
+        m_pending.store(m_threadCount - 1);
+        m_generation.fetch_add(1);
+    }
+    m_wakeCondition.notify_all();
+
+    RunSlice(0);
+
+    while (m_pending.load() != 0)
+    {
+        std::this_thread::yield();
+    }
+    m_pJob = nullptr;
+}
+
+void WorkerPool::RunSlice(unsigned int worker)
+{
+    unsigned int begin = (unsigned int)((unsigned long long)m_jobCount * worker / m_threadCount);
+    unsigned int end   = (unsigned int)((unsigned long long)m_jobCount * (worker + 1) / m_threadCount);
+    if (begin < end)
+    {
+        (*m_pJob)(begin, end, worker);
+    }
+}
+
+void WorkerPool::WorkerLoop(unsigned int worker)
+{
+    unsigned int seenGeneration = 0;
+
+    for (;;)
+    {
+        unsigned int spins = 0;
+        while (m_generation.load() == seenGeneration && spins < SPIN_COUNT)
+        {
+            ++spins;
+            std::this_thread::yield();
+        }
+
+        if (m_generation.load() == seenGeneration)
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wakeCondition.wait(lock, [this, seenGeneration]() { return m_generation.load() != seenGeneration; });
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            seenGeneration = m_generation.load();
+            if (m_quit)
+                return;
+        }
+
+        RunSlice(worker);
+        m_pending.fetch_sub(1);
+    }
+}
+
+bool PinThreadToCore(std::thread& rThread, unsigned int core)
+{
+    const unsigned int cores = std::thread::hardware_concurrency();
+    if (cores > 0)
+        core %= cores;
+#ifdef _WIN32
+    if (core >= sizeof(DWORD_PTR) * 8)
+        return false;
+    return SetThreadAffinityMask(rThread.native_handle(), DWORD_PTR(1) << core) != 0;
+#elif defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(core, &set);
+    return pthread_setaffinity_np(rThread.native_handle(), sizeof(set), &set) == 0;
+#else
+    (void)rThread;
+    return false;
+#endif
+}
+
+void ParallelForOnPool(int count, void (*pJob)(int index, void* pJobData), void* pJobData, void* pPool)
+{
+    static_cast<WorkerPool*>(pPool)->ParallelFor((unsigned int)count, [pJob, pJobData](unsigned int begin, unsigned int end, unsigned int)
+    {
+        for (unsigned int i = begin; i < end; ++i)
+            pJob((int)i, pJobData);
+    });
+}
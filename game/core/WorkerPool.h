@@ -0,0 +1,58 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed pool of worker threads used by the simulation for data-parallel loops.
+// The calling thread always takes part as worker 0, so a pool of one thread
+// runs everything inline.
+class WorkerPool
+{
+public:
+    typedef std::function<void(unsigned int begin, unsigned int end, unsigned int worker)> RangeJob;
+
+    explicit WorkerPool(unsigned int threadCount);
+    ~WorkerPool();
+
+    unsigned int GetThreadCount() const
+    {
+        return m_threadCount;
+    }
+
+    // Splits [0, count) into one contiguous slice per worker and blocks until all
+    // slices are done. Slice boundaries depend only on count and the thread
+    // count, never on timing, so results are reproducible for a given pool size.
+    void ParallelFor(unsigned int count, const RangeJob& rJob);
+
+private:
+    WorkerPool(const WorkerPool&);
+    WorkerPool& operator=(const WorkerPool&);
+
+    void WorkerLoop(unsigned int worker);
+    void RunSlice(unsigned int worker);
+
+    unsigned int m_threadCount;
+    std::vector<std::thread> m_threads;
+
+    std::mutex m_mutex;
+    std::condition_variable m_wakeCondition;
+    std::atomic<unsigned int> m_generation;
+    std::atomic<unsigned int> m_pending;
+    bool m_quit;
+
+    const RangeJob* m_pJob;
+    unsigned int m_jobCount;
+};
+
+// Keeps rThread on one core, counted modulo the cores there are. Best effort:
+// returns false where thread affinity cannot be set.
+bool PinThreadToCore(std::thread& rThread, unsigned int core);
+
+// Adapter for C-style parallel-for hooks such as ImFontAtlas::BuildParallelForFn:
+// runs pJob(index, pJobData) for every index in [0, count) on the WorkerPool
+// pPool and returns when all are done.
+void ParallelForOnPool(int count, void (*pJob)(int index, void* pJobData), void* pJobData, void* pPool);
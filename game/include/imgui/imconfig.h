@@ -45,6 +45,19 @@
 //#define IMGUI_DISABLE_STB_TRUETYPE_IMPLEMENTATION
 //#define IMGUI_DISABLE_STB_RECT_PACK_IMPLEMENTATION
 
+//---- Hash IDs with CRC32C (SSE4.2 crc32 instruction when the CPU has it, table otherwise), a label hashed on its own and then
+// combined with the ID stack. Enables compile-time hashing of literal labels with IM_HASHED(). IDs differ from the default hash;
+// imgui.ini settings are re-hashed from their names on load, so saved window positions still apply.
+#define IMGUI_USE_FAST_HASH
+
+//---- Back ImGuiStorage with an open-addressing hash table instead of a sorted vector: O(1) lookups and inserts instead of
+// O(log N) lookups and O(N) inserts, for 4 more bytes of index per slot. Pairs stay in ImGuiStorage::Data in insertion order.
+#define IMGUI_USE_HASHED_STORAGE
+
+//---- Tessellate anti-aliased polylines and convex fills with SSE2 on x86-64: segment normals two at a time, each vertex position and UV written
+// with one store, 16-bit indexes eight at a time. Same vertices as the scalar code: normals are divided by a square root, not an approximate one.
+#define IMGUI_USE_SIMD_TESSELLATION
+
 //---- Define constructor and implicit cast operators to convert back<>forth from your math types and ImVec2/ImVec4.
 // This will be inlined as part of ImVec2 and ImVec4 class declarations.
 /*
@@ -669,6 +669,14 @@
 #include <stdint.h>     // intptr_t
 #endif
 
+#if defined(IMGUI_USE_FAST_HASH) && (defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86))
+#define IMGUI_HASH_SSE42
+#include <nmmintrin.h>  // _mm_crc32_u8, _mm_crc32_u32
+#ifdef _MSC_VER
+#include <intrin.h>     // __cpuid
+#endif
+#endif
+
 #define IMGUI_DEBUG_NAV_SCORING     0
 #define IMGUI_DEBUG_NAV_RECTS       0
 
@@ -1114,6 +1122,137 @@ int ImFormatStringV(char* buf, size_t buf_size, const char* fmt, va_list args)
 }
 #endif // #ifdef IMGUI_DISABLE_FORMAT_STRING_FUNCTIONS
 
+#ifdef IMGUI_USE_FAST_HASH
+
+// CRC32C (Castagnoli polynomial), the one the SSE4.2 crc32 instruction computes, so both paths give the same IDs.
+static ImU32 ImCrc32cSoftware(ImU32 crc, const unsigned char* data, size_t size)
+{
+    static ImU32 crc32c_lut[256] = { 0 };
+    if (!crc32c_lut[1])
+    {
+        const ImU32 polynomial = 0x82F63B78;
+        for (ImU32 i = 0; i < 256; i++)
+        {
+            ImU32 c = i;
+            for (ImU32 j = 0; j < 8; j++)
+                c = (c >> 1) ^ (ImU32(-int(c & 1)) & polynomial);
+            crc32c_lut[i] = c;
+        }
+    }
+    while (size--)
+        crc = (crc >> 8) ^ crc32c_lut[(crc & 0xFF) ^ *data++];
+    return crc;
+}
+
+#ifdef IMGUI_HASH_SSE42
+#if defined(__GNUC__) || defined(__clang__)
+__attribute__((target("sse4.2")))
+#endif
+static ImU32 ImCrc32cHardware(ImU32 crc, const unsigned char* data, size_t size)
+{
+    for (; size >= 4; data += 4, size -= 4)
+    {
+        unsigned int word;
+        memcpy(&word, data, 4);
+        crc = _mm_crc32_u32(crc, word);
+    }
+    while (size--)
+        crc = _mm_crc32_u8(crc, *data++);
+    return crc;
+}
+
+// Zero-terminated label. Its first 16 bytes are hashed in the same pass that finds its end and its last "###", so most
+// labels need no strlen() and memchr() calls. Longer labels continue with that scan from there, keeping the CRC so far
+// unless a later "###" restarts the label. The seed is then combined with one more crc32 instruction.
+#if defined(__GNUC__) || defined(__clang__)
+__attribute__((target("sse4.2")))
+#endif
+static ImU32 ImHashLabelHardware(const char* label, ImU32 seed)
+{
+    ImU32 crc = 0xFFFFFFFF;
+    const char* p = label;
+    for (; p < label + 16; p++)
+    {
+        const unsigned char c = (unsigned char)*p;
+        if (c == 0)
+            return ~_mm_crc32_u32(~seed, ~crc);
+        if (c == '#' && p[1] == '#' && p[2] == '#')
+            crc = 0xFFFFFFFF;
+        crc = _mm_crc32_u8(crc, c);
+    }
+    const size_t size = strlen(p);
+    const char* begin = p;
+    const char* end = p + size;
+    for (const char* q = (const char*)memchr(p, '#', size); q; q = (const char*)memchr(q + 1, '#', end - q - 1))
+        if (q[1] == '#' && q[2] == '#')
+        {
+            begin = q;
+            crc = 0xFFFFFFFF;
+        }
+    crc = ImCrc32cHardware(crc, (const unsigned char*)begin, end - begin);
+    return ~_mm_crc32_u32(~seed, ~crc);
+}
+
+static bool ImCrc32cHardwareSupported()
+{
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    return (info[2] & (1 << 20)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sse4.2") != 0;
+#endif
+}
+#endif
+
+#ifdef IMGUI_HASH_SSE42
+// Checked once at startup rather than behind a function-local static's guard on every hash. Both paths give the same IDs,
+// so a hash taken before this is initialized just uses the table.
+static const bool ImCrc32cHardwareAvailable = ImCrc32cHardwareSupported();
+#endif
+
+static inline ImU32 ImCrc32c(ImU32 crc, const void* data, size_t size)
+{
+#ifdef IMGUI_HASH_SSE42
+    if (ImCrc32cHardwareAvailable)
+        return ImCrc32cHardware(crc, (const unsigned char*)data, size);
+#endif
+    return ImCrc32cSoftware(crc, (const unsigned char*)data, size);
+}
+
+ImU32 ImHashCombine(ImU32 seed, ImU32 hash)
+{
+    unsigned char bytes[4] = { (unsigned char)hash, (unsigned char)(hash >> 8), (unsigned char)(hash >> 16), (unsigned char)(hash >> 24) };
+    return ~ImCrc32c(~seed, bytes, 4);
+}
+
+// Pass data_size==0 for zero-terminated strings
+// The data is hashed on its own and then combined with the seed, so a label's hash can be computed once (see IM_HASHED).
+ImU32 ImHash(const void* data, int data_size, ImU32 seed)
+{
+    const char* begin = (const char*)data;
+    size_t size = (size_t)data_size;
+    if (data_size <= 0)
+    {
+#ifdef IMGUI_HASH_SSE42
+        if (ImCrc32cHardwareAvailable)
+            return ImHashLabelHardware(begin, seed);
+#endif
+        // Zero-terminated string, of which only the part from the last "###" counts in the "label###id" syntax.
+        // memchr() skips over the labels without any '#' quickly.
+        size = strlen(begin);
+        const char* end = begin + size;
+        for (const char* p = (const char*)memchr(begin, '#', size); p; p = (const char*)memchr(p + 1, '#', end - p - 1))
+            if (p[1] == '#' && p[2] == '#')
+                begin = p;
+        size = end - begin;
+    }
+    return ImHashCombine(seed, ~ImCrc32c(0xFFFFFFFF, begin, size));
+}
+
+#else
+
 // Pass data_size==0 for zero-terminated strings
 // FIXME-OPT: Replace with e.g. FNV1a hash? CRC32 pretty much randomly access 1KB. Need to do proper measurements.
 ImU32 ImHash(const void* data, int data_size, ImU32 seed)
@@ -1158,6 +1297,8 @@ ImU32 ImHash(const void* data, int data_size, ImU32 seed)
     return ~crc;
 }
 
+#endif // #ifdef IMGUI_USE_FAST_HASH
+
 //-----------------------------------------------------------------------------
 // ImText* helpers
 //-----------------------------------------------------------------------------
@@ -1500,6 +1641,116 @@ void* ImFileLoadToMemory(const char* filename, const char* file_open_mode, int*
 // Helper: Key->value storage
 //-----------------------------------------------------------------------------
 
+#ifdef IMGUI_USE_HASHED_STORAGE
+
+// Pairs are appended to Data and found through Index, which holds their positions by hash of the key.
+// IDs are hashes already, the multiply only spreads them over the low bits used as the slot.
+static inline int StorageSlot(ImGuiID key, int mask)
+{
+    ImU32 h = key * 0x9E3779B1u;
+    return (int)((h ^ (h >> 16)) & (ImU32)mask);
+}
+
+// Position of the key's pair in Data, or -1
+static int StorageFind(const ImGuiStorage& storage, ImGuiID key)
+{
+    const int mask = storage.Index.Size - 1;
+    if (mask < 0)
+        return -1;
+    for (int slot = StorageSlot(key, mask); ; slot = (slot + 1) & mask)
+    {
+        const int index = storage.Index[slot];
+        if (index < 0 || storage.Data[index].key == key)
+            return index;
+    }
+}
+
+static void StorageBuildIndex(ImGuiStorage& storage, int capacity)
+{
+    storage.Index.resize(capacity);
+    memset(storage.Index.Data, 0xFF, (size_t)capacity * sizeof(int));
+    const int mask = capacity - 1;
+    for (int i = 0; i < storage.Data.Size; i++)
+    {
+        int slot = StorageSlot(storage.Data[i].key, mask);
+        while (storage.Index[slot] >= 0)
+            slot = (slot + 1) & mask;
+        storage.Index[slot] = i;
+    }
+}
+
+// Pair of the key, appending 'pair' if missing
+static ImGuiStorage::Pair* StorageFindOrAdd(ImGuiStorage& storage, const ImGuiStorage::Pair& pair)
+{
+    if ((storage.Data.Size + 1) * 2 > storage.Index.Size)
+        StorageBuildIndex(storage, ImMax(16, storage.Index.Size * 2));
+    const int mask = storage.Index.Size - 1;
+    int slot = StorageSlot(pair.key, mask);
+    for (; storage.Index[slot] >= 0; slot = (slot + 1) & mask)
+        if (storage.Data[storage.Index[slot]].key == pair.key)
+            return &storage.Data[storage.Index[slot]];
+    storage.Index[slot] = storage.Data.Size;
+    storage.Data.push_back(pair);
+    return &storage.Data.back();
+}
+
+// For quicker full rebuild of a storage (instead of an incremental one), you may add all your contents and then index them once.
+void ImGuiStorage::BuildSortByKey()
+{
+    StorageBuildIndex(*this, ImMax(16, ImUpperPowerOfTwo(Data.Size * 2)));
+}
+
+int ImGuiStorage::GetInt(ImGuiID key, int default_val) const
+{
+    const int index = StorageFind(*this, key);
+    return index < 0 ? default_val : Data[index].val_i;
+}
+
+float ImGuiStorage::GetFloat(ImGuiID key, float default_val) const
+{
+    const int index = StorageFind(*this, key);
+    return index < 0 ? default_val : Data[index].val_f;
+}
+
+void* ImGuiStorage::GetVoidPtr(ImGuiID key) const
+{
+    const int index = StorageFind(*this, key);
+    return index < 0 ? NULL : Data[index].val_p;
+}
+
+// References are only valid until a new value is added to the storage. Calling a Set***() function or a Get***Ref() function invalidates the pointer.
+int* ImGuiStorage::GetIntRef(ImGuiID key, int default_val)
+{
+    return &StorageFindOrAdd(*this, Pair(key, default_val))->val_i;
+}
+
+float* ImGuiStorage::GetFloatRef(ImGuiID key, float default_val)
+{
+    return &StorageFindOrAdd(*this, Pair(key, default_val))->val_f;
+}
+
+void** ImGuiStorage::GetVoidPtrRef(ImGuiID key, void* default_val)
+{
+    return &StorageFindOrAdd(*this, Pair(key, default_val))->val_p;
+}
+
+void ImGuiStorage::SetInt(ImGuiID key, int val)
+{
+    StorageFindOrAdd(*this, Pair(key, val))->val_i = val;
+}
+
+void ImGuiStorage::SetFloat(ImGuiID key, float val)
+{
+    StorageFindOrAdd(*this, Pair(key, val))->val_f = val;
+}
+
+void ImGuiStorage::SetVoidPtr(ImGuiID key, void* val)
+{
+    StorageFindOrAdd(*this, Pair(key, val))->val_p = val;
+}
+
+#else
+
 // std::lower_bound but without the bullshit
 static ImVector<ImGuiStorage::Pair>::iterator LowerBound(ImVector<ImGuiStorage::Pair>& data, ImGuiID key)
 {
@@ -1548,11 +1799,6 @@ int ImGuiStorage::GetInt(ImGuiID key, int default_val) const
     return it->val_i;
 }
 
-bool ImGuiStorage::GetBool(ImGuiID key, bool default_val) const
-{
-    return GetInt(key, default_val ? 1 : 0) != 0;
-}
-
 float ImGuiStorage::GetFloat(ImGuiID key, float default_val) const
 {
     ImVector<Pair>::iterator it = LowerBound(const_cast<ImVector<ImGuiStorage::Pair>&>(Data), key);
@@ -1578,11 +1824,6 @@ int* ImGuiStorage::GetIntRef(ImGuiID key, int default_val)
     return &it->val_i;
 }
 
-bool* ImGuiStorage::GetBoolRef(ImGuiID key, bool default_val)
-{
-    return (bool*)GetIntRef(key, default_val ? 1 : 0);
-}
-
 float* ImGuiStorage::GetFloatRef(ImGuiID key, float default_val)
 {
     ImVector<Pair>::iterator it = LowerBound(Data, key);
@@ -1611,11 +1852,6 @@ void ImGuiStorage::SetInt(ImGuiID key, int val)
     it->val_i = val;
 }
 
-void ImGuiStorage::SetBool(ImGuiID key, bool val)
-{
-    SetInt(key, val ? 1 : 0);
-}
-
 void ImGuiStorage::SetFloat(ImGuiID key, float val)
 {
     ImVector<Pair>::iterator it = LowerBound(Data, key);
@@ -1638,6 +1874,31 @@ void ImGuiStorage::SetVoidPtr(ImGuiID key, void* val)
     it->val_p = val;
 }
 
+#endif // #ifdef IMGUI_USE_HASHED_STORAGE
+
+void ImGuiStorage::Clear()
+{
+    Data.clear();
+#ifdef IMGUI_USE_HASHED_STORAGE
+    Index.clear();
+#endif
+}
+
+bool ImGuiStorage::GetBool(ImGuiID key, bool default_val) const
+{
+    return GetInt(key, default_val ? 1 : 0) != 0;
+}
+
+bool* ImGuiStorage::GetBoolRef(ImGuiID key, bool default_val)
+{
+    return (bool*)GetIntRef(key, default_val ? 1 : 0);
+}
+
+void ImGuiStorage::SetBool(ImGuiID key, bool val)
+{
+    SetInt(key, val ? 1 : 0);
+}
+
 void ImGuiStorage::SetAllInt(int v)
 {
     for (int i = 0; i < Data.Size; i++)
@@ -1986,12 +2247,29 @@ ImGuiWindow::~ImGuiWindow()
 
 ImGuiID ImGuiWindow::GetID(const char* str, const char* str_end)
 {
+#ifdef IMGUI_USE_FAST_HASH
+    ImGuiContext& g = *GImGui;
+    if (str == g.HashedLabel.Str && str_end == NULL)
+        return GetID(g.HashedLabel);
+#endif
     ImGuiID seed = IDStack.back();
     ImGuiID id = ImHash(str, str_end ? (int)(str_end - str) : 0, seed);
     ImGui::KeepAliveID(id);
     return id;
 }
 
+ImGuiID ImGuiWindow::GetID(const ImHashedStr& str)
+{
+    ImGuiID seed = IDStack.back();
+#ifdef IMGUI_USE_FAST_HASH
+    ImGuiID id = ImHashCombine(seed, str.Hash);
+#else
+    ImGuiID id = ImHash(str.Str, 0, seed);
+#endif
+    ImGui::KeepAliveID(id);
+    return id;
+}
+
 ImGuiID ImGuiWindow::GetID(const void* ptr)
 {
     ImGuiID seed = IDStack.back();
@@ -2003,6 +2281,11 @@ ImGuiID ImGuiWindow::GetID(const void* ptr)
 ImGuiID ImGuiWindow::GetIDNoKeepAlive(const char* str, const char* str_end)
 {
     ImGuiID seed = IDStack.back();
+#ifdef IMGUI_USE_FAST_HASH
+    ImGuiContext& g = *GImGui;
+    if (str == g.HashedLabel.Str && str_end == NULL)
+        return ImHashCombine(seed, g.HashedLabel.Hash);
+#endif
     return ImHash(str, str_end ? (int)(str_end - str) : 0, seed);
 }
 
@@ -3445,6 +3728,8 @@ void ImGui::NewFrame()
 
     SetCurrentFont(GetDefaultFont());
     IM_ASSERT(g.Font->IsLoaded());
+    g.IO.Fonts->DynamicGlyphsNewFrame();
+    g.IO.Fonts->TextCacheNewFrame();
     g.DrawListSharedData.ClipRectFullscreen = ImVec4(0.0f, 0.0f, g.IO.DisplaySize.x, g.IO.DisplaySize.y);
     g.DrawListSharedData.CurveTessellationTol = g.Style.CurveTessellationTol;
 
@@ -7715,6 +8000,20 @@ bool ImGui::Button(const char* label, const ImVec2& size_arg)
     return ButtonEx(label, size_arg, 0);
 }
 
+// The ImHashedStr widgets submit the label as usual, with its hash handed to the ID lookups through g.HashedLabel.
+struct ImGuiHashedLabelScope
+{
+    ImHashedStr Backup;
+    ImGuiHashedLabelScope(const ImHashedStr& label) { ImGuiContext& g = *GImGui; Backup = g.HashedLabel; g.HashedLabel = label; }
+    ~ImGuiHashedLabelScope()                        { GImGui->HashedLabel = Backup; }
+};
+
+bool ImGui::Button(const ImHashedStr& label, const ImVec2& size_arg)
+{
+    ImGuiHashedLabelScope scope(label);
+    return Button(label.Str, size_arg);
+}
+
 // Small buttons fits within text without additional vertical spacing.
 bool ImGui::SmallButton(const char* label)
 {
@@ -8321,6 +8620,12 @@ void ImGui::PushID(const char* str_id_begin, const char* str_id_end)
     window->IDStack.push_back(window->GetID(str_id_begin, str_id_end));
 }
 
+void ImGui::PushID(const ImHashedStr& str_id)
+{
+    ImGuiWindow* window = GetCurrentWindowRead();
+    window->IDStack.push_back(window->GetID(str_id));
+}
+
 void ImGui::PushID(const void* ptr_id)
 {
     ImGuiWindow* window = GetCurrentWindowRead();
@@ -8355,6 +8660,11 @@ ImGuiID ImGui::GetID(const void* ptr_id)
     return GImGui->CurrentWindow->GetID(ptr_id);
 }
 
+ImGuiID ImGui::GetID(const ImHashedStr& str_id)
+{
+    return GImGui->CurrentWindow->GetID(str_id);
+}
+
 void ImGui::Bullet()
 {
     ImGuiWindow* window = GetCurrentWindow();
@@ -8863,6 +9173,12 @@ bool ImGui::SliderFloat(const char* label, float* v, float v_min, float v_max, c
     return value_changed;
 }
 
+bool ImGui::SliderFloat(const ImHashedStr& label, float* v, float v_min, float v_max, const char* display_format, float power)
+{
+    ImGuiHashedLabelScope scope(label);
+    return SliderFloat(label.Str, v, v_min, v_max, display_format, power);
+}
+
 bool ImGui::VSliderFloat(const char* label, const ImVec2& size, float* v, float v_min, float v_max, const char* display_format, float power)
 {
     ImGuiWindow* window = GetCurrentWindow();
@@ -8926,6 +9242,12 @@ bool ImGui::SliderInt(const char* label, int* v, int v_min, int v_max, const cha
     return value_changed;
 }
 
+bool ImGui::SliderInt(const ImHashedStr& label, int* v, int v_min, int v_max, const char* display_format)
+{
+    ImGuiHashedLabelScope scope(label);
+    return SliderInt(label.Str, v, v_min, v_max, display_format);
+}
+
 bool ImGui::VSliderInt(const char* label, const ImVec2& size, int* v, int v_min, int v_max, const char* display_format)
 {
     if (!display_format)
@@ -9547,6 +9869,12 @@ bool ImGui::Checkbox(const char* label, bool* v)
     return pressed;
 }
 
+bool ImGui::Checkbox(const ImHashedStr& label, bool* v)
+{
+    ImGuiHashedLabelScope scope(label);
+    return Checkbox(label.Str, v);
+}
+
 bool ImGui::CheckboxFlags(const char* label, unsigned int* flags, unsigned int flags_value)
 {
     bool v = ((*flags & flags_value) == flags_value);
@@ -13315,7 +13643,11 @@ void ImGui::ShowMetricsWindow(bool* p_open)
                     }
                     ImGui::TreePop();
                 }
+#ifdef IMGUI_USE_HASHED_STORAGE
+                ImGui::BulletText("Storage: %d bytes", window->StateStorage.Data.Size * (int)sizeof(ImGuiStorage::Pair) + window->StateStorage.Index.Size * (int)sizeof(int));
+#else
                 ImGui::BulletText("Storage: %d bytes", window->StateStorage.Data.Size * (int)sizeof(ImGuiStorage::Pair));
+#endif
                 ImGui::TreePop();
             }
         };
@@ -13338,6 +13670,26 @@ void ImGui::ShowMetricsWindow(bool* p_open)
             }
             ImGui::TreePop();
         }
+        if (g.IO.Fonts->DynamicGlyphs && ImGui::TreeNode("Dynamic glyphs"))
+        {
+            ImFontAtlasDynamicGlyphsStats stats;
+            g.IO.Fonts->GetDynamicGlyphsStats(&stats);
+            ImGui::BulletText("Resident: %d/%d glyphs, %d/%d pages, %.1f%% of page area", stats.GlyphsResident, stats.GlyphsTotal, stats.PagesUsed, stats.PagesCount, stats.PixelsTotal ? 100.0f * stats.PixelsUsed / stats.PixelsTotal : 0.0f);
+            ImGui::BulletText("Misses: %d this frame, %d total, %d drawn blank", stats.GlyphMissesFrame, stats.GlyphMisses, stats.GlyphsDropped);
+            ImGui::BulletText("Evicted: %d pages, %d glyphs", stats.PagesEvicted, stats.GlyphsEvicted);
+            ImGui::BulletText("Uploaded: %d bands, %d rows", stats.Uploads, stats.RowsUploaded);
+            ImGui::TreePop();
+        }
+        if (g.IO.Fonts->TextCache && ImGui::TreeNode("Text cache"))
+        {
+            ImFontAtlasTextCacheStats stats;
+            g.IO.Fonts->GetTextCacheStats(&stats);
+            ImGui::BulletText("Entries: %d/%d, %d line breaks", stats.Entries, g.IO.Fonts->TextCacheCapacity, stats.Breaks);
+            ImGui::BulletText("Hits: %d/%d this frame, %.1f%% overall", stats.HitsFrame, stats.LookupsFrame, stats.Lookups ? 100.0f * stats.Hits / stats.Lookups : 0.0f);
+            ImGui::BulletText("Not measured again: %.1f KB of text", (double)stats.BytesSaved / 1024.0);
+            ImGui::BulletText("Evicted: %d, not added when full: %d", stats.Evicted, stats.Rejected);
+            ImGui::TreePop();
+        }
         if (ImGui::TreeNode("Internal state"))
         {
             const char* input_source_names[] = { "None", "Mouse", "Nav", "NavKeyboard", "NavGamepad" }; IM_ASSERT(IM_ARRAYSIZE(input_source_names) == ImGuiInputSource_COUNT);
@@ -60,6 +60,8 @@ struct ImDrawVert;                  // A single vertex (20 bytes by default, ove
 struct ImFont;                      // Runtime data for a single font within a parent ImFontAtlas
 struct ImFontAtlas;                 // Runtime data for multiple fonts, bake multiple fonts into a single texture, TTF/OTF font loader
 struct ImFontConfig;                // Configuration data when adding a font or merging fonts
+struct ImFontAtlasDynamicGlyphs;    // Runtime data of an ImFontAtlas rasterizing glyphs on first use (opaque)
+struct ImFontAtlasTextCache;        // Text sizes and wrapped line breaks kept by the fonts of an ImFontAtlas (opaque)
 struct ImColor;                     // Helper functions to create a color that can be converted to either u32 or float4
 struct ImGuiIO;                     // Main configuration and I/O between your application and ImGui
 struct ImGuiOnceUponAFrame;         // Simple helper for running a block of code not more than once a frame, used by IMGUI_ONCE_UPON_A_FRAME macro
@@ -132,6 +134,24 @@ struct ImVec4
 #endif
 };
 
+// Labels hashed at compile time: IM_HASHED("label") pairs a string literal with its CRC32C, following the same "label###id" rule
+// as ImHash(). With IMGUI_USE_FAST_HASH the widgets and ID functions taking an ImHashedStr only combine that hash with the ID
+// stack instead of hashing the label again; without it they hash the label at runtime like the const char* versions.
+static inline constexpr ImU32 ImHashConstBit(ImU32 crc)                 { return (crc >> 1) ^ ((crc & 1) ? 0x82F63B78u : 0u); }
+static inline constexpr ImU32 ImHashConstByte(ImU32 crc)                { return ImHashConstBit(ImHashConstBit(ImHashConstBit(ImHashConstBit(ImHashConstBit(ImHashConstBit(ImHashConstBit(ImHashConstBit(crc)))))))); }
+static inline constexpr ImU32 ImHashConstStep(const char* s, ImU32 crc) { return *s == 0 ? crc : ImHashConstStep(s + 1, ImHashConstByte(((s[0] == '#' && s[1] == '#' && s[2] == '#') ? 0xFFFFFFFFu : crc) ^ (unsigned char)s[0])); }
+static inline constexpr ImU32 ImHashConst(const char* s)                { return ~ImHashConstStep(s, 0xFFFFFFFFu); }
+template<ImU32 HASH> struct ImHashConstant { static const ImU32 Value = HASH; };
+
+struct ImHashedStr
+{
+    const char* Str;
+    ImU32       Hash;               // ImHashConst(Str)
+    constexpr ImHashedStr() : Str(NULL), Hash(0) {}
+    constexpr ImHashedStr(const char* str, ImU32 hash) : Str(str), Hash(hash) {}
+};
+#define IM_HASHED(_LITERAL)         ImHashedStr(_LITERAL, ImHashConstant<ImHashConst(_LITERAL)>::Value)
+
 // ImGui end-user API
 // In a namespace so that user can add extra functions in a separate file (e.g. Value() helpers for your vector or common types)
 namespace ImGui
@@ -289,6 +309,8 @@ namespace ImGui
     IMGUI_API ImGuiID       GetID(const char* str_id);                                      // calculate unique ID (hash of whole ID stack + given parameter). e.g. if you want to query into ImGuiStorage yourself
     IMGUI_API ImGuiID       GetID(const char* str_id_begin, const char* str_id_end);
     IMGUI_API ImGuiID       GetID(const void* ptr_id);
+    IMGUI_API void          PushID(const ImHashedStr& str_id);                               // IM_HASHED("id")
+    IMGUI_API ImGuiID       GetID(const ImHashedStr& str_id);
 
     // Widgets: Text
     IMGUI_API void          TextUnformatted(const char* text, const char* text_end = NULL);                // raw text without formatting. Roughly equivalent to Text("%s", text) but: A) doesn't require null terminated string if 'text_end' is specified, B) it's faster, no memory copy is done, no buffer size limits, recommended for long chunks of text.
@@ -321,6 +343,8 @@ namespace ImGui
     IMGUI_API void          PlotHistogram(const char* label, const float* values, int values_count, int values_offset = 0, const char* overlay_text = NULL, float scale_min = FLT_MAX, float scale_max = FLT_MAX, ImVec2 graph_size = ImVec2(0,0), int stride = sizeof(float));
     IMGUI_API void          PlotHistogram(const char* label, float (*values_getter)(void* data, int idx), void* data, int values_count, int values_offset = 0, const char* overlay_text = NULL, float scale_min = FLT_MAX, float scale_max = FLT_MAX, ImVec2 graph_size = ImVec2(0,0));
     IMGUI_API void          ProgressBar(float fraction, const ImVec2& size_arg = ImVec2(-1,0), const char* overlay = NULL);
+    IMGUI_API bool          Button(const ImHashedStr& label, const ImVec2& size = ImVec2(0,0)); // IM_HASHED("label")
+    IMGUI_API bool          Checkbox(const ImHashedStr& label, bool* v);
     IMGUI_API void          Bullet();                                                       // draw a small circle and keep the cursor on the same line. advance cursor x position by GetTreeNodeToLabelSpacing(), same distance that TreeNode() uses
 
     // Widgets: Combo Box
@@ -369,6 +393,8 @@ namespace ImGui
     IMGUI_API bool          SliderInt2(const char* label, int v[2], int v_min, int v_max, const char* display_format = "%.0f");
     IMGUI_API bool          SliderInt3(const char* label, int v[3], int v_min, int v_max, const char* display_format = "%.0f");
     IMGUI_API bool          SliderInt4(const char* label, int v[4], int v_min, int v_max, const char* display_format = "%.0f");
+    IMGUI_API bool          SliderFloat(const ImHashedStr& label, float* v, float v_min, float v_max, const char* display_format = "%.3f", float power = 1.0f);    // IM_HASHED("label")
+    IMGUI_API bool          SliderInt(const ImHashedStr& label, int* v, int v_min, int v_max, const char* display_format = "%.0f");
     IMGUI_API bool          VSliderFloat(const char* label, const ImVec2& size, float* v, float v_min, float v_max, const char* display_format = "%.3f", float power = 1.0f);
     IMGUI_API bool          VSliderInt(const char* label, const ImVec2& size, int* v, int v_min, int v_max, const char* display_format = "%.0f");
 
@@ -553,7 +579,7 @@ namespace ImGui
 // Flags for ImGui::Begin()
 enum ImGuiWindowFlags_
 {
-    ImGuiWindowFlags_NoTitleBar             = 1 << 0,   // Disable title-bar
+    ImGuiWindowFlags_NoTitleBar             = 1 << 0,    // Disable title-bar
     ImGuiWindowFlags_NoResize               = 1 << 1,   // Disable user resizing with the lower-right grip
     ImGuiWindowFlags_NoMove                 = 1 << 2,   // Disable user moving the window
     ImGuiWindowFlags_NoScrollbar            = 1 << 3,   // Disable scrollbars (window can still scroll with mouse or programatically)
@@ -587,7 +613,7 @@ enum ImGuiWindowFlags_
 // Flags for ImGui::InputText()
 enum ImGuiInputTextFlags_
 {
-    ImGuiInputTextFlags_CharsDecimal        = 1 << 0,   // Allow 0123456789.+-*/
+    ImGuiInputTextFlags_CharsDecimal        = 1 << 0,    // Allow 0123456789.+-*/
     ImGuiInputTextFlags_CharsHexadecimal    = 1 << 1,   // Allow 0123456789ABCDEFabcdef
     ImGuiInputTextFlags_CharsUppercase      = 1 << 2,   // Turn a..z into A..Z
     ImGuiInputTextFlags_CharsNoBlank        = 1 << 3,   // Filter out spaces, tabs
@@ -612,7 +638,7 @@ enum ImGuiInputTextFlags_
 // Flags for ImGui::TreeNodeEx(), ImGui::CollapsingHeader*()
 enum ImGuiTreeNodeFlags_
 {
-    ImGuiTreeNodeFlags_Selected             = 1 << 0,   // Draw as selected
+    ImGuiTreeNodeFlags_Selected             = 1 << 0,    // Draw as selected
     ImGuiTreeNodeFlags_Framed               = 1 << 1,   // Full colored frame (e.g. for CollapsingHeader)
     ImGuiTreeNodeFlags_AllowItemOverlap     = 1 << 2,   // Hit testing to allow subsequent widgets to overlap this one
     ImGuiTreeNodeFlags_NoTreePushOnOpen     = 1 << 3,   // Don't do a TreePush() when open (e.g. for CollapsingHeader) = no extra indent nor pushing on ID stack
@@ -637,7 +663,7 @@ enum ImGuiTreeNodeFlags_
 // Flags for ImGui::Selectable()
 enum ImGuiSelectableFlags_
 {
-    ImGuiSelectableFlags_DontClosePopups    = 1 << 0,   // Clicking this don't close parent popup window
+    ImGuiSelectableFlags_DontClosePopups    = 1 << 0,    // Clicking this don't close parent popup window
     ImGuiSelectableFlags_SpanAllColumns     = 1 << 1,   // Selectable frame can span all columns (text will still fit in current column)
     ImGuiSelectableFlags_AllowDoubleClick   = 1 << 2    // Generate press events on double clicks too
 };
@@ -645,7 +671,7 @@ enum ImGuiSelectableFlags_
 // Flags for ImGui::BeginCombo()
 enum ImGuiComboFlags_
 {
-    ImGuiComboFlags_PopupAlignLeft          = 1 << 0,   // Align the popup toward the left by default
+    ImGuiComboFlags_PopupAlignLeft          = 1 << 0,    // Align the popup toward the left by default
     ImGuiComboFlags_HeightSmall             = 1 << 1,   // Max ~4 items visible. Tip: If you want your combo popup to be a specific size you can use SetNextWindowSizeConstraints() prior to calling BeginCombo()
     ImGuiComboFlags_HeightRegular           = 1 << 2,   // Max ~8 items visible (default)
     ImGuiComboFlags_HeightLarge             = 1 << 3,   // Max ~20 items visible
@@ -658,7 +684,7 @@ enum ImGuiComboFlags_
 // Flags for ImGui::IsWindowFocused()
 enum ImGuiFocusedFlags_
 {
-    ImGuiFocusedFlags_ChildWindows                  = 1 << 0,   // IsWindowFocused(): Return true if any children of the window is focused
+    ImGuiFocusedFlags_ChildWindows                  = 1 << 0,    // IsWindowFocused(): Return true if any children of the window is focused
     ImGuiFocusedFlags_RootWindow                    = 1 << 1,   // IsWindowFocused(): Test from root window (top most parent of the current hierarchy)
     ImGuiFocusedFlags_AnyWindow                     = 1 << 2,   // IsWindowFocused(): Return true if any window is focused
     ImGuiFocusedFlags_RootAndChildWindows           = ImGuiFocusedFlags_RootWindow | ImGuiFocusedFlags_ChildWindows
@@ -669,7 +695,7 @@ enum ImGuiFocusedFlags_
 enum ImGuiHoveredFlags_
 {
     ImGuiHoveredFlags_Default                       = 0,        // Return true if directly over the item/window, not obstructed by another window, not obstructed by an active popup or modal blocking inputs under them.
-    ImGuiHoveredFlags_ChildWindows                  = 1 << 0,   // IsWindowHovered() only: Return true if any children of the window is hovered
+    ImGuiHoveredFlags_ChildWindows                  = 1 << 0,    // IsWindowHovered() only: Return true if any children of the window is hovered
     ImGuiHoveredFlags_RootWindow                    = 1 << 1,   // IsWindowHovered() only: Test from root window (top most parent of the current hierarchy)
     ImGuiHoveredFlags_AnyWindow                     = 1 << 2,   // IsWindowHovered() only: Return true if any window is hovered
     ImGuiHoveredFlags_AllowWhenBlockedByPopup       = 1 << 3,   // Return true even if a popup window is normally blocking access to this item/window
@@ -684,7 +710,7 @@ enum ImGuiHoveredFlags_
 enum ImGuiDragDropFlags_
 {
     // BeginDragDropSource() flags
-    ImGuiDragDropFlags_SourceNoPreviewTooltip       = 1 << 0,   // By default, a successful call to BeginDragDropSource opens a tooltip so you can display a preview or description of the source contents. This flag disable this behavior.
+    ImGuiDragDropFlags_SourceNoPreviewTooltip       = 1 << 0,    // By default, a successful call to BeginDragDropSource opens a tooltip so you can display a preview or description of the source contents. This flag disable this behavior.
     ImGuiDragDropFlags_SourceNoDisableHover         = 1 << 1,   // By default, when dragging we clear data so that IsItemHovered() will return true, to avoid subsequent user code submitting tooltips. This flag disable this behavior so you can still call IsItemHovered() on the source item.
     ImGuiDragDropFlags_SourceNoHoldToOpenOthers     = 1 << 2,   // Disable the behavior that allows to open tree nodes and collapsing header by holding over them while dragging a source item.
     ImGuiDragDropFlags_SourceAllowNullID            = 1 << 3,   // Allow items such as Text(), Image() that have no unique identifier to be used as drag source, by manufacturing a temporary identifier based on their window-relative position. This is extremely unusual within the dear imgui ecosystem and so we made it explicit.
@@ -775,7 +801,7 @@ enum ImGuiNavInput_
 // Configuration flags stored in io.ConfigFlags. Set by user/application.
 enum ImGuiConfigFlags_
 {
-    ImGuiConfigFlags_NavEnableKeyboard      = 1 << 0,   // Master keyboard navigation enable flag. NewFrame() will automatically fill io.NavInputs[] based on io.KeyDown[].
+    ImGuiConfigFlags_NavEnableKeyboard      = 1 << 0,    // Master keyboard navigation enable flag. NewFrame() will automatically fill io.NavInputs[] based on io.KeyDown[].
     ImGuiConfigFlags_NavEnableGamepad       = 1 << 1,   // Master gamepad navigation enable flag. This is mostly to instruct your imgui back-end to fill io.NavInputs[]. Back-end also needs to set ImGuiBackendFlags_HasGamepad.
     ImGuiConfigFlags_NavEnableSetMousePos   = 1 << 2,   // Instruct navigation to move the mouse cursor. May be useful on TV/console systems where moving a virtual mouse is awkward. Will update io.MousePos and set io.WantSetMousePos=true. If enabled you MUST honor io.WantSetMousePos requests in your binding, otherwise ImGui will react as if the mouse is jumping around back and forth.
     ImGuiConfigFlags_NavNoCaptureKeyboard   = 1 << 3,   // Instruct navigation to not set the io.WantCaptureKeyboard flag with io.NavActive is set. 
@@ -790,7 +816,7 @@ enum ImGuiConfigFlags_
 // Back-end capabilities flags stored in io.BackendFlags. Set by imgui_impl_xxx or custom back-end.
 enum ImGuiBackendFlags_
 {
-    ImGuiBackendFlags_HasGamepad            = 1 << 0,   // Back-end has a connected gamepad.
+    ImGuiBackendFlags_HasGamepad            = 1 << 0,    // Back-end has a connected gamepad.
     ImGuiBackendFlags_HasMouseCursors       = 1 << 1,   // Back-end can honor GetMouseCursor() values and change the OS cursor shape.
     ImGuiBackendFlags_HasSetMousePos        = 1 << 2    // Back-end can honor io.WantSetMousePos and reposition the mouse (only used if ImGuiConfigFlags_NavEnableSetMousePos is set).
 };
@@ -941,7 +967,7 @@ enum ImGuiMouseCursor_
 // Important: Treat as a regular enum! Do NOT combine multiple values using binary operators! All the functions above treat 0 as a shortcut to ImGuiCond_Always. 
 enum ImGuiCond_
 {
-    ImGuiCond_Always        = 1 << 0,   // Set the variable
+    ImGuiCond_Always        = 1 << 0,    // Set the variable
     ImGuiCond_Once          = 1 << 1,   // Set the variable once per runtime session (only the first call with succeed)
     ImGuiCond_FirstUseEver  = 1 << 2,   // Set the variable if the object/window has no persistently saved data (no entry in .ini file)
     ImGuiCond_Appearing     = 1 << 3    // Set the variable if the object/window is appearing after being hidden/inactive (or the first time)
@@ -1296,11 +1322,14 @@ struct ImGuiStorage
         Pair(ImGuiID _key, void* _val_p) { key = _key; val_p = _val_p; }
     };
     ImVector<Pair>      Data;
+#ifdef IMGUI_USE_HASHED_STORAGE
+    ImVector<int>       Index;      // Open-addressing table (linear probing) of positions in Data, -1 for an empty slot. Power of two size, at most half full.
+#endif
 
-    // - Get***() functions find pair, never add/allocate. Pairs are sorted so a query is O(log N)
+    // - Get***() functions find pair, never add/allocate. Pairs are sorted so a query is O(log N), or hashed with IMGUI_USE_HASHED_STORAGE so a query is O(1)
     // - Set***() functions find pair, insertion on demand if missing.
-    // - Sorted insertion is costly, paid once. A typical frame shouldn't need to insert any new pair.
-    void                Clear() { Data.clear(); }
+    // - Sorted insertion is costly, paid once. A typical frame shouldn't need to insert any new pair. Hashed insertion appends to Data.
+    IMGUI_API void      Clear();
     IMGUI_API int       GetInt(ImGuiID key, int default_val = 0) const;
     IMGUI_API void      SetInt(ImGuiID key, int val);
     IMGUI_API bool      GetBool(ImGuiID key, bool default_val = false) const;
@@ -1323,6 +1352,7 @@ struct ImGuiStorage
     IMGUI_API void      SetAllInt(int val);
 
     // For quicker full rebuild of a storage (instead of an incremental one), you may add all your contents and then sort once.
+    // With IMGUI_USE_HASHED_STORAGE this rebuilds Index over the pairs pushed into Data instead.
     IMGUI_API void      BuildSortByKey();
 };
 
@@ -1673,10 +1703,51 @@ struct ImFontGlyph
     float           U0, V0, U1, V1;     // Texture coordinates
 };
 
+// Where a glyph of an atlas built with ImFontAtlasFlags_DynamicGlyphs is rasterized
+struct ImFontGlyphPage
+{
+    short           Page;               // Atlas page holding its pixels, -1 until it is first drawn and again once its page is evicted
+    short           ConfigIndex;        // Input in ContainerAtlas->ConfigData rasterizing it, -1 for glyphs that are never rasterized (TAB)
+};
+
 enum ImFontAtlasFlags_
 {
-    ImFontAtlasFlags_NoPowerOfTwoHeight = 1 << 0,   // Don't round the height to next power of two
-    ImFontAtlasFlags_NoMouseCursors     = 1 << 1    // Don't build software mouse cursors into the atlas
+    ImFontAtlasFlags_NoPowerOfTwoHeight  = 1 << 0,   // Don't round the height to next power of two
+    ImFontAtlasFlags_NoMouseCursors      = 1 << 1,   // Don't build software mouse cursors into the atlas
+    ImFontAtlasFlags_DynamicGlyphs       = 1 << 2,   // Only lay out glyphs in Build(): each is rasterized into a page of the texture the first time ImFont::FindGlyph() returns it (see DynamicPageHeight)
+    ImFontAtlasFlags_SignedDistanceField = 1 << 3    // Store glyphs as signed distance fields (see SdfPadding), drawn at any size from one atlas by a renderer thresholding at 0.5. Not with ImFontAtlasFlags_DynamicGlyphs.
+};
+
+// Counters of an atlas built with ImFontAtlasFlags_DynamicGlyphs, see ImFontAtlas::GetDynamicGlyphsStats()
+struct ImFontAtlasDynamicGlyphsStats
+{
+    int             GlyphsTotal;        // Glyphs of every font, which Build() would have rasterized without the flag
+    int             GlyphsResident;     // Glyphs rasterized in a page right now
+    int             GlyphMisses;        // FindGlyph() calls that had to rasterize their glyph, since Build()
+    int             GlyphMissesFrame;   // Same, since the last DynamicGlyphsNewFrame()
+    int             GlyphsEvicted;      // Glyphs dropped along with their page, they miss again when drawn
+    int             GlyphsDropped;      // Misses finding no page to evict, as all were drawn from this frame: drawn blank
+    int             PagesCount;
+    int             PagesUsed;          // Pages holding at least one glyph
+    int             PagesEvicted;
+    int             PixelsUsed;         // Area of the packed glyphs, padding included
+    int             PixelsTotal;        // Area of all pages
+    int             Uploads;            // Bands of rows returned by DynamicGlyphsTakeDirtyRows()
+    int             RowsUploaded;
+};
+
+// Counters of the text cache of an atlas, see ImFontAtlas::GetTextCacheStats()
+struct ImFontAtlasTextCacheStats
+{
+    int             Entries;            // Text sizes and wrapped layouts held
+    int             Breaks;             // Line breaks held by the wrapped layouts
+    int             Lookups;            // CalcTextSizeA() and wrapped RenderText() calls looking in the cache, since it was created
+    int             Hits;
+    int             LookupsFrame;       // Same, since the last TextCacheNewFrame()
+    int             HitsFrame;
+    int             Evicted;            // Entries not used for TextCacheMaxAge frames
+    int             Rejected;           // Results not added as the cache was full
+    ImU64           BytesSaved;         // Text the hits did not decode and measure again
 };
 
 // Load and rasterize multiple TTF/OTF fonts into a same texture.
@@ -1763,6 +1834,30 @@ struct ImFontAtlas
     IMGUI_API void      CalcCustomRectUV(const CustomRect* rect, ImVec2* out_uv_min, ImVec2* out_uv_max);
     IMGUI_API bool      GetMouseCursorTexData(ImGuiMouseCursor cursor, ImVec2* out_offset, ImVec2* out_size, ImVec2 out_uv_border[2], ImVec2 out_uv_fill[2]);
 
+    //-------------------------------------------
+    // Dynamic glyphs (ImFontAtlasFlags_DynamicGlyphs)
+    //-------------------------------------------
+
+    // Glyphs are packed into pages, bands of DynamicPageHeight rows below the custom rectangles, each with its own stb_rect_pack context.
+    // When no page has room the page drawn from longest ago is evicted whole. Pages drawn from since the last DynamicGlyphsNewFrame() are
+    // kept, as draw lists already refer to them. Rasterized glyphs are written to TexPixelsAlpha8 and, once created, TexPixelsRGBA32:
+    // after building your frame, upload each band returned by DynamicGlyphsTakeDirtyRows() into your texture (e.g. with glTexSubImage2D).
+    IMGUI_API void      DynamicGlyphsNewFrame();                                        // Called by ImGui::NewFrame(). Starts a frame for the eviction order and GlyphMissesFrame.
+    IMGUI_API bool      DynamicGlyphsTakeDirtyRows(int* out_y, int* out_height);        // Next band of texture rows written since it was last taken, at most one per page. Returns false when there is none left.
+    IMGUI_API void      GetDynamicGlyphsStats(ImFontAtlasDynamicGlyphsStats* out_stats) const;
+
+    //-------------------------------------------
+    // Text cache (TextCacheCapacity > 0)
+    //-------------------------------------------
+
+    // ImFont::CalcTextSizeA() and ImFont::RenderText() with word wrapping keep their results for texts of a few words or more, found by a hash of the text
+    // along with the font, size and wrap width and checked against a copy of the text, so that labels, tooltips and logs drawn every frame are decoded and
+    // measured once. Entries unused for TextCacheMaxAge frames are evicted; once full, new results are not kept until then. Cleared with the fonts and when
+    // the atlas is built again.
+    IMGUI_API void      TextCacheNewFrame();                                            // Called by ImGui::NewFrame(). Evicts the entries unused for TextCacheMaxAge frames.
+    IMGUI_API void      ClearTextCache();
+    IMGUI_API void      GetTextCacheStats(ImFontAtlasTextCacheStats* out_stats) const;
+
     //-------------------------------------------
     // Members
     //-------------------------------------------
@@ -1771,6 +1866,18 @@ struct ImFontAtlas
     ImTextureID                 TexID;              // User data to refer to the texture once it has been uploaded to user's graphic systems. It is passed back to you during rendering via the ImDrawCmd structure.
     int                         TexDesiredWidth;    // Texture width desired by user before Build(). Must be a power-of-two. If have many glyphs your graphics API have texture size restrictions you may want to increase texture width to decrease height.
     int                         TexGlyphPadding;    // Padding between glyphs within texture in pixels. Defaults to 1.
+    const char*                 BuildCacheFilename; // = NULL   // Path of a cache of the built atlas (pixels and glyph tables), keyed by the font data and every build setting. Build() loads it in one read when it matches and rewrites it when it does not. NULL to disable.
+    bool                        BuildFromCache;     // Output   // Set by Build(): the atlas was loaded from BuildCacheFilename.
+
+    // Optional: rasterize glyphs on the application's threads. Build() calls BuildParallelForFn(count, job, job_data, BuildParallelForUserData), which must have run
+    // job(index, job_data) once for every index in [0, count) when it returns. Jobs write disjoint parts of the atlas and allocate with malloc() rather than ImGui::MemAlloc().
+    void                        (*BuildParallelForFn)(int count, void (*job)(int index, void* job_data), void* job_data, void* user_data);
+    void*                       BuildParallelForUserData;
+    int                         DynamicPageHeight;  // = 128    // ImFontAtlasFlags_DynamicGlyphs: rows of each page glyphs are packed into and evicted with. Must fit the tallest glyph.
+    int                         DynamicPageCount;   // = 8      // ImFontAtlasFlags_DynamicGlyphs: minimum number of pages, Build() adds more to fill the texture up to its power of two height.
+    int                         TextCacheCapacity;  // = 0      // Entries of the text cache (see TextCacheNewFrame()), 0 to disable it.
+    int                         TextCacheMaxAge;    // = 60     // Frames a text cache entry is kept without being used.
+    int                         SdfPadding;         // = 4      // ImFontAtlasFlags_SignedDistanceField: pixels of distance around each glyph, the outline is at 128 and the field falls to 0 this far outside it. OversampleH/V and RasterizerMultiply are ignored.
 
     // [Internal]
     // NB: Access texture data via GetTexData*() calls! Which will setup a default font for you.
@@ -1784,6 +1891,8 @@ struct ImFontAtlas
     ImVector<CustomRect>        CustomRects;        // Rectangles for packing custom texture data into the atlas.
     ImVector<ImFontConfig>      ConfigData;         // Internal data
     int                         CustomRectIds[1];   // Identifiers of custom texture rectangle used by ImFontAtlas/ImDrawList
+    ImFontAtlasDynamicGlyphs*   DynamicGlyphs;      // Pages, fonts kept open for rasterizing and counters of ImFontAtlasFlags_DynamicGlyphs, NULL without it
+    ImFontAtlasTextCache*       TextCache;          // Entries, their index and counters of the text cache, NULL until it is first used
 };
 
 // Font runtime data and rendering
@@ -1808,6 +1917,7 @@ struct ImFont
     float                       Ascent, Descent;    //              // Ascent: distance from top to bottom of e.g. 'A' [0..FontSize]
     bool                        DirtyLookupTables;
     int                         MetricsTotalSurface;//              // Total surface in pixels to get an idea of the font rasterization/texture cost (not exact, we approximate the cost of padding between glyphs)
+    ImVector<ImFontGlyphPage>   GlyphPages;         //              // ImFontAtlasFlags_DynamicGlyphs: parallel to the first Glyphs, those Build() added. Empty otherwise.
 
     // Methods
     IMGUI_API ImFont();
@@ -18,6 +18,7 @@
 #include "imgui_internal.h"
 
 #include <stdio.h>      // vsnprintf, sscanf, printf
+#include <stdlib.h>     // malloc, free
 #if !defined(alloca)
 #ifdef _WIN32
 #include <malloc.h>     // alloca
@@ -31,6 +32,15 @@
 #endif
 #endif
 
+// x86-64 only, where the scalar float code is SSE too and gives the same results. Vertex stores assume ImDrawVert starts with pos and uv.
+#if defined(IMGUI_USE_SIMD_TESSELLATION) && (defined(__x86_64__) || defined(_M_X64)) && !defined(IMGUI_OVERRIDE_DRAWVERT_STRUCT_LAYOUT)
+#define IMGUI_TESSELLATE_SSE2
+#include <emmintrin.h>  // _mm_sqrt_ps, _mm_storeu_ps
+#ifndef ImDrawIdx
+#define IMGUI_TESSELLATE_SSE2_IDX16                 // Indexes written 8 at a time, ImDrawIdx being unsigned short
+#endif
+#endif
+
 #ifdef _MSC_VER
 #pragma warning (disable: 4505) // unreferenced local function has been removed (stb stuff)
 #pragma warning (disable: 4996) // 'This function or variable may be unsafe': strcpy, strdup, sprintf, vsnprintf, sscanf, fopen
@@ -103,8 +113,12 @@ namespace IMGUI_STB_NAMESPACE
 #endif
 
 #ifndef IMGUI_DISABLE_STB_TRUETYPE_IMPLEMENTATION
-#define STBTT_malloc(x,u)  ((void)(u), ImGui::MemAlloc(x))
-#define STBTT_free(x,u)    ((void)(u), ImGui::MemFree(x))
+// Glyphs rasterized by ImFontAtlas::BuildParallelForFn jobs come with a non-NULL font userdata and allocate from the C runtime,
+// as ImGui::MemAlloc() and user allocators are not expected to be thread-safe.
+static void*                ImFontAtlasBuildAlloc(size_t size, void* user_data) { return user_data ? malloc(size) : ImGui::MemAlloc(size); }
+static void                 ImFontAtlasBuildFree(void* ptr, void* user_data)    { if (user_data) free(ptr); else ImGui::MemFree(ptr); }
+#define STBTT_malloc(x,u)  ImFontAtlasBuildAlloc(x,u)
+#define STBTT_free(x,u)    ImFontAtlasBuildFree(x,u)
 #define STBTT_assert(x)    IM_ASSERT(x)
 #define STBTT_STATIC
 #define STB_TRUETYPE_IMPLEMENTATION
@@ -305,6 +319,7 @@ ImDrawListSharedData::ImDrawListSharedData()
         const float a = ((float)i * 2 * IM_PI) / (float)IM_ARRAYSIZE(CircleVtx12);
         CircleVtx12[i] = ImVec2(cosf(a), sinf(a));
     }
+    ArcTablesNext = 0;
 }
 
 //-----------------------------------------------------------------------------
@@ -614,6 +629,111 @@ void ImDrawList::PrimQuadUV(const ImVec2& a, const ImVec2& b, const ImVec2& c, c
     _IdxWritePtr += 6;
 }
 
+// Anti-aliased tessellation: unit normals of the segments of the path, then at each point the average of the normals on both sides of it,
+// scaled by the inverse of its squared length (at most 100) so that the fringes keep their width in corners. The SSE2 versions do two
+// segments or points per register with the same operations in the same order (a square root and a division, not an approximate reciprocal
+// square root), so both give the same vertices.
+
+// normals[i] is the normal of points[i] -> points[i+1], the last one of a closed path going back to points[0]. Open paths repeat the normal of
+// their last segment for their last point.
+static void PathSegmentNormals(const ImVec2* points, const int points_count, bool closed, ImVec2* out_normals)
+{
+    const int count = closed ? points_count : points_count-1;
+    int i1 = 0;
+#ifdef IMGUI_TESSELLATE_SSE2
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 negate_y = _mm_castsi128_ps(_mm_set_epi32((int)0x80000000, 0, (int)0x80000000, 0));
+    for (; i1 + 2 < points_count; i1 += 2)
+    {
+        const __m128 diff = _mm_sub_ps(_mm_loadu_ps(&points[i1+1].x), _mm_loadu_ps(&points[i1].x));
+        const __m128 diff2 = _mm_mul_ps(diff, diff);
+        const __m128 d = _mm_add_ps(diff2, _mm_shuffle_ps(diff2, diff2, _MM_SHUFFLE(2,3,0,1)));
+        const __m128 has_length = _mm_cmpgt_ps(d, _mm_setzero_ps());
+        const __m128 inv_length = _mm_or_ps(_mm_and_ps(has_length, _mm_div_ps(one, _mm_sqrt_ps(d))), _mm_andnot_ps(has_length, one));
+        const __m128 unit = _mm_mul_ps(diff, inv_length);
+        _mm_storeu_ps(&out_normals[i1].x, _mm_xor_ps(_mm_shuffle_ps(unit, unit, _MM_SHUFFLE(2,3,0,1)), negate_y));
+    }
+#endif
+    for (; i1 < count; i1++)
+    {
+        const int i2 = (i1+1) == points_count ? 0 : i1+1;
+        ImVec2 diff = points[i2] - points[i1];
+        diff *= ImInvLength(diff, 1.0f);
+        out_normals[i1].x = diff.y;
+        out_normals[i1].y = -diff.x;
+    }
+    if (!closed)
+        out_normals[points_count-1] = out_normals[points_count-2];
+}
+
+static inline ImVec2 PathMiterOffset(const ImVec2& n0, const ImVec2& n1)
+{
+    ImVec2 dm = (n0 + n1) * 0.5f;
+    float dmr2 = dm.x*dm.x + dm.y*dm.y;
+    if (dmr2 > 0.000001f)
+    {
+        float scale = 1.0f / dmr2;
+        if (scale > 100.0f) scale = 100.0f;
+        dm *= scale;
+    }
+    return dm;
+}
+
+// offsets[i] from normals[i-1] and normals[i], the last normal coming before the first one.
+static void PathMiterOffsets(const ImVec2* normals, const int points_count, ImVec2* out_offsets)
+{
+    if (points_count <= 0)
+        return;
+    out_offsets[0] = PathMiterOffset(normals[points_count-1], normals[0]);
+    int i = 1;
+#ifdef IMGUI_TESSELLATE_SSE2
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 half = _mm_set1_ps(0.5f);
+    const __m128 min_dmr2 = _mm_set1_ps(0.000001f);
+    const __m128 max_scale = _mm_set1_ps(100.0f);
+    for (; i + 1 < points_count; i += 2)
+    {
+        const __m128 dm = _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(&normals[i-1].x), _mm_loadu_ps(&normals[i].x)), half);
+        const __m128 dm2 = _mm_mul_ps(dm, dm);
+        const __m128 dmr2 = _mm_add_ps(dm2, _mm_shuffle_ps(dm2, dm2, _MM_SHUFFLE(2,3,0,1)));
+        const __m128 scaled = _mm_cmpgt_ps(dmr2, min_dmr2);
+        const __m128 scale = _mm_min_ps(_mm_div_ps(one, dmr2), max_scale);
+        _mm_storeu_ps(&out_offsets[i].x, _mm_or_ps(_mm_and_ps(scaled, _mm_mul_ps(dm, scale)), _mm_andnot_ps(scaled, dm)));
+    }
+#endif
+    for (; i < points_count; i++)
+        out_offsets[i] = PathMiterOffset(normals[i-1], normals[i]);
+}
+
+#ifdef IMGUI_TESSELLATE_SSE2
+static inline __m128 PathLoadPoint(const ImVec2& p)
+{
+    return _mm_loadl_pi(_mm_setzero_ps(), (const __m64*)&p);
+}
+
+// Position and UV in one store
+static inline void PrimWriteVtxSSE2(ImDrawVert* vtx, __m128 pos, __m128 uv, ImU32 col)
+{
+    _mm_storeu_ps(&vtx->pos.x, _mm_movelh_ps(pos, uv));
+    vtx->col = col;
+}
+#endif
+
+#ifdef IMGUI_TESSELLATE_SSE2_IDX16
+// Indexes of runs of primitives laid out alike: each run is pattern (pattern_size indexes, a multiple of 8) added to base, base moving on by
+// base_step from one run to the next. Wraps around like the (ImDrawIdx) casts of the scalar code.
+static inline ImDrawIdx* PrimWriteIdxRuns(ImDrawIdx* out, const ImDrawIdx* pattern, int pattern_size, unsigned int base, unsigned int base_step, int runs)
+{
+    for (int r = 0; r < runs; r++, base += base_step, out += pattern_size)
+    {
+        const __m128i base_sse = _mm_set1_epi16((short)base);
+        for (int n = 0; n < pattern_size; n += 8)
+            _mm_storeu_si128((__m128i*)(out + n), _mm_add_epi16(_mm_loadu_si128((const __m128i*)(pattern + n)), base_sse));
+    }
+    return out;
+}
+#endif
+
 // TODO: Thickness anti-aliased lines cap are missing their AA fringe.
 void ImDrawList::AddPolyline(const ImVec2* points, const int points_count, ImU32 col, bool closed, float thickness)
 {
@@ -637,109 +757,86 @@ void ImDrawList::AddPolyline(const ImVec2* points, const int points_count, ImU32
         const int vtx_count = thick_line ? points_count*4 : points_count*3;
         PrimReserve(idx_count, vtx_count);
 
-        // Temporary buffer
-        ImVec2* temp_normals = (ImVec2*)alloca(points_count * (thick_line ? 5 : 3) * sizeof(ImVec2));
-        ImVec2* temp_points = temp_normals + points_count;
-
-        for (int i1 = 0; i1 < count; i1++)
-        {
-            const int i2 = (i1+1) == points_count ? 0 : i1+1;
-            ImVec2 diff = points[i2] - points[i1];
-            diff *= ImInvLength(diff, 1.0f);
-            temp_normals[i1].x = diff.y;
-            temp_normals[i1].y = -diff.x;
-        }
+        // Temporary buffer: normals of the segments, offsets of the vertices at each point
+        ImVec2* temp_normals = (ImVec2*)alloca(points_count * 2 * sizeof(ImVec2));
+        ImVec2* temp_offsets = temp_normals + points_count;
+        PathSegmentNormals(points, points_count, closed, temp_normals);
+        PathMiterOffsets(temp_normals, points_count, temp_offsets);
         if (!closed)
-            temp_normals[points_count-1] = temp_normals[points_count-2];
+            temp_offsets[0] = temp_normals[0];
 
         if (!thick_line)
         {
-            if (!closed)
-            {
-                temp_points[0] = points[0] + temp_normals[0] * AA_SIZE;
-                temp_points[1] = points[0] - temp_normals[0] * AA_SIZE;
-                temp_points[(points_count-1)*2+0] = points[points_count-1] + temp_normals[points_count-1] * AA_SIZE;
-                temp_points[(points_count-1)*2+1] = points[points_count-1] - temp_normals[points_count-1] * AA_SIZE;
-            }
-
-            // FIXME-OPT: Merge the different loops, possibly remove the temporary buffer.
+            // Add indexes
             unsigned int idx1 = _VtxCurrentIdx;
-            for (int i1 = 0; i1 < count; i1++)
+            int i1 = 0;
+#ifdef IMGUI_TESSELLATE_SSE2_IDX16
+            // Two segments per run, up to the one closing the path
+            static const ImDrawIdx thin_pattern[24] = { 3,0,2, 2,5,3, 4,1,0, 0,3,4, 6,3,5, 5,8,6, 7,4,3, 3,6,7 };
+            const int runs = (points_count - 1) / 2;
+            _IdxWritePtr = PrimWriteIdxRuns(_IdxWritePtr, thin_pattern, 24, idx1, 6, runs);
+            i1 = runs * 2;
+            idx1 += runs * 6;
+#endif
+            for (; i1 < count; i1++)
             {
-                const int i2 = (i1+1) == points_count ? 0 : i1+1;
                 unsigned int idx2 = (i1+1) == points_count ? _VtxCurrentIdx : idx1+3;
-
-                // Average normals
-                ImVec2 dm = (temp_normals[i1] + temp_normals[i2]) * 0.5f;
-                float dmr2 = dm.x*dm.x + dm.y*dm.y;
-                if (dmr2 > 0.000001f)
-                {
-                    float scale = 1.0f / dmr2;
-                    if (scale > 100.0f) scale = 100.0f;
-                    dm *= scale;
-                }
-                dm *= AA_SIZE;
-                temp_points[i2*2+0] = points[i2] + dm;
-                temp_points[i2*2+1] = points[i2] - dm;
-
-                // Add indexes
                 _IdxWritePtr[0] = (ImDrawIdx)(idx2+0); _IdxWritePtr[1] = (ImDrawIdx)(idx1+0); _IdxWritePtr[2] = (ImDrawIdx)(idx1+2);
                 _IdxWritePtr[3] = (ImDrawIdx)(idx1+2); _IdxWritePtr[4] = (ImDrawIdx)(idx2+2); _IdxWritePtr[5] = (ImDrawIdx)(idx2+0);
                 _IdxWritePtr[6] = (ImDrawIdx)(idx2+1); _IdxWritePtr[7] = (ImDrawIdx)(idx1+1); _IdxWritePtr[8] = (ImDrawIdx)(idx1+0);
                 _IdxWritePtr[9] = (ImDrawIdx)(idx1+0); _IdxWritePtr[10]= (ImDrawIdx)(idx2+0); _IdxWritePtr[11]= (ImDrawIdx)(idx2+1);
                 _IdxWritePtr += 12;
-
                 idx1 = idx2;
             }
 
             // Add vertexes
+#ifdef IMGUI_TESSELLATE_SSE2
+            const __m128 uv_sse = PathLoadPoint(uv);
+            const __m128 aa_size = _mm_set1_ps(AA_SIZE);
             for (int i = 0; i < points_count; i++)
             {
-                _VtxWritePtr[0].pos = points[i];          _VtxWritePtr[0].uv = uv; _VtxWritePtr[0].col = col;
-                _VtxWritePtr[1].pos = temp_points[i*2+0]; _VtxWritePtr[1].uv = uv; _VtxWritePtr[1].col = col_trans;
-                _VtxWritePtr[2].pos = temp_points[i*2+1]; _VtxWritePtr[2].uv = uv; _VtxWritePtr[2].col = col_trans;
+                const __m128 p = PathLoadPoint(points[i]);
+                const __m128 dm = _mm_mul_ps(PathLoadPoint(temp_offsets[i]), aa_size);
+                PrimWriteVtxSSE2(_VtxWritePtr + 0, p, uv_sse, col);
+                PrimWriteVtxSSE2(_VtxWritePtr + 1, _mm_add_ps(p, dm), uv_sse, col_trans);
+                PrimWriteVtxSSE2(_VtxWritePtr + 2, _mm_sub_ps(p, dm), uv_sse, col_trans);
                 _VtxWritePtr += 3;
             }
+#else
+            for (int i = 0; i < points_count; i++)
+            {
+                const ImVec2 dm = temp_offsets[i] * AA_SIZE;
+                _VtxWritePtr[0].pos = points[i];      _VtxWritePtr[0].uv = uv; _VtxWritePtr[0].col = col;
+                _VtxWritePtr[1].pos = points[i] + dm; _VtxWritePtr[1].uv = uv; _VtxWritePtr[1].col = col_trans;
+                _VtxWritePtr[2].pos = points[i] - dm; _VtxWritePtr[2].uv = uv; _VtxWritePtr[2].col = col_trans;
+                _VtxWritePtr += 3;
+            }
+#endif
         }
         else
         {
             const float half_inner_thickness = (thickness - AA_SIZE) * 0.5f;
-            if (!closed)
-            {
-                temp_points[0] = points[0] + temp_normals[0] * (half_inner_thickness + AA_SIZE);
-                temp_points[1] = points[0] + temp_normals[0] * (half_inner_thickness);
-                temp_points[2] = points[0] - temp_normals[0] * (half_inner_thickness);
-                temp_points[3] = points[0] - temp_normals[0] * (half_inner_thickness + AA_SIZE);
-                temp_points[(points_count-1)*4+0] = points[points_count-1] + temp_normals[points_count-1] * (half_inner_thickness + AA_SIZE);
-                temp_points[(points_count-1)*4+1] = points[points_count-1] + temp_normals[points_count-1] * (half_inner_thickness);
-                temp_points[(points_count-1)*4+2] = points[points_count-1] - temp_normals[points_count-1] * (half_inner_thickness);
-                temp_points[(points_count-1)*4+3] = points[points_count-1] - temp_normals[points_count-1] * (half_inner_thickness + AA_SIZE);
-            }
 
-            // FIXME-OPT: Merge the different loops, possibly remove the temporary buffer.
+            // Add indexes
             unsigned int idx1 = _VtxCurrentIdx;
-            for (int i1 = 0; i1 < count; i1++)
+            int i1 = 0;
+#ifdef IMGUI_TESSELLATE_SSE2_IDX16
+            // Four segments per run, up to the one closing the path
+            static const ImDrawIdx thick_pattern[72] =
+            {
+                 5, 1, 2,  2, 6, 5,  5, 1, 0,  0, 4, 5,  6, 2, 3,  3, 7, 6,
+                 9, 5, 6,  6,10, 9,  9, 5, 4,  4, 8, 9, 10, 6, 7,  7,11,10,
+                13, 9,10, 10,14,13, 13, 9, 8,  8,12,13, 14,10,11, 11,15,14,
+                17,13,14, 14,18,17, 17,13,12, 12,16,17, 18,14,15, 15,19,18
+            };
+            const int runs = (points_count - 1) / 4;
+            _IdxWritePtr = PrimWriteIdxRuns(_IdxWritePtr, thick_pattern, 72, idx1, 16, runs);
+            i1 = runs * 4;
+            idx1 += runs * 16;
+#endif
+            for (; i1 < count; i1++)
             {
-                const int i2 = (i1+1) == points_count ? 0 : i1+1;
                 unsigned int idx2 = (i1+1) == points_count ? _VtxCurrentIdx : idx1+4;
-
-                // Average normals
-                ImVec2 dm = (temp_normals[i1] + temp_normals[i2]) * 0.5f;
-                float dmr2 = dm.x*dm.x + dm.y*dm.y;
-                if (dmr2 > 0.000001f)
-                {
-                    float scale = 1.0f / dmr2;
-                    if (scale > 100.0f) scale = 100.0f;
-                    dm *= scale;
-                }
-                ImVec2 dm_out = dm * (half_inner_thickness + AA_SIZE);
-                ImVec2 dm_in = dm * half_inner_thickness;
-                temp_points[i2*4+0] = points[i2] + dm_out;
-                temp_points[i2*4+1] = points[i2] + dm_in;
-                temp_points[i2*4+2] = points[i2] - dm_in;
-                temp_points[i2*4+3] = points[i2] - dm_out;
-
-                // Add indexes
                 _IdxWritePtr[0]  = (ImDrawIdx)(idx2+1); _IdxWritePtr[1]  = (ImDrawIdx)(idx1+1); _IdxWritePtr[2]  = (ImDrawIdx)(idx1+2);
                 _IdxWritePtr[3]  = (ImDrawIdx)(idx1+2); _IdxWritePtr[4]  = (ImDrawIdx)(idx2+2); _IdxWritePtr[5]  = (ImDrawIdx)(idx2+1);
                 _IdxWritePtr[6]  = (ImDrawIdx)(idx2+1); _IdxWritePtr[7]  = (ImDrawIdx)(idx1+1); _IdxWritePtr[8]  = (ImDrawIdx)(idx1+0);
@@ -747,19 +844,38 @@ void ImDrawList::AddPolyline(const ImVec2* points, const int points_count, ImU32
                 _IdxWritePtr[12] = (ImDrawIdx)(idx2+2); _IdxWritePtr[13] = (ImDrawIdx)(idx1+2); _IdxWritePtr[14] = (ImDrawIdx)(idx1+3);
                 _IdxWritePtr[15] = (ImDrawIdx)(idx1+3); _IdxWritePtr[16] = (ImDrawIdx)(idx2+3); _IdxWritePtr[17] = (ImDrawIdx)(idx2+2);
                 _IdxWritePtr += 18;
-
                 idx1 = idx2;
             }
 
             // Add vertexes
+#ifdef IMGUI_TESSELLATE_SSE2
+            const __m128 uv_sse = PathLoadPoint(uv);
+            const __m128 out_scale = _mm_set1_ps(half_inner_thickness + AA_SIZE);
+            const __m128 in_scale = _mm_set1_ps(half_inner_thickness);
             for (int i = 0; i < points_count; i++)
             {
-                _VtxWritePtr[0].pos = temp_points[i*4+0]; _VtxWritePtr[0].uv = uv; _VtxWritePtr[0].col = col_trans;
-                _VtxWritePtr[1].pos = temp_points[i*4+1]; _VtxWritePtr[1].uv = uv; _VtxWritePtr[1].col = col;
-                _VtxWritePtr[2].pos = temp_points[i*4+2]; _VtxWritePtr[2].uv = uv; _VtxWritePtr[2].col = col;
-                _VtxWritePtr[3].pos = temp_points[i*4+3]; _VtxWritePtr[3].uv = uv; _VtxWritePtr[3].col = col_trans;
+                const __m128 p = PathLoadPoint(points[i]);
+                const __m128 dm = PathLoadPoint(temp_offsets[i]);
+                const __m128 dm_out = _mm_mul_ps(dm, out_scale);
+                const __m128 dm_in = _mm_mul_ps(dm, in_scale);
+                PrimWriteVtxSSE2(_VtxWritePtr + 0, _mm_add_ps(p, dm_out), uv_sse, col_trans);
+                PrimWriteVtxSSE2(_VtxWritePtr + 1, _mm_add_ps(p, dm_in), uv_sse, col);
+                PrimWriteVtxSSE2(_VtxWritePtr + 2, _mm_sub_ps(p, dm_in), uv_sse, col);
+                PrimWriteVtxSSE2(_VtxWritePtr + 3, _mm_sub_ps(p, dm_out), uv_sse, col_trans);
                 _VtxWritePtr += 4;
             }
+#else
+            for (int i = 0; i < points_count; i++)
+            {
+                const ImVec2 dm_out = temp_offsets[i] * (half_inner_thickness + AA_SIZE);
+                const ImVec2 dm_in = temp_offsets[i] * half_inner_thickness;
+                _VtxWritePtr[0].pos = points[i] + dm_out; _VtxWritePtr[0].uv = uv; _VtxWritePtr[0].col = col_trans;
+                _VtxWritePtr[1].pos = points[i] + dm_in;  _VtxWritePtr[1].uv = uv; _VtxWritePtr[1].col = col;
+                _VtxWritePtr[2].pos = points[i] - dm_in;  _VtxWritePtr[2].uv = uv; _VtxWritePtr[2].col = col;
+                _VtxWritePtr[3].pos = points[i] - dm_out; _VtxWritePtr[3].uv = uv; _VtxWritePtr[3].col = col_trans;
+                _VtxWritePtr += 4;
+            }
+#endif
         }
         _VtxCurrentIdx += (ImDrawIdx)vtx_count;
     }
@@ -816,43 +932,56 @@ void ImDrawList::AddConvexPolyFilled(const ImVec2* points, const int points_coun
             _IdxWritePtr += 3;
         }
 
-        // Compute normals
-        ImVec2* temp_normals = (ImVec2*)alloca(points_count * sizeof(ImVec2));
-        for (int i0 = points_count-1, i1 = 0; i1 < points_count; i0 = i1++)
+        // Add indexes for fringes
+        int i0 = points_count-1, i1 = 0;
+#ifdef IMGUI_TESSELLATE_SSE2_IDX16
+        // The fringe closing the path first, then four per run
+        static const ImDrawIdx fringe_pattern[24] = { 2,0,1, 1,3,2, 4,2,3, 3,5,4, 6,4,5, 5,7,6, 8,6,7, 7,9,8 };
+        if (points_count > 0)
         {
-            const ImVec2& p0 = points[i0];
-            const ImVec2& p1 = points[i1];
-            ImVec2 diff = p1 - p0;
-            diff *= ImInvLength(diff, 1.0f);
-            temp_normals[i0].x = diff.y;
-            temp_normals[i0].y = -diff.x;
+            _IdxWritePtr[0] = (ImDrawIdx)(vtx_inner_idx); _IdxWritePtr[1] = (ImDrawIdx)(vtx_inner_idx+(i0<<1)); _IdxWritePtr[2] = (ImDrawIdx)(vtx_outer_idx+(i0<<1));
+            _IdxWritePtr[3] = (ImDrawIdx)(vtx_outer_idx+(i0<<1)); _IdxWritePtr[4] = (ImDrawIdx)(vtx_outer_idx); _IdxWritePtr[5] = (ImDrawIdx)(vtx_inner_idx);
+            _IdxWritePtr += 6;
+            const int runs = (points_count - 1) / 4;
+            _IdxWritePtr = PrimWriteIdxRuns(_IdxWritePtr, fringe_pattern, 24, vtx_inner_idx, 8, runs);
+            i0 = runs * 4;
+            i1 = i0 + 1;
         }
-
-        for (int i0 = points_count-1, i1 = 0; i1 < points_count; i0 = i1++)
+#endif
+        for (; i1 < points_count; i0 = i1++)
         {
-            // Average normals
-            const ImVec2& n0 = temp_normals[i0];
-            const ImVec2& n1 = temp_normals[i1];
-            ImVec2 dm = (n0 + n1) * 0.5f;
-            float dmr2 = dm.x*dm.x + dm.y*dm.y;
-            if (dmr2 > 0.000001f)
-            {
-                float scale = 1.0f / dmr2;
-                if (scale > 100.0f) scale = 100.0f;
-                dm *= scale;
-            }
-            dm *= AA_SIZE * 0.5f;
-
-            // Add vertices
-            _VtxWritePtr[0].pos = (points[i1] - dm); _VtxWritePtr[0].uv = uv; _VtxWritePtr[0].col = col;        // Inner
-            _VtxWritePtr[1].pos = (points[i1] + dm); _VtxWritePtr[1].uv = uv; _VtxWritePtr[1].col = col_trans;  // Outer
-            _VtxWritePtr += 2;
-
-            // Add indexes for fringes
             _IdxWritePtr[0] = (ImDrawIdx)(vtx_inner_idx+(i1<<1)); _IdxWritePtr[1] = (ImDrawIdx)(vtx_inner_idx+(i0<<1)); _IdxWritePtr[2] = (ImDrawIdx)(vtx_outer_idx+(i0<<1));
             _IdxWritePtr[3] = (ImDrawIdx)(vtx_outer_idx+(i0<<1)); _IdxWritePtr[4] = (ImDrawIdx)(vtx_outer_idx+(i1<<1)); _IdxWritePtr[5] = (ImDrawIdx)(vtx_inner_idx+(i1<<1));
             _IdxWritePtr += 6;
         }
+
+        // Compute normals and their averages
+        ImVec2* temp_normals = (ImVec2*)alloca(points_count * 2 * sizeof(ImVec2));
+        ImVec2* temp_offsets = temp_normals + points_count;
+        PathSegmentNormals(points, points_count, true, temp_normals);
+        PathMiterOffsets(temp_normals, points_count, temp_offsets);
+
+        // Add vertices
+#ifdef IMGUI_TESSELLATE_SSE2
+        const __m128 uv_sse = PathLoadPoint(uv);
+        const __m128 aa_scale = _mm_set1_ps(AA_SIZE * 0.5f);
+        for (int i = 0; i < points_count; i++)
+        {
+            const __m128 p = PathLoadPoint(points[i]);
+            const __m128 dm = _mm_mul_ps(PathLoadPoint(temp_offsets[i]), aa_scale);
+            PrimWriteVtxSSE2(_VtxWritePtr + 0, _mm_sub_ps(p, dm), uv_sse, col);         // Inner
+            PrimWriteVtxSSE2(_VtxWritePtr + 1, _mm_add_ps(p, dm), uv_sse, col_trans);   // Outer
+            _VtxWritePtr += 2;
+        }
+#else
+        for (int i = 0; i < points_count; i++)
+        {
+            const ImVec2 dm = temp_offsets[i] * (AA_SIZE * 0.5f);
+            _VtxWritePtr[0].pos = (points[i] - dm); _VtxWritePtr[0].uv = uv; _VtxWritePtr[0].col = col;        // Inner
+            _VtxWritePtr[1].pos = (points[i] + dm); _VtxWritePtr[1].uv = uv; _VtxWritePtr[1].col = col_trans;  // Outer
+            _VtxWritePtr += 2;
+        }
+#endif
         _VtxCurrentIdx += (ImDrawIdx)vtx_count;
     }
     else
@@ -890,6 +1019,33 @@ void ImDrawList::PathArcToFast(const ImVec2& centre, float radius, int a_min_of_
     }
 }
 
+// Unit circle points of PathArcTo(), computed as it would. AddCircle() and AddCircleFilled() draw the same few arcs over and over, each point
+// costing a cosf() and a sinf() otherwise. Returns NULL for arcs with too many segments to keep.
+static const ImVec2* PathArcTable(const ImDrawListSharedData* data, float a_min, float a_max, int num_segments)
+{
+    const int MAX_SEGMENTS = 512;
+    if (num_segments <= 0 || num_segments > MAX_SEGMENTS)
+        return NULL;
+    for (int n = 0; n < IM_ARRAYSIZE(data->ArcTables); n++)
+    {
+        const ImDrawListArcTable& table = data->ArcTables[n];
+        if (table.Segments == num_segments && table.AMin == a_min && table.AMax == a_max)
+            return table.Points.Data;
+    }
+    ImDrawListArcTable& table = data->ArcTables[data->ArcTablesNext];
+    data->ArcTablesNext = (data->ArcTablesNext + 1) % IM_ARRAYSIZE(data->ArcTables);
+    table.AMin = a_min;
+    table.AMax = a_max;
+    table.Segments = num_segments;
+    table.Points.resize(num_segments + 1);
+    for (int i = 0; i <= num_segments; i++)
+    {
+        const float a = a_min + ((float)i / (float)num_segments) * (a_max - a_min);
+        table.Points[i] = ImVec2(cosf(a), sinf(a));
+    }
+    return table.Points.Data;
+}
+
 void ImDrawList::PathArcTo(const ImVec2& centre, float radius, float a_min, float a_max, int num_segments)
 {
     if (radius == 0.0f)
@@ -897,6 +1053,15 @@ void ImDrawList::PathArcTo(const ImVec2& centre, float radius, float a_min, floa
         _Path.push_back(centre);
         return;
     }
+    if (const ImVec2* unit = PathArcTable(_Data, a_min, a_max, num_segments))
+    {
+        const int path_size = _Path.Size;
+        _Path.resize(path_size + num_segments + 1);
+        ImVec2* out = _Path.Data + path_size;
+        for (int i = 0; i <= num_segments; i++)
+            out[i] = ImVec2(centre.x + unit[i].x * radius, centre.y + unit[i].y * radius);
+        return;
+    }
     _Path.reserve(_Path.Size + (num_segments + 1));
     for (int i = 0; i <= num_segments; i++)
     {
@@ -1379,6 +1544,15 @@ ImFontAtlas::ImFontAtlas()
     TexID = NULL;
     TexDesiredWidth = 0;
     TexGlyphPadding = 1;
+    BuildCacheFilename = NULL;
+    BuildFromCache = false;
+    BuildParallelForFn = NULL;
+    BuildParallelForUserData = NULL;
+    DynamicPageHeight = 128;
+    DynamicPageCount = 8;
+    TextCacheCapacity = 0;
+    TextCacheMaxAge = 60;
+    SdfPadding = 4;
 
     TexPixelsAlpha8 = NULL;
     TexPixelsRGBA32 = NULL;
@@ -1387,6 +1561,8 @@ ImFontAtlas::ImFontAtlas()
     TexUvWhitePixel = ImVec2(0.0f, 0.0f);
     for (int n = 0; n < IM_ARRAYSIZE(CustomRectIds); n++)
         CustomRectIds[n] = -1;
+    DynamicGlyphs = NULL;
+    TextCache = NULL;
 }
 
 ImFontAtlas::~ImFontAtlas()
@@ -1394,8 +1570,12 @@ ImFontAtlas::~ImFontAtlas()
     Clear();
 }
 
+static void ImFontAtlasDynamicGlyphsDestroy(ImFontAtlas* atlas);
+
 void    ImFontAtlas::ClearInputData()
 {
+    // Dynamic glyphs rasterize from the font data
+    ImFontAtlasDynamicGlyphsDestroy(this);
     for (int i = 0; i < ConfigData.Size; i++)
         if (ConfigData[i].FontData && ConfigData[i].FontDataOwnedByAtlas)
         {
@@ -1418,6 +1598,9 @@ void    ImFontAtlas::ClearInputData()
 
 void    ImFontAtlas::ClearTexData()
 {
+    // Built again, glyph advances may change
+    ClearTextCache();
+    ImFontAtlasDynamicGlyphsDestroy(this);
     if (TexPixelsAlpha8)
         ImGui::MemFree(TexPixelsAlpha8);
     if (TexPixelsRGBA32)
@@ -1428,6 +1611,8 @@ void    ImFontAtlas::ClearTexData()
 
 void    ImFontAtlas::ClearFonts()
 {
+    // Entries are keyed by font
+    ClearTextCache();
     for (int i = 0; i < Fonts.Size; i++)
         IM_DELETE(Fonts[i]);
     Fonts.clear();
@@ -1677,9 +1862,362 @@ void    ImFontAtlasBuildMultiplyRectAlpha8(const unsigned char table[256], unsig
             data[i] = table[data[i]];
 }
 
+// Glyphs are rasterized in chunks of consecutive glyphs of one font input, each rendering into its own packed rectangles
+static const int FONT_ATLAS_RASTER_CHUNK_GLYPHS = 64;
+
+// Cache of built atlases: header, build description, custom rectangle positions, per font metrics and glyphs, then the pixels
+static const ImU32 FONT_ATLAS_CACHE_MAGIC = 0x43464D49; // "IMFC"
+static const ImU32 FONT_ATLAS_CACHE_VERSION = 1;
+
+struct ImFontTempBuildData
+{
+    stbtt_fontinfo      FontInfo;
+    stbrp_rect*         Rects;
+    int                 RectsCount;
+    stbtt_pack_range*   Ranges;
+    int                 RangesCount;
+};
+
+struct ImFontAtlasBuildRasterChunk
+{
+    int                 InputIndex;
+    int                 GlyphBegin, GlyphEnd;   // Indices into the input's rectangles, in range order
+};
+
+struct ImFontAtlasBuildRasterJobs
+{
+    ImFontAtlas*                            Atlas;
+    const stbtt_pack_context*               PackContext;
+    ImFontTempBuildData*                    Inputs;
+    ImVector<ImFontAtlasBuildRasterChunk>   Chunks;
+    bool                                    Threaded;
+};
+
+struct ImFontAtlasCacheHeader
+{
+    ImU32               Magic;
+    ImU32               Version;
+    int                 DescSize;               // ImU32 words of build description following the header
+    int                 TexWidth, TexHeight;
+    int                 FontsCount;
+    int                 CustomRectsCount;
+};
+
+struct ImFontAtlasCacheFont
+{
+    float               Ascent, Descent;
+    int                 MetricsTotalSurface;
+    int                 GlyphsCount;            // ImFontGlyph following
+};
+
+// A band of the texture that dynamic glyphs are packed into, in page coordinates: the pack context's pixels point at its first row
+struct ImFontAtlasDynamicPage
+{
+    stbtt_pack_context  PackContext;
+    int                 Y;                      // First texture row
+    int                 LastUsedFrame;          // -1 when empty
+    int                 GlyphsCount;
+    int                 PixelsUsed;
+    int                 DirtyY0, DirtyY1;       // Texture rows written since they were last taken, none when DirtyY0 >= DirtyY1
+};
+
+struct ImFontAtlasDynamicGlyphs
+{
+    ImVector<stbtt_fontinfo>            FontInfos;  // One per input, kept for rasterizing
+    ImVector<ImFontAtlasDynamicPage>    Pages;
+    int                                 Frame;
+    ImFontAtlasDynamicGlyphsStats       Stats;
+};
+
+static bool ImFontAtlasBuildDynamicGlyphs(ImFontAtlas* atlas);
+
+// ImFontAtlasFlags_SignedDistanceField: value of the field on the outline, the renderer thresholds at 0.5
+static const unsigned char FONT_ATLAS_SDF_ONEDGE = 128;
+
+// Same as stbtt_PackFontRangesGatherRects(), sized for the fields stbtt_GetGlyphSDF() renders: not oversampled, sdf_padding pixels around the glyph box
+static int ImFontAtlasBuildGatherSdfRects(const stbtt_fontinfo* info, int sdf_padding, int pack_padding, stbtt_pack_range* ranges, int ranges_count, stbrp_rect* rects)
+{
+    int k = 0;
+    for (int i = 0; i < ranges_count; i++)
+    {
+        const float scale = stbtt_ScaleForPixelHeight(info, ranges[i].font_size);
+        ranges[i].h_oversample = ranges[i].v_oversample = 1;
+        for (int j = 0; j < ranges[i].num_chars; j++, k++)
+        {
+            const int glyph = stbtt_FindGlyphIndex(info, ranges[i].first_unicode_codepoint_in_range + j);
+            int x0, y0, x1, y1;
+            stbtt_GetGlyphBitmapBoxSubpixel(info, glyph, scale, scale, 0.0f, 0.0f, &x0, &y0, &x1, &y1);
+            const bool empty = (x0 == x1 || y0 == y1); // No field, only the advance
+            rects[k].w = (stbrp_coord)(empty ? pack_padding : x1 - x0 + sdf_padding * 2 + pack_padding);
+            rects[k].h = (stbrp_coord)(empty ? pack_padding : y1 - y0 + sdf_padding * 2 + pack_padding);
+        }
+    }
+    return k;
+}
+
+// Same as stbtt_PackFontRangesRenderIntoRects() for one range, writing the signed distance field of each glyph and the stbtt_packedchar describing it
+static void ImFontAtlasBuildRenderSdfRects(const stbtt_pack_context* spc, const stbtt_fontinfo* info, int sdf_padding, const stbtt_pack_range& range, const stbrp_rect* rects)
+{
+    const float scale = stbtt_ScaleForPixelHeight(info, range.font_size);
+    const float pixel_dist_scale = (float)FONT_ATLAS_SDF_ONEDGE / sdf_padding;
+    for (int j = 0; j < range.num_chars; j++)
+    {
+        const stbrp_rect& r = rects[j];
+        if (!r.was_packed)
+            continue;
+        const int glyph = stbtt_FindGlyphIndex(info, range.first_unicode_codepoint_in_range + j);
+        int advance, lsb;
+        stbtt_GetGlyphHMetrics(info, glyph, &advance, &lsb);
+
+        int w = 0, h = 0, xoff = 0, yoff = 0;
+        unsigned char* field = stbtt_GetGlyphSDF(info, scale, glyph, sdf_padding, FONT_ATLAS_SDF_ONEDGE, pixel_dist_scale, &w, &h, &xoff, &yoff);
+        if (field)
+        {
+            IM_ASSERT(w <= r.w && h <= r.h);
+            unsigned char* dst = spc->pixels + r.x + r.y * spc->stride_in_bytes;
+            for (int y = 0; y < h; y++, dst += spc->stride_in_bytes)
+                memcpy(dst, field + y * w, (size_t)w);
+            stbtt_FreeSDF(field, info->userdata);
+        }
+
+        stbtt_packedchar& pc = range.chardata_for_range[j];
+        pc.x0 = (unsigned short)r.x;
+        pc.y0 = (unsigned short)r.y;
+        pc.x1 = (unsigned short)(r.x + w);
+        pc.y1 = (unsigned short)(r.y + h);
+        pc.xoff = (float)xoff;
+        pc.yoff = (float)yoff;
+        pc.xoff2 = (float)(xoff + w);
+        pc.yoff2 = (float)(yoff + h);
+        pc.xadvance = scale * advance;
+    }
+}
+
+static void ImFontAtlasBuildRasterizeChunk(int chunk_index, void* job_data)
+{
+    ImFontAtlasBuildRasterJobs* jobs = (ImFontAtlasBuildRasterJobs*)job_data;
+    const ImFontAtlasBuildRasterChunk& chunk = jobs->Chunks[chunk_index];
+    const ImFontConfig& cfg = jobs->Atlas->ConfigData[chunk.InputIndex];
+    ImFontTempBuildData& tmp = jobs->Inputs[chunk.InputIndex];
+
+    // Own copies of the packing context, whose oversampling stb_truetype changes while rendering, and of the font info, whose userdata picks the allocator
+    stbtt_pack_context spc = *jobs->PackContext;
+    stbtt_fontinfo font_info = tmp.FontInfo;
+    font_info.userdata = jobs->Threaded ? jobs : NULL;
+    stbtt_PackSetOversampling(&spc, cfg.OversampleH, cfg.OversampleV);
+    const bool sdf = (jobs->Atlas->Flags & ImFontAtlasFlags_SignedDistanceField) != 0;
+
+    // Render the ranges overlapping the chunk, cut down to it
+    int range_begin = 0;
+    for (int i = 0; i < tmp.RangesCount && range_begin < chunk.GlyphEnd; i++)
+    {
+        const int range_end = range_begin + tmp.Ranges[i].num_chars;
+        const int begin = ImMax(range_begin, chunk.GlyphBegin);
+        const int end = ImMin(range_end, chunk.GlyphEnd);
+        if (begin < end)
+        {
+            stbtt_pack_range range = tmp.Ranges[i];
+            range.first_unicode_codepoint_in_range += begin - range_begin;
+            range.num_chars = end - begin;
+            range.chardata_for_range += begin - range_begin;
+            if (sdf)
+                ImFontAtlasBuildRenderSdfRects(&spc, &font_info, jobs->Atlas->SdfPadding, range, tmp.Rects + begin);
+            else
+                stbtt_PackFontRangesRenderIntoRects(&spc, &font_info, &range, 1, tmp.Rects + begin);
+        }
+        range_begin = range_end;
+    }
+
+    if (cfg.RasterizerMultiply != 1.0f && !sdf)
+    {
+        unsigned char multiply_table[256];
+        ImFontAtlasBuildMultiplyCalcLookupTable(multiply_table, cfg.RasterizerMultiply);
+        for (const stbrp_rect* r = tmp.Rects + chunk.GlyphBegin; r != tmp.Rects + chunk.GlyphEnd; r++)
+            if (r->was_packed)
+                ImFontAtlasBuildMultiplyRectAlpha8(multiply_table, spc.pixels, r->x, r->y, r->w, r->h, spc.stride_in_bytes);
+    }
+}
+
+static int ImFontAtlasBuildFontIndex(const ImFontAtlas* atlas, const ImFont* font)
+{
+    for (int font_i = 0; font_i < atlas->Fonts.Size; font_i++)
+        if (atlas->Fonts[font_i] == font)
+            return font_i;
+    return -1;
+}
+
+static void ImFontAtlasBuildCacheDescPushFloat(ImVector<ImU32>& desc, float v)
+{
+    ImU32 bits;
+    memcpy(&bits, &v, sizeof(bits));
+    desc.push_back(bits);
+}
+
+// Everything the built atlas depends on, with the font data reduced to its size and hash
+static void ImFontAtlasBuildCacheDesc(const ImFontAtlas* atlas, ImVector<ImU32>& desc)
+{
+    desc.resize(0);
+    desc.push_back((ImU32)sizeof(ImFontGlyph));
+    desc.push_back((ImU32)atlas->Flags);
+    desc.push_back((ImU32)atlas->TexDesiredWidth);
+    desc.push_back((ImU32)atlas->TexGlyphPadding);
+    desc.push_back((ImU32)atlas->SdfPadding);
+    for (int input_i = 0; input_i < atlas->ConfigData.Size; input_i++)
+    {
+        const ImFontConfig& cfg = atlas->ConfigData[input_i];
+        desc.push_back((ImU32)cfg.FontDataSize);
+        desc.push_back(ImHash(cfg.FontData, cfg.FontDataSize));
+        desc.push_back((ImU32)cfg.FontNo);
+        ImFontAtlasBuildCacheDescPushFloat(desc, cfg.SizePixels);
+        desc.push_back((ImU32)cfg.OversampleH);
+        desc.push_back((ImU32)cfg.OversampleV);
+        desc.push_back(cfg.PixelSnapH ? 1 : 0);
+        ImFontAtlasBuildCacheDescPushFloat(desc, cfg.GlyphExtraSpacing.x);
+        ImFontAtlasBuildCacheDescPushFloat(desc, cfg.GlyphExtraSpacing.y);
+        ImFontAtlasBuildCacheDescPushFloat(desc, cfg.GlyphOffset.x);
+        ImFontAtlasBuildCacheDescPushFloat(desc, cfg.GlyphOffset.y);
+        desc.push_back(cfg.MergeMode ? 1 : 0);
+        ImFontAtlasBuildCacheDescPushFloat(desc, cfg.RasterizerMultiply);
+        desc.push_back((ImU32)ImFontAtlasBuildFontIndex(atlas, cfg.DstFont));
+        for (const ImWchar* in_range = cfg.GlyphRanges; in_range[0] && in_range[1]; in_range += 2)
+            desc.push_back((ImU32)in_range[0] | ((ImU32)in_range[1] << 16));
+        desc.push_back(0);
+    }
+    for (int i = 0; i < atlas->CustomRects.Size; i++)
+    {
+        const ImFontAtlas::CustomRect& r = atlas->CustomRects[i];
+        desc.push_back(r.ID);
+        desc.push_back((ImU32)r.Width | ((ImU32)r.Height << 16));
+        ImFontAtlasBuildCacheDescPushFloat(desc, r.GlyphAdvanceX);
+        ImFontAtlasBuildCacheDescPushFloat(desc, r.GlyphOffset.x);
+        ImFontAtlasBuildCacheDescPushFloat(desc, r.GlyphOffset.y);
+        desc.push_back((ImU32)ImFontAtlasBuildFontIndex(atlas, r.Font));
+    }
+}
+
+// Restores the output of the build from the cache if it was written for the same description, in a single read
+static bool ImFontAtlasBuildLoadCache(ImFontAtlas* atlas, const ImVector<ImU32>& desc)
+{
+    int file_size = 0;
+    unsigned char* file_data = (unsigned char*)ImFileLoadToMemory(atlas->BuildCacheFilename, "rb", &file_size);
+    if (!file_data)
+        return false;
+
+    // Validate the whole file before touching the atlas
+    ImFontAtlasCacheHeader header;
+    memset(&header, 0, sizeof(header));
+    size_t offset = sizeof(header);
+    bool valid = (size_t)file_size >= offset;
+    if (valid)
+    {
+        memcpy(&header, file_data, sizeof(header));
+        valid = header.Magic == FONT_ATLAS_CACHE_MAGIC && header.Version == FONT_ATLAS_CACHE_VERSION && header.DescSize == desc.Size
+            && header.FontsCount == atlas->Fonts.Size && header.CustomRectsCount == atlas->CustomRects.Size && header.TexWidth > 0 && header.TexHeight > 0;
+    }
+    const size_t desc_offset = offset;
+    offset += (size_t)desc.Size * sizeof(ImU32);
+    valid = valid && (size_t)file_size >= offset && memcmp(file_data + desc_offset, desc.Data, (size_t)desc.Size * sizeof(ImU32)) == 0;
+    const size_t rects_offset = offset;
+    offset += (size_t)header.CustomRectsCount * 2 * sizeof(unsigned short);
+    const size_t fonts_offset = offset;
+    for (int font_i = 0; valid && font_i < header.FontsCount; font_i++)
+    {
+        ImFontAtlasCacheFont font;
+        valid = (size_t)file_size >= offset + sizeof(font);
+        if (!valid)
+            break;
+        memcpy(&font, file_data + offset, sizeof(font));
+        valid = font.GlyphsCount >= 0;
+        offset += sizeof(font) + (size_t)font.GlyphsCount * sizeof(ImFontGlyph);
+    }
+    valid = valid && (size_t)file_size == offset + (size_t)header.TexWidth * header.TexHeight;
+    if (!valid)
+    {
+        ImGui::MemFree(file_data);
+        return false;
+    }
+
+    atlas->TexWidth = header.TexWidth;
+    atlas->TexHeight = header.TexHeight;
+    atlas->TexUvScale = ImVec2(1.0f / atlas->TexWidth, 1.0f / atlas->TexHeight);
+    atlas->TexPixelsAlpha8 = (unsigned char*)ImGui::MemAlloc(atlas->TexWidth * atlas->TexHeight);
+    memcpy(atlas->TexPixelsAlpha8, file_data + offset, (size_t)atlas->TexWidth * atlas->TexHeight);
+
+    for (int i = 0; i < atlas->CustomRects.Size; i++)
+    {
+        unsigned short xy[2];
+        memcpy(xy, file_data + rects_offset + i * sizeof(xy), sizeof(xy));
+        atlas->CustomRects[i].X = xy[0];
+        atlas->CustomRects[i].Y = xy[1];
+    }
+
+    for (int input_i = 0; input_i < atlas->ConfigData.Size; input_i++)
+        ImFontAtlasBuildSetupFont(atlas, atlas->ConfigData[input_i].DstFont, &atlas->ConfigData[input_i], 0.0f, 0.0f);
+    offset = fonts_offset;
+    for (int font_i = 0; font_i < atlas->Fonts.Size; font_i++)
+    {
+        ImFont* dst_font = atlas->Fonts[font_i];
+        ImFontAtlasCacheFont font;
+        memcpy(&font, file_data + offset, sizeof(font));
+        offset += sizeof(font);
+        dst_font->Ascent = font.Ascent;
+        dst_font->Descent = font.Descent;
+        dst_font->MetricsTotalSurface = font.MetricsTotalSurface;
+        dst_font->Glyphs.resize(font.GlyphsCount);
+        if (font.GlyphsCount > 0)
+            memcpy(dst_font->Glyphs.Data, file_data + offset, (size_t)font.GlyphsCount * sizeof(ImFontGlyph));
+        offset += (size_t)font.GlyphsCount * sizeof(ImFontGlyph);
+        dst_font->DirtyLookupTables = true;
+    }
+
+    ImGui::MemFree(file_data);
+    return true;
+}
+
+static void ImFontAtlasBuildSaveCache(const ImFontAtlas* atlas, const ImVector<ImU32>& desc)
+{
+    FILE* f = ImFileOpen(atlas->BuildCacheFilename, "wb");
+    if (!f)
+        return;
+
+    ImFontAtlasCacheHeader header;
+    header.Magic = FONT_ATLAS_CACHE_MAGIC;
+    header.Version = FONT_ATLAS_CACHE_VERSION;
+    header.DescSize = desc.Size;
+    header.TexWidth = atlas->TexWidth;
+    header.TexHeight = atlas->TexHeight;
+    header.FontsCount = atlas->Fonts.Size;
+    header.CustomRectsCount = atlas->CustomRects.Size;
+    bool written = fwrite(&header, sizeof(header), 1, f) == 1;
+    written &= fwrite(desc.Data, sizeof(ImU32), (size_t)desc.Size, f) == (size_t)desc.Size;
+    for (int i = 0; i < atlas->CustomRects.Size; i++)
+    {
+        const unsigned short xy[2] = { atlas->CustomRects[i].X, atlas->CustomRects[i].Y };
+        written &= fwrite(xy, sizeof(xy), 1, f) == 1;
+    }
+    for (int font_i = 0; font_i < atlas->Fonts.Size; font_i++)
+    {
+        const ImFont* src_font = atlas->Fonts[font_i];
+        ImFontAtlasCacheFont font;
+        font.Ascent = src_font->Ascent;
+        font.Descent = src_font->Descent;
+        font.MetricsTotalSurface = src_font->MetricsTotalSurface;
+        font.GlyphsCount = src_font->Glyphs.Size;
+        written &= fwrite(&font, sizeof(font), 1, f) == 1;
+        written &= fwrite(src_font->Glyphs.Data, sizeof(ImFontGlyph), (size_t)font.GlyphsCount, f) == (size_t)font.GlyphsCount;
+    }
+    written &= fwrite(atlas->TexPixelsAlpha8, 1, (size_t)atlas->TexWidth * atlas->TexHeight, f) == (size_t)atlas->TexWidth * atlas->TexHeight;
+    fclose(f);
+
+    // A partial cache would only be rejected on load, don't leave it behind
+    if (!written)
+        remove(atlas->BuildCacheFilename);
+}
+
 bool    ImFontAtlasBuildWithStbTruetype(ImFontAtlas* atlas)
 {
     IM_ASSERT(atlas->ConfigData.Size > 0);
+    IM_ASSERT(!(atlas->Flags & ImFontAtlasFlags_SignedDistanceField) || (!(atlas->Flags & ImFontAtlasFlags_DynamicGlyphs) && atlas->SdfPadding > 0));
 
     ImFontAtlasBuildRegisterDefaultCustomRects(atlas);
 
@@ -1701,6 +2239,24 @@ bool    ImFontAtlasBuildWithStbTruetype(ImFontAtlas* atlas)
             total_glyphs_count += (in_range[1] - in_range[0]) + 1;
     }
 
+    // Lay out glyphs without rasterizing them, nothing worth caching
+    atlas->BuildFromCache = false;
+    if (atlas->Flags & ImFontAtlasFlags_DynamicGlyphs)
+        return ImFontAtlasBuildDynamicGlyphs(atlas);
+
+    // Load the whole output from the cache when it was built from the same fonts and settings
+    ImVector<ImU32> cache_desc;
+    if (atlas->BuildCacheFilename)
+    {
+        ImFontAtlasBuildCacheDesc(atlas, cache_desc);
+        if (ImFontAtlasBuildLoadCache(atlas, cache_desc))
+        {
+            atlas->BuildFromCache = true;
+            ImFontAtlasBuildFinish(atlas);
+            return true;
+        }
+    }
+
     // We need a width for the skyline algorithm. Using a dumb heuristic here to decide of width. User can override TexDesiredWidth and TexGlyphPadding if they wish.
     // Width doesn't really matter much, but some API/GPU have texture size limitations and increasing width can decrease height.
     atlas->TexWidth = (atlas->TexDesiredWidth > 0) ? atlas->TexDesiredWidth : (total_glyphs_count > 4000) ? 4096 : (total_glyphs_count > 2000) ? 2048 : (total_glyphs_count > 1000) ? 1024 : 512;
@@ -1717,14 +2273,6 @@ bool    ImFontAtlasBuildWithStbTruetype(ImFontAtlas* atlas)
     ImFontAtlasBuildPackCustomRects(atlas, spc.pack_info);
 
     // Initialize font information (so we can error without any cleanup)
-    struct ImFontTempBuildData
-    {
-        stbtt_fontinfo      FontInfo;
-        stbrp_rect*         Rects;
-        int                 RectsCount;
-        stbtt_pack_range*   Ranges;
-        int                 RangesCount;
-    };
     ImFontTempBuildData* tmp_array = (ImFontTempBuildData*)ImGui::MemAlloc((size_t)atlas->ConfigData.Size * sizeof(ImFontTempBuildData));
     for (int input_i = 0; input_i < atlas->ConfigData.Size; input_i++)
     {
@@ -1740,6 +2288,7 @@ bool    ImFontAtlasBuildWithStbTruetype(ImFontAtlas* atlas)
             ImGui::MemFree(tmp_array);
             return false;
         }
+        tmp.FontInfo.userdata = NULL;
     }
 
     // Allocate packing character data and flag packed characters buffer as non-packed (x0=y0=x1=y1=0)
@@ -1781,7 +2330,9 @@ bool    ImFontAtlasBuildWithStbTruetype(ImFontAtlas* atlas)
         tmp.RectsCount = font_glyphs_count;
         buf_rects_n += font_glyphs_count;
         stbtt_PackSetOversampling(&spc, cfg.OversampleH, cfg.OversampleV);
-        int n = stbtt_PackFontRangesGatherRects(&spc, &tmp.FontInfo, tmp.Ranges, tmp.RangesCount, tmp.Rects);
+        int n = (atlas->Flags & ImFontAtlasFlags_SignedDistanceField)
+            ? ImFontAtlasBuildGatherSdfRects(&tmp.FontInfo, atlas->SdfPadding, atlas->TexGlyphPadding, tmp.Ranges, tmp.RangesCount, tmp.Rects)
+            : stbtt_PackFontRangesGatherRects(&spc, &tmp.FontInfo, tmp.Ranges, tmp.RangesCount, tmp.Rects);
         IM_ASSERT(n == font_glyphs_count);
         stbrp_pack_rects((stbrp_context*)spc.pack_info, tmp.Rects, n);
 
@@ -1802,23 +2353,28 @@ bool    ImFontAtlasBuildWithStbTruetype(ImFontAtlas* atlas)
     spc.pixels = atlas->TexPixelsAlpha8;
     spc.height = atlas->TexHeight;
 
-    // Second pass: render font characters
+    // Second pass: render font characters, in chunks that may run in parallel as they write to disjoint rectangles
+    ImFontAtlasBuildRasterJobs raster_jobs;
+    raster_jobs.Atlas = atlas;
+    raster_jobs.PackContext = &spc;
+    raster_jobs.Inputs = tmp_array;
     for (int input_i = 0; input_i < atlas->ConfigData.Size; input_i++)
-    {
-        ImFontConfig& cfg = atlas->ConfigData[input_i];
-        ImFontTempBuildData& tmp = tmp_array[input_i];
-        stbtt_PackSetOversampling(&spc, cfg.OversampleH, cfg.OversampleV);
-        stbtt_PackFontRangesRenderIntoRects(&spc, &tmp.FontInfo, tmp.Ranges, tmp.RangesCount, tmp.Rects);
-        if (cfg.RasterizerMultiply != 1.0f)
+        for (int glyph_begin = 0; glyph_begin < tmp_array[input_i].RectsCount; glyph_begin += FONT_ATLAS_RASTER_CHUNK_GLYPHS)
         {
-            unsigned char multiply_table[256];
-            ImFontAtlasBuildMultiplyCalcLookupTable(multiply_table, cfg.RasterizerMultiply);
-            for (const stbrp_rect* r = tmp.Rects; r != tmp.Rects + tmp.RectsCount; r++)
-                if (r->was_packed)
-                    ImFontAtlasBuildMultiplyRectAlpha8(multiply_table, spc.pixels, r->x, r->y, r->w, r->h, spc.stride_in_bytes);
+            ImFontAtlasBuildRasterChunk chunk;
+            chunk.InputIndex = input_i;
+            chunk.GlyphBegin = glyph_begin;
+            chunk.GlyphEnd = ImMin(glyph_begin + FONT_ATLAS_RASTER_CHUNK_GLYPHS, tmp_array[input_i].RectsCount);
+            raster_jobs.Chunks.push_back(chunk);
         }
-        tmp.Rects = NULL;
-    }
+    raster_jobs.Threaded = atlas->BuildParallelForFn != NULL && raster_jobs.Chunks.Size > 1;
+    if (raster_jobs.Threaded)
+        atlas->BuildParallelForFn(raster_jobs.Chunks.Size, ImFontAtlasBuildRasterizeChunk, &raster_jobs, atlas->BuildParallelForUserData);
+    else
+        for (int chunk_i = 0; chunk_i < raster_jobs.Chunks.Size; chunk_i++)
+            ImFontAtlasBuildRasterizeChunk(chunk_i, &raster_jobs);
+    for (int input_i = 0; input_i < atlas->ConfigData.Size; input_i++)
+        tmp_array[input_i].Rects = NULL;
 
     // End packing
     stbtt_PackEnd(&spc);
@@ -1870,6 +2426,10 @@ bool    ImFontAtlasBuildWithStbTruetype(ImFontAtlas* atlas)
     ImGui::MemFree(buf_ranges);
     ImGui::MemFree(tmp_array);
 
+    // Cached before the custom rectangles are rendered and registered, which loading does again
+    if (atlas->BuildCacheFilename)
+        ImFontAtlasBuildSaveCache(atlas, cache_desc);
+
     ImFontAtlasBuildFinish(atlas);
 
     return true;
@@ -1980,6 +2540,519 @@ void ImFontAtlasBuildFinish(ImFontAtlas* atlas)
             atlas->Fonts[i]->BuildLookupTable();
 }
 
+//-----------------------------------------------------------------------------
+// ImFontAtlas dynamic glyphs
+//-----------------------------------------------------------------------------
+
+// stbtt__oversample_shift(): phase shift of the box filter applied to oversampled glyphs
+static float ImFontAtlasBuildOversampleShift(int oversample)
+{
+    return oversample ? (float)-(oversample - 1) / (2.0f * (float)oversample) : 0.0f;
+}
+
+static bool ImFontAtlasBuildDynamicGlyphs(ImFontAtlas* atlas)
+{
+    IM_ASSERT(atlas->DynamicPageHeight > atlas->TexGlyphPadding && atlas->DynamicPageCount > 0);
+
+    // Custom rectangles are packed in the upper-left corner as usual, the pages start below them
+    atlas->TexWidth = (atlas->TexDesiredWidth > 0) ? atlas->TexDesiredWidth : 1024;
+    atlas->TexHeight = 0;
+    stbtt_pack_context spc = {};
+    if (!stbtt_PackBegin(&spc, NULL, atlas->TexWidth, 1024*32, 0, atlas->TexGlyphPadding, NULL))
+        return false;
+    ImFontAtlasBuildPackCustomRects(atlas, spc.pack_info);
+    stbtt_PackEnd(&spc);
+    const int pages_y = atlas->TexHeight + atlas->TexGlyphPadding;
+
+    // Create texture
+    atlas->TexHeight = pages_y + atlas->DynamicPageCount * atlas->DynamicPageHeight;
+    if (!(atlas->Flags & ImFontAtlasFlags_NoPowerOfTwoHeight))
+        atlas->TexHeight = ImUpperPowerOfTwo(atlas->TexHeight);
+    atlas->TexUvScale = ImVec2(1.0f / atlas->TexWidth, 1.0f / atlas->TexHeight);
+    atlas->TexPixelsAlpha8 = (unsigned char*)ImGui::MemAlloc(atlas->TexWidth * atlas->TexHeight);
+    memset(atlas->TexPixelsAlpha8, 0, atlas->TexWidth * atlas->TexHeight);
+
+    ImFontAtlasDynamicGlyphs* dynamic = IM_NEW(ImFontAtlasDynamicGlyphs);
+    dynamic->Frame = 0;
+    memset(&dynamic->Stats, 0, sizeof(dynamic->Stats));
+    atlas->DynamicGlyphs = dynamic;
+
+    // Fonts stay open for as long as the atlas rasterizes from them
+    dynamic->FontInfos.resize(atlas->ConfigData.Size);
+    for (int input_i = 0; input_i < atlas->ConfigData.Size; input_i++)
+    {
+        ImFontConfig& cfg = atlas->ConfigData[input_i];
+        IM_ASSERT(cfg.DstFont && (!cfg.DstFont->IsLoaded() || cfg.DstFont->ContainerAtlas == atlas));
+        const int font_offset = stbtt_GetFontOffsetForIndex((unsigned char*)cfg.FontData, cfg.FontNo);
+        IM_ASSERT(font_offset >= 0);
+        if (!stbtt_InitFont(&dynamic->FontInfos[input_i], (unsigned char*)cfg.FontData, font_offset))
+        {
+            atlas->ClearTexData();
+            atlas->TexWidth = atlas->TexHeight = 0; // Reset output on failure
+            return false;
+        }
+        dynamic->FontInfos[input_i].userdata = NULL;
+    }
+
+    // Pages, each packing in its own coordinates
+    dynamic->Pages.resize((atlas->TexHeight - pages_y) / atlas->DynamicPageHeight);
+    for (int page_i = 0; page_i < dynamic->Pages.Size; page_i++)
+    {
+        ImFontAtlasDynamicPage& page = dynamic->Pages[page_i];
+        page.Y = pages_y + page_i * atlas->DynamicPageHeight;
+        if (!stbtt_PackBegin(&page.PackContext, atlas->TexPixelsAlpha8 + page.Y * atlas->TexWidth, atlas->TexWidth, atlas->DynamicPageHeight, atlas->TexWidth, atlas->TexGlyphPadding, NULL))
+        {
+            dynamic->Pages.resize(page_i);
+            break;
+        }
+        page.LastUsedFrame = -1;
+        page.GlyphsCount = page.PixelsUsed = 0;
+        page.DirtyY0 = page.DirtyY1 = 0;
+    }
+    dynamic->Stats.PagesCount = dynamic->Pages.Size;
+    dynamic->Stats.PixelsTotal = dynamic->Pages.Size * atlas->TexWidth * atlas->DynamicPageHeight;
+
+    // Lay out every glyph of the ranges where stbtt_PackFontRangesRenderIntoRects() would, texture coordinates come with its pixels
+    const ImFontGlyphPage never_rasterized = { -1, -1 };
+    for (int input_i = 0; input_i < atlas->ConfigData.Size; input_i++)
+    {
+        ImFontConfig& cfg = atlas->ConfigData[input_i];
+        const stbtt_fontinfo& font_info = dynamic->FontInfos[input_i];
+        ImFont* dst_font = cfg.DstFont; // We can have multiple input fonts writing into a same destination font (when using MergeMode=true)
+        if (cfg.MergeMode)
+            dst_font->BuildLookupTable();
+
+        const float font_scale = stbtt_ScaleForPixelHeight(&font_info, cfg.SizePixels);
+        int unscaled_ascent, unscaled_descent, unscaled_line_gap;
+        stbtt_GetFontVMetrics(&font_info, &unscaled_ascent, &unscaled_descent, &unscaled_line_gap);
+
+        const float ascent = ImFloor(unscaled_ascent * font_scale + ((unscaled_ascent > 0.0f) ? +1 : -1));
+        const float descent = ImFloor(unscaled_descent * font_scale + ((unscaled_descent > 0.0f) ? +1 : -1));
+        ImFontAtlasBuildSetupFont(atlas, dst_font, &cfg, ascent, descent);
+        const float off_x = cfg.GlyphOffset.x;
+        const float off_y = cfg.GlyphOffset.y + (float)(int)(dst_font->Ascent + 0.5f);
+
+        const float recip_h = 1.0f / cfg.OversampleH;
+        const float recip_v = 1.0f / cfg.OversampleV;
+        const float sub_x = ImFontAtlasBuildOversampleShift(cfg.OversampleH);
+        const float sub_y = ImFontAtlasBuildOversampleShift(cfg.OversampleV);
+        for (const ImWchar* in_range = cfg.GlyphRanges; in_range[0] && in_range[1]; in_range += 2)
+            for (int codepoint = in_range[0]; codepoint <= in_range[1]; codepoint++)
+            {
+                if (cfg.MergeMode && dst_font->FindGlyphNoFallback((unsigned short)codepoint))
+                    continue;
+
+                int advance, lsb, x0, y0, x1, y1;
+                const int glyph_index = stbtt_FindGlyphIndex(&font_info, codepoint);
+                stbtt_GetGlyphHMetrics(&font_info, glyph_index, &advance, &lsb);
+                stbtt_GetGlyphBitmapBox(&font_info, glyph_index, font_scale * cfg.OversampleH, font_scale * cfg.OversampleV, &x0, &y0, &x1, &y1);
+                const int w = x1 - x0 + cfg.OversampleH - 1;
+                const int h = y1 - y0 + cfg.OversampleV - 1;
+                dst_font->AddGlyph((ImWchar)codepoint,
+                    (float)x0 * recip_h + sub_x + off_x, (float)y0 * recip_v + sub_y + off_y,
+                    (x0 + w) * recip_h + sub_x + off_x, (y0 + h) * recip_v + sub_y + off_y,
+                    0.0f, 0.0f, 0.0f, 0.0f, font_scale * advance);
+
+                // BuildLookupTable() may have appended a TAB glyph since the last one
+                ImFontGlyphPage glyph_page;
+                glyph_page.Page = -1;
+                glyph_page.ConfigIndex = (short)input_i;
+                dst_font->GlyphPages.resize(dst_font->Glyphs.Size - 1, never_rasterized);
+                dst_font->GlyphPages.push_back(glyph_page);
+                dynamic->Stats.GlyphsTotal++;
+            }
+    }
+
+    ImFontAtlasBuildFinish(atlas);
+    return true;
+}
+
+static void ImFontAtlasDynamicGlyphsDestroy(ImFontAtlas* atlas)
+{
+    ImFontAtlasDynamicGlyphs* dynamic = atlas->DynamicGlyphs;
+    if (!dynamic)
+        return;
+
+    // Fonts outliving the pages draw their glyphs blank rather than from stale texture coordinates
+    for (int font_i = 0; font_i < atlas->Fonts.Size; font_i++)
+    {
+        ImVector<ImFontGlyphPage>& glyph_pages = atlas->Fonts[font_i]->GlyphPages;
+        for (int i = 0; i < glyph_pages.Size; i++)
+            glyph_pages[i].Page = -1;
+    }
+    for (int page_i = 0; page_i < dynamic->Pages.Size; page_i++)
+        stbtt_PackEnd(&dynamic->Pages[page_i].PackContext);
+    IM_DELETE(atlas->DynamicGlyphs);
+}
+
+static void ImFontAtlasDynamicGlyphsEvictPage(ImFontAtlas* atlas, int page_i)
+{
+    ImFontAtlasDynamicGlyphs* dynamic = atlas->DynamicGlyphs;
+    ImFontAtlasDynamicPage& page = dynamic->Pages[page_i];
+    for (int font_i = 0; font_i < atlas->Fonts.Size; font_i++)
+    {
+        ImVector<ImFontGlyphPage>& glyph_pages = atlas->Fonts[font_i]->GlyphPages;
+        for (int i = 0; i < glyph_pages.Size; i++)
+            if (glyph_pages[i].Page == page_i)
+                glyph_pages[i].Page = -1;
+    }
+    dynamic->Stats.GlyphsEvicted += page.GlyphsCount;
+    dynamic->Stats.GlyphsResident -= page.GlyphsCount;
+    dynamic->Stats.PixelsUsed -= page.PixelsUsed;
+    dynamic->Stats.PagesUsed--;
+    dynamic->Stats.PagesEvicted++;
+    page.GlyphsCount = page.PixelsUsed = 0;
+    page.LastUsedFrame = -1;
+
+    // Pack from an empty page again, the pixels left behind are cleared glyph by glyph as they are overwritten
+    stbtt_pack_context& spc = page.PackContext;
+    stbrp_init_target((stbrp_context*)spc.pack_info, spc.width - spc.padding, spc.height - spc.padding, (stbrp_node*)spc.nodes, spc.width - spc.padding);
+}
+
+static bool ImFontAtlasDynamicGlyphsPackRect(ImFontAtlasDynamicPage& page, stbrp_rect* rect)
+{
+    stbrp_pack_rects((stbrp_context*)page.PackContext.pack_info, rect, 1);
+    return rect->was_packed != 0;
+}
+
+// Stands in for a glyph without pixels: same advance, empty quad
+static const ImFontGlyph* ImFontAtlasDynamicGlyphsBlank(const ImFontGlyph* glyph)
+{
+    static ImFontGlyph blank_glyph;
+    blank_glyph = *glyph;
+    blank_glyph.X1 = blank_glyph.X0;
+    blank_glyph.Y1 = blank_glyph.Y0;
+    return &blank_glyph;
+}
+
+// Returns 'glyph' of 'font' once its pixels are in a page, rasterizing it on a miss
+static const ImFontGlyph* ImFontAtlasDynamicGlyphsFind(ImFont* font, ImFontGlyph* glyph)
+{
+    const int glyph_i = (int)(glyph - font->Glyphs.Data);
+    if (glyph_i >= font->GlyphPages.Size || font->GlyphPages[glyph_i].ConfigIndex < 0)
+        return glyph;
+    ImFontGlyphPage& glyph_page = font->GlyphPages[glyph_i];
+    ImFontAtlas* atlas = font->ContainerAtlas;
+    ImFontAtlasDynamicGlyphs* dynamic = atlas->DynamicGlyphs;
+    if (glyph_page.Page >= 0)
+    {
+        dynamic->Pages[glyph_page.Page].LastUsedFrame = dynamic->Frame;
+        return glyph;
+    }
+    if (!dynamic)
+        return ImFontAtlasDynamicGlyphsBlank(glyph);
+    dynamic->Stats.GlyphMisses++;
+    dynamic->Stats.GlyphMissesFrame++;
+
+    // Size its rectangle like Build() does
+    const ImFontConfig& cfg = atlas->ConfigData[glyph_page.ConfigIndex];
+    const stbtt_fontinfo& font_info = dynamic->FontInfos[glyph_page.ConfigIndex];
+    stbtt_packedchar packed_char;
+    stbtt_pack_range range;
+    memset(&range, 0, sizeof(range));
+    range.font_size = cfg.SizePixels;
+    range.first_unicode_codepoint_in_range = glyph->Codepoint;
+    range.num_chars = 1;
+    range.chardata_for_range = &packed_char;
+    stbrp_rect rect;
+    memset(&rect, 0, sizeof(rect));
+    stbtt_pack_context spc = dynamic->Pages[0].PackContext;
+    stbtt_PackSetOversampling(&spc, cfg.OversampleH, cfg.OversampleV);
+    stbtt_PackFontRangesGatherRects(&spc, &font_info, &range, 1, &rect);
+
+    // Into the first page with room, else into the page drawn from longest ago once emptied. Pages drawn from this frame are
+    // already referenced by draw lists: with all of them full the glyph is drawn blank, and misses again on the next frame.
+    int page_i = -1;
+    for (int i = 0; i < dynamic->Pages.Size && page_i < 0; i++)
+        if (ImFontAtlasDynamicGlyphsPackRect(dynamic->Pages[i], &rect))
+            page_i = i;
+    if (page_i < 0 && rect.w <= spc.width - spc.padding && rect.h <= spc.height - spc.padding)
+    {
+        int lru_i = -1;
+        for (int i = 0; i < dynamic->Pages.Size; i++)
+        {
+            const ImFontAtlasDynamicPage& page = dynamic->Pages[i];
+            if (page.GlyphsCount > 0 && page.LastUsedFrame != dynamic->Frame && (lru_i < 0 || page.LastUsedFrame < dynamic->Pages[lru_i].LastUsedFrame))
+                lru_i = i;
+        }
+        if (lru_i >= 0)
+        {
+            ImFontAtlasDynamicGlyphsEvictPage(atlas, lru_i);
+            if (ImFontAtlasDynamicGlyphsPackRect(dynamic->Pages[lru_i], &rect))
+                page_i = lru_i;
+        }
+    }
+    if (page_i < 0)
+    {
+        dynamic->Stats.GlyphsDropped++;
+        return ImFontAtlasDynamicGlyphsBlank(glyph);
+    }
+
+    // Clear what an evicted glyph left in the rectangle, then render as Build() does
+    ImFontAtlasDynamicPage& page = dynamic->Pages[page_i];
+    spc.pixels = page.PackContext.pixels;
+    const int rect_x = rect.x, rect_y = rect.y, rect_w = rect.w, rect_h = rect.h;
+    for (int y = rect_y; y < rect_y + rect_h; y++)
+        memset(spc.pixels + rect_x + y * spc.stride_in_bytes, 0, (size_t)rect_w);
+    stbtt_PackFontRangesRenderIntoRects(&spc, &font_info, &range, 1, &rect);
+    if (cfg.RasterizerMultiply != 1.0f)
+    {
+        unsigned char multiply_table[256];
+        ImFontAtlasBuildMultiplyCalcLookupTable(multiply_table, cfg.RasterizerMultiply);
+        ImFontAtlasBuildMultiplyRectAlpha8(multiply_table, spc.pixels, rect.x, rect.y, rect.w, rect.h, spc.stride_in_bytes);
+    }
+    glyph->U0 = packed_char.x0 * atlas->TexUvScale.x;
+    glyph->V0 = (page.Y + packed_char.y0) * atlas->TexUvScale.y;
+    glyph->U1 = packed_char.x1 * atlas->TexUvScale.x;
+    glyph->V1 = (page.Y + packed_char.y1) * atlas->TexUvScale.y;
+
+    // Keep the RGBA32 copy in step and mark the rows for upload
+    const int tex_y0 = page.Y + rect_y;
+    const int tex_y1 = tex_y0 + rect_h;
+    if (atlas->TexPixelsRGBA32)
+        for (int y = tex_y0; y < tex_y1; y++)
+        {
+            const unsigned char* src = atlas->TexPixelsAlpha8 + rect_x + y * atlas->TexWidth;
+            unsigned int* dst = atlas->TexPixelsRGBA32 + rect_x + y * atlas->TexWidth;
+            for (int x = 0; x < rect_w; x++)
+                dst[x] = IM_COL32(255, 255, 255, (unsigned int)src[x]);
+        }
+    page.DirtyY0 = (page.DirtyY0 < page.DirtyY1) ? ImMin(page.DirtyY0, tex_y0) : tex_y0;
+    page.DirtyY1 = ImMax(page.DirtyY1, tex_y1);
+
+    glyph_page.Page = (short)page_i;
+    page.LastUsedFrame = dynamic->Frame;
+    if (page.GlyphsCount++ == 0)
+        dynamic->Stats.PagesUsed++;
+    page.PixelsUsed += rect_w * rect_h;
+    dynamic->Stats.GlyphsResident++;
+    dynamic->Stats.PixelsUsed += rect_w * rect_h;
+    return glyph;
+}
+
+void ImFontAtlas::DynamicGlyphsNewFrame()
+{
+    if (!DynamicGlyphs)
+        return;
+    DynamicGlyphs->Frame++;
+    DynamicGlyphs->Stats.GlyphMissesFrame = 0;
+}
+
+bool ImFontAtlas::DynamicGlyphsTakeDirtyRows(int* out_y, int* out_height)
+{
+    if (!DynamicGlyphs)
+        return false;
+    for (int page_i = 0; page_i < DynamicGlyphs->Pages.Size; page_i++)
+    {
+        ImFontAtlasDynamicPage& page = DynamicGlyphs->Pages[page_i];
+        if (page.DirtyY0 >= page.DirtyY1)
+            continue;
+        *out_y = page.DirtyY0;
+        *out_height = page.DirtyY1 - page.DirtyY0;
+        page.DirtyY0 = page.DirtyY1 = 0;
+        DynamicGlyphs->Stats.Uploads++;
+        DynamicGlyphs->Stats.RowsUploaded += *out_height;
+        return true;
+    }
+    return false;
+}
+
+void ImFontAtlas::GetDynamicGlyphsStats(ImFontAtlasDynamicGlyphsStats* out_stats) const
+{
+    if (DynamicGlyphs)
+        *out_stats = DynamicGlyphs->Stats;
+    else
+        memset(out_stats, 0, sizeof(*out_stats));
+}
+
+//-----------------------------------------------------------------------------
+// ImFontAtlas text cache
+//-----------------------------------------------------------------------------
+
+// Shorter texts are measured again, which costs about as much as hashing and looking them up
+static const int FONT_TEXT_CACHE_MIN_LENGTH = 16;
+
+enum ImFontTextCacheKind
+{
+    ImFontTextCacheKind_Size,           // CalcTextSizeA() without max_width
+    ImFontTextCacheKind_Breaks          // Line ends of the word wrapping in RenderText()
+};
+
+struct ImFontAtlasTextCacheEntry
+{
+    ImU32               Key;                    // Hash of the text, seeded with a hash of the other fields
+    int                 TextBegin;              // Copy of the text, in Texts
+    int                 TextLength;
+    const ImFont*       Font;
+    float               Size;                   // Font size, or scale for line breaks
+    float               WrapWidth;
+    int                 Kind;                   // ImFontTextCacheKind
+    int                 LastUsedFrame;
+    ImVec2              TextSize;               // ImFontTextCacheKind_Size: result, and offset of *remaining from the text
+    int                 Remaining;
+    int                 BreaksBegin;            // ImFontTextCacheKind_Breaks: line ends, as offsets from the text, in Breaks
+    int                 BreaksCount;
+};
+
+struct ImFontAtlasTextCache
+{
+    ImVector<ImFontAtlasTextCacheEntry> Entries;    // Reserved to Capacity, so entries never move between two evictions
+    ImVector<int>                       Index;      // Open addressing on Key: entry index + 1, 0 for an empty slot. Twice the capacity or more, a power of two.
+    ImVector<int>                       Breaks;
+    ImVector<char>                      Texts;      // Texts of the entries, compared on lookup as different texts can share a hash
+    int                                 Capacity;
+    int                                 Frame;
+    ImFontAtlasTextCacheStats           Stats;
+};
+
+static ImFontAtlasTextCache* ImFontAtlasTextCacheGet(ImFontAtlas* atlas)
+{
+    if (atlas->TextCache)
+        return atlas->TextCache;
+    ImFontAtlasTextCache* cache = IM_NEW(ImFontAtlasTextCache);
+    cache->Capacity = atlas->TextCacheCapacity;
+    cache->Frame = 0;
+    memset(&cache->Stats, 0, sizeof(cache->Stats));
+    cache->Entries.reserve(cache->Capacity);
+    cache->Index.resize(ImUpperPowerOfTwo(cache->Capacity * 2), 0);
+    atlas->TextCache = cache;
+    return cache;
+}
+
+static void ImFontAtlasTextCacheIndexEntry(ImFontAtlasTextCache* cache, int entry_i)
+{
+    const int mask = cache->Index.Size - 1;
+    int slot = (int)(cache->Entries[entry_i].Key & (ImU32)mask);
+    while (cache->Index[slot] != 0)
+        slot = (slot + 1) & mask;
+    cache->Index[slot] = entry_i + 1;
+}
+
+// Looks up a result for the text, or returns NULL with the key to add it under. Texts too short to be worth it and atlases without a cache return NULL with no cache.
+static ImFontAtlasTextCacheEntry* ImFontAtlasTextCacheLookup(const ImFont* font, float size, float wrap_width, int kind, const char* text, const char* text_end, ImFontAtlasTextCache** out_cache, ImU32* out_key)
+{
+    *out_cache = NULL;
+    ImFontAtlas* atlas = font->ContainerAtlas;
+    const int text_length = (int)(text_end - text);
+    if (!atlas || atlas->TextCacheCapacity <= 0 || text_length < FONT_TEXT_CACHE_MIN_LENGTH)
+        return NULL;
+
+    ImFontAtlasTextCache* cache = ImFontAtlasTextCacheGet(atlas);
+    ImU32 params[4] = { (ImU32)(size_t)font, 0, 0, (ImU32)kind };
+    memcpy(&params[1], &size, sizeof(float));
+    memcpy(&params[2], &wrap_width, sizeof(float));
+    const ImU32 key = ImHash(text, text_length, ImHash(params, (int)sizeof(params), 0));
+    cache->Stats.Lookups++;
+    cache->Stats.LookupsFrame++;
+    *out_cache = cache;
+    *out_key = key;
+
+    const int mask = cache->Index.Size - 1;
+    for (int slot = (int)(key & (ImU32)mask); cache->Index[slot] != 0; slot = (slot + 1) & mask)
+    {
+        ImFontAtlasTextCacheEntry& entry = cache->Entries[cache->Index[slot] - 1];
+        if (entry.Key == key && entry.TextLength == text_length && entry.Font == font && entry.Size == size && entry.WrapWidth == wrap_width && entry.Kind == kind
+            && memcmp(cache->Texts.Data + entry.TextBegin, text, (size_t)text_length) == 0)
+        {
+            entry.LastUsedFrame = cache->Frame;
+            cache->Stats.Hits++;
+            cache->Stats.HitsFrame++;
+            cache->Stats.BytesSaved += (ImU64)text_length;
+            return &entry;
+        }
+    }
+    return NULL;
+}
+
+static bool ImFontAtlasTextCacheHasRoom(ImFontAtlasTextCache* cache)
+{
+    if (cache->Entries.Size < cache->Capacity)
+        return true;
+    cache->Stats.Rejected++;
+    return false;
+}
+
+// Returns NULL when the cache is full
+static ImFontAtlasTextCacheEntry* ImFontAtlasTextCacheAdd(ImFontAtlasTextCache* cache, ImU32 key, const ImFont* font, float size, float wrap_width, int kind, const char* text, const char* text_end)
+{
+    if (!ImFontAtlasTextCacheHasRoom(cache))
+        return NULL;
+    ImFontAtlasTextCacheEntry entry = ImFontAtlasTextCacheEntry();
+    entry.Key = key;
+    entry.TextBegin = cache->Texts.Size;
+    entry.TextLength = (int)(text_end - text);
+    cache->Texts.resize(cache->Texts.Size + entry.TextLength);
+    memcpy(cache->Texts.Data + entry.TextBegin, text, (size_t)entry.TextLength);
+    entry.Font = font;
+    entry.Size = size;
+    entry.WrapWidth = wrap_width;
+    entry.Kind = kind;
+    entry.LastUsedFrame = cache->Frame;
+    cache->Entries.push_back(entry);
+    ImFontAtlasTextCacheIndexEntry(cache, cache->Entries.Size - 1);
+    return &cache->Entries.back();
+}
+
+void ImFontAtlas::TextCacheNewFrame()
+{
+    ImFontAtlasTextCache* cache = TextCache;
+    if (!cache)
+        return;
+    cache->Frame++;
+    cache->Stats.LookupsFrame = cache->Stats.HitsFrame = 0;
+
+    // Keep the recently used entries, their texts and their breaks, packed at the front, then index them again
+    const int oldest_frame = cache->Frame - TextCacheMaxAge;
+    int kept = 0;
+    for (int i = 0; i < cache->Entries.Size; i++)
+        if (cache->Entries[i].LastUsedFrame >= oldest_frame)
+            cache->Entries[kept++] = cache->Entries[i];
+    if (kept == cache->Entries.Size)
+        return;
+    cache->Stats.Evicted += cache->Entries.Size - kept;
+    cache->Entries.resize(kept);
+
+    int texts_size = 0;
+    int breaks_count = 0;
+    for (int i = 0; i < cache->Entries.Size; i++)
+    {
+        ImFontAtlasTextCacheEntry& entry = cache->Entries[i];
+        memmove(cache->Texts.Data + texts_size, cache->Texts.Data + entry.TextBegin, (size_t)entry.TextLength);
+        entry.TextBegin = texts_size;
+        texts_size += entry.TextLength;
+        if (entry.Kind != ImFontTextCacheKind_Breaks)
+            continue;
+        memmove(cache->Breaks.Data + breaks_count, cache->Breaks.Data + entry.BreaksBegin, (size_t)entry.BreaksCount * sizeof(int));
+        entry.BreaksBegin = breaks_count;
+        breaks_count += entry.BreaksCount;
+    }
+    cache->Texts.resize(texts_size);
+    cache->Breaks.resize(breaks_count);
+
+    memset(cache->Index.Data, 0, (size_t)cache->Index.Size * sizeof(int));
+    for (int i = 0; i < cache->Entries.Size; i++)
+        ImFontAtlasTextCacheIndexEntry(cache, i);
+}
+
+void ImFontAtlas::ClearTextCache()
+{
+    IM_DELETE(TextCache);
+}
+
+void ImFontAtlas::GetTextCacheStats(ImFontAtlasTextCacheStats* out_stats) const
+{
+    if (TextCache)
+    {
+        *out_stats = TextCache->Stats;
+        out_stats->Entries = TextCache->Entries.Size;
+        out_stats->Breaks = TextCache->Breaks.Size;
+    }
+    else
+    {
+        memset(out_stats, 0, sizeof(*out_stats));
+    }
+}
+
 // Retrieve list of range (2 int per range, values are inclusive)
 const ImWchar*   ImFontAtlas::GetGlyphRangesDefault()
 {
@@ -2184,6 +3257,7 @@ void    ImFont::ClearOutputData()
     Ascent = Descent = 0.0f;
     DirtyLookupTables = true;
     MetricsTotalSurface = 0;
+    GlyphPages.clear();
 }
 
 void ImFont::BuildLookupTable()
@@ -2280,12 +3354,13 @@ void ImFont::AddRemapChar(ImWchar dst, ImWchar src, bool overwrite_dst)
 
 const ImFontGlyph* ImFont::FindGlyph(ImWchar c) const
 {
-    if (c >= IndexLookup.Size)
-        return FallbackGlyph;
-    const unsigned short i = IndexLookup[c];
-    if (i == (unsigned short)-1)
-        return FallbackGlyph;
-    return &Glyphs.Data[i];
+    const unsigned short i = (c < IndexLookup.Size) ? IndexLookup[c] : (unsigned short)-1;
+    const ImFontGlyph* glyph = (i != (unsigned short)-1) ? &Glyphs.Data[i] : FallbackGlyph;
+
+    // With ImFontAtlasFlags_DynamicGlyphs the glyph is rasterized the first time it is returned for drawing
+    if (GlyphPages.Size > 0 && glyph != NULL)
+        return ImFontAtlasDynamicGlyphsFind(const_cast<ImFont*>(this), const_cast<ImFontGlyph*>(glyph));
+    return glyph;
 }
 
 const ImFontGlyph* ImFont::FindGlyphNoFallback(ImWchar c) const
@@ -2397,11 +3472,52 @@ const char* ImFont::CalcWordWrapPositionA(float scale, const char* text, const c
     return s;
 }
 
+// Line ends of the word wrapping RenderText() and CalcTextSizeA() do from the start of the text, where each line starts at 0 and wraps at wrap_width
+static void ImFontCalcWordWrapBreaks(const ImFont* font, float scale, float wrap_width, const char* text_begin, const char* text_end, ImVector<int>& out_breaks)
+{
+    const char* s = text_begin;
+    while (s < text_end)
+    {
+        const char* word_wrap_eol = font->CalcWordWrapPositionA(scale, s, text_end, wrap_width);
+        if (word_wrap_eol == s)
+        {
+            // Forced one character line, the drawing loop steps over the whole character
+            unsigned int c = (unsigned int)*s;
+            const int char_length = (c < 0x80) ? 1 : ImTextCharFromUtf8(&c, s, text_end);
+            word_wrap_eol = s + 1;
+            s += ImMax(char_length, 1);
+        }
+        else
+        {
+            s = word_wrap_eol;
+        }
+        out_breaks.push_back((int)(word_wrap_eol - text_begin));
+
+        // Wrapping skips upcoming blanks
+        while (s < text_end)
+        {
+            const char c = *s;
+            if (ImCharIsSpace((unsigned int)c)) { s++; } else if (c == '\n') { s++; break; } else { break; }
+        }
+    }
+}
+
 ImVec2 ImFont::CalcTextSizeA(float size, float max_width, float wrap_width, const char* text_begin, const char* text_end, const char** remaining) const
 {
     if (!text_end)
         text_end = text_begin + strlen(text_begin); // FIXME-OPT: Need to avoid this.
 
+    // Measured before? Only without max_width, which callers set to cut text as it changes.
+    ImFontAtlasTextCache* cache = NULL;
+    ImU32 cache_key = 0;
+    if (max_width >= FLT_MAX)
+        if (const ImFontAtlasTextCacheEntry* entry = ImFontAtlasTextCacheLookup(this, size, wrap_width, ImFontTextCacheKind_Size, text_begin, text_end, &cache, &cache_key))
+        {
+            if (remaining)
+                *remaining = text_begin + entry->Remaining;
+            return entry->TextSize;
+        }
+
     const float line_height = size;
     const float scale = size / FontSize;
 
@@ -2488,6 +3604,13 @@ ImVec2 ImFont::CalcTextSizeA(float size, float max_width, float wrap_width, cons
     if (remaining)
         *remaining = s;
 
+    if (cache)
+        if (ImFontAtlasTextCacheEntry* entry = ImFontAtlasTextCacheAdd(cache, cache_key, this, size, wrap_width, ImFontTextCacheKind_Size, text_begin, text_end))
+        {
+            entry->TextSize = text_size;
+            entry->Remaining = (int)(s - text_begin);
+        }
+
     return text_size;
 }
 
@@ -2523,6 +3646,32 @@ void ImFont::RenderText(ImDrawList* draw_list, float size, ImVec2 pos, ImU32 col
     const bool word_wrap_enabled = (wrap_width > 0.0f);
     const char* word_wrap_eol = NULL;
 
+    // Line ends found when the text was last drawn with the same wrapping, then computed line by line past them
+    const int* word_wrap_breaks = NULL;
+    int word_wrap_breaks_count = 0;
+    int word_wrap_break_n = 0;
+    if (word_wrap_enabled)
+    {
+        ImFontAtlasTextCache* cache = NULL;
+        ImU32 cache_key = 0;
+        const ImFontAtlasTextCacheEntry* entry = ImFontAtlasTextCacheLookup(this, scale, wrap_width, ImFontTextCacheKind_Breaks, text_begin, text_end, &cache, &cache_key);
+        // A full cache leaves the text to the line by line wrapping below, rather than laying it out twice
+        if (!entry && cache && ImFontAtlasTextCacheHasRoom(cache))
+        {
+            const int breaks_begin = cache->Breaks.Size;
+            ImFontCalcWordWrapBreaks(this, scale, wrap_width, text_begin, text_end, cache->Breaks);
+            ImFontAtlasTextCacheEntry* new_entry = ImFontAtlasTextCacheAdd(cache, cache_key, this, scale, wrap_width, ImFontTextCacheKind_Breaks, text_begin, text_end);
+            new_entry->BreaksBegin = breaks_begin;
+            new_entry->BreaksCount = cache->Breaks.Size - breaks_begin;
+            entry = new_entry;
+        }
+        if (entry)
+        {
+            word_wrap_breaks = cache->Breaks.Data + entry->BreaksBegin;
+            word_wrap_breaks_count = entry->BreaksCount;
+        }
+    }
+
     // Skip non-visible lines
     const char* s = text_begin;
     if (!word_wrap_enabled && y + line_height < clip_rect.y)
@@ -2544,7 +3693,11 @@ void ImFont::RenderText(ImDrawList* draw_list, float size, ImVec2 pos, ImU32 col
         if (word_wrap_enabled)
         {
             // Calculate how far we can render. Requires two passes on the string data but keeps the code simple and not intrusive for what's essentially an uncommon feature.
-            if (!word_wrap_eol)
+            if (!word_wrap_eol && word_wrap_break_n < word_wrap_breaks_count)
+            {
+                word_wrap_eol = text_begin + word_wrap_breaks[word_wrap_break_n++];
+            }
+            else if (!word_wrap_eol)
             {
                 word_wrap_eol = CalcWordWrapPositionA(scale, s, text_end, wrap_width - (x - pos.x));
                 if (word_wrap_eol == s) // Wrap_width is too small to fit anything. Force displaying 1 character to minimize the height discontinuity.
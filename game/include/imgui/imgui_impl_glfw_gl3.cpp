@@ -62,13 +62,131 @@ static GLuint       g_FontTexture = 0;
 static int          g_ShaderHandle = 0, g_VertHandle = 0, g_FragHandle = 0;
 static int          g_AttribLocationTex = 0, g_AttribLocationProjMtx = 0;
 static int          g_AttribLocationPosition = 0, g_AttribLocationUV = 0, g_AttribLocationColor = 0;
+static ImFontAtlas* g_SdfFontAtlas = NULL;      // Atlas built with ImFontAtlasFlags_SignedDistanceField, drawn with the SDF program
+static GLuint       g_SdfFontTexture = 0;
+static int          g_SdfShaderHandle = 0, g_SdfFragHandle = 0;
+static int          g_SdfAttribLocationTex = 0, g_SdfAttribLocationProjMtx = 0;
 static unsigned int g_VboHandle = 0, g_ElementsHandle = 0;
 
+// Render options
+static int          g_RenderFlags = ImGui_ImplGlfwGL3_RenderFlags_None;
+static bool         g_HasHostState = false;
+static ImGui_ImplGlfwGL3_HostState  g_HostState;
+static ImGui_ImplGlfwGL3_RenderStats g_RenderStats;
+
+// Persistent VAOs, one per GL context (VAOs are not shared among contexts)
+struct ImGui_ImplGlfwGL3_ContextVao { GLFWwindow* Context; GLuint Vao; };
+static ImGui_ImplGlfwGL3_ContextVao g_ContextVaos[4] = {};
+
+// Draw lists concatenated for the single upload
+static ImVector<ImDrawVert> g_FrameVtxBuffer;
+static ImVector<ImDrawIdx>  g_FrameIdxBuffer;
+
+void ImGui_ImplGlfwGL3_SetRenderFlags(int flags)
+{
+    g_RenderFlags = flags;
+}
+
+int ImGui_ImplGlfwGL3_GetRenderFlags()
+{
+    return g_RenderFlags;
+}
+
+void ImGui_ImplGlfwGL3_SetHostState(const ImGui_ImplGlfwGL3_HostState* state)
+{
+    g_HasHostState = state != NULL;
+    if (state)
+        g_HostState = *state;
+}
+
+void ImGui_ImplGlfwGL3_GetRenderStats(ImGui_ImplGlfwGL3_RenderStats* out_stats)
+{
+    *out_stats = g_RenderStats;
+}
+
+// Points the attributes of the bound VAO at our buffers.
+static void ImGui_ImplGlfwGL3_SetupVertexArray()
+{
+    glBindBuffer(GL_ARRAY_BUFFER, g_VboHandle);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, g_ElementsHandle);
+    glEnableVertexAttribArray(g_AttribLocationPosition);
+    glEnableVertexAttribArray(g_AttribLocationUV);
+    glEnableVertexAttribArray(g_AttribLocationColor);
+    glVertexAttribPointer(g_AttribLocationPosition, 2, GL_FLOAT, GL_FALSE, sizeof(ImDrawVert), (GLvoid*)IM_OFFSETOF(ImDrawVert, pos));
+    glVertexAttribPointer(g_AttribLocationUV, 2, GL_FLOAT, GL_FALSE, sizeof(ImDrawVert), (GLvoid*)IM_OFFSETOF(ImDrawVert, uv));
+    glVertexAttribPointer(g_AttribLocationColor, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(ImDrawVert), (GLvoid*)IM_OFFSETOF(ImDrawVert, col));
+    g_RenderStats.StateChanges += 8;
+}
+
+// Returns the VAO kept for the current context, creating it on first use. 0 when every slot is taken by other contexts.
+static GLuint ImGui_ImplGlfwGL3_GetContextVao()
+{
+    GLFWwindow* context = glfwGetCurrentContext();
+    int free_slot = -1;
+    for (int n = 0; n < IM_ARRAYSIZE(g_ContextVaos); n++)
+    {
+        if (g_ContextVaos[n].Vao && g_ContextVaos[n].Context == context)
+            return g_ContextVaos[n].Vao;
+        if (!g_ContextVaos[n].Vao && free_slot < 0)
+            free_slot = n;
+    }
+    if (free_slot < 0)
+        return 0;
+
+    GLuint vao_handle = 0;
+    glGenVertexArrays(1, &vao_handle);
+    glBindVertexArray(vao_handle);
+    ImGui_ImplGlfwGL3_SetupVertexArray();
+    g_ContextVaos[free_slot].Context = context;
+    g_ContextVaos[free_slot].Vao = vao_handle;
+    g_RenderStats.VaoCreated++;
+    return vao_handle;
+}
+
+// Sets a capability unless it is already known to be in that state.
+static void ImGui_ImplGlfwGL3_SetEnabled(GLenum cap, bool enabled, bool known, bool known_enabled)
+{
+    if (known && known_enabled == enabled)
+        return;
+    if (enabled) glEnable(cap); else glDisable(cap);
+    g_RenderStats.StateChanges++;
+}
+
+// Uploads the texture rows that glyphs rasterized on first use were written to (ImFontAtlasFlags_DynamicGlyphs), one band per atlas page.
+static void ImGui_ImplGlfwGL3_UpdateFontsTexture()
+{
+    ImFontAtlas* atlas = ImGui::GetIO().Fonts;
+    int y, height;
+    if (g_FontTexture == 0 || atlas->TexPixelsRGBA32 == NULL || !atlas->DynamicGlyphsTakeDirtyRows(&y, &height))
+        return;
+
+    GLint last_texture = (GLint)g_HostState.Texture;
+    if (!g_HasHostState)
+    {
+        glGetIntegerv(GL_TEXTURE_BINDING_2D, &last_texture);
+        g_RenderStats.StateQueries++;
+    }
+    glBindTexture(GL_TEXTURE_2D, g_FontTexture);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    do
+    {
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, y, atlas->TexWidth, height, GL_RGBA, GL_UNSIGNED_BYTE, atlas->TexPixelsRGBA32 + y * atlas->TexWidth);
+        g_RenderStats.FontUploads++;
+        g_RenderStats.FontUploadBytes += atlas->TexWidth * height * 4;
+    }
+    while (atlas->DynamicGlyphsTakeDirtyRows(&y, &height));
+    glBindTexture(GL_TEXTURE_2D, last_texture);
+    g_RenderStats.StateChanges += 3;
+}
+
 // OpenGL3 Render function.
 // (this used to be set in io.RenderDrawListsFn and called by ImGui::Render(), but you can now call this directly from your main loop)
-// Note that this implementation is little overcomplicated because we are saving/setting up/restoring every OpenGL state explicitly, in order to be able to run within any OpenGL engine that doesn't do so. 
+// Note that this implementation is little overcomplicated because we are saving/setting up/restoring every OpenGL state explicitly, in order to be able to run within any OpenGL engine that doesn't do so.
+// With a host state declared through ImGui_ImplGlfwGL3_SetHostState() nothing is saved, and only what differs from it is set up and restored.
 void ImGui_ImplGlfwGL3_RenderDrawData(ImDrawData* draw_data)
 {
+    memset(&g_RenderStats, 0, sizeof(g_RenderStats));
+
     // Avoid rendering when minimized, scale coordinates for retina displays (screen coordinates != framebuffer coordinates)
     ImGuiIO& io = ImGui::GetIO();
     int fb_width = (int)(io.DisplaySize.x * io.DisplayFramebufferScale.x);
@@ -76,41 +194,69 @@ void ImGui_ImplGlfwGL3_RenderDrawData(ImDrawData* draw_data)
     if (fb_width == 0 || fb_height == 0)
         return;
     draw_data->ScaleClipRects(io.DisplayFramebufferScale);
+    g_RenderStats.DrawLists = draw_data->CmdListsCount;
+    ImGui_ImplGlfwGL3_UpdateFontsTexture();
 
     // Backup GL state
-    GLenum last_active_texture; glGetIntegerv(GL_ACTIVE_TEXTURE, (GLint*)&last_active_texture);
-    glActiveTexture(GL_TEXTURE0);
-    GLint last_program; glGetIntegerv(GL_CURRENT_PROGRAM, &last_program);
-    GLint last_texture; glGetIntegerv(GL_TEXTURE_BINDING_2D, &last_texture);
-    GLint last_sampler; glGetIntegerv(GL_SAMPLER_BINDING, &last_sampler);
-    GLint last_array_buffer; glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &last_array_buffer);
-    GLint last_element_array_buffer; glGetIntegerv(GL_ELEMENT_ARRAY_BUFFER_BINDING, &last_element_array_buffer);
-    GLint last_vertex_array; glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &last_vertex_array);
-    GLint last_polygon_mode[2]; glGetIntegerv(GL_POLYGON_MODE, last_polygon_mode);
-    GLint last_viewport[4]; glGetIntegerv(GL_VIEWPORT, last_viewport);
-    GLint last_scissor_box[4]; glGetIntegerv(GL_SCISSOR_BOX, last_scissor_box);
-    GLenum last_blend_src_rgb; glGetIntegerv(GL_BLEND_SRC_RGB, (GLint*)&last_blend_src_rgb);
-    GLenum last_blend_dst_rgb; glGetIntegerv(GL_BLEND_DST_RGB, (GLint*)&last_blend_dst_rgb);
-    GLenum last_blend_src_alpha; glGetIntegerv(GL_BLEND_SRC_ALPHA, (GLint*)&last_blend_src_alpha);
-    GLenum last_blend_dst_alpha; glGetIntegerv(GL_BLEND_DST_ALPHA, (GLint*)&last_blend_dst_alpha);
-    GLenum last_blend_equation_rgb; glGetIntegerv(GL_BLEND_EQUATION_RGB, (GLint*)&last_blend_equation_rgb);
-    GLenum last_blend_equation_alpha; glGetIntegerv(GL_BLEND_EQUATION_ALPHA, (GLint*)&last_blend_equation_alpha);
-    GLboolean last_enable_blend = glIsEnabled(GL_BLEND);
-    GLboolean last_enable_cull_face = glIsEnabled(GL_CULL_FACE);
-    GLboolean last_enable_depth_test = glIsEnabled(GL_DEPTH_TEST);
-    GLboolean last_enable_scissor_test = glIsEnabled(GL_SCISSOR_TEST);
+    const bool known = g_HasHostState;
+    GLenum last_active_texture = GL_TEXTURE0;
+    GLint last_program = 0, last_texture = 0, last_sampler = 0, last_array_buffer = 0, last_element_array_buffer = 0, last_vertex_array = 0;
+    GLint last_polygon_mode[2] = { GL_FILL, GL_FILL };
+    GLint last_viewport[4] = { 0, 0, 0, 0 };
+    GLint last_scissor_box[4] = { 0, 0, 0, 0 };
+    GLenum last_blend_src_rgb = GL_SRC_ALPHA, last_blend_dst_rgb = GL_ONE_MINUS_SRC_ALPHA, last_blend_src_alpha = GL_SRC_ALPHA, last_blend_dst_alpha = GL_ONE_MINUS_SRC_ALPHA;
+    GLenum last_blend_equation_rgb = GL_FUNC_ADD, last_blend_equation_alpha = GL_FUNC_ADD;
+    GLboolean last_enable_blend = GL_FALSE, last_enable_cull_face = GL_FALSE, last_enable_depth_test = GL_FALSE, last_enable_scissor_test = GL_FALSE;
+    if (!known)
+    {
+        glGetIntegerv(GL_ACTIVE_TEXTURE, (GLint*)&last_active_texture);
+        glActiveTexture(GL_TEXTURE0);
+        glGetIntegerv(GL_CURRENT_PROGRAM, &last_program);
+        glGetIntegerv(GL_TEXTURE_BINDING_2D, &last_texture);
+        glGetIntegerv(GL_SAMPLER_BINDING, &last_sampler);
+        glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &last_array_buffer);
+        glGetIntegerv(GL_ELEMENT_ARRAY_BUFFER_BINDING, &last_element_array_buffer);
+        glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &last_vertex_array);
+        glGetIntegerv(GL_POLYGON_MODE, last_polygon_mode);
+        glGetIntegerv(GL_VIEWPORT, last_viewport);
+        glGetIntegerv(GL_SCISSOR_BOX, last_scissor_box);
+        glGetIntegerv(GL_BLEND_SRC_RGB, (GLint*)&last_blend_src_rgb);
+        glGetIntegerv(GL_BLEND_DST_RGB, (GLint*)&last_blend_dst_rgb);
+        glGetIntegerv(GL_BLEND_SRC_ALPHA, (GLint*)&last_blend_src_alpha);
+        glGetIntegerv(GL_BLEND_DST_ALPHA, (GLint*)&last_blend_dst_alpha);
+        glGetIntegerv(GL_BLEND_EQUATION_RGB, (GLint*)&last_blend_equation_rgb);
+        glGetIntegerv(GL_BLEND_EQUATION_ALPHA, (GLint*)&last_blend_equation_alpha);
+        last_enable_blend = glIsEnabled(GL_BLEND);
+        last_enable_cull_face = glIsEnabled(GL_CULL_FACE);
+        last_enable_depth_test = glIsEnabled(GL_DEPTH_TEST);
+        last_enable_scissor_test = glIsEnabled(GL_SCISSOR_TEST);
+        g_RenderStats.StateQueries += 20;
+        g_RenderStats.StateChanges += 1;
+    }
 
     // Setup render state: alpha-blending enabled, no face culling, no depth testing, scissor enabled, polygon fill
-    glEnable(GL_BLEND);
-    glBlendEquation(GL_FUNC_ADD);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-    glDisable(GL_CULL_FACE);
-    glDisable(GL_DEPTH_TEST);
-    glEnable(GL_SCISSOR_TEST);
-    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+    ImGui_ImplGlfwGL3_SetEnabled(GL_BLEND, true, known, g_HostState.Blend);
+    if (!known || !g_HostState.Blend)
+    {
+        glBlendEquation(GL_FUNC_ADD);
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        g_RenderStats.StateChanges += 2;
+    }
+    ImGui_ImplGlfwGL3_SetEnabled(GL_CULL_FACE, false, known, g_HostState.CullFace);
+    ImGui_ImplGlfwGL3_SetEnabled(GL_DEPTH_TEST, false, known, g_HostState.DepthTest);
+    ImGui_ImplGlfwGL3_SetEnabled(GL_SCISSOR_TEST, true, known, g_HostState.ScissorTest);
+    if (!known || g_HostState.PolygonMode != GL_FILL)
+    {
+        glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+        g_RenderStats.StateChanges++;
+    }
 
     // Setup viewport, orthographic projection matrix
-    glViewport(0, 0, (GLsizei)fb_width, (GLsizei)fb_height);
+    if (!known || g_HostState.Viewport[0] != 0 || g_HostState.Viewport[1] != 0 || g_HostState.Viewport[2] != fb_width || g_HostState.Viewport[3] != fb_height)
+    {
+        glViewport(0, 0, (GLsizei)fb_width, (GLsizei)fb_height);
+        g_RenderStats.StateChanges++;
+    }
     const float ortho_projection[4][4] =
     {
         { 2.0f/io.DisplaySize.x, 0.0f,                   0.0f, 0.0f },
@@ -118,35 +264,84 @@ void ImGui_ImplGlfwGL3_RenderDrawData(ImDrawData* draw_data)
         { 0.0f,                  0.0f,                  -1.0f, 0.0f },
         {-1.0f,                  1.0f,                   0.0f, 1.0f },
     };
+    if (g_SdfFontTexture)
+    {
+        glUseProgram(g_SdfShaderHandle);
+        glUniform1i(g_SdfAttribLocationTex, 0);
+        glUniformMatrix4fv(g_SdfAttribLocationProjMtx, 1, GL_FALSE, &ortho_projection[0][0]);
+        g_RenderStats.StateChanges += 3;
+    }
     glUseProgram(g_ShaderHandle);
     glUniform1i(g_AttribLocationTex, 0);
     glUniformMatrix4fv(g_AttribLocationProjMtx, 1, GL_FALSE, &ortho_projection[0][0]);
-    glBindSampler(0, 0); // Rely on combined texture/sampler state.
+    g_RenderStats.StateChanges += 3;
+    if (!known)
+    {
+        glBindSampler(0, 0); // Rely on combined texture/sampler state.
+        g_RenderStats.StateChanges++;
+    }
 
-    // Recreate the VAO every time 
-    // (This is to easily allow multiple GL contexts. VAO are not shared among GL contexts, and we don't track creation/deletion of windows so we don't have an obvious key to use to cache them.)
+    // Either the VAO kept for this context, or one recreated every time
+    // (This is to easily allow multiple GL contexts. VAO are not shared among GL contexts, and without the persistent VAO flag we don't track creation/deletion of windows so we don't have an obvious key to use to cache them.)
     GLuint vao_handle = 0;
-    glGenVertexArrays(1, &vao_handle);
-    glBindVertexArray(vao_handle);
-    glBindBuffer(GL_ARRAY_BUFFER, g_VboHandle);
-    glEnableVertexAttribArray(g_AttribLocationPosition);
-    glEnableVertexAttribArray(g_AttribLocationUV);
-    glEnableVertexAttribArray(g_AttribLocationColor);
-    glVertexAttribPointer(g_AttribLocationPosition, 2, GL_FLOAT, GL_FALSE, sizeof(ImDrawVert), (GLvoid*)IM_OFFSETOF(ImDrawVert, pos));
-    glVertexAttribPointer(g_AttribLocationUV, 2, GL_FLOAT, GL_FALSE, sizeof(ImDrawVert), (GLvoid*)IM_OFFSETOF(ImDrawVert, uv));
-    glVertexAttribPointer(g_AttribLocationColor, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(ImDrawVert), (GLvoid*)IM_OFFSETOF(ImDrawVert, col));
+    bool vao_owned = false;
+    if (g_RenderFlags & ImGui_ImplGlfwGL3_RenderFlags_PersistentVao)
+        vao_handle = ImGui_ImplGlfwGL3_GetContextVao();
+    if (vao_handle)
+    {
+        // The array buffer binding is not part of the VAO
+        glBindVertexArray(vao_handle);
+        glBindBuffer(GL_ARRAY_BUFFER, g_VboHandle);
+        g_RenderStats.StateChanges += 2;
+    }
+    else
+    {
+        glGenVertexArrays(1, &vao_handle);
+        glBindVertexArray(vao_handle);
+        ImGui_ImplGlfwGL3_SetupVertexArray();
+        g_RenderStats.VaoCreated++;
+        vao_owned = true;
+    }
 
     // Draw
+    const GLenum idx_type = sizeof(ImDrawIdx) == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+    GLuint last_bound_texture = known ? g_HostState.Texture : (GLuint)last_texture;
+    int last_used_program = g_ShaderHandle;
+    if (g_RenderFlags & ImGui_ImplGlfwGL3_RenderFlags_SingleUpload)
+    {
+        // One upload of everything, each list then drawn from its offset with its indices rebased
+        g_FrameVtxBuffer.resize(draw_data->TotalVtxCount);
+        g_FrameIdxBuffer.resize(draw_data->TotalIdxCount);
+        ImDrawVert* vtx_dst = g_FrameVtxBuffer.Data;
+        ImDrawIdx* idx_dst = g_FrameIdxBuffer.Data;
+        for (int n = 0; n < draw_data->CmdListsCount; n++)
+        {
+            const ImDrawList* cmd_list = draw_data->CmdLists[n];
+            memcpy(vtx_dst, cmd_list->VtxBuffer.Data, cmd_list->VtxBuffer.Size * sizeof(ImDrawVert));
+            memcpy(idx_dst, cmd_list->IdxBuffer.Data, cmd_list->IdxBuffer.Size * sizeof(ImDrawIdx));
+            vtx_dst += cmd_list->VtxBuffer.Size;
+            idx_dst += cmd_list->IdxBuffer.Size;
+        }
+        glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)g_FrameVtxBuffer.Size * sizeof(ImDrawVert), (const GLvoid*)g_FrameVtxBuffer.Data, GL_STREAM_DRAW);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, (GLsizeiptr)g_FrameIdxBuffer.Size * sizeof(ImDrawIdx), (const GLvoid*)g_FrameIdxBuffer.Data, GL_STREAM_DRAW);
+        g_RenderStats.BufferUploads += 2;
+        g_RenderStats.UploadBytes += g_FrameVtxBuffer.Size * (int)sizeof(ImDrawVert) + g_FrameIdxBuffer.Size * (int)sizeof(ImDrawIdx);
+    }
+
+    int vtx_offset = 0;
+    const ImDrawIdx* idx_buffer_offset = 0;
     for (int n = 0; n < draw_data->CmdListsCount; n++)
     {
         const ImDrawList* cmd_list = draw_data->CmdLists[n];
-        const ImDrawIdx* idx_buffer_offset = 0;
-
-        glBindBuffer(GL_ARRAY_BUFFER, g_VboHandle);
-        glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)cmd_list->VtxBuffer.Size * sizeof(ImDrawVert), (const GLvoid*)cmd_list->VtxBuffer.Data, GL_STREAM_DRAW);
-
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, g_ElementsHandle);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, (GLsizeiptr)cmd_list->IdxBuffer.Size * sizeof(ImDrawIdx), (const GLvoid*)cmd_list->IdxBuffer.Data, GL_STREAM_DRAW);
+        if (!(g_RenderFlags & ImGui_ImplGlfwGL3_RenderFlags_SingleUpload))
+        {
+            idx_buffer_offset = 0;
+            vtx_offset = 0;
+            glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)cmd_list->VtxBuffer.Size * sizeof(ImDrawVert), (const GLvoid*)cmd_list->VtxBuffer.Data, GL_STREAM_DRAW);
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER, (GLsizeiptr)cmd_list->IdxBuffer.Size * sizeof(ImDrawIdx), (const GLvoid*)cmd_list->IdxBuffer.Data, GL_STREAM_DRAW);
+            g_RenderStats.BufferUploads += 2;
+            g_RenderStats.UploadBytes += cmd_list->VtxBuffer.Size * (int)sizeof(ImDrawVert) + cmd_list->IdxBuffer.Size * (int)sizeof(ImDrawIdx);
+        }
 
         for (int cmd_i = 0; cmd_i < cmd_list->CmdBuffer.Size; cmd_i++)
         {
@@ -157,32 +352,85 @@ void ImGui_ImplGlfwGL3_RenderDrawData(ImDrawData* draw_data)
             }
             else
             {
-                glBindTexture(GL_TEXTURE_2D, (GLuint)(intptr_t)pcmd->TextureId);
+                // Consecutive commands mostly share the font texture
+                const GLuint texture = (GLuint)(intptr_t)pcmd->TextureId;
+                if (texture != last_bound_texture || !(g_RenderFlags & ImGui_ImplGlfwGL3_RenderFlags_SingleUpload))
+                {
+                    glBindTexture(GL_TEXTURE_2D, texture);
+                    last_bound_texture = texture;
+                    g_RenderStats.StateChanges++;
+                }
+
+                // Distance field glyphs are thresholded rather than blended by coverage
+                const int program = (g_SdfFontTexture && texture == g_SdfFontTexture) ? g_SdfShaderHandle : g_ShaderHandle;
+                if (program != last_used_program)
+                {
+                    glUseProgram(program);
+                    last_used_program = program;
+                    g_RenderStats.StateChanges++;
+                }
                 glScissor((int)pcmd->ClipRect.x, (int)(fb_height - pcmd->ClipRect.w), (int)(pcmd->ClipRect.z - pcmd->ClipRect.x), (int)(pcmd->ClipRect.w - pcmd->ClipRect.y));
-                glDrawElements(GL_TRIANGLES, (GLsizei)pcmd->ElemCount, sizeof(ImDrawIdx) == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT, idx_buffer_offset);
+                if (vtx_offset == 0)
+                    glDrawElements(GL_TRIANGLES, (GLsizei)pcmd->ElemCount, idx_type, idx_buffer_offset);
+                else
+                    glDrawElementsBaseVertex(GL_TRIANGLES, (GLsizei)pcmd->ElemCount, idx_type, (void*)idx_buffer_offset, (GLint)vtx_offset);
+                g_RenderStats.StateChanges++;
+                g_RenderStats.DrawCalls++;
             }
             idx_buffer_offset += pcmd->ElemCount;
         }
+        vtx_offset += cmd_list->VtxBuffer.Size;
     }
-    glDeleteVertexArrays(1, &vao_handle);
+    if (vao_owned)
+        glDeleteVertexArrays(1, &vao_handle);
 
     // Restore modified GL state
-    glUseProgram(last_program);
-    glBindTexture(GL_TEXTURE_2D, last_texture);
-    glBindSampler(0, last_sampler);
-    glActiveTexture(last_active_texture);
-    glBindVertexArray(last_vertex_array);
-    glBindBuffer(GL_ARRAY_BUFFER, last_array_buffer);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, last_element_array_buffer);
-    glBlendEquationSeparate(last_blend_equation_rgb, last_blend_equation_alpha);
-    glBlendFuncSeparate(last_blend_src_rgb, last_blend_dst_rgb, last_blend_src_alpha, last_blend_dst_alpha);
-    if (last_enable_blend) glEnable(GL_BLEND); else glDisable(GL_BLEND);
-    if (last_enable_cull_face) glEnable(GL_CULL_FACE); else glDisable(GL_CULL_FACE);
-    if (last_enable_depth_test) glEnable(GL_DEPTH_TEST); else glDisable(GL_DEPTH_TEST);
-    if (last_enable_scissor_test) glEnable(GL_SCISSOR_TEST); else glDisable(GL_SCISSOR_TEST);
-    glPolygonMode(GL_FRONT_AND_BACK, (GLenum)last_polygon_mode[0]);
-    glViewport(last_viewport[0], last_viewport[1], (GLsizei)last_viewport[2], (GLsizei)last_viewport[3]);
-    glScissor(last_scissor_box[0], last_scissor_box[1], (GLsizei)last_scissor_box[2], (GLsizei)last_scissor_box[3]);
+    if (!known)
+    {
+        glUseProgram(last_program);
+        glBindTexture(GL_TEXTURE_2D, last_texture);
+        glBindSampler(0, last_sampler);
+        glActiveTexture(last_active_texture);
+        glBindVertexArray(last_vertex_array);
+        glBindBuffer(GL_ARRAY_BUFFER, last_array_buffer);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, last_element_array_buffer);
+        glBlendEquationSeparate(last_blend_equation_rgb, last_blend_equation_alpha);
+        glBlendFuncSeparate(last_blend_src_rgb, last_blend_dst_rgb, last_blend_src_alpha, last_blend_dst_alpha);
+        if (last_enable_blend) glEnable(GL_BLEND); else glDisable(GL_BLEND);
+        if (last_enable_cull_face) glEnable(GL_CULL_FACE); else glDisable(GL_CULL_FACE);
+        if (last_enable_depth_test) glEnable(GL_DEPTH_TEST); else glDisable(GL_DEPTH_TEST);
+        if (last_enable_scissor_test) glEnable(GL_SCISSOR_TEST); else glDisable(GL_SCISSOR_TEST);
+        glPolygonMode(GL_FRONT_AND_BACK, (GLenum)last_polygon_mode[0]);
+        glViewport(last_viewport[0], last_viewport[1], (GLsizei)last_viewport[2], (GLsizei)last_viewport[3]);
+        glScissor(last_scissor_box[0], last_scissor_box[1], (GLsizei)last_scissor_box[2], (GLsizei)last_scissor_box[3]);
+        g_RenderStats.StateChanges += 16;
+        return;
+    }
+
+    const ImGui_ImplGlfwGL3_HostState& host = g_HostState;
+    glUseProgram(host.Program);
+    glBindVertexArray(host.VertexArray);
+    glBindBuffer(GL_ARRAY_BUFFER, host.ArrayBuffer);
+    g_RenderStats.StateChanges += 3;
+    if (last_bound_texture != host.Texture)
+    {
+        glBindTexture(GL_TEXTURE_2D, host.Texture);
+        g_RenderStats.StateChanges++;
+    }
+    ImGui_ImplGlfwGL3_SetEnabled(GL_BLEND, host.Blend, true, true);
+    ImGui_ImplGlfwGL3_SetEnabled(GL_CULL_FACE, host.CullFace, true, false);
+    ImGui_ImplGlfwGL3_SetEnabled(GL_DEPTH_TEST, host.DepthTest, true, false);
+    ImGui_ImplGlfwGL3_SetEnabled(GL_SCISSOR_TEST, host.ScissorTest, true, true);
+    if (host.PolygonMode != GL_FILL)
+    {
+        glPolygonMode(GL_FRONT_AND_BACK, (GLenum)host.PolygonMode);
+        g_RenderStats.StateChanges++;
+    }
+    if (host.Viewport[2] != 0 && (host.Viewport[0] != 0 || host.Viewport[1] != 0 || host.Viewport[2] != fb_width || host.Viewport[3] != fb_height))
+    {
+        glViewport(host.Viewport[0], host.Viewport[1], (GLsizei)host.Viewport[2], (GLsizei)host.Viewport[3]);
+        g_RenderStats.StateChanges++;
+    }
 }
 
 static const char* ImGui_ImplGlfwGL3_GetClipboardText(void* user_data)
@@ -257,6 +505,50 @@ bool ImGui_ImplGlfwGL3_CreateFontsTexture()
     return true;
 }
 
+bool ImGui_ImplGlfwGL3_CreateSdfFontsTexture(ImFontAtlas* atlas)
+{
+    IM_ASSERT(atlas->Flags & ImFontAtlasFlags_SignedDistanceField);
+    if (g_SdfFontAtlas && g_SdfFontAtlas != atlas)
+        ImGui_ImplGlfwGL3_DestroySdfFontsTexture();
+
+    // One channel: the field is all the shader reads, a quarter of the RGBA upload
+    unsigned char* pixels;
+    int width, height;
+    atlas->GetTexDataAsAlpha8(&pixels, &width, &height);
+
+    GLint last_texture;
+    glGetIntegerv(GL_TEXTURE_BINDING_2D, &last_texture);
+    if (!g_SdfFontTexture)
+        glGenTextures(1, &g_SdfFontTexture);
+    glBindTexture(GL_TEXTURE_2D, g_SdfFontTexture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, width, height, 0, GL_RED, GL_UNSIGNED_BYTE, pixels);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    atlas->TexID = (void *)(intptr_t)g_SdfFontTexture;
+    g_SdfFontAtlas = atlas;
+
+    glBindTexture(GL_TEXTURE_2D, last_texture);
+    return true;
+}
+
+void ImGui_ImplGlfwGL3_DestroySdfFontsTexture()
+{
+    if (g_SdfFontTexture)
+    {
+        glDeleteTextures(1, &g_SdfFontTexture);
+        g_SdfFontTexture = 0;
+    }
+    if (g_SdfFontAtlas)
+    {
+        g_SdfFontAtlas->TexID = 0;
+        g_SdfFontAtlas = NULL;
+    }
+}
+
 bool ImGui_ImplGlfwGL3_CreateDeviceObjects()
 {
     // Backup GL state
@@ -289,8 +581,22 @@ bool ImGui_ImplGlfwGL3_CreateDeviceObjects()
         "	Out_Color = Frag_Color * texture( Texture, Frag_UV.st);\n"
         "}\n";
 
+    // The edge is at 0.5 of the field, smoothed over about one screen pixel whatever the scale the glyphs are drawn at
+    const GLchar* sdf_fragment_shader =
+        "uniform sampler2D Texture;\n"
+        "in vec2 Frag_UV;\n"
+        "in vec4 Frag_Color;\n"
+        "out vec4 Out_Color;\n"
+        "void main()\n"
+        "{\n"
+        "	float dist = texture( Texture, Frag_UV.st).r;\n"
+        "	float width = max(fwidth(dist), 0.0001);\n"
+        "	Out_Color = vec4(Frag_Color.rgb, Frag_Color.a * smoothstep(0.5 - width, 0.5 + width, dist));\n"
+        "}\n";
+
     const GLchar* vertex_shader_with_version[2] = { g_GlslVersion, vertex_shader };
     const GLchar* fragment_shader_with_version[2] = { g_GlslVersion, fragment_shader };
+    const GLchar* sdf_fragment_shader_with_version[2] = { g_GlslVersion, sdf_fragment_shader };
 
     g_ShaderHandle = glCreateProgram();
     g_VertHandle = glCreateShader(GL_VERTEX_SHADER);
@@ -309,10 +615,26 @@ bool ImGui_ImplGlfwGL3_CreateDeviceObjects()
     g_AttribLocationUV = glGetAttribLocation(g_ShaderHandle, "UV");
     g_AttribLocationColor = glGetAttribLocation(g_ShaderHandle, "Color");
 
+    // Same vertex shader and attribute locations, so that both programs draw from the same VAO
+    g_SdfShaderHandle = glCreateProgram();
+    g_SdfFragHandle = glCreateShader(GL_FRAGMENT_SHADER);
+    glShaderSource(g_SdfFragHandle, 2, sdf_fragment_shader_with_version, NULL);
+    glCompileShader(g_SdfFragHandle);
+    glAttachShader(g_SdfShaderHandle, g_VertHandle);
+    glAttachShader(g_SdfShaderHandle, g_SdfFragHandle);
+    glBindAttribLocation(g_SdfShaderHandle, g_AttribLocationPosition, "Position");
+    glBindAttribLocation(g_SdfShaderHandle, g_AttribLocationUV, "UV");
+    glBindAttribLocation(g_SdfShaderHandle, g_AttribLocationColor, "Color");
+    glLinkProgram(g_SdfShaderHandle);
+    g_SdfAttribLocationTex = glGetUniformLocation(g_SdfShaderHandle, "Texture");
+    g_SdfAttribLocationProjMtx = glGetUniformLocation(g_SdfShaderHandle, "ProjMtx");
+
     glGenBuffers(1, &g_VboHandle);
     glGenBuffers(1, &g_ElementsHandle);
 
     ImGui_ImplGlfwGL3_CreateFontsTexture();
+    if (g_SdfFontAtlas)
+        ImGui_ImplGlfwGL3_CreateSdfFontsTexture(g_SdfFontAtlas);
 
     // Restore modified GL state
     glBindTexture(GL_TEXTURE_2D, last_texture);
@@ -324,10 +646,26 @@ bool ImGui_ImplGlfwGL3_CreateDeviceObjects()
 
 void    ImGui_ImplGlfwGL3_InvalidateDeviceObjects()
 {
+    // Only the current context's VAO can be deleted from here, the others go with their contexts
+    GLFWwindow* context = glfwGetCurrentContext();
+    for (int n = 0; n < IM_ARRAYSIZE(g_ContextVaos); n++)
+    {
+        if (g_ContextVaos[n].Vao && g_ContextVaos[n].Context == context)
+            glDeleteVertexArrays(1, &g_ContextVaos[n].Vao);
+        g_ContextVaos[n].Context = NULL;
+        g_ContextVaos[n].Vao = 0;
+    }
+
     if (g_VboHandle) glDeleteBuffers(1, &g_VboHandle);
     if (g_ElementsHandle) glDeleteBuffers(1, &g_ElementsHandle);
     g_VboHandle = g_ElementsHandle = 0;
 
+    if (g_SdfShaderHandle && g_VertHandle) glDetachShader(g_SdfShaderHandle, g_VertHandle);
+    if (g_SdfShaderHandle && g_SdfFragHandle) glDetachShader(g_SdfShaderHandle, g_SdfFragHandle);
+    if (g_SdfFragHandle) glDeleteShader(g_SdfFragHandle);
+    if (g_SdfShaderHandle) glDeleteProgram(g_SdfShaderHandle);
+    g_SdfFragHandle = g_SdfShaderHandle = 0;
+
     if (g_ShaderHandle && g_VertHandle) glDetachShader(g_ShaderHandle, g_VertHandle);
     if (g_VertHandle) glDeleteShader(g_VertHandle);
     g_VertHandle = 0;
@@ -345,6 +683,13 @@ void    ImGui_ImplGlfwGL3_InvalidateDeviceObjects()
         ImGui::GetIO().Fonts->TexID = 0;
         g_FontTexture = 0;
     }
+
+    // The SDF atlas is kept and uploaded again with the device objects
+    if (g_SdfFontTexture)
+    {
+        glDeleteTextures(1, &g_SdfFontTexture);
+        g_SdfFontTexture = 0;
+    }
 }
 
 static void ImGui_ImplGlfw_InstallCallbacks(GLFWwindow* window)
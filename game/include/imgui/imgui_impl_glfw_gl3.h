@@ -18,6 +18,58 @@ IMGUI_API void        ImGui_ImplGlfwGL3_Shutdown();
 IMGUI_API void        ImGui_ImplGlfwGL3_NewFrame();
 IMGUI_API void        ImGui_ImplGlfwGL3_RenderDrawData(ImDrawData* draw_data);
 
+// Render options, see ImGui_ImplGlfwGL3_SetRenderFlags().
+enum ImGui_ImplGlfwGL3_RenderFlags_
+{
+    ImGui_ImplGlfwGL3_RenderFlags_None          = 0,
+    ImGui_ImplGlfwGL3_RenderFlags_SingleUpload  = 1 << 0,   // Concatenate every draw list into one vertex and one index upload, drawn with glDrawElementsBaseVertex()
+    ImGui_ImplGlfwGL3_RenderFlags_PersistentVao = 1 << 1,   // Keep one VAO per GL context across frames instead of creating one every frame
+    ImGui_ImplGlfwGL3_RenderFlags_Batched       = ImGui_ImplGlfwGL3_RenderFlags_SingleUpload | ImGui_ImplGlfwGL3_RenderFlags_PersistentVao
+};
+
+// GL state the host engine promises to leave behind when it calls ImGui_ImplGlfwGL3_RenderDrawData(), and gets back afterwards.
+// With it declared, nothing is read back through glGet*() and only the state that differs from what ImGui needs is set and restored.
+// Texture unit 0 is assumed active with no sampler bound.
+struct ImGui_ImplGlfwGL3_HostState
+{
+    unsigned int    Program;
+    unsigned int    VertexArray;
+    unsigned int    ArrayBuffer;
+    unsigned int    Texture;                // GL_TEXTURE_2D binding
+    bool            Blend;                  // When enabled, ImGui's blend function and equation must be the host's too
+    bool            CullFace;
+    bool            DepthTest;
+    bool            ScissorTest;            // When enabled, the host sets its own scissor box again
+    unsigned int    PolygonMode;            // GL_FILL, GL_LINE or GL_POINT for both faces
+    int             Viewport[4];            // Width 0: the host sets its own viewport again
+
+    ImGui_ImplGlfwGL3_HostState() { memset(this, 0, sizeof(*this)); PolygonMode = 0x1B02; /* GL_FILL */ }
+};
+
+// Counts of the last ImGui_ImplGlfwGL3_RenderDrawData() call.
+struct ImGui_ImplGlfwGL3_RenderStats
+{
+    int             DrawLists;
+    int             DrawCalls;
+    int             BufferUploads;          // glBufferData() calls
+    int             UploadBytes;
+    int             StateQueries;           // glGet*() and glIsEnabled() calls
+    int             StateChanges;           // Calls setting and restoring state, draws and uploads excluded
+    int             VaoCreated;
+    int             FontUploads;            // glTexSubImage2D() calls for glyphs rasterized on first use
+    int             FontUploadBytes;
+};
+
+IMGUI_API void        ImGui_ImplGlfwGL3_SetRenderFlags(int flags);                                   // ImGui_ImplGlfwGL3_RenderFlags_None by default
+IMGUI_API int         ImGui_ImplGlfwGL3_GetRenderFlags();
+IMGUI_API void        ImGui_ImplGlfwGL3_SetHostState(const ImGui_ImplGlfwGL3_HostState* state);     // NULL (default): back up and restore every piece of state
+IMGUI_API void        ImGui_ImplGlfwGL3_GetRenderStats(ImGui_ImplGlfwGL3_RenderStats* out_stats);
+
+// Upload a font atlas built with ImFontAtlasFlags_SignedDistanceField (e.g. HUD fonts drawn at any size) and set its TexID.
+// Commands drawing from it use a shader thresholding the field, so one atlas serves every size. One such atlas at a time, it is uploaded again by CreateDeviceObjects().
+IMGUI_API bool        ImGui_ImplGlfwGL3_CreateSdfFontsTexture(ImFontAtlas* atlas);
+IMGUI_API void        ImGui_ImplGlfwGL3_DestroySdfFontsTexture();
+
 // Use if you want to reset your rendering device without losing ImGui state.
 IMGUI_API void        ImGui_ImplGlfwGL3_InvalidateDeviceObjects();
 IMGUI_API bool        ImGui_ImplGlfwGL3_CreateDeviceObjects();
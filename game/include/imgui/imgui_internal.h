@@ -96,6 +96,9 @@ IMGUI_API int           ImTextCountUtf8BytesFromStr(const ImWchar* in_text, cons
 
 // Helpers: Misc
 IMGUI_API ImU32         ImHash(const void* data, int data_size, ImU32 seed = 0);    // Pass data_size==0 for zero-terminated strings
+#ifdef IMGUI_USE_FAST_HASH
+IMGUI_API ImU32         ImHashCombine(ImU32 seed, ImU32 hash);                      // ID of a label hashed on its own (ImHashConst) under 'seed'
+#endif
 IMGUI_API void*         ImFileLoadToMemory(const char* filename, const char* file_open_mode, int* out_file_size = NULL, int padding_bytes = 0);
 IMGUI_API FILE*         ImFileOpen(const char* filename, const char* file_open_mode);
 static inline bool      ImCharIsSpace(unsigned int c)   { return c == ' ' || c == '\t' || c == 0x3000; }
@@ -476,6 +479,16 @@ struct ImGuiColumnsSet
     }
 };
 
+// Points of a unit circle arc as PathArcTo() computes them, for arcs drawn again with the same angles and segment count
+struct ImDrawListArcTable
+{
+    float               AMin, AMax;
+    int                 Segments;               // 0 while unused
+    ImVector<ImVec2>    Points;                 // Segments + 1
+
+    ImDrawListArcTable() { AMin = AMax = 0.0f; Segments = 0; }
+};
+
 struct IMGUI_API ImDrawListSharedData
 {
     ImVec2          TexUvWhitePixel;            // UV of white pixel in the atlas
@@ -488,6 +501,10 @@ struct IMGUI_API ImDrawListSharedData
     // FIXME: Bake rounded corners fill/borders in atlas
     ImVec2          CircleVtx12[12];
 
+    // Filled by PathArcTo() through the const pointer draw lists hold: draw lists sharing this data are built one at a time
+    mutable ImDrawListArcTable  ArcTables[16];
+    mutable int                 ArcTablesNext;  // Replaced when no table matches
+
     ImDrawListSharedData();
 };
 
@@ -576,6 +593,7 @@ struct ImGuiContext
     ImGuiWindow*            CurrentWindow;                      // Being drawn into
     ImGuiWindow*            HoveredWindow;                      // Will catch mouse inputs
     ImGuiWindow*            HoveredRootWindow;                  // Will catch mouse inputs (for focus/move only)
+    ImHashedStr             HashedLabel;                        // Label of the ImHashedStr widget being submitted, its ID lookups use the precomputed hash
     ImGuiID                 HoveredId;                          // Hovered widget
     bool                    HoveredIdAllowOverlap;
     ImGuiID                 HoveredIdPreviousFrame;
@@ -969,6 +987,7 @@ public:
 
     ImGuiID     GetID(const char* str, const char* str_end = NULL);
     ImGuiID     GetID(const void* ptr);
+    ImGuiID     GetID(const ImHashedStr& str);
     ImGuiID     GetIDNoKeepAlive(const char* str, const char* str_end = NULL);
     ImGuiID     GetIDFromRectangle(const ImRect& r_abs);
 
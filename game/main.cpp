@@ -6,7 +6,22 @@
 #include <glm/gtc/type_ptr.hpp>
 #include "imgui/imgui.h"
 #include "imgui/imgui_impl_glfw_gl3.h"
+#include "core/WorkerPool.h"
+#include "net/GameClient.h"
+#include "net/GameServer.h"
+#include "net/RollbackSession.h"
+#include "physics/ClothNet.h"
+#include "render/StreamingBuffer.h"
+#include "render/UiRenderBenchmark.h"
+#include "replay/ReplayPlayer.h"
+#include "replay/ReplayRecorder.h"
+#include "Match.h"
+#include "DebugWindows.h"
+#include <algorithm>
+#include <chrono>
 #include <iostream>
+#include <thread>
+#include <vector>
 
 using namespace std;
 
@@ -76,6 +91,7 @@ void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 void mouse_callback(GLFWwindow* window, double xpos, double ypos);
 void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
 void processInput(GLFWwindow *window);
+PlayerInput readPlayerInput(GLFWwindow *window);
 
 float g_TranslateX = 0.0f;
 float g_TranslateY = 1.0f;
@@ -88,11 +104,16 @@ float g_Projection = 45.0f;
 float g_DeltaTime = 0.0f;
 float g_LastFrame = 0.0f;
 
+// physics
+const unsigned int MAX_PHYSICS_STEPS_PER_FRAME = 5;
+const char* REPLAY_FILE = "deathball.replay";
+float g_PhysicsAccumulator = 0.0f;
+
 
 
 // camera
-glm::vec3 g_CameraPos   = glm::vec3(0.0f, 1.0f,  3.0f);
-glm::vec3 g_CameraFront = glm::vec3(0.0f, 0.0f, -1.0f);
+glm::vec3 g_CameraPos   = glm::vec3(0.0f, 5.0f, 10.0f);
+glm::vec3 g_CameraFront = glm::normalize(glm::vec3(0.0f, -0.5f, -1.0f));
 glm::vec3 g_CameraUp    = glm::vec3(0.0f, 1.0f,  0.0f);
 
 
@@ -248,6 +269,85 @@ int main()
     io.DisplaySize.y = SCR_HEIGHT;             // set the current display height here
 
 
+    // -------------------- PHYSICS --------------------
+
+    WorkerPool workerPool(std::max(1u, std::thread::hardware_concurrency()));
+
+    // the UI font atlas is built on the first frame: glyphs rasterized on the
+    // pool, the result cached next to imgui.ini for the following launches
+    io.Fonts->BuildParallelForFn = ParallelForOnPool;
+    io.Fonts->BuildParallelForUserData = &workerPool;
+    io.Fonts->BuildCacheFilename = "imgui_fonts.cache";
+    // labels, tooltips and the match log are measured once while they stay
+    // on screen rather than every frame
+    io.Fonts->TextCacheCapacity = 2048;
+    Match match;
+    const PhysicsWorld& world = match.GetWorld();
+    const RagdollSystem& ragdolls = match.GetRagdolls();
+    const std::vector<DeathFootBallPlayer>& players = match.GetPlayers();
+    const unsigned int ball = match.GetBall();
+    std::vector<PlayerInput> inputs(Match::PLAYER_COUNT);
+    bool sadisticTacklePending = false;
+    ReplayRecorder recorder;
+    ReplayPlayer replay;
+
+    // loopback rollback play: the second match stands in for the remote peer
+    // and gets the away team's inputs through its own session
+    Match remoteMatch;
+    RollbackSession localSession(match, 0);
+    RollbackSession remoteSession(remoteMatch, 1);
+    std::vector<unsigned char> matchState(match.GetMaxStateSize());
+    bool rollbackPlay = false;
+
+    // loopback server play: an authoritative server with its own match, and
+    // this window as one of its clients predicting the player it controls
+    Match serverMatch;
+    GameServer server(serverMatch, 2);
+    std::vector<unsigned char> serverStartState(serverMatch.GetMaxStateSize());
+    serverStartState.resize(serverMatch.SaveState(&serverStartState[0]));
+    GameClient client;
+    bool serverPlay = false;
+    std::vector<float> boneMatrices(64 * RagdollSystem::BONE_COUNT * RagdollSystem::FLOATS_PER_BONE);
+
+    // goal nets hang just behind each goal line, the ball pushes into them
+    ClothNet homeNet(glm::vec3(-5.9f, 0.8f, -1.0f), glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(0.0f, -1.0f, 0.0f), 21, 9, 0.1f);
+    ClothNet awayNet(glm::vec3( 5.9f, 0.8f, -1.0f), glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(0.0f, -1.0f, 0.0f), 21, 9, 0.1f);
+    std::vector<ClothNet*> nets;
+    nets.push_back(&homeNet);
+    nets.push_back(&awayNet);
+
+    // all net vertices share one streamed buffer; the line indices never change
+    unsigned int netVertexCount = 0;
+    std::vector<unsigned short> netIndices;
+    for (unsigned int i = 0; i < nets.size(); ++i)
+    {
+        std::vector<unsigned short> lines;
+        nets[i]->BuildLineIndices(lines);
+        for (unsigned int j = 0; j < lines.size(); ++j)
+            netIndices.push_back((unsigned short)(lines[j] + netVertexCount));
+        netVertexCount += nets[i]->GetVertexCount();
+    }
+
+    unsigned int netVAO, netEBO;
+    glGenVertexArrays(1, &netVAO);
+    glBindVertexArray(netVAO);
+    StreamingBuffer netVertices(GL_ARRAY_BUFFER, netVertexCount * 3 * sizeof(float));
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), 0);
+    glEnableVertexAttribArray(0);
+    glGenBuffers(1, &netEBO);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, netEBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, netIndices.size() * sizeof(unsigned short), &netIndices[0], GL_STATIC_DRAW);
+    bool netsUploaded = false;
+
+    // what the frame leaves bound when ImGui draws last: the scene program
+    // and cube VAO, no texture, depth test, blending or culling
+    UiRenderBenchmark uiBenchmark;
+    ImGui_ImplGlfwGL3_HostState uiHostState;
+    uiHostState.Program = ShaderObj.GetProgramId();
+    uiHostState.VertexArray = VAO2;
+
+    // --------------------------------------------------
+
     ImVec4 color = ImVec4(0.88f, 0.55f, 0.60f, 1.00f);
     // render loop
     // -----------
@@ -261,8 +361,59 @@ int main()
         // input
         // -----
         processInput(window);
+
+        const double nowMs = glfwGetTime() * 1000.0;
+        if (serverPlay)
+            client.Update(readPlayerInput(window), nowMs);
+        const bool drawClient = serverPlay && client.HasSnapshot();
+
+        // physics
+        // -------
+        g_PhysicsAccumulator += g_DeltaTime;
+        unsigned int physicsSteps = 0;
+        unsigned int subStepsThisFrame = 0;
+        const float tickSeconds = Match::GetTickSeconds();
+        while (g_PhysicsAccumulator >= tickSeconds && physicsSteps < MAX_PHYSICS_STEPS_PER_FRAME)
+        {
+            if (replay.IsOpen())
+            {
+                replay.Advance(match, workerPool);
+            }
+            else if (rollbackPlay)
+            {
+                for (unsigned int i = 0; i < inputs.size(); ++i)
+                    inputs[i].buttons = sadisticTacklePending ? BUTTON_CHARGE : 0;
+                sadisticTacklePending = false;
+
+                localSession.AdvanceFrame(&inputs[0], workerPool, nowMs);
+                remoteSession.AdvanceFrame(&inputs[RollbackSession::PLAYERS_PER_PEER], workerPool, nowMs);
+            }
+            else if (serverPlay)
+            {
+                server.Update(workerPool, nowMs);
+            }
+            else
+            {
+                // every player charges the ball at once - the pile-up case the solver is built for
+                for (unsigned int i = 0; i < inputs.size(); ++i)
+                    inputs[i].buttons = sadisticTacklePending ? BUTTON_CHARGE : 0;
+                sadisticTacklePending = false;
+
+                recorder.RecordTick(match, &inputs[0]);
+                match.Tick(&inputs[0], workerPool);
+            }
+            subStepsThisFrame += world.GetSubStepStats().islandSubSteps;
+            StepClothNets(nets, tickSeconds, drawClient ? client.GetDrawPosition(0, nowMs) : world.GetPosition(ball),
+                          world.GetRadius(ball), workerPool);
+            g_PhysicsAccumulator -= tickSeconds;
+            ++physicsSteps;
+        }
+        if (physicsSteps == MAX_PHYSICS_STEPS_PER_FRAME)
+            g_PhysicsAccumulator = 0.0f;
+
         // render
         // ------
+        const glm::vec3 ballPosition = drawClient ? client.GetDrawPosition(0, nowMs) : world.GetPosition(ball);
         glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT);
 
@@ -303,6 +454,70 @@ int main()
 
         glDrawArrays(GL_TRIANGLES, 0, 36);
 
+        // the cube mesh is 0.4 wide, so scale it to the body's diameter
+        glm::mat4 ballModel = glm::translate(glm::mat4(1.0f), ballPosition);
+        ballModel = glm::scale(ballModel, glm::vec3(world.GetRadius(ball) / 0.2f));
+        glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(ballModel));
+        glUniform4f(uniformLocation, 1.0f, 1.0f, 1.0f, 1.0f);
+        glDrawArrays(GL_TRIANGLES, 0, 36);
+
+        for (unsigned int i = 0; i < players.size(); ++i)
+        {
+            const bool knockedOut = drawClient ? (client.GetEntityFlags(i + 1) & ENTITY_KNOCKED_OUT) != 0 : players[i].IsKnockedOut();
+            if (knockedOut)
+                continue;
+            unsigned int body = players[i].GetBody();
+            glm::vec3 position = drawClient ? client.GetDrawPosition(i + 1, nowMs) : world.GetPosition(body);
+            glm::mat4 bodyModel = glm::translate(glm::mat4(1.0f), position);
+            bodyModel = glm::scale(bodyModel, glm::vec3(world.GetRadius(body) / 0.2f));
+            glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(bodyModel));
+            glUniform4f(uniformLocation, players[i].GetTeam() ? 0.9f : 0.2f, 0.2f, players[i].GetTeam() ? 0.2f : 0.9f, 1.0f);
+            glDrawArrays(GL_TRIANGLES, 0, 36);
+        }
+
+        // ragdoll bones: unit cube stretched along the bone's +Y axis; snapshots
+        // carry no ragdolls, so none are drawn in server play
+        ragdolls.WriteBoneMatrices(&boneMatrices[0]);
+        glUniform4f(uniformLocation, 0.9f, 0.8f, 0.6f, 1.0f);
+        for (unsigned int slot = 0; slot < (drawClient ? 0 : ragdolls.GetActiveCount()); ++slot)
+        {
+            for (unsigned int bone = 0; bone < RagdollSystem::BONE_COUNT; ++bone)
+            {
+                float length = ragdolls.GetBoneLength(slot, bone);
+                glm::mat4 boneModel = glm::make_mat4(&boneMatrices[(slot * RagdollSystem::BONE_COUNT + bone) * RagdollSystem::FLOATS_PER_BONE]);
+                boneModel = glm::translate(boneModel, glm::vec3(0.0f, 0.5f * length, 0.0f));
+                boneModel = glm::scale(boneModel, glm::vec3(0.15f, length / 0.4f, 0.15f));
+                glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(boneModel));
+                glDrawArrays(GL_TRIANGLES, 0, 36);
+            }
+        }
+
+        // goal nets: re-upload only when a net moved, sleeping nets redraw the last region
+        netsUploaded = false;
+        for (unsigned int i = 0; i < nets.size(); ++i)
+        {
+            if (nets[i]->ConsumeDirty())
+                netsUploaded = true;
+        }
+        glBindVertexArray(netVAO);
+        if (netsUploaded)
+        {
+            glBindBuffer(GL_ARRAY_BUFFER, netVertices.GetBuffer());
+            float* pVertices = static_cast<float*>(netVertices.Map());
+            for (unsigned int i = 0; i < nets.size(); ++i)
+            {
+                nets[i]->WriteVertices(pVertices);
+                pVertices += nets[i]->GetVertexCount() * 3;
+            }
+            netVertices.Unmap();
+        }
+        glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(glm::mat4(1.0f)));
+        glUniform4f(uniformLocation, 0.95f, 0.95f, 0.95f, 1.0f);
+        glDrawElementsBaseVertex(GL_LINES, (GLsizei)netIndices.size(), GL_UNSIGNED_SHORT, 0,
+                                 (GLint)(netVertices.GetOffset() / (3 * sizeof(float))));
+        netVertices.Fence();
+        glBindVertexArray(VAO2);
+
         // render your GUI
 
         {
@@ -311,9 +526,9 @@ int main()
              //ImGui::SameLine();
 
              ImGui::Text("MODEL TRANSLATION");
-             ImGui::SliderFloat("Translation x", &g_TranslateX, -5.0f, 5.0f);
-             ImGui::SliderFloat("Translation y", &g_TranslateY, -5.0f, 5.0f);
-             ImGui::SliderFloat("Translation z", &g_TranslateZ, -10.0f, 10.0f);
+             ImGui::SliderFloat(IM_HASHED("Translation x"), &g_TranslateX, -5.0f, 5.0f);
+             ImGui::SliderFloat(IM_HASHED("Translation y"), &g_TranslateY, -5.0f, 5.0f);
+             ImGui::SliderFloat(IM_HASHED("Translation z"), &g_TranslateZ, -10.0f, 10.0f);
 
              ImGui::Text("CAMERA POSITION");
              ImGui::Text("Camera Pos: x = %f, y = %f, z = %f", g_CameraPos.x, g_CameraPos.y, g_CameraPos.z);
@@ -323,16 +538,124 @@ int main()
              ImGui::Text("FPS");
              ImGui::Text("Application average %.3f ms/frame (%.1f FPS)", 1000.0f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
 
+             ImGui::Text("PHYSICS");
+             if (ImGui::Button(IM_HASHED("Sadistic tackle")))
+                 sadisticTacklePending = true;
+             ImGui::Text("Tick %u  State hash %016llx", match.GetTick(), (unsigned long long)match.GetStateHash());
+
+             ImGui::Text("NETWORK");
+             if (!replay.IsOpen() && !recorder.IsRecording() && !serverPlay)
+             {
+                 bool enable = rollbackPlay;
+                 if (ImGui::Checkbox(IM_HASHED("Loopback rollback play"), &enable) && enable)
+                 {
+                     if (localSession.Open(0) && remoteSession.Open(0))
+                     {
+                         localSession.SetRemote(remoteSession.GetLocalAddress());
+                         remoteSession.SetRemote(localSession.GetLocalAddress());
+                         remoteMatch.LoadState(&matchState[0], match.SaveState(&matchState[0]));
+                         localSession.Start();
+                         remoteSession.Start();
+                     }
+                     else
+                     {
+                         enable = false;
+                     }
+                 }
+                 rollbackPlay = enable;
+             }
+             if (rollbackPlay)
+             {
+                 // both directions share the conditions set on the local peer
+                 const LinkConditioner& rLink = localSession.GetConditioner();
+                 remoteSession.GetConditioner().SetConditions(rLink.GetLatencyMs(), rLink.GetJitterMs(), rLink.GetLossPercent());
+                 ImGui::Text("Remote tick %u  State hash %016llx", remoteMatch.GetTick(), (unsigned long long)remoteMatch.GetStateHash());
+             }
+             if (!replay.IsOpen() && !recorder.IsRecording() && !rollbackPlay)
+             {
+                 bool enable = serverPlay;
+                 if (ImGui::Checkbox(IM_HASHED("Loopback server play (IJKL + space)"), &enable))
+                 {
+                     if (enable && server.Open(NET_LOOPBACK, 0))
+                     {
+                         NetAddress address = { NET_LOOPBACK, server.GetLocalAddress().port };
+                         enable = client.Open(address);
+                     }
+                     else
+                     {
+                         enable = false;
+                     }
+                     if (!enable)
+                     {
+                         // the next session starts from kickoff on a server without clients
+                         client.Disconnect();
+                         serverMatch.LoadState(&serverStartState[0], serverStartState.size());
+                         server.Close();
+                     }
+                 }
+                 serverPlay = enable;
+             }
+             if (serverPlay)
+             {
+                 // the client's conditions apply to both directions
+                 const LinkConditioner& rLink = client.GetConditioner();
+                 server.GetConditioner().SetConditions(rLink.GetLatencyMs(), rLink.GetJitterMs(), rLink.GetLossPercent());
+                 ImGui::Text("Server tick %u  Clients %u", serverMatch.GetTick(), server.GetClientCount());
+             }
+
+             ImGui::Text("REPLAY");
+             if (rollbackPlay || serverPlay)
+             {
+                 ImGui::Text("Unavailable during network play");
+             }
+             else if (recorder.IsRecording())
+             {
+                 ImGui::Text("Recording: %u ticks, %.1f KB", recorder.GetTickCount(), recorder.GetBytesWritten() / 1024.0f);
+                 if (ImGui::Button(IM_HASHED("Stop recording")))
+                     recorder.End();
+             }
+             else if (replay.IsOpen())
+             {
+                 int tick = (int)match.GetTick();
+                 if (ImGui::SliderInt(IM_HASHED("Replay tick"), &tick, (int)replay.GetFirstTick(), (int)replay.GetEndTick()))
+                     replay.Seek(match, (unsigned int)tick, workerPool);
+                 if (ImGui::Button(IM_HASHED("Stop replay")))
+                     replay.Close();
+             }
+             else
+             {
+                 if (ImGui::Button(IM_HASHED("Record replay")))
+                     recorder.Begin(REPLAY_FILE, match);
+                 ImGui::SameLine();
+                 if (ImGui::Button(IM_HASHED("Play replay")) && replay.Open(REPLAY_FILE))
+                     replay.Seek(match, replay.GetFirstTick(), workerPool);
+             }
+
 
 
 
          }
+        ShowPhysicsDebugWindow(world, physicsSteps, subStepsThisFrame);
+        ShowRagdollDebugWindow(ragdolls);
+        ShowClothDebugWindow(nets, netsUploaded);
+        if (rollbackPlay)
+            ShowRollbackDebugWindow(localSession);
+        if (serverPlay)
+            ShowPredictionDebugWindow(client);
+        uiBenchmark.ShowResultsWindow();
+        uiBenchmark.ShowStressWindows();
         glUniform4f(uniformLocation, color.x, color.y, color.z, 1.0f);
 
-        ImGui::Render();
-        ImGui_ImplGlfwGL3_RenderDrawData(ImGui::GetDrawData());
         int display_w, display_h;
         glfwGetFramebufferSize(window, &display_w, &display_h);
+        const UiRenderBenchmark::Mode uiMode = uiBenchmark.GetMode();
+        ImGui_ImplGlfwGL3_SetRenderFlags(uiMode == UiRenderBenchmark::MODE_REFERENCE ? ImGui_ImplGlfwGL3_RenderFlags_None : ImGui_ImplGlfwGL3_RenderFlags_Batched);
+        ImGui_ImplGlfwGL3_SetHostState(uiMode == UiRenderBenchmark::MODE_BATCHED_HOST_STATE ? &uiHostState : NULL);
+
+        ImGui::Render();
+        const std::chrono::steady_clock::time_point uiStart = std::chrono::steady_clock::now();
+        ImGui_ImplGlfwGL3_RenderDrawData(ImGui::GetDrawData());
+        uiBenchmark.AddFrame(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - uiStart).count());
 
 
         glViewport(0, 0, display_w, display_h);
@@ -346,6 +669,8 @@ int main()
     ImGui::DestroyContext();
     glDeleteVertexArrays(1, &VAO2);
     glDeleteBuffers(1, &VBO2);
+    glDeleteVertexArrays(1, &netVAO);
+    glDeleteBuffers(1, &netEBO);
     // glfw: terminate, clearing all previously allocated GLFW resources.
     // ------------------------------------------------------------------
     glfwTerminate();
@@ -390,6 +715,23 @@ void processInput(GLFWwindow *window)
     //cout << "(x = "<<g_TranslateX <<", y = " <<g_TranslateY << ", r = " <<g_Rotate << ", p = " <<g_Projection <<")"<<endl;
 }
 
+// the networked player runs with IJKL and charges the ball with space
+PlayerInput readPlayerInput(GLFWwindow *window)
+{
+    PlayerInput input = PlayerInput();
+    if (glfwGetKey(window, GLFW_KEY_J) == GLFW_PRESS)
+        input.moveX -= 127;
+    if (glfwGetKey(window, GLFW_KEY_L) == GLFW_PRESS)
+        input.moveX += 127;
+    if (glfwGetKey(window, GLFW_KEY_I) == GLFW_PRESS)
+        input.moveZ -= 127;
+    if (glfwGetKey(window, GLFW_KEY_K) == GLFW_PRESS)
+        input.moveZ += 127;
+    if (glfwGetKey(window, GLFW_KEY_SPACE) == GLFW_PRESS)
+        input.buttons |= BUTTON_CHARGE;
+    return input;
+}
+
 // glfw: whenever the window size changed (by OS or user resize) this callback function executes
 // ---------------------------------------------------------------------------------------------
 void framebuffer_size_callback(GLFWwindow* window, int width, int height)
@@ -0,0 +1,569 @@
+#include "BatchedUdpSocket.h"
+
+#include <cerrno>
+#include <cstring>
+
+#ifdef __linux__
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#if defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+#endif
+#endif
+
+// io_uring is used through its system calls directly; liburing is not needed.
+#if defined(__linux__) && defined(IORING_OFF_SQ_RING) && defined(__NR_io_uring_setup)
+#define DEATHBALL_IO_URING 1
+#else
+#define DEATHBALL_IO_URING 0
+#endif
+
+namespace
+{
+#ifdef __linux__
+    sockaddr_in ToSockAddr(const NetAddress& rAddress)
+    {
+        sockaddr_in address;
+        std::memset(&address, 0, sizeof(address));
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(rAddress.ip);
+        address.sin_port = htons(rAddress.port);
+        return address;
+    }
+
+    NetAddress FromSockAddr(const sockaddr_in& rAddress)
+    {
+        NetAddress address;
+        address.ip = ntohl(rAddress.sin_addr.s_addr);
+        address.port = ntohs(rAddress.sin_port);
+        return address;
+    }
+#endif
+
+#if DEATHBALL_IO_URING
+    // Completions of posted receives carry RECEIVE_TAG and the slot, sends the queue index.
+    const uint64_t RECEIVE_TAG = 1ull << 32;
+
+    // The shared submission and completion rings of one io_uring instance.
+    struct Ring
+    {
+        int fd;
+        unsigned char* pSqRing;
+        size_t sqRingBytes;
+        unsigned char* pCqRing;
+        size_t cqRingBytes;
+        io_uring_sqe* pSqes;
+        size_t sqesBytes;
+        unsigned int* pSqHead;
+        unsigned int* pSqTail;
+        unsigned int sqMask;
+        unsigned int sqEntries;
+        unsigned int* pSqArray;
+        unsigned int* pCqHead;
+        unsigned int* pCqTail;
+        unsigned int cqMask;
+        io_uring_cqe* pCqes;
+        unsigned int unsubmitted;
+
+        Ring() : fd(-1), pSqRing(nullptr), pCqRing(nullptr), pSqes(nullptr), unsubmitted(0) {}
+
+        bool Setup(unsigned int entries)
+        {
+            io_uring_params params;
+            std::memset(&params, 0, sizeof(params));
+            fd = (int)syscall(__NR_io_uring_setup, entries, &params);
+            if (fd < 0)
+                return false;
+
+            sqRingBytes = params.sq_off.array + params.sq_entries * sizeof(unsigned int);
+            cqRingBytes = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+            const bool singleMap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+            if (singleMap)
+                sqRingBytes = cqRingBytes = sqRingBytes > cqRingBytes ? sqRingBytes : cqRingBytes;
+
+            void* pSq = mmap(nullptr, sqRingBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+            if (pSq == MAP_FAILED)
+                return false;
+            pSqRing = static_cast<unsigned char*>(pSq);
+            if (singleMap)
+            {
+                pCqRing = pSqRing;
+            }
+            else
+            {
+                void* pCq = mmap(nullptr, cqRingBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+                if (pCq == MAP_FAILED)
+                    return false;
+                pCqRing = static_cast<unsigned char*>(pCq);
+            }
+            sqesBytes = params.sq_entries * sizeof(io_uring_sqe);
+            void* pEntries = mmap(nullptr, sqesBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+            if (pEntries == MAP_FAILED)
+                return false;
+            pSqes = static_cast<io_uring_sqe*>(pEntries);
+
+            pSqHead = reinterpret_cast<unsigned int*>(pSqRing + params.sq_off.head);
+            pSqTail = reinterpret_cast<unsigned int*>(pSqRing + params.sq_off.tail);
+            sqMask = *reinterpret_cast<unsigned int*>(pSqRing + params.sq_off.ring_mask);
+            sqEntries = params.sq_entries;
+            pSqArray = reinterpret_cast<unsigned int*>(pSqRing + params.sq_off.array);
+            pCqHead = reinterpret_cast<unsigned int*>(pCqRing + params.cq_off.head);
+            pCqTail = reinterpret_cast<unsigned int*>(pCqRing + params.cq_off.tail);
+            cqMask = *reinterpret_cast<unsigned int*>(pCqRing + params.cq_off.ring_mask);
+            pCqes = reinterpret_cast<io_uring_cqe*>(pCqRing + params.cq_off.cqes);
+            return true;
+        }
+
+        void Close()
+        {
+            if (pSqes)
+                munmap(pSqes, sqesBytes);
+            if (pCqRing && pCqRing != pSqRing)
+                munmap(pCqRing, cqRingBytes);
+            if (pSqRing)
+                munmap(pSqRing, sqRingBytes);
+            if (fd >= 0)
+                close(fd);
+            fd = -1;
+            pSqRing = pCqRing = nullptr;
+            pSqes = nullptr;
+            unsubmitted = 0;
+        }
+
+        // A cleared entry at the tail, or null when the ring is full.
+        io_uring_sqe* Push(uint8_t opcode, int socket, const msghdr* pMessage, uint64_t userData)
+        {
+            const unsigned int tail = *pSqTail;
+            if (tail - __atomic_load_n(pSqHead, __ATOMIC_ACQUIRE) >= sqEntries)
+                return nullptr;
+            const unsigned int index = tail & sqMask;
+            io_uring_sqe* pEntry = &pSqes[index];
+            std::memset(pEntry, 0, sizeof(*pEntry));
+            pEntry->opcode = opcode;
+            pEntry->fd = socket;
+            pEntry->addr = reinterpret_cast<uint64_t>(pMessage);
+            pEntry->len = 1;
+            pEntry->user_data = userData;
+            pSqArray[index] = index;
+            __atomic_store_n(pSqTail, tail + 1, __ATOMIC_RELEASE);
+            ++unsubmitted;
+            return pEntry;
+        }
+
+        int Enter(unsigned int minComplete)
+        {
+            const unsigned int flags = minComplete > 0 ? IORING_ENTER_GETEVENTS : 0;
+            const int result = (int)syscall(__NR_io_uring_enter, fd, unsubmitted, minComplete, flags, nullptr, 0);
+            if (result > 0)
+                unsubmitted -= (unsigned int)result;
+            return result;
+        }
+
+        bool HasCompletions() const
+        {
+            return *pCqHead != __atomic_load_n(pCqTail, __ATOMIC_ACQUIRE);
+        }
+    };
+#endif
+}
+
+#ifdef __linux__
+struct BatchedUdpSocket::LinuxState
+{
+    std::vector<mmsghdr> receiveMessages;
+    std::vector<mmsghdr> sendMessages;
+    std::vector<iovec> receiveVectors;
+    std::vector<iovec> sendVectors;
+    std::vector<sockaddr_in> receiveAddresses;
+    std::vector<sockaddr_in> sendAddresses;
+#if DEATHBALL_IO_URING
+    Ring ring;
+    std::vector<unsigned int> completed;    // receive slots finished since the last Receive()
+    std::vector<unsigned int> repost;       // receive slots to post again
+    unsigned int sendsInFlight;
+    unsigned int sendsFailed;
+#endif
+};
+
+namespace
+{
+    void PointMessage(mmsghdr& rMessage, iovec& rVector, sockaddr_in& rAddress, unsigned char* pBuffer)
+    {
+        std::memset(&rMessage, 0, sizeof(rMessage));
+        rVector.iov_base = pBuffer;
+        rVector.iov_len = BatchedUdpSocket::MAX_DATAGRAM;
+        rMessage.msg_hdr.msg_name = &rAddress;
+        rMessage.msg_hdr.msg_namelen = sizeof(rAddress);
+        rMessage.msg_hdr.msg_iov = &rVector;
+        rMessage.msg_hdr.msg_iovlen = 1;
+    }
+}
+#else
+struct BatchedUdpSocket::LinuxState
+{
+};
+#endif
+
+BatchedUdpSocket::BatchedUdpSocket(unsigned int batchSize)
+    : m_batchSize(batchSize > 0 ? batchSize : 1),
+      m_backend(UDP_BACKEND_SINGLE),
+      m_queued(0),
+      m_pLinux(nullptr)
+{
+    ResetStats();
+}
+
+BatchedUdpSocket::~BatchedUdpSocket()
+{
+    Close();
+}
+
+const char* BatchedUdpSocket::GetBackendName(UdpBackend backend)
+{
+    switch (backend)
+    {
+    case UDP_BACKEND_MMSG:
+        return "mmsg";
+    case UDP_BACKEND_IO_URING:
+        return "io_uring";
+    default:
+        return "single";
+    }
+}
+
+void BatchedUdpSocket::ResetStats()
+{
+    std::memset(&m_stats, 0, sizeof(m_stats));
+}
+
+bool BatchedUdpSocket::Open(uint32_t ip, uint16_t port, UdpBackend backend)
+{
+    Close();
+
+    m_buffers.assign(2 * m_batchSize * MAX_DATAGRAM, 0);
+    m_receiveSlots.resize(m_batchSize);
+    m_sendSlots.resize(m_batchSize);
+    m_received.reserve(m_batchSize);
+    if (!m_socket.Open(ip, port))
+        return false;
+    m_backend = backend;
+    if (backend == UDP_BACKEND_SINGLE)
+        return true;
+
+#ifdef __linux__
+    m_pLinux = new LinuxState;
+    LinuxState& rState = *m_pLinux;
+    rState.receiveMessages.resize(m_batchSize);
+    rState.sendMessages.resize(m_batchSize);
+    rState.receiveVectors.resize(m_batchSize);
+    rState.sendVectors.resize(m_batchSize);
+    rState.receiveAddresses.resize(m_batchSize);
+    rState.sendAddresses.resize(m_batchSize);
+    for (unsigned int i = 0; i < m_batchSize; ++i)
+    {
+        PointMessage(rState.receiveMessages[i], rState.receiveVectors[i], rState.receiveAddresses[i], ReceiveBuffer(i));
+        PointMessage(rState.sendMessages[i], rState.sendVectors[i], rState.sendAddresses[i], SendBuffer(i));
+    }
+    if (backend == UDP_BACKEND_MMSG)
+        return true;
+
+#if DEATHBALL_IO_URING
+    rState.completed.reserve(m_batchSize);
+    rState.repost.reserve(m_batchSize);
+    rState.sendsInFlight = 0;
+    rState.sendsFailed = 0;
+    const int descriptor = m_socket.GetDescriptor();
+    if (rState.ring.Setup(2 * m_batchSize)
+        && fcntl(descriptor, F_SETFL, fcntl(descriptor, F_GETFL, 0) & ~O_NONBLOCK) == 0)
+    {
+        for (unsigned int slot = 0; slot < m_batchSize; ++slot)
+            rState.ring.Push(IORING_OP_RECVMSG, descriptor, &rState.receiveMessages[slot].msg_hdr, RECEIVE_TAG | slot);
+        ++m_stats.systemCalls;
+        if (rState.ring.Enter(0) == (int)m_batchSize)
+            return true;
+    }
+#endif
+#endif
+    Close();
+    return false;
+}
+
+void BatchedUdpSocket::Close()
+{
+#ifdef __linux__
+    if (m_pLinux)
+    {
+#if DEATHBALL_IO_URING
+        // closing the ring cancels the posted receives before their buffers go
+        m_pLinux->ring.Close();
+#endif
+        delete m_pLinux;
+        m_pLinux = nullptr;
+    }
+#endif
+    m_socket.Close();
+    m_received.clear();
+    m_queued = 0;
+}
+
+unsigned int BatchedUdpSocket::Receive()
+{
+    m_received.clear();
+    if (!IsOpen())
+        return 0;
+
+    switch (m_backend)
+    {
+    case UDP_BACKEND_SINGLE:
+        for (unsigned int slot = 0; slot < m_batchSize; ++slot)
+        {
+            NetAddress from;
+            const int size = m_socket.Receive(ReceiveBuffer(slot), MAX_DATAGRAM, from);
+            ++m_stats.systemCalls;
+            if (size < 0)
+                break;
+            m_receiveSlots[slot].address = from;
+            m_receiveSlots[slot].size = (unsigned int)size;
+            m_received.push_back(slot);
+        }
+        break;
+
+#ifdef __linux__
+    case UDP_BACKEND_MMSG:
+    {
+        LinuxState& rState = *m_pLinux;
+        for (unsigned int slot = 0; slot < m_batchSize; ++slot)
+            rState.receiveMessages[slot].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+        const int count = recvmmsg(m_socket.GetDescriptor(), &rState.receiveMessages[0], m_batchSize, MSG_DONTWAIT, nullptr);
+        ++m_stats.systemCalls;
+        for (int slot = 0; slot < count; ++slot)
+        {
+            m_receiveSlots[slot].address = FromSockAddr(rState.receiveAddresses[slot]);
+            m_receiveSlots[slot].size = rState.receiveMessages[slot].msg_len;
+            m_received.push_back((unsigned int)slot);
+        }
+        break;
+    }
+
+#if DEATHBALL_IO_URING
+    case UDP_BACKEND_IO_URING:
+    {
+        LinuxState& rState = *m_pLinux;
+        Ring& rRing = rState.ring;
+
+        // the previous batch has been read, its buffers go back to the kernel
+        const int descriptor = m_socket.GetDescriptor();
+        for (unsigned int i = 0; i < rState.repost.size(); ++i)
+        {
+            const unsigned int slot = rState.repost[i];
+            rState.receiveMessages[slot].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+            rRing.Push(IORING_OP_RECVMSG, descriptor, &rState.receiveMessages[slot].msg_hdr, RECEIVE_TAG | slot);
+        }
+        rState.repost.clear();
+        if (rRing.unsubmitted > 0)
+        {
+            rRing.Enter(0);
+            ++m_stats.systemCalls;
+        }
+
+        ReapCompletions();
+
+        m_received.swap(rState.completed);
+        rState.completed.clear();
+        rState.repost.insert(rState.repost.end(), m_received.begin(), m_received.end());
+        break;
+    }
+#endif
+#endif
+
+    default:
+        break;
+    }
+
+    m_stats.packetsReceived += m_received.size();
+    return (unsigned int)m_received.size();
+}
+
+#if DEATHBALL_IO_URING
+void BatchedUdpSocket::ReapCompletions()
+{
+    LinuxState& rState = *m_pLinux;
+    Ring& rRing = rState.ring;
+    unsigned int head = *rRing.pCqHead;
+    const unsigned int tail = __atomic_load_n(rRing.pCqTail, __ATOMIC_ACQUIRE);
+    for (; head != tail; ++head)
+    {
+        const io_uring_cqe& rEntry = rRing.pCqes[head & rRing.cqMask];
+        if (!(rEntry.user_data & RECEIVE_TAG))
+        {
+            --rState.sendsInFlight;
+            if (rEntry.res < 0)
+                ++rState.sendsFailed;
+            continue;
+        }
+
+        // a failed receive is posted again with the next batch
+        const unsigned int slot = (unsigned int)(rEntry.user_data & 0xFFFFFFFFu);
+        if (rEntry.res >= 0)
+        {
+            m_receiveSlots[slot].address = FromSockAddr(rState.receiveAddresses[slot]);
+            m_receiveSlots[slot].size = (unsigned int)rEntry.res;
+            rState.completed.push_back(slot);
+        }
+        else
+        {
+            rState.repost.push_back(slot);
+        }
+    }
+    __atomic_store_n(rRing.pCqHead, head, __ATOMIC_RELEASE);
+}
+#endif
+
+const unsigned char* BatchedUdpSocket::GetReceived(unsigned int index, unsigned int& rSize, NetAddress& rFrom) const
+{
+    const unsigned int slot = m_received[index];
+    rSize = m_receiveSlots[slot].size;
+    rFrom = m_receiveSlots[slot].address;
+    return &m_buffers[slot * MAX_DATAGRAM];
+}
+
+bool BatchedUdpSocket::Wait(unsigned int timeoutMs)
+{
+#if DEATHBALL_IO_URING
+    if (m_backend == UDP_BACKEND_IO_URING && m_pLinux)
+    {
+        // the ring's descriptor becomes readable with completions waiting
+        if (m_pLinux->ring.HasCompletions())
+            return true;
+        pollfd ring;
+        ring.fd = m_pLinux->ring.fd;
+        ring.events = POLLIN;
+        ring.revents = 0;
+        return poll(&ring, 1, (int)timeoutMs) > 0;
+    }
+#endif
+    return m_socket.Wait(timeoutMs);
+}
+
+void BatchedUdpSocket::Send(const NetAddress& rTo, const void* pData, unsigned int size)
+{
+    if (size > MAX_DATAGRAM)
+    {
+        ++m_stats.sendFailures;
+        return;
+    }
+    if (m_queued == m_batchSize)
+        Flush();
+
+    m_sendSlots[m_queued].address = rTo;
+    m_sendSlots[m_queued].size = size;
+    m_sendSlots[m_queued].pData = SendBuffer(m_queued);
+    std::memcpy(SendBuffer(m_queued), pData, size);
+    ++m_queued;
+}
+
+void BatchedUdpSocket::SendShared(const NetAddress& rTo, const void* pData, unsigned int size)
+{
+    if (size > MAX_DATAGRAM)
+    {
+        ++m_stats.sendFailures;
+        return;
+    }
+    if (m_queued == m_batchSize)
+        Flush();
+
+    m_sendSlots[m_queued].address = rTo;
+    m_sendSlots[m_queued].size = size;
+    m_sendSlots[m_queued].pData = static_cast<const unsigned char*>(pData);
+    ++m_queued;
+}
+
+unsigned int BatchedUdpSocket::Flush()
+{
+    const unsigned int queued = m_queued;
+    m_queued = 0;
+    if (queued == 0 || !IsOpen())
+        return 0;
+
+    unsigned int sent = 0;
+    switch (m_backend)
+    {
+#ifdef __linux__
+    case UDP_BACKEND_MMSG:
+    {
+        LinuxState& rState = *m_pLinux;
+        for (unsigned int i = 0; i < queued; ++i)
+        {
+            rState.sendAddresses[i] = ToSockAddr(m_sendSlots[i].address);
+            rState.sendVectors[i].iov_base = const_cast<unsigned char*>(m_sendSlots[i].pData);
+            rState.sendVectors[i].iov_len = m_sendSlots[i].size;
+        }
+        while (sent < queued)
+        {
+            const int count = sendmmsg(m_socket.GetDescriptor(), &rState.sendMessages[sent], queued - sent, 0);
+            ++m_stats.systemCalls;
+            if (count <= 0)
+                break;
+            sent += (unsigned int)count;
+        }
+        break;
+    }
+
+#if DEATHBALL_IO_URING
+    case UDP_BACKEND_IO_URING:
+    {
+        LinuxState& rState = *m_pLinux;
+        Ring& rRing = rState.ring;
+        const int descriptor = m_socket.GetDescriptor();
+        unsigned int posted = 0;
+        for (; posted < queued; ++posted)
+        {
+            rState.sendAddresses[posted] = ToSockAddr(m_sendSlots[posted].address);
+            rState.sendVectors[posted].iov_base = const_cast<unsigned char*>(m_sendSlots[posted].pData);
+            rState.sendVectors[posted].iov_len = m_sendSlots[posted].size;
+            if (!rRing.Push(IORING_OP_SENDMSG, descriptor, &rState.sendMessages[posted].msg_hdr, posted))
+                break;
+        }
+        rState.sendsInFlight = posted;
+        rState.sendsFailed = 0;
+
+        // the send buffers are reused by the next batch, so wait for every
+        // send; receives finishing meanwhile are kept for the next Receive()
+        unsigned int waitFor = posted;
+        while (rState.sendsInFlight > 0)
+        {
+            ++m_stats.systemCalls;
+            if (rRing.Enter(waitFor) < 0 && errno != EINTR)
+                break;
+            ReapCompletions();
+            waitFor = 1;
+        }
+        sent = posted - rState.sendsFailed;
+        break;
+    }
+#endif
+#endif
+
+    default:
+        for (unsigned int i = 0; i < queued; ++i)
+        {
+            ++m_stats.systemCalls;
+            if (m_socket.Send(m_sendSlots[i].address, m_sendSlots[i].pData, m_sendSlots[i].size))
+                ++sent;
+        }
+        break;
+    }
+
+    m_stats.packetsSent += sent;
+    m_stats.sendFailures += queued - sent;
+    return sent;
+}
@@ -0,0 +1,138 @@
+#pragma once
+
+#include "UdpSocket.h"
+
+#include <cstdint>
+#include <vector>
+
+enum UdpBackend
+{
+    UDP_BACKEND_SINGLE,     // one recvfrom/sendto per datagram, on every platform
+    UDP_BACKEND_MMSG,       // recvmmsg/sendmmsg, one system call per batch (Linux)
+    UDP_BACKEND_IO_URING    // receives stay posted in an io_uring, sends go as one submission (Linux)
+};
+
+struct UdpBatchStats
+{
+    uint64_t packetsReceived;
+    uint64_t packetsSent;
+    uint64_t sendFailures;
+    uint64_t systemCalls;
+};
+
+// A UdpSocket that moves datagrams in batches, for servers whose time would
+// otherwise go into one system call per packet. Receive() fills a batch of
+// preallocated buffers that stay valid until the next Receive(); Send()
+// copies into a preallocated send queue that Flush() hands to the kernel
+// at once, and SendShared() queues the caller's buffer as it is. Every
+// buffer is allocated in Open(), none per packet.
+//
+// With io_uring every receive buffer has a receive posted in the ring and
+// the kernel fills them as datagrams arrive; Receive() collects the finished
+// ones and posts the previous batch again. The ring takes over the socket,
+// so it is switched to blocking mode and GetSocket().Receive() must not be
+// used with that backend.
+class BatchedUdpSocket
+{
+public:
+    static const unsigned int MAX_DATAGRAM = 1472;
+
+    explicit BatchedUdpSocket(unsigned int batchSize = 64);
+    ~BatchedUdpSocket();
+
+    // Fails when the backend is not supported here, e.g. io_uring in a
+    // kernel or sandbox that does not allow it.
+    bool Open(uint32_t ip, uint16_t port, UdpBackend backend);
+    void Close();
+
+    bool IsOpen() const
+    {
+        return m_socket.IsOpen();
+    }
+
+    UdpBackend GetBackend() const
+    {
+        return m_backend;
+    }
+
+    NetAddress GetLocalAddress() const
+    {
+        return m_socket.GetLocalAddress();
+    }
+
+    // The plain socket, for single sends such as a LinkConditioner's.
+    UdpSocket& GetSocket()
+    {
+        return m_socket;
+    }
+
+    // Collects up to the batch size of waiting datagrams and returns how many.
+    unsigned int Receive();
+    const unsigned char* GetReceived(unsigned int index, unsigned int& rSize, NetAddress& rFrom) const;
+
+    // Blocks until datagrams are waiting or timeoutMs passed.
+    bool Wait(unsigned int timeoutMs);
+
+    // Queues a copy of the datagram, flushing first when the queue is full.
+    void Send(const NetAddress& rTo, const void* pData, unsigned int size);
+
+    // Queues the datagram without copying it, for one buffer fanned out to
+    // many addresses. pData must stay unchanged until the next Flush().
+    void SendShared(const NetAddress& rTo, const void* pData, unsigned int size);
+
+    // Sends the queue and returns how many datagrams the kernel took.
+    unsigned int Flush();
+
+    unsigned int GetQueuedCount() const
+    {
+        return m_queued;
+    }
+
+    const UdpBatchStats& GetStats() const
+    {
+        return m_stats;
+    }
+
+    void ResetStats();
+
+    static const char* GetBackendName(UdpBackend backend);
+
+private:
+    BatchedUdpSocket(const BatchedUdpSocket&);
+    BatchedUdpSocket& operator=(const BatchedUdpSocket&);
+
+    struct Slot
+    {
+        NetAddress address;
+        unsigned int size;
+        const unsigned char* pData;    // a send buffer, or the caller's for SendShared()
+    };
+
+    // Kernel structures of the Linux backends, kept out of this header.
+    struct LinuxState;
+
+    // Takes the io_uring completions: finished receives join the next
+    // Receive(), finished sends are counted off.
+    void ReapCompletions();
+
+    unsigned char* ReceiveBuffer(unsigned int slot)
+    {
+        return &m_buffers[slot * MAX_DATAGRAM];
+    }
+
+    unsigned char* SendBuffer(unsigned int slot)
+    {
+        return &m_buffers[(m_batchSize + slot) * MAX_DATAGRAM];
+    }
+
+    unsigned int m_batchSize;
+    UdpBackend m_backend;
+    UdpSocket m_socket;
+    std::vector<unsigned char> m_buffers;    // batchSize receive buffers, then batchSize send buffers
+    std::vector<Slot> m_receiveSlots;
+    std::vector<Slot> m_sendSlots;
+    std::vector<unsigned int> m_received;    // receive slots of the current batch, in arrival order
+    unsigned int m_queued;
+    LinuxState* m_pLinux;
+    UdpBatchStats m_stats;
+};
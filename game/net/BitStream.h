@@ -0,0 +1,133 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// Packs values of any width up to 32 bits back to back, least significant
+// bit first. Bits gather in a 64-bit scratch word that is stored 32 bits at a
+// time, so a write is a shift, an or and at most one store. Running out of
+// space sets the overflow flag instead of writing past the buffer.
+class BitWriter
+{
+public:
+    BitWriter(unsigned char* pOut, size_t capacity)
+        : m_pOut(pOut), m_capacity(capacity & ~(size_t)3), m_scratch(0), m_scratchBits(0), m_bytes(0), m_overflow(false)
+    {
+    }
+
+    void Write(uint32_t value, unsigned int bits)
+    {
+        m_scratch |= (uint64_t)(value & (bits < 32 ? (1u << bits) - 1u : 0xFFFFFFFFu)) << m_scratchBits;
+        m_scratchBits += bits;
+        if (m_scratchBits >= 32)
+        {
+            StoreWord();
+            m_scratch >>= 32;
+            m_scratchBits -= 32;
+        }
+    }
+
+    void WriteBool(bool value)
+    {
+        Write(value ? 1u : 0u, 1);
+    }
+
+    // Stores the partial last word; GetBytes() is final afterwards.
+    void Flush()
+    {
+        if (m_scratchBits > 0)
+        {
+            StoreWord();
+            m_scratch = 0;
+            m_scratchBits = 0;
+        }
+    }
+
+    size_t GetBitCount() const
+    {
+        return m_bytes * 8 + m_scratchBits;
+    }
+
+    size_t GetBytes() const
+    {
+        return m_bytes;
+    }
+
+    bool HasOverflowed() const
+    {
+        return m_overflow;
+    }
+
+private:
+    void StoreWord()
+    {
+        if (m_bytes + 4 > m_capacity)
+        {
+            m_overflow = true;
+            return;
+        }
+        const uint32_t word = (uint32_t)m_scratch;
+        std::memcpy(m_pOut + m_bytes, &word, 4);
+        m_bytes += 4;
+    }
+
+    unsigned char* m_pOut;
+    size_t m_capacity;
+    uint64_t m_scratch;
+    unsigned int m_scratchBits;
+    size_t m_bytes;
+    bool m_overflow;
+};
+
+// Reads what BitWriter wrote. Reading past the end yields zeros and sets the
+// overflow flag, so a truncated packet is detected once at the end.
+class BitReader
+{
+public:
+    BitReader(const unsigned char* pIn, size_t size)
+        : m_pIn(pIn), m_size(size & ~(size_t)3), m_scratch(0), m_scratchBits(0), m_offset(0), m_overflow(false)
+    {
+    }
+
+    uint32_t Read(unsigned int bits)
+    {
+        if (m_scratchBits < bits)
+        {
+            uint32_t word = 0;
+            if (m_offset + 4 <= m_size)
+            {
+                std::memcpy(&word, m_pIn + m_offset, 4);
+                m_offset += 4;
+            }
+            else
+            {
+                m_overflow = true;
+            }
+            m_scratch |= (uint64_t)word << m_scratchBits;
+            m_scratchBits += 32;
+        }
+        const uint32_t value = (uint32_t)(m_scratch & (bits < 32 ? (1u << bits) - 1u : 0xFFFFFFFFu));
+        m_scratch >>= bits;
+        m_scratchBits -= bits;
+        return value;
+    }
+
+    bool ReadBool()
+    {
+        return Read(1) != 0;
+    }
+
+    bool HasOverflowed() const
+    {
+        return m_overflow;
+    }
+
+private:
+    const unsigned char* m_pIn;
+    size_t m_size;
+    uint64_t m_scratch;
+    unsigned int m_scratchBits;
+    size_t m_offset;
+    bool m_overflow;
+};
@@ -0,0 +1,220 @@
+#include "BotClient.h"
+#include "../core/Histogram.h"
+
+#include <cstring>
+
+namespace
+{
+    const double CONNECT_RETRY_MS = 250.0;
+
+    // A new direction every half second on average, a charge every few seconds.
+    const unsigned int TURN_CHANCE = 30;
+    const unsigned int CHARGE_CHANCE = 240;
+}
+
+BotClient::BotClient(unsigned int seed)
+    : m_random(seed * 2654435761u | 1u),
+      m_player(SERVER_NO_PLAYER),
+      m_rejected(false),
+      m_nextSendMs(0.0),
+      m_tickMs(1000.0 / Match::TICK_RATE),
+      m_sequence(0),
+      m_input(),
+      m_pControl(nullptr),
+      m_pLatency(nullptr),
+      m_ackedSequence(NO_INPUT_SEQUENCE),
+      m_codec(CreateMatchCodec()),
+      m_history(SNAPSHOT_ENTITY_COUNT, SNAPSHOT_HISTORY),
+      m_decoded(SNAPSHOT_ENTITY_COUNT),
+      m_snapshotsReceived(0),
+      m_decodeFailures(0),
+      m_lastSnapshotTick(NO_SNAPSHOT_TICK),
+      m_lastSnapshotMs(0.0),
+      m_lateSnapshots(0),
+      m_bytesSent(0),
+      m_bytesReceived(0),
+      m_packet(SERVER_MAX_PACKET)
+{
+    std::memset(m_inputs, 0, sizeof(m_inputs));
+    std::memset(m_sendMs, 0, sizeof(m_sendMs));
+}
+
+bool BotClient::Open(const NetAddress& rServer)
+{
+    m_server = rServer;
+    m_player = SERVER_NO_PLAYER;
+    m_rejected = false;
+    m_nextSendMs = 0.0;
+    m_sequence = 0;
+    m_ackedSequence = NO_INPUT_SEQUENCE;
+    m_lastSnapshotTick = NO_SNAPSHOT_TICK;
+    m_history.Clear();
+    return m_socket.Open(0, 0);
+}
+
+void BotClient::Disconnect()
+{
+    if (IsConnected())
+    {
+        PacketHeader header = { SERVER_PACKET_MAGIC, PACKET_DISCONNECT, (uint8_t)m_player, 0 };
+        Send(&header, sizeof(header));
+    }
+    m_player = SERVER_NO_PLAYER;
+    m_socket.Close();
+}
+
+void BotClient::Update(double nowMs)
+{
+    if (!m_socket.IsOpen() || m_rejected)
+        return;
+
+    ReceivePackets(nowMs);
+    if (nowMs < m_nextSendMs)
+        return;
+
+    if (!IsConnected())
+    {
+        PacketHeader header = { SERVER_PACKET_MAGIC, PACKET_CONNECT, SERVER_NO_PLAYER, 0 };
+        Send(&header, sizeof(header));
+        m_nextSendMs = nowMs + CONNECT_RETRY_MS;
+        return;
+    }
+
+    SendInput(nowMs);
+    // keep the cadence, but do not burst to catch up after a long stall
+    m_nextSendMs += m_tickMs;
+    if (m_nextSendMs < nowMs)
+        m_nextSendMs = nowMs + m_tickMs;
+}
+
+void BotClient::ReceivePackets(double nowMs)
+{
+    NetAddress from;
+    int size;
+    while ((size = m_socket.Receive(&m_packet[0], m_packet.size(), from)) >= 0)
+    {
+        m_bytesReceived += size;
+        if (!(from == m_server) || size < (int)sizeof(PacketHeader))
+            continue;
+
+        PacketHeader header;
+        std::memcpy(&header, &m_packet[0], sizeof(header));
+        if (header.magic != SERVER_PACKET_MAGIC)
+            continue;
+
+        if (header.type == PACKET_ACCEPT && size >= (int)sizeof(AcceptPacket))
+        {
+            AcceptPacket accept;
+            std::memcpy(&accept, &m_packet[0], sizeof(accept));
+            // a malformed accept is ignored like a lost one: the connect is sent again
+            if (!IsConnected() && header.player < Match::PLAYER_COUNT && accept.tickRate > 0)
+            {
+                m_player = header.player;
+                m_tickMs = 1000.0 / accept.tickRate;
+                m_nextSendMs = 0.0;
+            }
+        }
+        else if (header.type == PACKET_REJECT)
+        {
+            m_rejected = true;
+        }
+        else if (header.type == PACKET_SNAPSHOT && size >= (int)sizeof(SnapshotHeader))
+        {
+            HandleSnapshot((unsigned int)size, nowMs);
+        }
+        else if (header.type == PACKET_DISCONNECT)
+        {
+            m_player = SERVER_NO_PLAYER;
+        }
+    }
+}
+
+void BotClient::HandleSnapshot(unsigned int size, double nowMs)
+{
+    SnapshotHeader header;
+    std::memcpy(&header, &m_packet[0], sizeof(header));
+
+    // an older snapshot arriving late is of no use any more
+    if (m_lastSnapshotTick != NO_SNAPSHOT_TICK && header.tick <= m_lastSnapshotTick)
+        return;
+
+    const NetEntity* pBaseline = 0;
+    if (header.baselineTick != NO_SNAPSHOT_TICK)
+    {
+        pBaseline = m_history.Find(header.baselineTick);
+        if (!pBaseline)
+        {
+            ++m_decodeFailures;
+            return;
+        }
+    }
+    if (!m_codec.Decode(&m_packet[sizeof(header)], size - sizeof(header), pBaseline, &m_decoded[0]))
+    {
+        ++m_decodeFailures;
+        return;
+    }
+
+    std::memcpy(m_history.Store(header.tick), &m_decoded[0], m_decoded.size() * sizeof(NetEntity));
+    if (m_lastSnapshotTick != NO_SNAPSHOT_TICK &&
+        nowMs - m_lastSnapshotMs > (header.tick - m_lastSnapshotTick + 1) * m_tickMs)
+        ++m_lateSnapshots;
+    ++m_snapshotsReceived;
+    m_lastSnapshotTick = header.tick;
+    m_lastSnapshotMs = nowMs;
+
+    const uint32_t acked = header.inputSequence;
+    if (acked != NO_INPUT_SEQUENCE && acked < m_sequence && acked + SEND_TIMES > m_sequence &&
+        (m_ackedSequence == NO_INPUT_SEQUENCE || acked > m_ackedSequence))
+    {
+        if (m_pLatency)
+            m_pLatency->Add((float)(nowMs - m_sendMs[acked % SEND_TIMES]));
+        m_ackedSequence = acked;
+    }
+}
+
+void BotClient::SendInput(double nowMs)
+{
+    std::memmove(m_inputs, m_inputs + 1, (INPUT_REDUNDANCY - 1) * sizeof(PlayerInput));
+    m_inputs[INPUT_REDUNDANCY - 1] = NextInput();
+
+    InputPacket packet;
+    packet.header.magic = SERVER_PACKET_MAGIC;
+    packet.header.type = PACKET_INPUT;
+    packet.header.player = (uint8_t)m_player;
+    packet.header.reserved = 0;
+    packet.sequence = m_sequence;
+    packet.ackTick = m_lastSnapshotTick;
+    packet.viewTick = m_lastSnapshotTick;
+    packet.viewFraction = 0;
+    packet.reserved = 0;
+    packet.count = m_sequence + 1 < INPUT_REDUNDANCY ? m_sequence + 1 : INPUT_REDUNDANCY;
+    std::memcpy(packet.inputs, m_inputs + INPUT_REDUNDANCY - packet.count, packet.count * sizeof(PlayerInput));
+    std::memset(packet.inputs + packet.count, 0, (INPUT_REDUNDANCY - packet.count) * sizeof(PlayerInput));
+    Send(&packet, sizeof(packet));
+    m_sendMs[m_sequence % SEND_TIMES] = nowMs;
+    ++m_sequence;
+}
+
+void BotClient::Send(const void* pData, unsigned int size)
+{
+    if (m_socket.Send(m_server, pData, size))
+        m_bytesSent += size;
+}
+
+PlayerInput BotClient::NextInput()
+{
+    if (m_pControl)
+        return m_pControl->Poll(m_sequence);
+
+    m_random ^= m_random << 13;
+    m_random ^= m_random >> 17;
+    m_random ^= m_random << 5;
+
+    if (m_random % TURN_CHANCE == 0)
+    {
+        m_input.moveX = (signed char)((int)((m_random >> 8) & 0xFF) % 255 - 127);
+        m_input.moveZ = (signed char)((int)((m_random >> 16) & 0xFF) % 255 - 127);
+    }
+    m_input.buttons = (m_random >> 24) % CHARGE_CHANCE == 0 ? BUTTON_CHARGE : 0;
+    return m_input;
+}
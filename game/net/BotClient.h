@@ -0,0 +1,135 @@
+#pragma once
+
+#include "../IControl.h"
+#include "ServerProtocol.h"
+#include "SnapshotCodec.h"
+#include "UdpSocket.h"
+
+#include <cstdint>
+#include <vector>
+
+class LatencyHistogram;
+
+// Headless stand-in for a player's game: connects to a GameServer, sends a
+// wandering input (or an IControl's) once per server tick and decodes the
+// snapshots it gets back, acknowledging the newest as the baseline for the
+// next.
+class BotClient
+{
+public:
+    explicit BotClient(unsigned int seed);
+
+    // Binds a local socket and starts connecting to rServer.
+    bool Open(const NetAddress& rServer);
+    void Disconnect();
+
+    // Call often, at least once per server tick.
+    void Update(double nowMs);
+
+    // Inputs come from pControl, polled with the input number, instead of
+    // wandering at random. The control must outlive the bot.
+    void SetControl(IControl* pControl)
+    {
+        m_pControl = pControl;
+    }
+
+    // Every snapshot acknowledging a newer input adds the time since that
+    // input was sent. Many bots may share one; null for none.
+    void SetLatencyHistogram(LatencyHistogram* pHistogram)
+    {
+        m_pLatency = pHistogram;
+    }
+
+    bool IsConnected() const
+    {
+        return m_player != SERVER_NO_PLAYER;
+    }
+
+    bool WasRejected() const
+    {
+        return m_rejected;
+    }
+
+    unsigned int GetPlayer() const
+    {
+        return m_player;
+    }
+
+    unsigned int GetSnapshotsReceived() const
+    {
+        return m_snapshotsReceived;
+    }
+
+    uint32_t GetLastSnapshotTick() const
+    {
+        return m_lastSnapshotTick;
+    }
+
+    uint32_t GetInputsSent() const
+    {
+        return m_sequence;
+    }
+
+    // Snapshots arriving over a tick later than the ticks between them
+    // allow, as when the server falls behind.
+    unsigned int GetLateSnapshots() const
+    {
+        return m_lateSnapshots;
+    }
+
+    // Snapshots dropped as malformed or coded against a baseline no longer held.
+    unsigned int GetDecodeFailures() const
+    {
+        return m_decodeFailures;
+    }
+
+    uint64_t GetBytesSent() const
+    {
+        return m_bytesSent;
+    }
+
+    uint64_t GetBytesReceived() const
+    {
+        return m_bytesReceived;
+    }
+
+private:
+    BotClient(const BotClient&);
+    BotClient& operator=(const BotClient&);
+
+    static const unsigned int SEND_TIMES = 64;
+
+    void ReceivePackets(double nowMs);
+    void HandleSnapshot(unsigned int size, double nowMs);
+    void SendInput(double nowMs);
+    void Send(const void* pData, unsigned int size);
+    PlayerInput NextInput();
+
+    UdpSocket m_socket;
+    NetAddress m_server;
+    unsigned int m_random;
+    unsigned int m_player;
+    bool m_rejected;
+    double m_nextSendMs;
+    double m_tickMs;
+
+    uint32_t m_sequence;
+    PlayerInput m_inputs[INPUT_REDUNDANCY];
+    PlayerInput m_input;
+    IControl* m_pControl;
+    LatencyHistogram* m_pLatency;
+    double m_sendMs[SEND_TIMES];      // by input number
+    uint32_t m_ackedSequence;
+
+    SnapshotCodec m_codec;
+    SnapshotHistory m_history;
+    std::vector<NetEntity> m_decoded;
+    unsigned int m_snapshotsReceived;
+    unsigned int m_decodeFailures;
+    uint32_t m_lastSnapshotTick;
+    double m_lastSnapshotMs;
+    unsigned int m_lateSnapshots;
+    uint64_t m_bytesSent;
+    uint64_t m_bytesReceived;
+    std::vector<unsigned char> m_packet;
+};
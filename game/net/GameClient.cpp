@@ -0,0 +1,303 @@
+#include "GameClient.h"
+#include "../Match.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+    const double CONNECT_RETRY_MS = 250.0;
+
+    // Corrections fade to a third over this long; anything further than
+    // SNAP_DISTANCE is a teleport and is shown at once.
+    const double ERROR_FADE_MS = 100.0;
+    const float SNAP_DISTANCE = 2.0f;
+    const double MAX_EXTRAPOLATION_MS = 150.0;
+
+    double Fade(double sinceMs)
+    {
+        return std::exp(-std::max(sinceMs, 0.0) / ERROR_FADE_MS);
+    }
+
+    unsigned int CreatePredictionWorld(PhysicsWorld& rWorld)
+    {
+        Match::AddPitchWalls(rWorld);
+        rWorld.SetSleepingEnabled(false);
+        return rWorld.AddBody(BodyKind::Player, glm::vec3(0.0f, Match::GetPlayerRadius(), 0.0f),
+                              Match::GetPlayerRadius(), Match::GetPlayerMass());
+    }
+}
+
+GameClient::GameClient()
+    : m_player(SERVER_NO_PLAYER),
+      m_nextSendMs(0.0),
+      m_tickMs(1000.0 / Match::TICK_RATE),
+      m_sequence(0),
+      m_inputs(INPUT_HISTORY),
+      m_inputSentMs(INPUT_HISTORY),
+      m_input(),
+      m_codec(CreateMatchCodec()),
+      m_history(SNAPSHOT_ENTITY_COUNT, SNAPSHOT_HISTORY),
+      m_decoded(SNAPSHOT_ENTITY_COUNT),
+      m_entities(SNAPSHOT_ENTITY_COUNT),
+      m_errorOffsets(SNAPSHOT_ENTITY_COUNT),
+      m_drawPositions(SNAPSHOT_ENTITY_COUNT),
+      m_lastSnapshotTick(NO_SNAPSHOT_TICK),
+      m_snapshotMs(0.0),
+      m_predictionEnabled(true),
+      m_predicting(false),
+      m_predictionPool(1),
+      m_predictionWorld(4),
+      m_predictedBody(CreatePredictionWorld(m_predictionWorld)),
+      m_predictedPlayer(m_predictedBody, 0),
+      m_appliedSequence(NO_INPUT_SEQUENCE),
+      m_localError(0.0f),
+      m_localErrorMs(0.0),
+      m_packet(SERVER_MAX_PACKET)
+{
+    std::memset(&m_stats, 0, sizeof(m_stats));
+}
+
+bool GameClient::Open(const NetAddress& rServer)
+{
+    m_server = rServer;
+    m_player = SERVER_NO_PLAYER;
+    m_nextSendMs = 0.0;
+    m_sequence = 0;
+    m_lastSnapshotTick = NO_SNAPSHOT_TICK;
+    m_history.Clear();
+    m_predicting = false;
+    m_appliedSequence = NO_INPUT_SEQUENCE;
+    std::memset(&m_stats, 0, sizeof(m_stats));
+    return m_socket.Open(0, 0);
+}
+
+void GameClient::Disconnect()
+{
+    if (IsConnected())
+    {
+        PacketHeader header = { SERVER_PACKET_MAGIC, PACKET_DISCONNECT, (uint8_t)m_player, 0 };
+        m_socket.Send(m_server, &header, sizeof(header));
+    }
+    m_player = SERVER_NO_PLAYER;
+    m_predicting = false;
+    m_socket.Close();
+    m_conditioner.Clear();
+}
+
+void GameClient::Update(const PlayerInput& rInput, double nowMs)
+{
+    if (!m_socket.IsOpen())
+        return;
+
+    m_conditioner.Flush(m_socket, nowMs);
+    ReceivePackets(nowMs);
+
+    m_input = rInput;
+    if (nowMs < m_nextSendMs)
+        return;
+
+    if (!IsConnected())
+    {
+        PacketHeader header = { SERVER_PACKET_MAGIC, PACKET_CONNECT, SERVER_NO_PLAYER, 0 };
+        Send(&header, sizeof(header), nowMs);
+        m_nextSendMs = nowMs + CONNECT_RETRY_MS;
+        return;
+    }
+
+    SendInput(nowMs);
+    m_nextSendMs += m_tickMs;
+    if (m_nextSendMs < nowMs)
+        m_nextSendMs = nowMs + m_tickMs;
+}
+
+glm::vec3 GameClient::GetDrawPosition(unsigned int entity, double nowMs) const
+{
+    if (m_predicting && entity == m_player + 1)
+        return m_predictionWorld.GetPosition(m_predictedBody) + m_localError * (float)Fade(nowMs - m_localErrorMs);
+
+    const EntityState& rEntity = m_entities[entity];
+    const double aheadMs = std::min(std::max(nowMs - m_snapshotMs, 0.0), MAX_EXTRAPOLATION_MS);
+    return rEntity.position + rEntity.velocity * (float)(aheadMs / 1000.0)
+         + m_errorOffsets[entity] * (float)Fade(nowMs - m_snapshotMs);
+}
+
+void GameClient::GetViewTime(double nowMs, uint32_t& rTick, float& rFraction) const
+{
+    rTick = m_lastSnapshotTick;
+    rFraction = 0.0f;
+    if (!HasSnapshot())
+        return;
+
+    // the same clamped time GetDrawPosition() extrapolates others to
+    const double aheadTicks = std::min(std::max(nowMs - m_snapshotMs, 0.0), MAX_EXTRAPOLATION_MS) / m_tickMs;
+    const double whole = std::floor(aheadTicks);
+    rTick += (uint32_t)whole;
+    rFraction = (float)(aheadTicks - whole);
+}
+
+void GameClient::ReceivePackets(double nowMs)
+{
+    NetAddress from;
+    int size;
+    while ((size = m_socket.Receive(&m_packet[0], m_packet.size(), from)) >= 0)
+    {
+        if (!(from == m_server) || size < (int)sizeof(PacketHeader))
+            continue;
+
+        PacketHeader header;
+        std::memcpy(&header, &m_packet[0], sizeof(header));
+        if (header.magic != SERVER_PACKET_MAGIC)
+            continue;
+
+        if (header.type == PACKET_ACCEPT && size >= (int)sizeof(AcceptPacket))
+        {
+            AcceptPacket accept;
+            std::memcpy(&accept, &m_packet[0], sizeof(accept));
+            // a malformed accept is ignored like a lost one: the connect is sent again
+            if (!IsConnected() && header.player < Match::PLAYER_COUNT && accept.tickRate > 0)
+            {
+                m_player = header.player;
+                m_tickMs = 1000.0 / accept.tickRate;
+                m_nextSendMs = 0.0;
+            }
+        }
+        else if (header.type == PACKET_SNAPSHOT && size >= (int)sizeof(SnapshotHeader) && IsConnected())
+        {
+            HandleSnapshot((unsigned int)size, nowMs);
+        }
+        else if (header.type == PACKET_DISCONNECT)
+        {
+            m_player = SERVER_NO_PLAYER;
+            m_predicting = false;
+        }
+    }
+}
+
+void GameClient::HandleSnapshot(unsigned int size, double nowMs)
+{
+    SnapshotHeader header;
+    std::memcpy(&header, &m_packet[0], sizeof(header));
+    if (m_lastSnapshotTick != NO_SNAPSHOT_TICK && header.tick <= m_lastSnapshotTick)
+        return;
+
+    const NetEntity* pBaseline = 0;
+    if (header.baselineTick != NO_SNAPSHOT_TICK)
+    {
+        pBaseline = m_history.Find(header.baselineTick);
+        if (!pBaseline)
+        {
+            ++m_stats.decodeFailures;
+            return;
+        }
+    }
+    if (!m_codec.Decode(&m_packet[sizeof(header)], size - sizeof(header), pBaseline, &m_decoded[0]))
+    {
+        ++m_stats.decodeFailures;
+        return;
+    }
+    std::memcpy(m_history.Store(header.tick), &m_decoded[0], m_decoded.size() * sizeof(NetEntity));
+
+    // where everything was drawn a moment ago, so the new state can fade in
+    const bool first = m_lastSnapshotTick == NO_SNAPSHOT_TICK;
+    for (unsigned int i = 0; i < m_entities.size(); ++i)
+        m_drawPositions[i] = GetDrawPosition(i, nowMs);
+
+    m_codec.Dequantise(&m_decoded[0], &m_entities[0]);
+    m_lastSnapshotTick = header.tick;
+    m_snapshotMs = nowMs;
+    ++m_stats.snapshotsReceived;
+
+    for (unsigned int i = 0; i < m_entities.size(); ++i)
+    {
+        const glm::vec3 offset = m_drawPositions[i] - m_entities[i].position;
+        m_errorOffsets[i] = first || glm::length(offset) > SNAP_DISTANCE ? glm::vec3(0.0f) : offset;
+    }
+
+    Reconcile(header.inputSequence, nowMs);
+}
+
+void GameClient::Reconcile(uint32_t appliedSequence, double nowMs)
+{
+    const unsigned int entity = m_player + 1;
+    const EntityState& rServer = m_entities[entity];
+    const bool wasPredicting = m_predicting;
+    const glm::vec3 drawn = m_drawPositions[entity];
+    const glm::vec3 predicted = m_predictionWorld.GetPosition(m_predictedBody);
+
+    if (appliedSequence != NO_INPUT_SEQUENCE && appliedSequence != m_appliedSequence
+        && m_sequence - appliedSequence <= INPUT_HISTORY)
+    {
+        const float sampleMs = (float)(nowMs - m_inputSentMs[appliedSequence % INPUT_HISTORY]);
+        m_stats.rttMs = m_stats.rttMs == 0.0f ? sampleMs : m_stats.rttMs * 0.9f + sampleMs * 0.1f;
+    }
+    m_appliedSequence = appliedSequence;
+
+    // knocked out players are thrown around by others, nothing to predict
+    m_predicting = m_predictionEnabled && appliedSequence != NO_INPUT_SEQUENCE
+                && !(rServer.flags & ENTITY_KNOCKED_OUT) && m_sequence - appliedSequence <= INPUT_HISTORY;
+    if (!m_predicting)
+    {
+        m_stats.unackedInputs = 0;
+        return;
+    }
+
+    m_predictionWorld.SetBodyState(m_predictedBody, rServer.position, rServer.velocity);
+    m_predictedPlayer.SetLastButtons(m_inputs[appliedSequence % INPUT_HISTORY].buttons);
+    for (uint32_t sequence = appliedSequence + 1; sequence < m_sequence; ++sequence)
+        PredictTick(m_inputs[sequence % INPUT_HISTORY]);
+    m_stats.unackedInputs = m_sequence - appliedSequence - 1;
+
+    const glm::vec3 corrected = m_predictionWorld.GetPosition(m_predictedBody);
+    if (wasPredicting)
+    {
+        m_stats.lastCorrection = glm::length(corrected - predicted);
+        m_stats.maxCorrection = std::max(m_stats.maxCorrection, m_stats.lastCorrection);
+    }
+    m_localError = drawn - corrected;
+    if (glm::length(m_localError) > SNAP_DISTANCE)
+        m_localError = glm::vec3(0.0f);
+    m_localErrorMs = nowMs;
+}
+
+void GameClient::SendInput(double nowMs)
+{
+    const uint32_t sequence = m_sequence++;
+    m_inputs[sequence % INPUT_HISTORY] = m_input;
+    m_inputSentMs[sequence % INPUT_HISTORY] = nowMs;
+
+    InputPacket packet;
+    packet.header.magic = SERVER_PACKET_MAGIC;
+    packet.header.type = PACKET_INPUT;
+    packet.header.player = (uint8_t)m_player;
+    packet.header.reserved = 0;
+    packet.sequence = sequence;
+    packet.ackTick = m_lastSnapshotTick;
+    float viewFraction;
+    GetViewTime(nowMs, packet.viewTick, viewFraction);
+    packet.viewFraction = (uint16_t)std::min(viewFraction * 65536.0f, 65535.0f);
+    packet.reserved = 0;
+    packet.count = std::min(m_sequence, INPUT_REDUNDANCY);
+    for (unsigned int i = 0; i < INPUT_REDUNDANCY; ++i)
+    {
+        packet.inputs[i] = i < packet.count
+                         ? m_inputs[(sequence - (packet.count - 1 - i)) % INPUT_HISTORY]
+                         : PlayerInput();
+    }
+    Send(&packet, sizeof(packet), nowMs);
+
+    if (m_predicting)
+        PredictTick(m_input);
+}
+
+void GameClient::PredictTick(const PlayerInput& rInput)
+{
+    m_predictedPlayer.ApplyInput(m_predictionWorld, rInput, m_entities[0].position, Match::GetTickSeconds());
+    m_predictionWorld.Step(Match::GetTickSeconds(), m_predictionPool);
+}
+
+void GameClient::Send(const void* pData, unsigned int size, double nowMs)
+{
+    m_conditioner.Send(m_socket, m_server, pData, size, nowMs);
+}
@@ -0,0 +1,148 @@
+#pragma once
+
+#include "../DeathFootBallPlayer.h"
+#include "../IControl.h"
+#include "../core/WorkerPool.h"
+#include "../physics/PhysicsWorld.h"
+#include "LinkConditioner.h"
+#include "ServerProtocol.h"
+#include "SnapshotCodec.h"
+#include "UdpSocket.h"
+
+#include <cstdint>
+#include <vector>
+
+struct ClientStats
+{
+    unsigned int snapshotsReceived;
+    unsigned int decodeFailures;
+    unsigned int unackedInputs;      // inputs replayed by the last reconciliation
+    float rttMs;                     // input sent to input applied in a snapshot, smoothed
+    float lastCorrection;            // metres the last reconciliation moved the prediction
+    float maxCorrection;
+};
+
+// A player's connection to a GameServer, drawing the match from snapshots.
+//
+// The local player is predicted: each input is sent and at once applied to a
+// copy of the player's body in a small PhysicsWorld with the pitch walls,
+// running the same DeathFootBallPlayer movement code as the server. Inputs
+// are kept by sequence number; every snapshot says which one the server has
+// applied, so the prediction is reset to the authoritative state and the
+// newer inputs are replayed on top. The difference to the old prediction is
+// not shown as a jump but drawn as an offset that fades out.
+//
+// Other entities are extrapolated from their last snapshot along their
+// velocity, and the jump to each new snapshot fades out the same way.
+class GameClient
+{
+public:
+    static const unsigned int INPUT_HISTORY = 128;
+
+    GameClient();
+
+    bool Open(const NetAddress& rServer);
+    void Disconnect();
+
+    // Call every frame with the player's current input; it is sampled once per
+    // server tick, sent and predicted.
+    void Update(const PlayerInput& rInput, double nowMs);
+
+    bool IsConnected() const
+    {
+        return m_player != SERVER_NO_PLAYER;
+    }
+
+    unsigned int GetPlayer() const
+    {
+        return m_player;
+    }
+
+    bool HasSnapshot() const
+    {
+        return m_lastSnapshotTick != NO_SNAPSHOT_TICK;
+    }
+
+    uint32_t GetSnapshotTick() const
+    {
+        return m_lastSnapshotTick;
+    }
+
+    // Entity 0 is the ball, entity p + 1 is player p.
+    glm::vec3 GetDrawPosition(unsigned int entity, double nowMs) const;
+    uint32_t GetEntityFlags(unsigned int entity) const
+    {
+        return m_entities[entity].flags;
+    }
+
+    // The match time other entities are drawn at, as a tick and a fraction
+    // of the next; sent with every input for the server's hit checks.
+    void GetViewTime(double nowMs, uint32_t& rTick, float& rFraction) const;
+
+    // Prediction can be turned off to see the round trip it hides.
+    void SetPredictionEnabled(bool enabled)
+    {
+        m_predictionEnabled = enabled;
+    }
+
+    bool IsPredictionEnabled() const
+    {
+        return m_predictionEnabled;
+    }
+
+    LinkConditioner& GetConditioner()
+    {
+        return m_conditioner;
+    }
+
+    const ClientStats& GetStats() const
+    {
+        return m_stats;
+    }
+
+private:
+    GameClient(const GameClient&);
+    GameClient& operator=(const GameClient&);
+
+    void ReceivePackets(double nowMs);
+    void HandleSnapshot(unsigned int size, double nowMs);
+    void Reconcile(uint32_t appliedSequence, double nowMs);
+    void SendInput(double nowMs);
+    void PredictTick(const PlayerInput& rInput);
+    void Send(const void* pData, unsigned int size, double nowMs);
+
+    UdpSocket m_socket;
+    NetAddress m_server;
+    LinkConditioner m_conditioner;
+    unsigned int m_player;
+    double m_nextSendMs;
+    double m_tickMs;
+
+    // inputs by sequence number, with the time each one was sent
+    uint32_t m_sequence;
+    std::vector<PlayerInput> m_inputs;
+    std::vector<double> m_inputSentMs;
+    PlayerInput m_input;
+
+    SnapshotCodec m_codec;
+    SnapshotHistory m_history;
+    std::vector<NetEntity> m_decoded;
+    std::vector<EntityState> m_entities;
+    std::vector<glm::vec3> m_errorOffsets;   // fading from m_snapshotMs
+    std::vector<glm::vec3> m_drawPositions;
+    uint32_t m_lastSnapshotTick;
+    double m_snapshotMs;
+
+    bool m_predictionEnabled;
+    bool m_predicting;
+    WorkerPool m_predictionPool;
+    PhysicsWorld m_predictionWorld;
+    unsigned int m_predictedBody;
+    DeathFootBallPlayer m_predictedPlayer;
+    uint32_t m_appliedSequence;
+    glm::vec3 m_localError;
+    double m_localErrorMs;
+
+    ClientStats m_stats;
+    std::vector<unsigned char> m_packet;
+};
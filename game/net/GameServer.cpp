@@ -0,0 +1,465 @@
+#include "GameServer.h"
+#include "../Match.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+namespace
+{
+    const double CLIENT_TIMEOUT_MS = 3000.0;
+
+    // A client running further ahead than this is skipped forward so its
+    // inputs do not queue up into latency.
+    const unsigned int MAX_INPUT_BACKLOG = 8;
+
+    // How far past touching a charge reaches, between surfaces.
+    const float CHARGE_REACH = 0.35f;
+    const unsigned int MAX_CHARGE_CANDIDATES = 16;
+
+    typedef std::chrono::steady_clock Clock;
+
+    PacketHeader MakeHeader(ServerPacketType type, unsigned int player)
+    {
+        PacketHeader header;
+        header.magic = SERVER_PACKET_MAGIC;
+        header.type = (uint8_t)type;
+        header.player = (uint8_t)player;
+        header.reserved = 0;
+        return header;
+    }
+}
+
+GameServer::GameServer(Match& rMatch, unsigned int snapshotInterval)
+    : m_pMatch(&rMatch),
+      m_snapshotInterval(snapshotInterval > 0 ? snapshotInterval : 1),
+      m_nowMs(0.0),
+      m_clients(MAX_CLIENTS),
+      m_playerInputs(Match::PLAYER_COUNT),
+      m_appliedSequences(Match::PLAYER_COUNT, NO_INPUT_SEQUENCE),
+      m_codec(CreateMatchCodec()),
+      m_history(SNAPSHOT_ENTITY_COUNT, SNAPSHOT_HISTORY),
+      m_entityStates(SNAPSHOT_ENTITY_COUNT),
+      m_packet(SERVER_MAX_PACKET),
+      m_hitHistory(SNAPSHOT_ENTITY_COUNT),
+      m_lagCompensation(true),
+      m_pInterest(0)
+{
+    for (unsigned int i = 0; i < m_clients.size(); ++i)
+        m_clients[i].connected = false;
+    m_stats.tickMs.reserve(60 * Match::TICK_RATE);
+    m_hitHistory.RecordMatch(rMatch);
+    ResetStats();
+}
+
+GameServer::~GameServer()
+{
+    delete m_pInterest;
+}
+
+bool GameServer::Open(uint32_t ip, uint16_t port, UdpBackend backend)
+{
+    if (m_socket.Open(ip, port, backend))
+        return true;
+    return backend != UDP_BACKEND_SINGLE && m_socket.Open(ip, port, UDP_BACKEND_SINGLE);
+}
+
+void GameServer::Close()
+{
+    m_socket.Close();
+    m_conditioner.Clear();
+    for (unsigned int i = 0; i < m_clients.size(); ++i)
+        m_clients[i].connected = false;
+    std::fill(m_playerInputs.begin(), m_playerInputs.end(), PlayerInput());
+    std::fill(m_appliedSequences.begin(), m_appliedSequences.end(), NO_INPUT_SEQUENCE);
+    m_history.Clear();
+    for (unsigned int i = 0; i < m_views.size(); ++i)
+        m_views[i].Clear();
+    m_hitHistory.Clear();
+    m_hitHistory.RecordMatch(*m_pMatch);
+}
+
+unsigned int GameServer::GetClientCount() const
+{
+    unsigned int count = 0;
+    for (unsigned int i = 0; i < m_clients.size(); ++i)
+    {
+        if (m_clients[i].connected)
+            ++count;
+    }
+    return count;
+}
+
+void GameServer::ResetStats()
+{
+    m_stats.ticks = 0;
+    m_stats.tickMs.clear();
+    m_stats.bytesSent = 0;
+    m_stats.bytesReceived = 0;
+    m_stats.packetsSent = 0;
+    m_stats.packetsReceived = 0;
+    m_stats.clientsConnected = 0;
+    m_stats.clientsTimedOut = 0;
+    m_stats.attacks = 0;
+    m_stats.hits = 0;
+    m_stats.rewoundTicks = 0;
+    m_stats.maxRewindTicks = 0;
+    m_stats.attackCheckMs = 0.0;
+    m_stats.entitiesSent = 0;
+    m_stats.relevancyMs = 0.0;
+}
+
+void GameServer::SetInterestBudget(unsigned int entities)
+{
+    delete m_pInterest;
+    m_pInterest = 0;
+    m_views.clear();
+    if (entities == 0 || entities >= SNAPSHOT_ENTITY_COUNT)
+        return;
+
+    m_pInterest = new InterestManager(SNAPSHOT_ENTITY_COUNT, MAX_CLIENTS, CreateMatchInterestSettings(entities));
+    m_views.assign(MAX_CLIENTS, SnapshotHistory(SNAPSHOT_ENTITY_COUNT, SNAPSHOT_HISTORY));
+    m_positions.resize(SNAPSHOT_ENTITY_COUNT);
+    m_relevant.resize(entities);
+    // every client starts over from a full snapshot
+    for (unsigned int i = 0; i < m_clients.size(); ++i)
+        m_clients[i].ackTick = NO_SNAPSHOT_TICK;
+}
+
+void GameServer::Update(WorkerPool& rPool, double nowMs)
+{
+    Clock::time_point start = Clock::now();
+
+    m_nowMs = nowMs;
+    m_conditioner.Flush(m_socket.GetSocket(), nowMs);
+    ReceivePackets(nowMs);
+    DropSilentClients(nowMs);
+    ConsumeInputs();
+    m_pMatch->Tick(&m_playerInputs[0], rPool);
+    m_hitHistory.RecordMatch(*m_pMatch);
+    if (m_pMatch->GetTick() % m_snapshotInterval == 0)
+        SendSnapshots();
+    m_socket.Flush();
+
+    ++m_stats.ticks;
+    m_stats.tickMs.push_back(std::chrono::duration<float, std::milli>(Clock::now() - start).count());
+}
+
+void GameServer::ReceivePackets(double nowMs)
+{
+    unsigned int count;
+    while ((count = m_socket.Receive()) > 0)
+    {
+        for (unsigned int i = 0; i < count; ++i)
+        {
+            NetAddress from;
+            unsigned int size;
+            const unsigned char* pData = m_socket.GetReceived(i, size, from);
+            HandlePacket(from, pData, size, nowMs);
+        }
+        // answers to connects go out before the buffers are reused
+        m_socket.Flush();
+    }
+}
+
+void GameServer::HandlePacket(const NetAddress& rFrom, const unsigned char* pData, unsigned int size, double nowMs)
+{
+    ++m_stats.packetsReceived;
+    m_stats.bytesReceived += size;
+    if (size < sizeof(PacketHeader))
+        return;
+
+    PacketHeader header;
+    std::memcpy(&header, pData, sizeof(header));
+    if (header.magic != SERVER_PACKET_MAGIC)
+        return;
+
+    const int client = FindClient(rFrom);
+    switch (header.type)
+    {
+    case PACKET_CONNECT:
+        HandleConnect(rFrom, nowMs);
+        break;
+    case PACKET_INPUT:
+        if (size >= sizeof(InputPacket))
+        {
+            InputPacket packet;
+            std::memcpy(&packet, pData, sizeof(packet));
+            HandleInput(rFrom, packet, nowMs);
+        }
+        break;
+    case PACKET_DISCONNECT:
+        if (client >= 0)
+        {
+            m_clients[client].connected = false;
+            m_playerInputs[client] = PlayerInput();
+            m_appliedSequences[client] = NO_INPUT_SEQUENCE;
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+void GameServer::HandleConnect(const NetAddress& rFrom, double nowMs)
+{
+    // a repeated connect means the accept was lost, so it is sent again
+    int player = FindClient(rFrom);
+    if (player < 0)
+    {
+        for (unsigned int i = 0; i < m_clients.size() && player < 0; ++i)
+        {
+            if (!m_clients[i].connected)
+                player = (int)i;
+        }
+        if (player < 0)
+        {
+            PacketHeader reject = MakeHeader(PACKET_REJECT, SERVER_NO_PLAYER);
+            Send(rFrom, &reject, sizeof(reject));
+            return;
+        }
+
+        Client& rClient = m_clients[player];
+        rClient.connected = true;
+        rClient.address = rFrom;
+        rClient.nextSequence = 0;
+        rClient.newestSequence = NO_INPUT_SEQUENCE;
+        rClient.ackTick = NO_SNAPSHOT_TICK;
+        for (unsigned int i = 0; i < INPUT_BUFFER; ++i)
+            rClient.inputSequences[i] = NO_INPUT_SEQUENCE;
+        if (m_pInterest)
+            m_views[player].Clear();
+        ++m_stats.clientsConnected;
+    }
+
+    Client& rClient = m_clients[player];
+    rClient.lastHeardMs = nowMs;
+
+    AcceptPacket accept;
+    accept.header = MakeHeader(PACKET_ACCEPT, (unsigned int)player);
+    accept.tick = m_pMatch->GetTick();
+    accept.tickRate = Match::TICK_RATE;
+    Send(rFrom, &accept, sizeof(accept));
+}
+
+void GameServer::HandleInput(const NetAddress& rFrom, const InputPacket& rPacket, double nowMs)
+{
+    const int player = FindClient(rFrom);
+    if (player < 0 || rPacket.count == 0 || rPacket.count > INPUT_REDUNDANCY)
+        return;
+
+    Client& rClient = m_clients[player];
+    rClient.lastHeardMs = nowMs;
+    if (rPacket.ackTick != NO_SNAPSHOT_TICK && (rClient.ackTick == NO_SNAPSHOT_TICK || rPacket.ackTick > rClient.ackTick))
+        rClient.ackTick = rPacket.ackTick;
+    for (unsigned int i = 0; i < rPacket.count; ++i)
+    {
+        const unsigned int back = rPacket.count - 1 - i;
+        if (back > rPacket.sequence)
+            continue;
+        const uint32_t sequence = rPacket.sequence - back;
+        if (sequence < rClient.nextSequence)
+            continue;
+
+        // older inputs were sent a tick apart, viewing a tick earlier each
+        const unsigned int slot = sequence % INPUT_BUFFER;
+        rClient.inputs[slot] = rPacket.inputs[i];
+        rClient.inputSequences[slot] = sequence;
+        rClient.viewTicks[slot] = rPacket.viewTick == NO_SNAPSHOT_TICK || rPacket.viewTick < back ? NO_SNAPSHOT_TICK : rPacket.viewTick - back;
+        rClient.viewFractions[slot] = rPacket.viewFraction / 65536.0f;
+        if (rClient.newestSequence == NO_INPUT_SEQUENCE || sequence > rClient.newestSequence)
+            rClient.newestSequence = sequence;
+    }
+}
+
+void GameServer::ConsumeInputs()
+{
+    for (unsigned int player = 0; player < m_clients.size(); ++player)
+    {
+        Client& rClient = m_clients[player];
+        if (!rClient.connected || rClient.newestSequence == NO_INPUT_SEQUENCE
+            || rClient.newestSequence < rClient.nextSequence)
+        {
+            // nothing new: the player keeps doing what it did
+            continue;
+        }
+
+        if (rClient.newestSequence - rClient.nextSequence >= MAX_INPUT_BACKLOG)
+            rClient.nextSequence = rClient.newestSequence - 1;
+
+        const unsigned int slot = rClient.nextSequence % INPUT_BUFFER;
+        if (rClient.inputSequences[slot] == rClient.nextSequence)
+        {
+            PlayerInput input = rClient.inputs[slot];
+            input.target = 0;
+            if ((input.buttons & BUTTON_CHARGE) && !(m_playerInputs[player].buttons & BUTTON_CHARGE))
+                input.target = (unsigned char)ResolveCharge(player, rClient.viewTicks[slot], rClient.viewFractions[slot]);
+            m_playerInputs[player] = input;
+            m_appliedSequences[player] = rClient.nextSequence;
+        }
+        // a missing input with newer ones present was lost with all its
+        // copies; the previous input stands in for it
+        ++rClient.nextSequence;
+    }
+}
+
+unsigned int GameServer::ResolveCharge(unsigned int player, uint32_t viewTick, float viewFraction)
+{
+    const std::vector<DeathFootBallPlayer>& rPlayers = m_pMatch->GetPlayers();
+    const DeathFootBallPlayer& rAttacker = rPlayers[player];
+    if (rAttacker.IsKnockedOut())
+        return 0;
+
+    Clock::time_point start = Clock::now();
+
+    const uint32_t now = m_pMatch->GetTick();
+    if (!m_lagCompensation || viewTick == NO_SNAPSHOT_TICK || viewTick > now)
+    {
+        viewTick = now;
+        viewFraction = 0.0f;
+    }
+    const unsigned int rewind = std::min(now - viewTick, HitHistory::HISTORY_TICKS - 1);
+
+    // the attacker is where it is now, the others where the client saw them
+    HitHistory::Hit candidates[MAX_CHARGE_CANDIDATES];
+    const unsigned int count = std::min(
+        m_hitHistory.Query(viewTick, viewFraction, m_pMatch->GetWorld().GetPosition(rAttacker.GetBody()),
+                           Match::GetPlayerRadius() + CHARGE_REACH, candidates, MAX_CHARGE_CANDIDATES),
+        MAX_CHARGE_CANDIDATES);
+
+    unsigned int target = 0;
+    float nearest = 0.0f;
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        const unsigned int entity = candidates[i].entity;
+        if (entity > 0)
+        {
+            // only opponents still standing in the present can go down
+            const DeathFootBallPlayer& rVictim = rPlayers[entity - 1];
+            if (entity - 1 == player || rVictim.GetTeam() == rAttacker.GetTeam() || rVictim.IsKnockedOut())
+                continue;
+        }
+        if (target == 0 || candidates[i].distanceSq < nearest)
+        {
+            target = entity + 1;
+            nearest = candidates[i].distanceSq;
+        }
+    }
+
+    ++m_stats.attacks;
+    if (target != 0)
+        ++m_stats.hits;
+    m_stats.rewoundTicks += rewind;
+    m_stats.maxRewindTicks = std::max(m_stats.maxRewindTicks, rewind);
+    m_stats.attackCheckMs += std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    return target;
+}
+
+void GameServer::SendSnapshots()
+{
+    const uint32_t tick = m_pMatch->GetTick();
+    CaptureEntities(*m_pMatch, &m_entityStates[0]);
+    NetEntity* pCurrent = m_history.Store(tick);
+    m_codec.Quantise(&m_entityStates[0], pCurrent);
+
+    if (m_pInterest)
+    {
+        for (unsigned int i = 0; i < SNAPSHOT_ENTITY_COUNT; ++i)
+            m_positions[i] = m_entityStates[i].position;
+        m_pInterest->Update(&m_positions[0], tick);
+    }
+
+    SnapshotHeader header;
+    header.tick = tick;
+    header.reserved = 0;
+    header.stateHash = m_pMatch->GetStateHash();
+    for (unsigned int player = 0; player < m_clients.size(); ++player)
+    {
+        Client& rClient = m_clients[player];
+        if (!rClient.connected)
+            continue;
+
+        // a baseline that fell out of the history means a full snapshot
+        const SnapshotHistory& rBaselines = m_pInterest ? m_views[player] : m_history;
+        const NetEntity* pBaseline = rClient.ackTick != NO_SNAPSHOT_TICK ? rBaselines.Find(rClient.ackTick) : 0;
+        const NetEntity* pView = pCurrent;
+        if (m_pInterest)
+            pView = SelectView(player, pCurrent, !pBaseline);
+        else
+            m_stats.entitiesSent += SNAPSHOT_ENTITY_COUNT;
+        const size_t payload = m_codec.Encode(pView, pBaseline, &m_packet[sizeof(header)], m_packet.size() - sizeof(header));
+        if (payload == 0)
+            continue;
+
+        header.header = MakeHeader(PACKET_SNAPSHOT, player);
+        header.baselineTick = pBaseline ? rClient.ackTick : NO_SNAPSHOT_TICK;
+        header.inputSequence = m_appliedSequences[player];
+        std::memcpy(&m_packet[0], &header, sizeof(header));
+        Send(rClient.address, &m_packet[0], (unsigned int)(sizeof(header) + payload));
+    }
+}
+
+// Stores what the client is sent this snapshot in its view history: its
+// previous view with the entities the InterestManager picks brought up to
+// date, or all of them for a full snapshot.
+const NetEntity* GameServer::SelectView(unsigned int player, const NetEntity* pCurrent, bool full)
+{
+    Clock::time_point start = Clock::now();
+
+    const NetEntity* pPrevious = m_views[player].GetNewest();
+    NetEntity* pView = m_views[player].Store(m_pMatch->GetTick());
+    if (full || !pPrevious)
+    {
+        std::memcpy(pView, pCurrent, SNAPSHOT_ENTITY_COUNT * sizeof(NetEntity));
+        m_pInterest->MarkAllSent(player);
+        m_stats.entitiesSent += SNAPSHOT_ENTITY_COUNT;
+    }
+    else
+    {
+        std::memcpy(pView, pPrevious, SNAPSHOT_ENTITY_COUNT * sizeof(NetEntity));
+        const EntityState& rViewer = m_entityStates[1 + player];
+        const unsigned int required[2] = { 0, 1 + player };
+        const unsigned int count = m_pInterest->Select(player, rViewer.position, rViewer.velocity, required, 2, &m_relevant[0]);
+        for (unsigned int i = 0; i < count; ++i)
+            pView[m_relevant[i]] = pCurrent[m_relevant[i]];
+        m_stats.entitiesSent += count;
+    }
+
+    m_stats.relevancyMs += std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    return pView;
+}
+
+void GameServer::DropSilentClients(double nowMs)
+{
+    for (unsigned int player = 0; player < m_clients.size(); ++player)
+    {
+        Client& rClient = m_clients[player];
+        if (rClient.connected && nowMs - rClient.lastHeardMs > CLIENT_TIMEOUT_MS)
+        {
+            rClient.connected = false;
+            m_playerInputs[player] = PlayerInput();
+            m_appliedSequences[player] = NO_INPUT_SEQUENCE;
+            ++m_stats.clientsTimedOut;
+        }
+    }
+}
+
+void GameServer::Send(const NetAddress& rTo, const void* pData, unsigned int size)
+{
+    if (m_conditioner.IsPerfect())
+        m_socket.Send(rTo, pData, size);
+    else
+        m_conditioner.Send(m_socket.GetSocket(), rTo, pData, size, m_nowMs);
+    ++m_stats.packetsSent;
+    m_stats.bytesSent += size;
+}
+
+int GameServer::FindClient(const NetAddress& rAddress) const
+{
+    for (unsigned int i = 0; i < m_clients.size(); ++i)
+    {
+        if (m_clients[i].connected && m_clients[i].address == rAddress)
+            return (int)i;
+    }
+    return -1;
+}
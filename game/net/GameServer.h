@@ -0,0 +1,175 @@
+#pragma once
+
+#include "../IControl.h"
+#include "BatchedUdpSocket.h"
+#include "HitHistory.h"
+#include "InterestManager.h"
+#include "LinkConditioner.h"
+#include "ServerProtocol.h"
+#include "SnapshotCodec.h"
+
+#include <cstdint>
+#include <vector>
+
+class Match;
+class WorkerPool;
+
+struct ServerStats
+{
+    unsigned int ticks;
+    std::vector<float> tickMs;    // one sample per Update(), receive to last send
+    uint64_t bytesSent;
+    uint64_t bytesReceived;
+    unsigned int packetsSent;
+    unsigned int packetsReceived;
+    unsigned int clientsConnected;
+    unsigned int clientsTimedOut;
+    unsigned int attacks;         // charges checked for a hit
+    unsigned int hits;
+    uint64_t rewoundTicks;        // summed over every attack
+    unsigned int maxRewindTicks;
+    double attackCheckMs;         // summed over every attack
+    uint64_t entitiesSent;        // summed over every snapshot sent
+    double relevancyMs;           // choosing the entities of every snapshot
+};
+
+// Authoritative host of one match. Clients connect over UDP and each takes
+// one player; datagrams are received and sent in batches. The server applies
+// the clients' inputs one per tick in the order they were numbered,
+// repeating the last one when the next has not arrived yet, and sends every
+// client the match state every snapshotInterval ticks, delta coded against
+// the newest snapshot that client acknowledged.
+// Players without a client stand still.
+//
+// Charges are lag compensated: every tick's hit volumes go into a
+// HitHistory, and when a client's input presses charge the server rewinds to
+// the moment that client was drawing and looks for the nearest ball or
+// opponent within reach of the attacker. A hit is written into the input's
+// target, so the match applies it as a pure function of its inputs.
+//
+// With an interest budget each client is sent only that many entities per
+// snapshot, chosen by an InterestManager, and the rest as it last saw them.
+// The server keeps every client's view as its baselines, so clients decode
+// them as any other snapshot.
+class GameServer
+{
+public:
+    static const unsigned int MAX_CLIENTS = Match::PLAYER_COUNT;
+    static const unsigned int INPUT_BUFFER = 32;
+
+    GameServer(Match& rMatch, unsigned int snapshotInterval);
+    ~GameServer();
+
+    // Falls back to one system call per datagram when the backend is not
+    // available; GetBackend() tells which one is in use.
+    bool Open(uint32_t ip, uint16_t port, UdpBackend backend = UDP_BACKEND_MMSG);
+    NetAddress GetLocalAddress() const
+    {
+        return m_socket.GetLocalAddress();
+    }
+
+    UdpBackend GetBackend() const
+    {
+        return m_socket.GetBackend();
+    }
+
+    // Handles waiting packets, runs one tick and sends snapshots when due.
+    // The caller paces the calls at Match::TICK_RATE.
+    void Update(WorkerPool& rPool, double nowMs);
+
+    // Closes the socket and forgets the clients, what they were sent and the
+    // hit history, so that the next Open() starts a new session. Reset the
+    // match first: its present state is recorded again.
+    void Close();
+
+    unsigned int GetClientCount() const;
+
+    // Outgoing packets pass through it when given conditions; otherwise they
+    // are queued and sent as one batch at the end of Update().
+    LinkConditioner& GetConditioner()
+    {
+        return m_conditioner;
+    }
+
+    const ServerStats& GetStats() const
+    {
+        return m_stats;
+    }
+
+    void ResetStats();
+
+    // Off, charges are checked against the present; for comparison.
+    void SetLagCompensation(bool enabled)
+    {
+        m_lagCompensation = enabled;
+    }
+
+    bool IsLagCompensationEnabled() const
+    {
+        return m_lagCompensation;
+    }
+
+    const HitHistory& GetHitHistory() const
+    {
+        return m_hitHistory;
+    }
+
+    // Entities per client per snapshot, the ball and the client's own player
+    // among them; 0 or SNAPSHOT_ENTITY_COUNT and up send every entity.
+    void SetInterestBudget(unsigned int entities);
+
+    unsigned int GetInterestBudget() const
+    {
+        return m_pInterest ? m_pInterest->GetSettings().budget : 0;
+    }
+
+private:
+    GameServer(const GameServer&);
+    GameServer& operator=(const GameServer&);
+
+    struct Client
+    {
+        bool connected;
+        NetAddress address;
+        double lastHeardMs;
+        uint32_t nextSequence;       // next input to apply
+        uint32_t newestSequence;     // NO_INPUT_SEQUENCE until the first input
+        PlayerInput inputs[INPUT_BUFFER];
+        uint32_t inputSequences[INPUT_BUFFER];
+        uint32_t viewTicks[INPUT_BUFFER];
+        float viewFractions[INPUT_BUFFER];
+        uint32_t ackTick;
+    };
+
+    void ReceivePackets(double nowMs);
+    void HandlePacket(const NetAddress& rFrom, const unsigned char* pData, unsigned int size, double nowMs);
+    void HandleConnect(const NetAddress& rFrom, double nowMs);
+    void HandleInput(const NetAddress& rFrom, const InputPacket& rPacket, double nowMs);
+    void ConsumeInputs();
+    unsigned int ResolveCharge(unsigned int player, uint32_t viewTick, float viewFraction);
+    void SendSnapshots();
+    const NetEntity* SelectView(unsigned int player, const NetEntity* pCurrent, bool full);
+    void DropSilentClients(double nowMs);
+    void Send(const NetAddress& rTo, const void* pData, unsigned int size);
+    int FindClient(const NetAddress& rAddress) const;
+
+    Match* m_pMatch;
+    unsigned int m_snapshotInterval;
+    BatchedUdpSocket m_socket;
+    LinkConditioner m_conditioner;
+    double m_nowMs;
+    std::vector<Client> m_clients;            // indexed by player
+    std::vector<PlayerInput> m_playerInputs;
+    std::vector<uint32_t> m_appliedSequences;
+    SnapshotCodec m_codec;
+    SnapshotHistory m_history;
+    std::vector<EntityState> m_entityStates;
+    std::vector<unsigned char> m_packet;
+    HitHistory m_hitHistory;
+    bool m_lagCompensation;
+    InterestManager* m_pInterest;             // null without an interest budget
+    std::vector<SnapshotHistory> m_views;     // per client, what it was sent
+    std::vector<glm::vec3> m_positions;
+    std::vector<unsigned int> m_relevant;
+    ServerStats m_stats;
+};
@@ -0,0 +1,204 @@
+#include "HitHistory.h"
+#include "../Match.h"
+#include "../core/Arena.h"
+#include "../core/Float4.h"
+
+#include <cstdlib>
+#include <cstring>
+
+namespace
+{
+    // Where entities without a volume sit; squared distances stay finite.
+    const float FAR_AWAY = 1e15f;
+
+    unsigned int RoundUp4(unsigned int value)
+    {
+        return (value + 3u) & ~3u;
+    }
+}
+
+HitHistory::HitHistory(unsigned int capacity)
+    : m_capacity(capacity),
+      m_stride(RoundUp4(capacity > 0 ? capacity : 1)),
+      m_rowFloats(4 * m_stride),
+      m_pStorage(nullptr),
+      m_pRows(nullptr),
+      m_newestTick(NO_TICK)
+{
+    const size_t bytes = GetMemoryBytes();
+    m_pStorage = static_cast<unsigned char*>(AllocateAligned(bytes));
+    m_pRows = reinterpret_cast<float*>(m_pStorage);
+    Clear();
+}
+
+HitHistory::~HitHistory()
+{
+    FreeAligned(m_pStorage);
+}
+
+void HitHistory::Clear()
+{
+    for (unsigned int slot = 0; slot < HISTORY_TICKS; ++slot)
+    {
+        float* pRow = m_pRows + slot * m_rowFloats;
+        for (unsigned int i = 0; i < 3 * m_stride; ++i)
+            pRow[i] = FAR_AWAY;
+        std::memset(pRow + 3 * m_stride, 0, m_stride * sizeof(float));
+        m_ticks[slot] = NO_TICK;
+    }
+    m_newestTick = NO_TICK;
+}
+
+void HitHistory::Record(uint32_t tick, const glm::vec3* pCentres, const float* pRadii, unsigned int count)
+{
+    if (count > m_capacity)
+        count = m_capacity;
+
+    float* pX = m_pRows + (tick % HISTORY_TICKS) * m_rowFloats;
+    float* pY = pX + m_stride;
+    float* pZ = pY + m_stride;
+    float* pR = pZ + m_stride;
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        pX[i] = pCentres[i].x;
+        pY[i] = pCentres[i].y;
+        pZ[i] = pCentres[i].z;
+        pR[i] = pRadii[i];
+    }
+    for (unsigned int i = count; i < m_capacity; ++i)
+    {
+        pX[i] = pY[i] = pZ[i] = FAR_AWAY;
+        pR[i] = 0.0f;
+    }
+
+    // a tick out of order starts the history over from it
+    if (m_newestTick == NO_TICK || tick != m_newestTick + 1)
+    {
+        for (unsigned int slot = 0; slot < HISTORY_TICKS; ++slot)
+            m_ticks[slot] = NO_TICK;
+    }
+    m_ticks[tick % HISTORY_TICKS] = tick;
+    m_newestTick = tick;
+}
+
+void HitHistory::RecordMatch(const Match& rMatch)
+{
+    const PhysicsWorld& rWorld = rMatch.GetWorld();
+    const std::vector<DeathFootBallPlayer>& rPlayers = rMatch.GetPlayers();
+
+    glm::vec3 centres[Match::PLAYER_COUNT + 1];
+    float radii[Match::PLAYER_COUNT + 1];
+    for (unsigned int i = 0; i <= rPlayers.size(); ++i)
+    {
+        const unsigned int body = i == 0 ? rMatch.GetBall() : rPlayers[i - 1].GetBody();
+        if (i > 0 && rPlayers[i - 1].IsKnockedOut())
+        {
+            centres[i] = glm::vec3(FAR_AWAY);
+            radii[i] = 0.0f;
+        }
+        else
+        {
+            centres[i] = rWorld.GetPosition(body);
+            radii[i] = rWorld.GetRadius(body);
+        }
+    }
+    Record(rMatch.GetTick(), centres, radii, Match::PLAYER_COUNT + 1);
+}
+
+uint32_t HitHistory::GetOldestTick() const
+{
+    if (m_newestTick == NO_TICK)
+        return NO_TICK;
+
+    uint32_t oldest = m_newestTick;
+    while (m_newestTick - oldest + 1 < HISTORY_TICKS && oldest > 0 && m_ticks[(oldest - 1) % HISTORY_TICKS] == oldest - 1)
+        --oldest;
+    return oldest;
+}
+
+void HitHistory::Resolve(uint32_t& rTick, float& rFraction) const
+{
+    if (rFraction < 0.0f)
+        rFraction = 0.0f;
+    if (rFraction > 1.0f)
+        rFraction = 1.0f;
+
+    if (rTick >= m_newestTick)
+    {
+        rTick = m_newestTick;
+        rFraction = 0.0f;
+    }
+    else if (m_ticks[rTick % HISTORY_TICKS] != rTick)
+    {
+        // older than the history: the oldest volumes will have to do
+        rTick = GetOldestTick();
+        rFraction = 0.0f;
+    }
+}
+
+unsigned int HitHistory::Query(uint32_t tick, float fraction, const glm::vec3& rCentre, float radius,
+                               Hit* pHits, unsigned int maxHits) const
+{
+    if (IsEmpty())
+        return 0;
+    Resolve(tick, fraction);
+
+    const float* pFrom = Row(tick);
+    const float* pTo = fraction > 0.0f ? Row(tick + 1) : pFrom;
+    const Float4 t(fraction);
+    const Float4 centreX(rCentre.x);
+    const Float4 centreY(rCentre.y);
+    const Float4 centreZ(rCentre.z);
+    const Float4 reach(radius);
+
+    unsigned int count = 0;
+    for (unsigned int i = 0; i < m_stride; i += 4)
+    {
+        const Float4 fromX = Float4::Load(pFrom + i);
+        const Float4 fromY = Float4::Load(pFrom + m_stride + i);
+        const Float4 fromZ = Float4::Load(pFrom + 2 * m_stride + i);
+        const Float4 fromR = Float4::Load(pFrom + 3 * m_stride + i);
+        const Float4 dx = fromX + (Float4::Load(pTo + i) - fromX) * t - centreX;
+        const Float4 dy = fromY + (Float4::Load(pTo + m_stride + i) - fromY) * t - centreY;
+        const Float4 dz = fromZ + (Float4::Load(pTo + 2 * m_stride + i) - fromZ) * t - centreZ;
+        const Float4 limit = fromR + (Float4::Load(pTo + 3 * m_stride + i) - fromR) * t + reach;
+        const Float4 distanceSq = dx * dx + dy * dy + dz * dz;
+
+        int bits = MoveMask(Less(distanceSq, limit * limit));
+        if (bits == 0)
+            continue;
+
+        float lanes[4];
+        distanceSq.StoreUnaligned(lanes);
+        for (unsigned int lane = 0; lane < 4; ++lane)
+        {
+            if (!(bits & (1 << lane)))
+                continue;
+            if (count < maxHits)
+            {
+                pHits[count].entity = i + lane;
+                pHits[count].distanceSq = lanes[lane];
+            }
+            ++count;
+        }
+    }
+    return count;
+}
+
+void HitHistory::GetSphere(unsigned int entity, uint32_t tick, float fraction, glm::vec3& rCentre, float& rRadius) const
+{
+    if (IsEmpty() || entity >= m_capacity)
+    {
+        rCentre = glm::vec3(FAR_AWAY);
+        rRadius = 0.0f;
+        return;
+    }
+    Resolve(tick, fraction);
+
+    const float* pFrom = Row(tick) + entity;
+    const float* pTo = (fraction > 0.0f ? Row(tick + 1) : Row(tick)) + entity;
+    rCentre.x = pFrom[0] + (pTo[0] - pFrom[0]) * fraction;
+    rCentre.y = pFrom[m_stride] + (pTo[m_stride] - pFrom[m_stride]) * fraction;
+    rCentre.z = pFrom[2 * m_stride] + (pTo[2 * m_stride] - pFrom[2 * m_stride]) * fraction;
+    rRadius = pFrom[3 * m_stride] + (pTo[3 * m_stride] - pFrom[3 * m_stride]) * fraction;
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+
+class Match;
+
+// The server's memory of where every entity's hit volume was over the last
+// HISTORY_TICKS ticks, so an attack can be judged against the world as the
+// attacking client saw it rather than as it is by the time the input arrives.
+//
+// Hit volumes are spheres. Each tick is one row of four contiguous columns,
+// centre x, y, z and radius, padded to a multiple of four entities, and all
+// rows live in one fixed aligned block. A rewind query blends two rows and
+// tests four entities at a time with Float4; nothing is allocated after
+// construction. Padding lanes sit far outside any query.
+class HitHistory
+{
+public:
+    static const unsigned int HISTORY_TICKS = 64;
+
+    struct Hit
+    {
+        unsigned int entity;
+        float distanceSq;   // between the query centre and the entity's centre
+    };
+
+    explicit HitHistory(unsigned int capacity);
+    ~HitHistory();
+
+    // Stores the volumes after tick. Entities past count have no volume.
+    void Record(uint32_t tick, const glm::vec3* pCentres, const float* pRadii, unsigned int count);
+
+    // Records rMatch after its last tick, in snapshot entity order: the ball
+    // followed by every player. Knocked-out players have no volume.
+    void RecordMatch(const Match& rMatch);
+
+    void Clear();
+
+    bool IsEmpty() const
+    {
+        return m_newestTick == NO_TICK;
+    }
+
+    uint32_t GetNewestTick() const
+    {
+        return m_newestTick;
+    }
+
+    // Oldest tick the history still holds without a gap up to the newest.
+    uint32_t GetOldestTick() const;
+
+    // Finds the entities whose volume overlapped the sphere at rCentre at
+    // tick + fraction of the way to the next tick, a time clamped to the
+    // recorded range. Writes at most maxHits of them in entity order and
+    // returns how many there were.
+    unsigned int Query(uint32_t tick, float fraction, const glm::vec3& rCentre, float radius,
+                       Hit* pHits, unsigned int maxHits) const;
+
+    // One entity's volume at the same clamped time as Query().
+    void GetSphere(unsigned int entity, uint32_t tick, float fraction, glm::vec3& rCentre, float& rRadius) const;
+
+    size_t GetMemoryBytes() const
+    {
+        return HISTORY_TICKS * m_rowFloats * sizeof(float);
+    }
+
+    static const uint32_t NO_TICK = 0xFFFFFFFFu;
+
+private:
+    HitHistory(const HitHistory&);
+    HitHistory& operator=(const HitHistory&);
+
+    const float* Row(uint32_t tick) const
+    {
+        return m_pRows + (tick % HISTORY_TICKS) * m_rowFloats;
+    }
+
+    // Clamps tick + fraction into the recorded range.
+    void Resolve(uint32_t& rTick, float& rFraction) const;
+
+    unsigned int m_capacity;
+    unsigned int m_stride;      // entities per column, a multiple of four
+    unsigned int m_rowFloats;   // four columns
+    unsigned char* m_pStorage;
+    float* m_pRows;
+    uint32_t m_ticks[HISTORY_TICKS];
+    uint32_t m_newestTick;
+};
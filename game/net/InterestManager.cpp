@@ -0,0 +1,200 @@
+#include "InterestManager.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace
+{
+    // Cells are half the view radius across, so a view covers at most 5 x 5.
+    const float CELLS_PER_VIEW_RADIUS = 2.0f;
+
+    // Entities spread far apart get larger cells rather than an empty grid.
+    const unsigned int MAX_CELLS_PER_ENTITY = 4;
+
+    // Smallest cell, so that the grid is sized in finite steps whatever the
+    // view radius.
+    const float MIN_CELL_SIZE = 0.01f;
+
+    const uint32_t NEVER_SCORED = 0;
+}
+
+InterestSettings CreateMatchInterestSettings(unsigned int budget)
+{
+    InterestSettings settings;
+    settings.viewRadius = 6.0f;
+    settings.falloff = 3.0f;
+    settings.behindFactor = 0.5f;
+    settings.farShare = 0.25f;
+    settings.budget = budget;
+    return settings;
+}
+
+InterestManager::InterestManager(unsigned int entityCount, unsigned int clientCount, const InterestSettings& rSettings)
+    : m_entityCount(entityCount),
+      m_settings(rSettings),
+      m_tick(0),
+      m_pPositions(0),
+      m_cellSize(std::max(rSettings.viewRadius / CELLS_PER_VIEW_RADIUS, MIN_CELL_SIZE)),
+      m_minX(0.0f),
+      m_minZ(0.0f),
+      m_columns(1),
+      m_rows(1),
+      m_cellEntities(entityCount),
+      m_entityCells(entityCount),
+      m_lastSent(entityCount * clientCount, 0),
+      m_farCursor(clientCount, 0),
+      m_stamp(entityCount, NEVER_SCORED),
+      m_selection(NEVER_SCORED),
+      m_candidatesScored(0)
+{
+    assert(rSettings.viewRadius > 0.0f);
+    m_candidates.reserve(entityCount);
+    m_far.reserve(entityCount);
+}
+
+void InterestManager::Update(const glm::vec3* pPositions, uint32_t tick)
+{
+    m_pPositions = pPositions;
+    m_tick = tick;
+    if (m_entityCount == 0)
+        return;
+
+    float maxX = pPositions[0].x;
+    float maxZ = pPositions[0].z;
+    m_minX = maxX;
+    m_minZ = maxZ;
+    for (unsigned int i = 1; i < m_entityCount; ++i)
+    {
+        m_minX = std::min(m_minX, pPositions[i].x);
+        m_minZ = std::min(m_minZ, pPositions[i].z);
+        maxX = std::max(maxX, pPositions[i].x);
+        maxZ = std::max(maxZ, pPositions[i].z);
+    }
+
+    m_cellSize = std::max(m_settings.viewRadius / CELLS_PER_VIEW_RADIUS, MIN_CELL_SIZE);
+    const float maxCells = (float)(MAX_CELLS_PER_ENTITY * m_entityCount);
+    while (((maxX - m_minX) / m_cellSize + 1.0f) * ((maxZ - m_minZ) / m_cellSize + 1.0f) > maxCells)
+        m_cellSize *= 2.0f;
+    m_columns = (unsigned int)((maxX - m_minX) / m_cellSize) + 1;
+    m_rows = (unsigned int)((maxZ - m_minZ) / m_cellSize) + 1;
+
+    // counting sort of the entities by cell
+    m_cellStart.assign(m_columns * m_rows + 1, 0);
+    for (unsigned int i = 0; i < m_entityCount; ++i)
+    {
+        const unsigned int column = std::min((unsigned int)((pPositions[i].x - m_minX) / m_cellSize), m_columns - 1);
+        const unsigned int row = std::min((unsigned int)((pPositions[i].z - m_minZ) / m_cellSize), m_rows - 1);
+        m_entityCells[i] = row * m_columns + column;
+        ++m_cellStart[m_entityCells[i] + 1];
+    }
+    for (unsigned int cell = 0; cell < m_columns * m_rows; ++cell)
+        m_cellStart[cell + 1] += m_cellStart[cell];
+    std::vector<unsigned int>::iterator next = m_cellStart.begin();
+    for (unsigned int i = 0; i < m_entityCount; ++i)
+        m_cellEntities[next[m_entityCells[i]]++] = i;
+    // the fill advanced every start to the next cell's
+    for (unsigned int cell = m_columns * m_rows; cell > 0; --cell)
+        m_cellStart[cell] = m_cellStart[cell - 1];
+    m_cellStart[0] = 0;
+}
+
+unsigned int InterestManager::Select(unsigned int client, const glm::vec3& rViewer, const glm::vec3& rForward,
+                                     const unsigned int* pRequired, unsigned int requiredCount, unsigned int* pOut)
+{
+    uint32_t* pLastSent = &m_lastSent[client * m_entityCount];
+    if (++m_selection == NEVER_SCORED)
+    {
+        std::fill(m_stamp.begin(), m_stamp.end(), NEVER_SCORED);
+        m_selection = NEVER_SCORED + 1;
+    }
+
+    unsigned int count = 0;
+    for (unsigned int i = 0; i < requiredCount && count < m_settings.budget; ++i)
+    {
+        const unsigned int entity = pRequired[i];
+        if (entity >= m_entityCount || m_stamp[entity] == m_selection)
+            continue;
+        m_stamp[entity] = m_selection;
+        pLastSent[entity] = m_tick;
+        pOut[count++] = entity;
+    }
+    const unsigned int slots = m_settings.budget - count;
+    if (slots == 0 || m_entityCount == 0)
+        return count;
+
+    // the entities in view, by distance and facing
+    m_candidates.clear();
+    const float radius = m_settings.viewRadius;
+    const float forwardLength = std::sqrt(rForward.x * rForward.x + rForward.z * rForward.z);
+    const int firstColumn = std::max((int)std::floor((rViewer.x - radius - m_minX) / m_cellSize), 0);
+    const int lastColumn = std::min((int)std::floor((rViewer.x + radius - m_minX) / m_cellSize), (int)m_columns - 1);
+    const int firstRow = std::max((int)std::floor((rViewer.z - radius - m_minZ) / m_cellSize), 0);
+    const int lastRow = std::min((int)std::floor((rViewer.z + radius - m_minZ) / m_cellSize), (int)m_rows - 1);
+    for (int row = firstRow; row <= lastRow; ++row)
+    {
+        for (int column = firstColumn; column <= lastColumn; ++column)
+        {
+            const unsigned int cell = row * m_columns + column;
+            for (unsigned int i = m_cellStart[cell]; i < m_cellStart[cell + 1]; ++i)
+            {
+                const unsigned int entity = m_cellEntities[i];
+                if (m_stamp[entity] == m_selection)
+                    continue;
+                const float dx = m_pPositions[entity].x - rViewer.x;
+                const float dz = m_pPositions[entity].z - rViewer.z;
+                const float distance = std::sqrt(dx * dx + dz * dz);
+                if (distance > radius)
+                    continue;
+                float priority = 1.0f / (1.0f + distance / m_settings.falloff);
+                if (forwardLength > 0.0f && dx * rForward.x + dz * rForward.z < 0.0f)
+                    priority *= m_settings.behindFactor;
+                m_stamp[entity] = m_selection;
+                const Candidate candidate = { priority * (float)(m_tick - pLastSent[entity] + 1), entity };
+                m_candidates.push_back(candidate);
+            }
+        }
+    }
+
+    // beyond it, in round-robin order: the entities after the cursor were
+    // sent longest ago, as they are only sent from there
+    m_far.clear();
+    unsigned int& rCursor = m_farCursor[client];
+    for (unsigned int step = 0; step < m_entityCount && m_far.size() < slots; ++step)
+    {
+        const unsigned int entity = (rCursor + step) % m_entityCount;
+        if (m_stamp[entity] != m_selection)
+            m_far.push_back(entity);
+    }
+    m_candidatesScored += m_candidates.size() + m_far.size();
+
+    const unsigned int farReserved = std::min((unsigned int)m_far.size(), (unsigned int)std::ceil(slots * m_settings.farShare));
+    const unsigned int inView = std::min((unsigned int)m_candidates.size(), slots - farReserved);
+    if (inView < m_candidates.size())
+        std::nth_element(m_candidates.begin(), m_candidates.begin() + inView, m_candidates.end(), HigherScore());
+    for (unsigned int i = 0; i < inView; ++i)
+    {
+        pLastSent[m_candidates[i].entity] = m_tick;
+        pOut[count++] = m_candidates[i].entity;
+    }
+
+    const unsigned int beyond = std::min((unsigned int)m_far.size(), slots - inView);
+    for (unsigned int i = 0; i < beyond; ++i)
+    {
+        pLastSent[m_far[i]] = m_tick;
+        pOut[count++] = m_far[i];
+    }
+    if (beyond > 0)
+        rCursor = (m_far[beyond - 1] + 1) % m_entityCount;
+    return count;
+}
+
+void InterestManager::MarkAllSent(unsigned int client)
+{
+    std::fill(m_lastSent.begin() + client * m_entityCount, m_lastSent.begin() + (client + 1) * m_entityCount, m_tick);
+}
+
+uint32_t InterestManager::GetAge(unsigned int client, unsigned int entity) const
+{
+    return m_tick - m_lastSent[client * m_entityCount + entity];
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+
+struct InterestSettings
+{
+    float viewRadius;       // entities within it are ranked by distance and facing; positive
+    float falloff;          // distance at which a visible entity's priority halves
+    float behindFactor;     // priority kept by visible entities behind the viewer
+    float farShare;         // of the budget kept for entities beyond the view radius
+    unsigned int budget;    // entities per client per snapshot, required ones included
+};
+
+// Settings for the match pitch with the given budget: half its length in
+// view, priority halving every three metres, a quarter of the budget for
+// entities beyond that.
+InterestSettings CreateMatchInterestSettings(unsigned int budget);
+
+// Picks which entities each client is sent. Entities in view carry, per
+// client, the ticks since they were last sent; their score is that age times
+// a priority falling with distance and for being behind the viewer, so near
+// entities in front refresh often and the others in view still do in turn.
+// Each snapshot the highest scores are sent and their age restarts.
+// Entities beyond the view radius take turns in round-robin order in a
+// share of the budget, and in whatever the view leaves unused.
+//
+// Entities are bucketed in a uniform grid on the ground plane each tick. A
+// selection only looks at the cells within the view radius and the next few
+// entities in round-robin order, so at a given density its cost does not
+// grow with the entity count.
+class InterestManager
+{
+public:
+    InterestManager(unsigned int entityCount, unsigned int clientCount, const InterestSettings& rSettings);
+
+    const InterestSettings& GetSettings() const
+    {
+        return m_settings;
+    }
+
+    // Buckets this tick's entity positions.
+    void Update(const glm::vec3* pPositions, uint32_t tick);
+
+    // Writes the entities the client is sent this snapshot to pOut (room for
+    // the budget) and returns how many. The required ones come first, e.g.
+    // the client's own player and the ball.
+    unsigned int Select(unsigned int client, const glm::vec3& rViewer, const glm::vec3& rForward,
+                        const unsigned int* pRequired, unsigned int requiredCount, unsigned int* pOut);
+
+    // Marks every entity as sent this tick, as when the client got a full snapshot.
+    void MarkAllSent(unsigned int client);
+
+    // Ticks since the client was last sent the entity.
+    uint32_t GetAge(unsigned int client, unsigned int entity) const;
+
+    // Entities scored by Select() calls so far.
+    uint64_t GetCandidatesScored() const
+    {
+        return m_candidatesScored;
+    }
+
+private:
+    struct Candidate
+    {
+        float score;
+        unsigned int entity;
+    };
+
+    struct HigherScore
+    {
+        bool operator()(const Candidate& rA, const Candidate& rB) const
+        {
+            return rA.score > rB.score || (rA.score == rB.score && rA.entity < rB.entity);
+        }
+    };
+
+    unsigned int m_entityCount;
+    InterestSettings m_settings;
+    uint32_t m_tick;
+
+    // grid over the ground plane: the entities of a cell are
+    // m_cellEntities[m_cellStart[cell]] up to m_cellStart[cell + 1]
+    const glm::vec3* m_pPositions;
+    float m_cellSize;
+    float m_minX;
+    float m_minZ;
+    unsigned int m_columns;
+    unsigned int m_rows;
+    std::vector<unsigned int> m_cellStart;
+    std::vector<unsigned int> m_cellEntities;
+    std::vector<unsigned int> m_entityCells;
+
+    std::vector<uint32_t> m_lastSent;        // client * entityCount + entity
+    std::vector<unsigned int> m_farCursor;   // per client
+    std::vector<uint32_t> m_stamp;           // per entity, the selection that last scored it
+    uint32_t m_selection;
+    std::vector<Candidate> m_candidates;
+    std::vector<unsigned int> m_far;
+    uint64_t m_candidatesScored;
+};
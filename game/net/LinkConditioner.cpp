@@ -0,0 +1,90 @@
+#include "LinkConditioner.h"
+
+#include <cstring>
+
+LinkConditioner::LinkConditioner(unsigned int capacity)
+    : m_latencyMs(0.0f),
+      m_jitterMs(0.0f),
+      m_lossPercent(0.0f),
+      m_random(0x12345678u),
+      m_dropped(0),
+      m_pool(capacity)
+{
+    m_free.reserve(capacity);
+    m_held.reserve(capacity);
+    for (unsigned int i = capacity; i-- > 0;)
+        m_free.push_back(i);
+}
+
+void LinkConditioner::SetConditions(float latencyMs, float jitterMs, float lossPercent)
+{
+    m_latencyMs = latencyMs;
+    m_jitterMs = jitterMs;
+    m_lossPercent = lossPercent;
+}
+
+float LinkConditioner::NextRandom()
+{
+    // xorshift32, good enough to pick which packets to lose
+    m_random ^= m_random << 13;
+    m_random ^= m_random >> 17;
+    m_random ^= m_random << 5;
+    return (m_random >> 8) * (1.0f / 16777216.0f);
+}
+
+void LinkConditioner::Send(UdpSocket& rSocket, const NetAddress& rTo, const void* pData, unsigned int size, double nowMs)
+{
+    if (m_lossPercent > 0.0f && NextRandom() * 100.0f < m_lossPercent)
+    {
+        ++m_dropped;
+        return;
+    }
+
+    double delayMs = m_latencyMs + m_jitterMs * NextRandom();
+    if (delayMs <= 0.0 || size > MAX_DATAGRAM)
+    {
+        rSocket.Send(rTo, pData, size);
+        return;
+    }
+    if (m_free.empty())
+    {
+        // a full queue behaves like a congested router
+        ++m_dropped;
+        return;
+    }
+
+    unsigned int slot = m_free.back();
+    m_free.pop_back();
+    Datagram& rDatagram = m_pool[slot];
+    rDatagram.dueMs = nowMs + delayMs;
+    rDatagram.to = rTo;
+    rDatagram.size = size;
+    std::memcpy(rDatagram.data, pData, size);
+    m_held.push_back(slot);
+}
+
+void LinkConditioner::Clear()
+{
+    m_free.insert(m_free.end(), m_held.begin(), m_held.end());
+    m_held.clear();
+}
+
+void LinkConditioner::Flush(UdpSocket& rSocket, double nowMs)
+{
+    // Jitter may reorder datagrams, exactly like a real link.
+    unsigned int kept = 0;
+    for (unsigned int i = 0; i < m_held.size(); ++i)
+    {
+        Datagram& rDatagram = m_pool[m_held[i]];
+        if (rDatagram.dueMs <= nowMs)
+        {
+            rSocket.Send(rDatagram.to, rDatagram.data, rDatagram.size);
+            m_free.push_back(m_held[i]);
+        }
+        else
+        {
+            m_held[kept++] = m_held[i];
+        }
+    }
+    m_held.resize(kept);
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "UdpSocket.h"
+
+#include <vector>
+
+// Sits in front of UdpSocket::Send() and makes a perfect loopback link behave
+// like the internet: every datagram is dropped with the given probability or
+// held back for the latency plus a random jitter. Held datagrams live in a
+// preallocated pool and go out from Flush() once due.
+class LinkConditioner
+{
+public:
+    static const unsigned int MAX_DATAGRAM = 1400;
+
+    explicit LinkConditioner(unsigned int capacity = 512);
+
+    void SetConditions(float latencyMs, float jitterMs, float lossPercent);
+
+    float GetLatencyMs() const
+    {
+        return m_latencyMs;
+    }
+
+    float GetJitterMs() const
+    {
+        return m_jitterMs;
+    }
+
+    float GetLossPercent() const
+    {
+        return m_lossPercent;
+    }
+
+    // True without conditions, when Send() would go straight to the socket.
+    bool IsPerfect() const
+    {
+        return m_latencyMs <= 0.0f && m_jitterMs <= 0.0f && m_lossPercent <= 0.0f;
+    }
+
+    void Send(UdpSocket& rSocket, const NetAddress& rTo, const void* pData, unsigned int size, double nowMs);
+
+    // Sends every held datagram whose time has come.
+    void Flush(UdpSocket& rSocket, double nowMs);
+
+    // Drops every held datagram, for a link being closed.
+    void Clear();
+
+    unsigned int GetDroppedCount() const
+    {
+        return m_dropped;
+    }
+
+private:
+    struct Datagram
+    {
+        double dueMs;
+        NetAddress to;
+        unsigned int size;
+        unsigned char data[MAX_DATAGRAM];
+    };
+
+    float NextRandom();
+
+    float m_latencyMs;
+    float m_jitterMs;
+    float m_lossPercent;
+    unsigned int m_random;
+    unsigned int m_dropped;
+
+    std::vector<Datagram> m_pool;
+    std::vector<unsigned int> m_free;
+    std::vector<unsigned int> m_held;
+};
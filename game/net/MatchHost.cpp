@@ -0,0 +1,239 @@
+#include "MatchHost.h"
+#include "GameServer.h"
+#include "../Match.h"
+#include "../core/Arena.h"
+#include "../core/Percentile.h"
+#include "../core/WorkerPool.h"
+
+#include <algorithm>
+#include <new>
+
+namespace
+{
+    typedef std::chrono::steady_clock Clock;
+
+    // Through AllocateAligned(), so into the current arena when there is one.
+    void CreateMatch(Match*& rpMatch, GameServer*& rpServer, unsigned int snapshotInterval)
+    {
+        rpMatch = new (AllocateAligned(sizeof(Match))) Match();
+        rpServer = new (AllocateAligned(sizeof(GameServer))) GameServer(*rpMatch, snapshotInterval);
+    }
+}
+
+MatchHost::MatchHost(unsigned int matchCount, unsigned int workerCount, unsigned int snapshotInterval,
+                     size_t arenaBytes)
+    : m_matches(matchCount),
+      m_workerCount(workerCount == 0 ? 1 : workerCount),
+      m_periodMs(1000.0 / Match::TICK_RATE),
+      m_pinning(true),
+      m_pinnedCount(0),
+      m_running(false),
+      m_start(Clock::now())
+{
+    for (unsigned int i = 0; i < m_matches.size(); ++i)
+    {
+        HostedMatch& rHosted = m_matches[i];
+        rHosted.pArena = arenaBytes > 0 ? new Arena(arenaBytes) : nullptr;
+
+        // The match, its server and their simulation blocks go into the
+        // arena one after another; without one they come from the heap.
+        if (rHosted.pArena != nullptr)
+        {
+            ArenaScope scope(*rHosted.pArena);
+            CreateMatch(rHosted.pMatch, rHosted.pServer, snapshotInterval);
+        }
+        else
+        {
+            CreateMatch(rHosted.pMatch, rHosted.pServer, snapshotInterval);
+        }
+
+        rHosted.dueMs = 0.0;
+        rHosted.ticks = 0;
+        rHosted.missedDeadlines = 0;
+        rHosted.maxLatenessMs = 0.0f;
+        rHosted.resetPending = false;
+        rHosted.clients = 0;
+    }
+
+    for (unsigned int worker = 0; worker < m_workerCount; ++worker)
+        m_pools.push_back(new WorkerPool(1));
+}
+
+MatchHost::~MatchHost()
+{
+    Stop();
+    for (unsigned int i = 0; i < m_matches.size(); ++i)
+    {
+        HostedMatch& rHosted = m_matches[i];
+        rHosted.pServer->~GameServer();
+        FreeAligned(rHosted.pServer);
+        rHosted.pMatch->~Match();
+        FreeAligned(rHosted.pMatch);
+        delete rHosted.pArena;
+    }
+    for (unsigned int worker = 0; worker < m_pools.size(); ++worker)
+        delete m_pools[worker];
+}
+
+bool MatchHost::Open(uint32_t ip, uint16_t firstPort, UdpBackend backend)
+{
+    for (unsigned int i = 0; i < m_matches.size(); ++i)
+    {
+        const uint16_t port = firstPort == 0 ? 0 : (uint16_t)(firstPort + i);
+        if (!m_matches[i].pServer->Open(ip, port, backend))
+            return false;
+    }
+    return true;
+}
+
+void MatchHost::Start()
+{
+    if (m_running)
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_start = Clock::now();
+        m_running = true;
+        m_ready.clear();
+        for (unsigned int i = 0; i < m_matches.size(); ++i)
+        {
+            m_matches[i].dueMs = m_periodMs * i / m_matches.size();
+            m_ready.push_back(i);
+        }
+        LaterDeadline later = { &m_matches };
+        std::make_heap(m_ready.begin(), m_ready.end(), later);
+    }
+
+    m_pinnedCount = 0;
+    for (unsigned int worker = 0; worker < m_workerCount; ++worker)
+    {
+        m_threads.push_back(std::thread(&MatchHost::WorkerLoop, this, worker));
+        if (m_pinning && PinThreadToCore(m_threads.back(), worker))
+            ++m_pinnedCount;
+    }
+}
+
+void MatchHost::Stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_running)
+            return;
+        m_running = false;
+    }
+    m_wakeCondition.notify_all();
+
+    for (unsigned int i = 0; i < m_threads.size(); ++i)
+        m_threads[i].join();
+    m_threads.clear();
+}
+
+NetAddress MatchHost::GetLocalAddress(unsigned int match) const
+{
+    return m_matches[match].pServer->GetLocalAddress();
+}
+
+UdpBackend MatchHost::GetBackend() const
+{
+    return m_matches.empty() ? UDP_BACKEND_SINGLE : m_matches[0].pServer->GetBackend();
+}
+
+MatchTickStats MatchHost::GetTickStats(unsigned int match) const
+{
+    std::vector<float> tickMs;
+    MatchTickStats stats;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const HostedMatch& rHosted = m_matches[match];
+        tickMs = rHosted.tickMs;
+        stats.ticks = rHosted.ticks;
+        stats.missedDeadlines = rHosted.missedDeadlines;
+        stats.maxLatenessMs = rHosted.maxLatenessMs;
+        stats.clients = rHosted.clients;
+    }
+
+    stats.p50Ms = Percentile(tickMs, 0.50f);
+    stats.p90Ms = Percentile(tickMs, 0.90f);
+    stats.p99Ms = Percentile(tickMs, 0.99f);
+    stats.maxMs = Percentile(tickMs, 1.0f);
+    const Arena* pArena = m_matches[match].pArena;
+    stats.arenaBytes = pArena != nullptr ? pArena->GetUsed() : 0;
+    stats.overflowBytes = pArena != nullptr ? pArena->GetOverflowBytes() : 0;
+    return stats;
+}
+
+void MatchHost::ResetStats()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (unsigned int i = 0; i < m_matches.size(); ++i)
+    {
+        HostedMatch& rHosted = m_matches[i];
+        rHosted.ticks = 0;
+        rHosted.missedDeadlines = 0;
+        rHosted.maxLatenessMs = 0.0f;
+        rHosted.tickMs.clear();
+        rHosted.resetPending = true;
+    }
+}
+
+double MatchHost::NowMs() const
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - m_start).count();
+}
+
+void MatchHost::WorkerLoop(unsigned int worker)
+{
+    LaterDeadline later = { &m_matches };
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (m_running)
+    {
+        if (m_ready.empty())
+        {
+            m_wakeCondition.wait(lock);
+            continue;
+        }
+
+        // the earliest deadline is due first too, as every match has the same period
+        const unsigned int index = m_ready.front();
+        const double dueMs = m_matches[index].dueMs;
+        const double startMs = NowMs();
+        if (startMs < dueMs)
+        {
+            m_wakeCondition.wait_until(lock, m_start + std::chrono::duration_cast<Clock::duration>(
+                                                           std::chrono::duration<double, std::milli>(dueMs)));
+            continue;
+        }
+        std::pop_heap(m_ready.begin(), m_ready.end(), later);
+        m_ready.pop_back();
+
+        HostedMatch& rHosted = m_matches[index];
+        const bool reset = rHosted.resetPending;
+        rHosted.resetPending = false;
+        lock.unlock();
+
+        if (reset)
+            rHosted.pServer->ResetStats();
+        rHosted.pServer->Update(*m_pools[worker], startMs);
+        const unsigned int clients = rHosted.pServer->GetClientCount();
+        const double endMs = NowMs();
+
+        lock.lock();
+        rHosted.tickMs.push_back((float)(endMs - startMs));
+        rHosted.ticks++;
+        rHosted.maxLatenessMs = std::max(rHosted.maxLatenessMs, (float)(startMs - dueMs));
+        if (endMs > dueMs + m_periodMs)
+            rHosted.missedDeadlines++;
+        rHosted.clients = clients;
+
+        // after an overrun the match's schedule restarts rather than bursting
+        rHosted.dueMs += m_periodMs;
+        if (rHosted.dueMs < endMs)
+            rHosted.dueMs = endMs;
+        m_ready.push_back(index);
+        std::push_heap(m_ready.begin(), m_ready.end(), later);
+
+        // a worker sleeping towards a later deadline has to look again
+        m_wakeCondition.notify_one();
+    }
+}
@@ -0,0 +1,132 @@
+#pragma once
+
+#include "BatchedUdpSocket.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class Arena;
+class GameServer;
+class Match;
+class WorkerPool;
+
+struct MatchTickStats
+{
+    unsigned int ticks;
+    unsigned int missedDeadlines;    // ticks that finished after the next one was due
+    float p50Ms;                     // Update() duration
+    float p90Ms;
+    float p99Ms;
+    float maxMs;
+    float maxLatenessMs;             // longest a due tick waited for a worker
+    unsigned int clients;
+    size_t arenaBytes;               // used of the match's arena
+    size_t overflowBytes;            // that did not fit and went to the heap
+};
+
+// Runs many independent matches in one process, each a Match and GameServer
+// with its own UDP port. Tick k of match m is due at m's phase plus k tick
+// periods and must finish before tick k + 1 is due; phases are spread over
+// the period so the matches' ticks do not all come due at once.
+//
+// A fixed set of worker threads, each pinned to a core, takes the due tick
+// with the earliest deadline next (earliest deadline first) and runs it to
+// completion. A match is only ever on one worker at a time, and each keeps
+// its Match, GameServer and their simulation blocks together in one arena.
+class MatchHost
+{
+public:
+    static const size_t DEFAULT_ARENA_BYTES = 256 << 10;
+
+    // arenaBytes 0 leaves every match on the heap, for comparison.
+    MatchHost(unsigned int matchCount, unsigned int workerCount, unsigned int snapshotInterval,
+              size_t arenaBytes = DEFAULT_ARENA_BYTES);
+    ~MatchHost();
+
+    // Match m listens on firstPort + m, or on any free port when firstPort
+    // is 0.
+    bool Open(uint32_t ip, uint16_t firstPort, UdpBackend backend = UDP_BACKEND_MMSG);
+
+    // Best effort; call before Start().
+    void SetPinning(bool enabled)
+    {
+        m_pinning = enabled;
+    }
+
+    void Start();
+    void Stop();
+
+    unsigned int GetMatchCount() const
+    {
+        return (unsigned int)m_matches.size();
+    }
+
+    unsigned int GetWorkerCount() const
+    {
+        return m_workerCount;
+    }
+
+    // Workers that could be pinned in the last Start().
+    unsigned int GetPinnedCount() const
+    {
+        return m_pinnedCount;
+    }
+
+    NetAddress GetLocalAddress(unsigned int match) const;
+    UdpBackend GetBackend() const;
+
+    // Safe while the host runs.
+    MatchTickStats GetTickStats(unsigned int match) const;
+    void ResetStats();
+
+private:
+    MatchHost(const MatchHost&);
+    MatchHost& operator=(const MatchHost&);
+
+    struct HostedMatch
+    {
+        Arena* pArena;
+        Match* pMatch;
+        GameServer* pServer;
+        double dueMs;                 // when the next tick may start
+        unsigned int ticks;
+        unsigned int missedDeadlines;
+        float maxLatenessMs;
+        std::vector<float> tickMs;
+        bool resetPending;            // the server's own stats, reset by its worker
+        unsigned int clients;
+    };
+
+    // Earliest deadline first; the deadline is the next tick's due time.
+    struct LaterDeadline
+    {
+        const std::vector<HostedMatch>* pMatches;
+
+        bool operator()(unsigned int a, unsigned int b) const
+        {
+            return (*pMatches)[a].dueMs > (*pMatches)[b].dueMs;
+        }
+    };
+
+    void WorkerLoop(unsigned int worker);
+    double NowMs() const;
+
+    std::vector<HostedMatch> m_matches;
+    unsigned int m_workerCount;
+    double m_periodMs;
+    bool m_pinning;
+    unsigned int m_pinnedCount;
+    std::vector<std::thread> m_threads;
+    std::vector<WorkerPool*> m_pools;       // one inline pool per worker
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_wakeCondition;
+    std::vector<unsigned int> m_ready;      // heap of matches not on a worker
+    bool m_running;
+    std::chrono::steady_clock::time_point m_start;
+};
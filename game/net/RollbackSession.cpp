@@ -0,0 +1,213 @@
+#include "RollbackSession.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+namespace
+{
+    const uint32_t PACKET_MAGIC = 0x4E494244u;   // "DBIN"
+
+    struct InputPacketHeader
+    {
+        uint32_t magic;
+        uint32_t firstTick;      // first tick of the inputs that follow
+        uint32_t tickCount;
+        uint32_t received;       // sender has the receiver's inputs below this tick
+        uint32_t hashTick;       // NO_TICK when no confirmed tick yet
+        uint32_t reserved;
+        uint64_t hash;
+    };
+
+    typedef std::chrono::steady_clock Clock;
+}
+
+RollbackSession::RollbackSession(Match& rMatch, unsigned int localPeer)
+    : m_pMatch(&rMatch),
+      m_localFirst(localPeer == 0 ? 0 : PLAYERS_PER_PEER),
+      m_remoteFirst(localPeer == 0 ? PLAYERS_PER_PEER : 0),
+      m_snapshots(rMatch, MAX_PREDICTION + 2),
+      m_frames(INPUT_WINDOW * Match::PLAYER_COUNT),
+      m_lastRemoteInputs(PLAYERS_PER_PEER),
+      m_tickHashes(INPUT_WINDOW),
+      m_tickHashTicks(INPUT_WINDOW),
+      m_packet(LinkConditioner::MAX_DATAGRAM)
+{
+    m_remote.ip = NET_LOOPBACK;
+    m_remote.port = 0;
+    Start();
+}
+
+bool RollbackSession::Open(uint16_t port)
+{
+    return m_socket.Open(NET_LOOPBACK, port);
+}
+
+void RollbackSession::Start()
+{
+    const unsigned int tick = m_pMatch->GetTick();
+    std::fill(m_lastRemoteInputs.begin(), m_lastRemoteInputs.end(), PlayerInput());
+    std::fill(m_tickHashTicks.begin(), m_tickHashTicks.end(), NO_TICK);
+    m_remoteReceived = tick;
+    m_remoteAcked = tick;
+    m_rollbackTo = NO_TICK;
+
+    std::memset(&m_stats, 0, sizeof(m_stats));
+    m_stats.checkedTick = NO_TICK;
+    m_stats.desyncTick = NO_TICK;
+}
+
+bool RollbackSession::AdvanceFrame(const PlayerInput* pLocalInputs, WorkerPool& rPool, double nowMs)
+{
+    m_conditioner.Flush(m_socket, nowMs);
+    ReceivePackets();
+
+    m_stats.rollbackDepth = 0;
+    m_stats.resimMs = 0.0f;
+    if (m_rollbackTo != NO_TICK)
+        Rollback(rPool);
+
+    const unsigned int tick = m_pMatch->GetTick();
+    bool advanced = false;
+    if (tick < m_remoteReceived + MAX_PREDICTION)
+    {
+        std::memcpy(GetFrame(tick) + m_localFirst, pLocalInputs, PLAYERS_PER_PEER * sizeof(PlayerInput));
+        SimulateTick(rPool);
+        advanced = true;
+    }
+    else
+    {
+        ++m_stats.stalls;
+    }
+
+    const unsigned int newTick = m_pMatch->GetTick();
+    m_stats.predictedTicks = newTick > m_remoteReceived ? newTick - m_remoteReceived : 0;
+    SendInputs(nowMs);
+    return advanced;
+}
+
+void RollbackSession::SimulateTick(WorkerPool& rPool)
+{
+    const unsigned int tick = m_pMatch->GetTick();
+    PlayerInput* pFrame = GetFrame(tick);
+    if (tick >= m_remoteReceived)
+        std::memcpy(pFrame + m_remoteFirst, &m_lastRemoteInputs[0], PLAYERS_PER_PEER * sizeof(PlayerInput));
+
+    m_snapshots.Save(*m_pMatch);
+    m_pMatch->Tick(pFrame, rPool);
+
+    const unsigned int slot = tick % INPUT_WINDOW;
+    m_tickHashes[slot] = m_pMatch->GetStateHash();
+    m_tickHashTicks[slot] = tick;
+}
+
+// Last simulated tick whose remote input was known and not contradicted by a
+// pending rollback, so its hash is final.
+unsigned int RollbackSession::GetLastConfirmedTick() const
+{
+    unsigned int end = std::min(m_remoteReceived, m_pMatch->GetTick());
+    if (m_rollbackTo != NO_TICK)
+        end = std::min(end, m_rollbackTo);
+    if (end == 0 || m_tickHashTicks[(end - 1) % INPUT_WINDOW] != end - 1)
+        return NO_TICK;
+    return end - 1;
+}
+
+void RollbackSession::Rollback(WorkerPool& rPool)
+{
+    const unsigned int present = m_pMatch->GetTick();
+    const unsigned int from = m_rollbackTo;
+    m_rollbackTo = NO_TICK;
+    if (!m_snapshots.Load(*m_pMatch, from))
+        return;
+
+    Clock::time_point start = Clock::now();
+    while (m_pMatch->GetTick() < present)
+        SimulateTick(rPool);
+
+    m_stats.rollbackDepth = present - from;
+    m_stats.resimMs = std::chrono::duration<float, std::milli>(Clock::now() - start).count();
+    m_stats.maxRollbackDepth = std::max(m_stats.maxRollbackDepth, m_stats.rollbackDepth);
+    m_stats.maxResimMs = std::max(m_stats.maxResimMs, m_stats.resimMs);
+    ++m_stats.rollbacks;
+}
+
+void RollbackSession::ReceivePackets()
+{
+    NetAddress from;
+    int size;
+    while ((size = m_socket.Receive(&m_packet[0], m_packet.size(), from)) >= 0)
+    {
+        InputPacketHeader header;
+        if (!(from == m_remote) || (size_t)size < sizeof(header))
+            continue;
+        std::memcpy(&header, &m_packet[0], sizeof(header));
+        const size_t tickBytes = PLAYERS_PER_PEER * sizeof(PlayerInput);
+        if (header.magic != PACKET_MAGIC || (size_t)size != sizeof(header) + header.tickCount * tickBytes)
+            continue;
+        ++m_stats.packetsReceived;
+
+        m_remoteAcked = std::max(m_remoteAcked, header.received);
+
+        // Inputs are taken strictly in order; anything past a gap comes again
+        // in a later packet because the ack has not moved.
+        const unsigned int present = m_pMatch->GetTick();
+        for (unsigned int i = 0; i < header.tickCount; ++i)
+        {
+            const unsigned int tick = header.firstTick + i;
+            if (tick != m_remoteReceived)
+                continue;
+
+            const unsigned char* pInputs = &m_packet[sizeof(header) + i * tickBytes];
+            PlayerInput* pSlot = GetFrame(tick) + m_remoteFirst;
+            if (tick < present && std::memcmp(pSlot, pInputs, tickBytes) != 0)
+                m_rollbackTo = std::min(m_rollbackTo, tick);
+            std::memcpy(pSlot, pInputs, tickBytes);
+            std::memcpy(&m_lastRemoteInputs[0], pInputs, tickBytes);
+            ++m_remoteReceived;
+        }
+
+        const unsigned int confirmed = GetLastConfirmedTick();
+        const unsigned int slot = header.hashTick % INPUT_WINDOW;
+        if (header.hashTick != NO_TICK && confirmed != NO_TICK && header.hashTick <= confirmed
+            && m_tickHashTicks[slot] == header.hashTick)
+        {
+            if (m_tickHashes[slot] != header.hash)
+            {
+                if (m_stats.desyncTick == NO_TICK)
+                    m_stats.desyncTick = header.hashTick;
+            }
+            else if (m_stats.checkedTick == NO_TICK || header.hashTick > m_stats.checkedTick)
+            {
+                m_stats.checkedTick = header.hashTick;
+            }
+        }
+    }
+}
+
+void RollbackSession::SendInputs(double nowMs)
+{
+    if (m_remote.port == 0)
+        return;
+
+    const unsigned int present = m_pMatch->GetTick();
+    unsigned int first = std::max(m_remoteAcked, present > MAX_SEND_TICKS ? present - MAX_SEND_TICKS : 0u);
+    first = std::min(first, present);
+
+    InputPacketHeader header;
+    header.magic = PACKET_MAGIC;
+    header.firstTick = first;
+    header.tickCount = present - first;
+    header.received = m_remoteReceived;
+    header.hashTick = GetLastConfirmedTick();
+    header.reserved = 0;
+    header.hash = header.hashTick != NO_TICK ? m_tickHashes[header.hashTick % INPUT_WINDOW] : 0;
+
+    const size_t tickBytes = PLAYERS_PER_PEER * sizeof(PlayerInput);
+    std::memcpy(&m_packet[0], &header, sizeof(header));
+    for (unsigned int i = 0; i < header.tickCount; ++i)
+        std::memcpy(&m_packet[sizeof(header) + i * tickBytes], GetFrame(first + i) + m_localFirst, tickBytes);
+
+    m_conditioner.Send(m_socket, m_remote, &m_packet[0], (unsigned int)(sizeof(header) + header.tickCount * tickBytes), nowMs);
+    ++m_stats.packetsSent;
+}
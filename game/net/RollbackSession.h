@@ -0,0 +1,118 @@
+#pragma once
+
+#include "../IControl.h"
+#include "../Match.h"
+#include "LinkConditioner.h"
+#include "SnapshotRing.h"
+#include "UdpSocket.h"
+
+#include <cstdint>
+#include <vector>
+
+class WorkerPool;
+
+struct RollbackStats
+{
+    unsigned int rollbackDepth;      // ticks re-simulated by the last AdvanceFrame()
+    float resimMs;                   // time those ticks took
+    unsigned int maxRollbackDepth;
+    float maxResimMs;
+    unsigned int rollbacks;
+    unsigned int stalls;             // frames spent waiting for remote input
+    unsigned int predictedTicks;     // ticks simulated ahead of the remote peer's input
+    unsigned int packetsSent;
+    unsigned int packetsReceived;
+    unsigned int checkedTick;        // last tick whose state hash both peers compared
+    unsigned int desyncTick;         // first tick the hashes differed, NO_TICK if never
+};
+
+// GGPO-style rollback between two peers, each owning one team. Every tick
+// the local inputs are applied at once and the remote team's inputs are
+// predicted by repeating the last ones received. The state before each tick
+// goes into a SnapshotRing; when the real remote input for a tick arrives and
+// differs from the prediction, the match is restored to that tick and
+// re-simulated to the present within the same frame.
+//
+// Each datagram carries every local input the remote peer has not
+// acknowledged, so a lost packet is repaired by the next one, plus the state
+// hash after the last tick whose inputs the sender has confirmed.
+class RollbackSession
+{
+public:
+    static const unsigned int PLAYERS_PER_PEER = Match::PLAYER_COUNT / 2;
+    static const unsigned int MAX_PREDICTION = 12;
+    static const unsigned int NO_TICK = 0xFFFFFFFFu;
+
+    // localPeer 0 owns players [0, PLAYERS_PER_PEER), peer 1 the rest.
+    RollbackSession(Match& rMatch, unsigned int localPeer);
+
+    // Binds a socket on the loopback interface; port 0 picks a free one.
+    bool Open(uint16_t port);
+    NetAddress GetLocalAddress() const
+    {
+        return m_socket.GetLocalAddress();
+    }
+    void SetRemote(const NetAddress& rRemote)
+    {
+        m_remote = rRemote;
+    }
+
+    // Restarts the exchange from the match's current tick. Both peers must
+    // start from identical matches.
+    void Start();
+
+    LinkConditioner& GetConditioner()
+    {
+        return m_conditioner;
+    }
+
+    // Sends and receives inputs, rolls back if a prediction was wrong, then
+    // runs one tick with pLocalInputs (PLAYERS_PER_PEER of them) unless the
+    // peer is MAX_PREDICTION ticks behind. Returns whether a tick ran.
+    bool AdvanceFrame(const PlayerInput* pLocalInputs, WorkerPool& rPool, double nowMs);
+
+    const RollbackStats& GetStats() const
+    {
+        return m_stats;
+    }
+
+private:
+    RollbackSession(const RollbackSession&);
+    RollbackSession& operator=(const RollbackSession&);
+
+    PlayerInput* GetFrame(unsigned int tick)
+    {
+        return &m_frames[(tick % INPUT_WINDOW) * Match::PLAYER_COUNT];
+    }
+
+    void ReceivePackets();
+    void SendInputs(double nowMs);
+    void Rollback(WorkerPool& rPool);
+    void SimulateTick(WorkerPool& rPool);
+    unsigned int GetLastConfirmedTick() const;
+
+    static const unsigned int INPUT_WINDOW = 64;
+    static const unsigned int MAX_SEND_TICKS = 2 * MAX_PREDICTION + 4;
+
+    Match* m_pMatch;
+    unsigned int m_localFirst;
+    unsigned int m_remoteFirst;
+
+    UdpSocket m_socket;
+    NetAddress m_remote;
+    LinkConditioner m_conditioner;
+    SnapshotRing m_snapshots;
+
+    std::vector<PlayerInput> m_frames;             // INPUT_WINDOW ticks of PLAYER_COUNT inputs
+    std::vector<PlayerInput> m_lastRemoteInputs;   // prediction for unconfirmed ticks
+    unsigned int m_remoteReceived;                 // remote inputs are known below this tick
+    unsigned int m_remoteAcked;                    // the peer has our inputs below this tick
+    unsigned int m_rollbackTo;
+
+    // State hash after each of the last INPUT_WINDOW ticks, as last simulated.
+    std::vector<uint64_t> m_tickHashes;
+    std::vector<unsigned int> m_tickHashTicks;
+
+    std::vector<unsigned char> m_packet;
+    RollbackStats m_stats;
+};
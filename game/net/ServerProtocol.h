@@ -0,0 +1,83 @@
+#pragma once
+
+#include "../IControl.h"
+#include "../Match.h"
+
+#include <cstdint>
+
+// Datagrams exchanged between DeathBallServer and its clients. Every packet
+// starts with a PacketHeader and is sent as laid out in memory; all supported
+// targets are little-endian.
+
+const uint32_t SERVER_PACKET_MAGIC = 0x56534244u;   // "DBSV"
+const uint16_t SERVER_DEFAULT_PORT = 27015;
+const unsigned int SERVER_NO_PLAYER = 0xFF;
+const unsigned int SERVER_MAX_PACKET = 1400;
+const uint32_t NO_SNAPSHOT_TICK = 0xFFFFFFFFu;
+
+enum ServerPacketType
+{
+    PACKET_CONNECT,      // client -> server, resent until answered
+    PACKET_ACCEPT,       // server -> client, header.player is the controlled player
+    PACKET_REJECT,       // server -> client, every player is taken
+    PACKET_INPUT,        // client -> server
+    PACKET_SNAPSHOT,     // server -> client
+    PACKET_DISCONNECT,   // either way
+    PACKET_SPECTATE,     // spectator -> relay, resent until frames arrive and then as a keepalive
+    PACKET_BROADCAST     // relay -> spectator, a SnapshotHeader coded against a keyframe
+};
+
+struct PacketHeader
+{
+    uint32_t magic;
+    uint8_t type;
+    uint8_t player;
+    uint16_t reserved;
+};
+
+struct AcceptPacket
+{
+    PacketHeader header;
+    uint32_t tick;
+    uint32_t tickRate;
+};
+
+// Each input packet repeats the client's newest INPUT_REDUNDANCY inputs, so
+// a lost packet is covered by the next one. Inputs are numbered by the
+// client from 0 and applied by the server one per tick in that order.
+// The view time says which moment of the match the client was showing when
+// it sent the newest input; the server judges its charges against that
+// moment. PlayerInput::target is the server's to fill and is ignored.
+const unsigned int INPUT_REDUNDANCY = 4;
+const uint32_t NO_INPUT_SEQUENCE = 0xFFFFFFFFu;
+
+struct InputPacket
+{
+    PacketHeader header;
+    uint32_t sequence;   // number of the newest input, the last one in inputs
+    uint32_t count;
+    uint32_t ackTick;    // newest snapshot decoded, the baseline for the next ones
+    uint32_t viewTick;   // NO_SNAPSHOT_TICK before the first snapshot
+    uint16_t viewFraction;   // of a tick past viewTick, in 65536ths
+    uint16_t reserved;
+    PlayerInput inputs[INPUT_REDUNDANCY];
+};
+
+// The ball followed by every player in Match::GetPlayers() order.
+const unsigned int SNAPSHOT_ENTITY_COUNT = Match::PLAYER_COUNT + 1;
+
+// Snapshots both sides keep as baselines; at one snapshot every two ticks
+// this covers about a second of acknowledgement delay.
+const unsigned int SNAPSHOT_HISTORY = 32;
+
+// Followed by a SnapshotCodec payload delta coded against the snapshot of
+// baselineTick, or against nothing when it is NO_SNAPSHOT_TICK.
+struct SnapshotHeader
+{
+    PacketHeader header;
+    uint32_t tick;
+    uint32_t baselineTick;
+    uint32_t inputSequence;   // newest input of the receiving client applied before tick, none for broadcasts
+    uint32_t reserved;
+    uint64_t stateHash;
+};
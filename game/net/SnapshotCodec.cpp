@@ -0,0 +1,372 @@
+#include "SnapshotCodec.h"
+#include "BitStream.h"
+#include "../Match.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+    // Position deltas from the baseline: +-0.5 m in 10 bits, +-8 m in 14,
+    // anything further as an absolute value.
+    const unsigned int NEAR_DELTA_BITS = 10;
+    const unsigned int FAR_DELTA_BITS = 14;
+    const unsigned int VELOCITY_DELTA_BITS = 7;   // +-1 m/s
+    const unsigned int GAP_BITS = 4;
+
+    const float SQRT_HALF = 0.70710678f;
+
+    unsigned int BitsFor(uint32_t maxValue)
+    {
+        unsigned int bits = 1;
+        while (bits < 32 && (maxValue >> bits) != 0)
+            ++bits;
+        return bits;
+    }
+
+    bool FitsSigned(int32_t value, unsigned int bits)
+    {
+        const int32_t limit = 1 << (bits - 1);
+        return value >= -limit && value < limit;
+    }
+
+    int32_t ReadSigned(BitReader& rIn, unsigned int bits)
+    {
+        const uint32_t value = rIn.Read(bits);
+        const uint32_t sign = 1u << (bits - 1);
+        return (int32_t)((value ^ sign) - sign);
+    }
+
+    uint32_t QuantiseOrientation(const glm::vec4& rQ)
+    {
+        const float q[4] = { rQ.x, rQ.y, rQ.z, rQ.w };
+        unsigned int largest = 0;
+        for (unsigned int i = 1; i < 4; ++i)
+        {
+            if (std::fabs(q[i]) > std::fabs(q[largest]))
+                largest = i;
+        }
+
+        // q and -q are the same rotation, so the dropped component is made positive
+        const float sign = q[largest] < 0.0f ? -1.0f : 1.0f;
+        const float maxValue = (float)((1u << SnapshotCodec::ORIENTATION_BITS) - 1);
+        uint32_t packed = largest;
+        for (unsigned int i = 0; i < 4; ++i)
+        {
+            if (i == largest)
+                continue;
+            float unit = (sign * q[i] / SQRT_HALF + 1.0f) * 0.5f;
+            unit = std::min(std::max(unit, 0.0f), 1.0f);
+            packed = (packed << SnapshotCodec::ORIENTATION_BITS) | (uint32_t)(unit * maxValue + 0.5f);
+        }
+        return packed;
+    }
+
+    glm::vec4 DequantiseOrientation(uint32_t packed)
+    {
+        const uint32_t mask = (1u << SnapshotCodec::ORIENTATION_BITS) - 1;
+        const float maxValue = (float)mask;
+        const unsigned int largest = packed >> (3 * SnapshotCodec::ORIENTATION_BITS);
+
+        float q[4];
+        float sumSq = 0.0f;
+        unsigned int shift = 2 * SnapshotCodec::ORIENTATION_BITS;
+        for (unsigned int i = 0; i < 4; ++i)
+        {
+            if (i == largest)
+                continue;
+            q[i] = (((packed >> shift) & mask) / maxValue * 2.0f - 1.0f) * SQRT_HALF;
+            sumSq += q[i] * q[i];
+            shift -= SnapshotCodec::ORIENTATION_BITS;
+        }
+        q[largest] = std::sqrt(std::max(0.0f, 1.0f - sumSq));
+        return glm::vec4(q[0], q[1], q[2], q[3]);
+    }
+
+    // Torso frame of a ragdoll: +Y from pelvis to chest, +X towards the right knee.
+    glm::vec4 TorsoOrientation(const RagdollSystem& rRagdolls, unsigned int ragdoll)
+    {
+        const glm::vec3 pelvis = rRagdolls.GetParticle(ragdoll, RagdollSystem::Pelvis);
+        glm::vec3 up = rRagdolls.GetParticle(ragdoll, RagdollSystem::Chest) - pelvis;
+        glm::vec3 right = rRagdolls.GetParticle(ragdoll, RagdollSystem::RightKnee)
+                        - rRagdolls.GetParticle(ragdoll, RagdollSystem::LeftKnee);
+        if (glm::length(up) < 1e-4f)
+            return glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+        up = glm::normalize(up);
+        right -= up * glm::dot(right, up);
+        if (glm::length(right) < 1e-4f)
+            return glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+        right = glm::normalize(right);
+        const glm::vec3 forward = glm::cross(right, up);
+
+        // rotation matrix columns right, up, forward to quaternion
+        const float trace = right.x + up.y + forward.z;
+        glm::vec4 q;
+        if (trace > 0.0f)
+        {
+            const float s = std::sqrt(trace + 1.0f) * 2.0f;
+            q = glm::vec4((up.z - forward.y) / s, (forward.x - right.z) / s, (right.y - up.x) / s, 0.25f * s);
+        }
+        else if (right.x > up.y && right.x > forward.z)
+        {
+            const float s = std::sqrt(1.0f + right.x - up.y - forward.z) * 2.0f;
+            q = glm::vec4(0.25f * s, (up.x + right.y) / s, (forward.x + right.z) / s, (up.z - forward.y) / s);
+        }
+        else if (up.y > forward.z)
+        {
+            const float s = std::sqrt(1.0f + up.y - right.x - forward.z) * 2.0f;
+            q = glm::vec4((up.x + right.y) / s, 0.25f * s, (forward.y + up.z) / s, (forward.x - right.z) / s);
+        }
+        else
+        {
+            const float s = std::sqrt(1.0f + forward.z - right.x - up.y) * 2.0f;
+            q = glm::vec4((forward.x + right.z) / s, (forward.y + up.z) / s, 0.25f * s, (right.y - up.x) / s);
+        }
+        return glm::normalize(q);
+    }
+}
+
+void CaptureEntities(const Match& rMatch, EntityState* pOut)
+{
+    const PhysicsWorld& rWorld = rMatch.GetWorld();
+    const RagdollSystem& rRagdolls = rMatch.GetRagdolls();
+    const std::vector<DeathFootBallPlayer>& rPlayers = rMatch.GetPlayers();
+
+    for (unsigned int i = 0; i <= rPlayers.size(); ++i)
+    {
+        const unsigned int body = i == 0 ? rMatch.GetBall() : rPlayers[i - 1].GetBody();
+        EntityState& rEntity = pOut[i];
+        rEntity.position = rWorld.GetPosition(body);
+        rEntity.velocity = rWorld.GetVelocity(body);
+        rEntity.orientation = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+        rEntity.flags = rWorld.IsAwake(body) ? ENTITY_AWAKE : 0;
+        if (i > 0 && rPlayers[i - 1].IsKnockedOut())
+        {
+            rEntity.orientation = TorsoOrientation(rRagdolls, rPlayers[i - 1].GetRagdoll());
+            rEntity.flags |= ENTITY_KNOCKED_OUT;
+        }
+    }
+}
+
+SnapshotCodec::SnapshotCodec(const glm::vec3& rMin, const glm::vec3& rMax, unsigned int entityCount)
+    : m_min(rMin),
+      m_indexBits(BitsFor(entityCount)),
+      m_entityCount(entityCount)
+{
+    for (unsigned int axis = 0; axis < 3; ++axis)
+    {
+        m_positionMax[axis] = (uint32_t)std::ceil((rMax[axis] - rMin[axis]) * POSITION_SCALE);
+        m_positionBits[axis] = BitsFor(m_positionMax[axis]);
+    }
+}
+
+void SnapshotCodec::Quantise(const EntityState* pStates, NetEntity* pOut) const
+{
+    const int32_t velocityLimit = (1 << (VELOCITY_BITS - 1)) - 1;
+    for (unsigned int i = 0; i < m_entityCount; ++i)
+    {
+        const EntityState& rState = pStates[i];
+        NetEntity& rOut = pOut[i];
+        for (unsigned int axis = 0; axis < 3; ++axis)
+        {
+            // clamped as floats, NaN to zero: converting a float out of the
+            // integer's range is undefined
+            float position = (rState.position[axis] - m_min[axis]) * POSITION_SCALE + 0.5f;
+            position = position > 0.0f ? std::min(position, (float)m_positionMax[axis]) : 0.0f;
+            rOut.position[axis] = std::min((uint32_t)position, m_positionMax[axis]);
+
+            float velocity = rState.velocity[axis] * VELOCITY_SCALE + 0.5f;
+            velocity = velocity == velocity ? std::min(std::max(velocity, -(float)velocityLimit), (float)velocityLimit) : 0.0f;
+            rOut.velocity[axis] = (int32_t)std::floor(velocity);
+        }
+        rOut.orientation = QuantiseOrientation(rState.orientation);
+        rOut.flags = rState.flags & ((1u << FLAG_BITS) - 1);
+    }
+}
+
+void SnapshotCodec::Dequantise(const NetEntity* pEntities, EntityState* pOut) const
+{
+    for (unsigned int i = 0; i < m_entityCount; ++i)
+    {
+        const NetEntity& rEntity = pEntities[i];
+        EntityState& rOut = pOut[i];
+        for (unsigned int axis = 0; axis < 3; ++axis)
+        {
+            rOut.position[axis] = m_min[axis] + rEntity.position[axis] / (float)POSITION_SCALE;
+            rOut.velocity[axis] = rEntity.velocity[axis] / (float)VELOCITY_SCALE;
+        }
+        rOut.orientation = DequantiseOrientation(rEntity.orientation);
+        rOut.flags = rEntity.flags;
+    }
+}
+
+size_t SnapshotCodec::Encode(const NetEntity* pCurrent, const NetEntity* pBaseline, unsigned char* pOut, size_t capacity) const
+{
+    static const NetEntity ZERO = NetEntity();
+
+    BitWriter out(pOut, capacity);
+    unsigned int next = 0;
+    for (unsigned int i = 0; i < m_entityCount; ++i)
+    {
+        const NetEntity& rCurrent = pCurrent[i];
+        const NetEntity& rBase = pBaseline ? pBaseline[i] : ZERO;
+        if (std::memcmp(&rCurrent, &rBase, sizeof(NetEntity)) == 0)
+            continue;
+
+        // entity follows, then the number of unchanged entities skipped
+        out.WriteBool(true);
+        const unsigned int gap = i - next;
+        const bool nearGap = gap < (1u << GAP_BITS);
+        out.WriteBool(nearGap);
+        out.Write(gap, nearGap ? GAP_BITS : m_indexBits);
+        next = i + 1;
+
+        const bool positionChanged = std::memcmp(rCurrent.position, rBase.position, sizeof(rCurrent.position)) != 0;
+        out.WriteBool(positionChanged);
+        if (positionChanged)
+        {
+            for (unsigned int axis = 0; axis < 3; ++axis)
+            {
+                const int32_t delta = (int32_t)(rCurrent.position[axis] - rBase.position[axis]);
+                if (FitsSigned(delta, NEAR_DELTA_BITS))
+                {
+                    out.WriteBool(true);
+                    out.Write((uint32_t)delta, NEAR_DELTA_BITS);
+                }
+                else if (FitsSigned(delta, FAR_DELTA_BITS))
+                {
+                    out.Write(2u, 2);   // bits 0, 1
+                    out.Write((uint32_t)delta, FAR_DELTA_BITS);
+                }
+                else
+                {
+                    out.Write(0u, 2);
+                    out.Write(rCurrent.position[axis], m_positionBits[axis]);
+                }
+            }
+        }
+
+        const bool velocityChanged = std::memcmp(rCurrent.velocity, rBase.velocity, sizeof(rCurrent.velocity)) != 0;
+        out.WriteBool(velocityChanged);
+        if (velocityChanged)
+        {
+            for (unsigned int axis = 0; axis < 3; ++axis)
+            {
+                const int32_t delta = rCurrent.velocity[axis] - rBase.velocity[axis];
+                const bool nearVelocity = FitsSigned(delta, VELOCITY_DELTA_BITS);
+                out.WriteBool(nearVelocity);
+                if (nearVelocity)
+                    out.Write((uint32_t)delta, VELOCITY_DELTA_BITS);
+                else
+                    out.Write((uint32_t)rCurrent.velocity[axis], VELOCITY_BITS);
+            }
+        }
+
+        const bool orientationChanged = rCurrent.orientation != rBase.orientation;
+        out.WriteBool(orientationChanged);
+        if (orientationChanged)
+            out.Write(rCurrent.orientation, 2 + 3 * ORIENTATION_BITS);
+
+        const bool flagsChanged = rCurrent.flags != rBase.flags;
+        out.WriteBool(flagsChanged);
+        if (flagsChanged)
+            out.Write(rCurrent.flags, FLAG_BITS);
+    }
+    out.WriteBool(false);
+    out.Flush();
+    return out.HasOverflowed() ? 0 : out.GetBytes();
+}
+
+bool SnapshotCodec::Decode(const unsigned char* pIn, size_t size, const NetEntity* pBaseline, NetEntity* pOut) const
+{
+    if (pBaseline)
+        std::memcpy(pOut, pBaseline, m_entityCount * sizeof(NetEntity));
+    else
+        std::memset(pOut, 0, m_entityCount * sizeof(NetEntity));
+
+    BitReader in(pIn, size);
+    unsigned int next = 0;
+    while (in.ReadBool())
+    {
+        const bool nearGap = in.ReadBool();
+        const unsigned int i = next + in.Read(nearGap ? GAP_BITS : m_indexBits);
+        if (i >= m_entityCount || in.HasOverflowed())
+            return false;
+        next = i + 1;
+
+        NetEntity& rOut = pOut[i];
+        if (in.ReadBool())
+        {
+            for (unsigned int axis = 0; axis < 3; ++axis)
+            {
+                if (in.ReadBool())
+                    rOut.position[axis] += (uint32_t)ReadSigned(in, NEAR_DELTA_BITS);
+                else if (in.ReadBool())
+                    rOut.position[axis] += (uint32_t)ReadSigned(in, FAR_DELTA_BITS);
+                else
+                    rOut.position[axis] = in.Read(m_positionBits[axis]);
+            }
+        }
+        if (in.ReadBool())
+        {
+            for (unsigned int axis = 0; axis < 3; ++axis)
+            {
+                if (in.ReadBool())
+                    rOut.velocity[axis] += ReadSigned(in, VELOCITY_DELTA_BITS);
+                else
+                    rOut.velocity[axis] = ReadSigned(in, VELOCITY_BITS);
+            }
+        }
+        if (in.ReadBool())
+            rOut.orientation = in.Read(2 + 3 * ORIENTATION_BITS);
+        if (in.ReadBool())
+            rOut.flags = in.Read(FLAG_BITS);
+    }
+    return !in.HasOverflowed();
+}
+
+SnapshotCodec CreateMatchCodec()
+{
+    glm::vec3 min, max;
+    Match::GetPitchBounds(min, max);
+    return SnapshotCodec(min, max, Match::PLAYER_COUNT + 1);
+}
+
+SnapshotHistory::SnapshotHistory(unsigned int entityCount, unsigned int depth)
+    : m_entityCount(entityCount),
+      m_next(0),
+      m_entities(entityCount * depth),
+      m_ticks(depth, NO_TICK)
+{
+}
+
+NetEntity* SnapshotHistory::Store(uint32_t tick)
+{
+    const unsigned int slot = m_next;
+    m_next = (m_next + 1) % m_ticks.size();
+    m_ticks[slot] = tick;
+    return &m_entities[slot * m_entityCount];
+}
+
+const NetEntity* SnapshotHistory::Find(uint32_t tick) const
+{
+    for (unsigned int slot = 0; slot < m_ticks.size(); ++slot)
+    {
+        if (m_ticks[slot] == tick)
+            return &m_entities[slot * m_entityCount];
+    }
+    return 0;
+}
+
+const NetEntity* SnapshotHistory::GetNewest() const
+{
+    const unsigned int slot = (m_next + (unsigned int)m_ticks.size() - 1) % m_ticks.size();
+    return m_ticks[slot] != NO_TICK ? &m_entities[slot * m_entityCount] : 0;
+}
+
+void SnapshotHistory::Clear()
+{
+    std::fill(m_ticks.begin(), m_ticks.end(), NO_TICK);
+    m_next = 0;
+}
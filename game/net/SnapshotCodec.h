@@ -0,0 +1,112 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class Match;
+
+enum EntityFlags
+{
+    ENTITY_AWAKE = 1 << 0,
+    ENTITY_KNOCKED_OUT = 1 << 1
+};
+
+// What a client needs to draw an entity.
+struct EntityState
+{
+    glm::vec3 position;
+    glm::vec3 velocity;
+    glm::vec4 orientation;   // unit quaternion x, y, z, w
+    uint32_t flags;
+};
+
+// An EntityState after quantisation. Two equal NetEntities look the same on
+// every client, so unchanged entities are found with a memcmp.
+struct NetEntity
+{
+    uint32_t position[3];    // fixed point from the pitch minimum
+    int32_t velocity[3];
+    uint32_t orientation;    // smallest three
+    uint32_t flags;
+};
+
+// Fills pOut with the ball followed by every player of rMatch; knocked-out
+// players carry their ragdoll torso's orientation.
+void CaptureEntities(const Match& rMatch, EntityState* pOut);
+
+// Bit-packed snapshot encoding of a fixed number of entities, delta coded
+// against a baseline both sides hold: only entities that differ from the
+// baseline are written, each as a gap-coded index followed by its changed
+// fields. Positions are fixed point relative to the pitch bounds and sent as
+// a short delta when close to the baseline, velocities are fixed point and
+// orientations are smallest-three quaternions in 32 bits. Without a baseline
+// every entity is coded against zero.
+class SnapshotCodec
+{
+public:
+    static const unsigned int POSITION_SCALE = 512;      // 2 mm steps
+    static const unsigned int VELOCITY_SCALE = 64;       // 1/64 m/s steps
+    static const unsigned int VELOCITY_BITS = 12;        // +-32 m/s
+    static const unsigned int ORIENTATION_BITS = 10;     // per smallest-three component
+    static const unsigned int FLAG_BITS = 2;
+
+    SnapshotCodec(const glm::vec3& rMin, const glm::vec3& rMax, unsigned int entityCount);
+
+    unsigned int GetEntityCount() const
+    {
+        return m_entityCount;
+    }
+
+    void Quantise(const EntityState* pStates, NetEntity* pOut) const;
+    void Dequantise(const NetEntity* pEntities, EntityState* pOut) const;
+
+    // pBaseline may be null. Returns the payload size, 0 when it does not
+    // fit in capacity.
+    size_t Encode(const NetEntity* pCurrent, const NetEntity* pBaseline, unsigned char* pOut, size_t capacity) const;
+
+    // pBaseline must be the one the payload was encoded against. Returns
+    // false on a malformed payload.
+    bool Decode(const unsigned char* pIn, size_t size, const NetEntity* pBaseline, NetEntity* pOut) const;
+
+private:
+    glm::vec3 m_min;
+    unsigned int m_positionBits[3];
+    uint32_t m_positionMax[3];
+    unsigned int m_indexBits;
+    unsigned int m_entityCount;
+};
+
+// Codec for the Match::PLAYER_COUNT + 1 entities of CaptureEntities() within
+// the match's pitch bounds.
+SnapshotCodec CreateMatchCodec();
+
+// The last few snapshots by tick, kept by the server as baselines for its
+// clients and by a client as the baselines the server may refer to.
+class SnapshotHistory
+{
+public:
+    static const unsigned int NO_TICK = 0xFFFFFFFFu;
+
+    SnapshotHistory(unsigned int entityCount, unsigned int depth);
+
+    // Returns the slot for tick, replacing the oldest snapshot. Snapshots need
+    // not be consecutive ticks.
+    NetEntity* Store(uint32_t tick);
+
+    // Null when tick is not (or no longer) held.
+    const NetEntity* Find(uint32_t tick) const;
+
+    // The last one stored; null when empty.
+    const NetEntity* GetNewest() const;
+
+    void Clear();
+
+private:
+    unsigned int m_entityCount;
+    unsigned int m_next;
+    std::vector<NetEntity> m_entities;
+    std::vector<uint32_t> m_ticks;
+};
@@ -0,0 +1,54 @@
+#include "SnapshotRing.h"
+#include "../Match.h"
+
+#include <cstdlib>
+
+namespace
+{
+    const unsigned int NO_TICK = 0xFFFFFFFFu;
+}
+
+SnapshotRing::SnapshotRing(const Match& rMatch, unsigned int count)
+    : m_count(count),
+      m_arenaSize((rMatch.GetMaxStateSize() + 63) & ~size_t(63)),
+      m_pArenas(nullptr),
+      m_pTicks(nullptr),
+      m_pSizes(nullptr)
+{
+    m_pArenas = static_cast<unsigned char*>(std::malloc(m_arenaSize * m_count));
+    m_pTicks = static_cast<unsigned int*>(std::malloc(sizeof(unsigned int) * m_count));
+    m_pSizes = static_cast<size_t*>(std::malloc(sizeof(size_t) * m_count));
+    for (unsigned int i = 0; i < m_count; ++i)
+    {
+        m_pTicks[i] = NO_TICK;
+        m_pSizes[i] = 0;
+    }
+}
+
+SnapshotRing::~SnapshotRing()
+{
+    std::free(m_pArenas);
+    std::free(m_pTicks);
+    std::free(m_pSizes);
+}
+
+void SnapshotRing::Save(const Match& rMatch)
+{
+    const unsigned int slot = rMatch.GetTick() % m_count;
+    m_pSizes[slot] = rMatch.SaveState(m_pArenas + slot * m_arenaSize);
+    m_pTicks[slot] = rMatch.GetTick();
+}
+
+bool SnapshotRing::Load(Match& rMatch, unsigned int tick) const
+{
+    if (!Has(tick))
+        return false;
+    const unsigned int slot = tick % m_count;
+    rMatch.LoadState(m_pArenas + slot * m_arenaSize, m_pSizes[slot]);
+    return true;
+}
+
+bool SnapshotRing::Has(unsigned int tick) const
+{
+    return m_pTicks[tick % m_count] == tick;
+}
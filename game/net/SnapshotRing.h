@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+
+class Match;
+
+// Ring of match snapshots for rollback, one per tick. All arenas come from a
+// single allocation made up front and each holds Match::GetMaxStateSize()
+// bytes, so taking a snapshot is a handful of memcpys of POD columns and
+// never allocates.
+class SnapshotRing
+{
+public:
+    SnapshotRing(const Match& rMatch, unsigned int count);
+    ~SnapshotRing();
+
+    // Stores rMatch's state under its current tick, replacing the snapshot
+    // taken count ticks earlier.
+    void Save(const Match& rMatch);
+
+    // False if the tick has already been overwritten.
+    bool Load(Match& rMatch, unsigned int tick) const;
+
+    bool Has(unsigned int tick) const;
+
+    size_t GetArenaSize() const
+    {
+        return m_arenaSize;
+    }
+
+private:
+    SnapshotRing(const SnapshotRing&);
+    SnapshotRing& operator=(const SnapshotRing&);
+
+    unsigned int m_count;
+    size_t m_arenaSize;
+    unsigned char* m_pArenas;
+    unsigned int* m_pTicks;
+    size_t* m_pSizes;
+};
@@ -0,0 +1,130 @@
+#include "SpectatorClient.h"
+
+#include <cstring>
+
+namespace
+{
+    const double SPECTATE_RETRY_MS = 250.0;
+    const double KEEPALIVE_MS = 1000.0;
+
+    // A newer keyframe replaces an older one only after the frames in
+    // flight coded against the older one are through.
+    const unsigned int KEYFRAMES_HELD = 2;
+}
+
+SpectatorClient::SpectatorClient()
+    : m_rejected(false),
+      m_openMs(-1.0),
+      m_nextSendMs(0.0),
+      m_firstFrameMs(-1.0),
+      m_codec(CreateMatchCodec()),
+      m_keyframes(SNAPSHOT_ENTITY_COUNT, KEYFRAMES_HELD),
+      m_decoded(SNAPSHOT_ENTITY_COUNT),
+      m_framesReceived(0),
+      m_keyframesReceived(0),
+      m_decodeFailures(0),
+      m_lastTick(NO_SNAPSHOT_TICK),
+      m_bytesReceived(0),
+      m_packet(SERVER_MAX_PACKET)
+{
+}
+
+bool SpectatorClient::Open(const NetAddress& rRelay)
+{
+    m_relay = rRelay;
+    m_rejected = false;
+    m_openMs = -1.0;
+    m_nextSendMs = 0.0;
+    m_firstFrameMs = -1.0;
+    m_lastTick = NO_SNAPSHOT_TICK;
+    m_keyframes.Clear();
+    return m_socket.Open(0, 0);
+}
+
+void SpectatorClient::Disconnect()
+{
+    if (m_socket.IsOpen())
+    {
+        PacketHeader header = { SERVER_PACKET_MAGIC, PACKET_DISCONNECT, (uint8_t)SERVER_NO_PLAYER, 0 };
+        Send(&header, sizeof(header));
+    }
+    m_lastTick = NO_SNAPSHOT_TICK;
+    m_socket.Close();
+}
+
+void SpectatorClient::Update(double nowMs)
+{
+    if (!m_socket.IsOpen() || m_rejected)
+        return;
+    if (m_openMs < 0.0)
+        m_openMs = nowMs;
+
+    ReceivePackets(nowMs);
+    if (nowMs < m_nextSendMs)
+        return;
+
+    PacketHeader header = { SERVER_PACKET_MAGIC, PACKET_SPECTATE, (uint8_t)SERVER_NO_PLAYER, 0 };
+    Send(&header, sizeof(header));
+    m_nextSendMs = nowMs + (IsWatching() ? KEEPALIVE_MS : SPECTATE_RETRY_MS);
+}
+
+void SpectatorClient::ReceivePackets(double nowMs)
+{
+    NetAddress from;
+    int size;
+    while ((size = m_socket.Receive(&m_packet[0], m_packet.size(), from)) >= 0)
+    {
+        m_bytesReceived += size;
+        if (!(from == m_relay) || size < (int)sizeof(PacketHeader))
+            continue;
+
+        PacketHeader header;
+        std::memcpy(&header, &m_packet[0], sizeof(header));
+        if (header.magic != SERVER_PACKET_MAGIC)
+            continue;
+
+        if (header.type == PACKET_BROADCAST && size >= (int)sizeof(SnapshotHeader))
+            HandleFrame((unsigned int)size, nowMs);
+        else if (header.type == PACKET_REJECT)
+            m_rejected = true;
+    }
+}
+
+void SpectatorClient::HandleFrame(unsigned int size, double nowMs)
+{
+    SnapshotHeader header;
+    std::memcpy(&header, &m_packet[0], sizeof(header));
+    if (m_lastTick != NO_SNAPSHOT_TICK && header.tick <= m_lastTick)
+        return;
+
+    const NetEntity* pBaseline = 0;
+    if (header.baselineTick != NO_SNAPSHOT_TICK)
+    {
+        pBaseline = m_keyframes.Find(header.baselineTick);
+        if (!pBaseline)
+        {
+            ++m_decodeFailures;
+            return;
+        }
+    }
+    if (!m_codec.Decode(&m_packet[sizeof(header)], size - sizeof(header), pBaseline, &m_decoded[0]))
+    {
+        ++m_decodeFailures;
+        return;
+    }
+
+    if (header.baselineTick == NO_SNAPSHOT_TICK)
+    {
+        std::memcpy(m_keyframes.Store(header.tick), &m_decoded[0], m_decoded.size() * sizeof(NetEntity));
+        ++m_keyframesReceived;
+    }
+    if (m_firstFrameMs < 0.0)
+        m_firstFrameMs = nowMs;
+    ++m_framesReceived;
+    m_lastTick = header.tick;
+}
+
+void SpectatorClient::Send(const void* pData, unsigned int size)
+{
+    m_socket.Send(m_relay, pData, size);
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "ServerProtocol.h"
+#include "SnapshotCodec.h"
+#include "UdpSocket.h"
+
+#include <cstdint>
+#include <vector>
+
+// Headless spectator of a SpectatorRelay: asks to watch, keeps asking as a
+// keepalive and decodes every broadcast frame against the keyframe it names.
+class SpectatorClient
+{
+public:
+    SpectatorClient();
+
+    bool Open(const NetAddress& rRelay);
+    void Disconnect();
+
+    // Call often, at least once per broadcast frame.
+    void Update(double nowMs);
+
+    bool IsWatching() const
+    {
+        return m_lastTick != NO_SNAPSHOT_TICK;
+    }
+
+    bool WasRejected() const
+    {
+        return m_rejected;
+    }
+
+    unsigned int GetFramesReceived() const
+    {
+        return m_framesReceived;
+    }
+
+    unsigned int GetKeyframesReceived() const
+    {
+        return m_keyframesReceived;
+    }
+
+    // Frames coded against a keyframe this spectator does not hold, or malformed.
+    unsigned int GetDecodeFailures() const
+    {
+        return m_decodeFailures;
+    }
+
+    uint32_t GetLastTick() const
+    {
+        return m_lastTick;
+    }
+
+    // From the first Update() after Open() to the first decoded frame;
+    // negative until then.
+    double GetJoinMs() const
+    {
+        return m_firstFrameMs >= 0.0 ? m_firstFrameMs - m_openMs : -1.0;
+    }
+
+    uint64_t GetBytesReceived() const
+    {
+        return m_bytesReceived;
+    }
+
+    // The ball and players of the newest frame.
+    const std::vector<NetEntity>& GetEntities() const
+    {
+        return m_decoded;
+    }
+
+private:
+    SpectatorClient(const SpectatorClient&);
+    SpectatorClient& operator=(const SpectatorClient&);
+
+    void ReceivePackets(double nowMs);
+    void HandleFrame(unsigned int size, double nowMs);
+    void Send(const void* pData, unsigned int size);
+
+    UdpSocket m_socket;
+    NetAddress m_relay;
+    bool m_rejected;
+    double m_openMs;
+    double m_nextSendMs;
+    double m_firstFrameMs;
+
+    SnapshotCodec m_codec;
+    SnapshotHistory m_keyframes;
+    std::vector<NetEntity> m_decoded;
+    unsigned int m_framesReceived;
+    unsigned int m_keyframesReceived;
+    unsigned int m_decodeFailures;
+    uint32_t m_lastTick;
+    uint64_t m_bytesReceived;
+    std::vector<unsigned char> m_packet;
+};
@@ -0,0 +1,275 @@
+#include "SpectatorRelay.h"
+#include "../Match.h"
+
+#include <chrono>
+#include <cstring>
+
+namespace
+{
+    const double SPECTATOR_TIMEOUT_MS = 3000.0;
+    const unsigned int RELAY_BATCH = 256;
+
+    // Joins and keepalives from thousands of spectators arrive in bursts.
+    const int SOCKET_BUFFER_BYTES = 4 << 20;
+
+    typedef std::chrono::steady_clock Clock;
+
+    double MsSince(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+}
+
+SpectatorRelay::SpectatorRelay(unsigned int maxSpectators, unsigned int frameInterval, unsigned int keyframeInterval,
+                               unsigned int delayTicks)
+    : m_maxSpectators(maxSpectators),
+      m_frameInterval(frameInterval > 0 ? frameInterval : 1),
+      m_keyframeInterval(keyframeInterval > 0 ? keyframeInterval : 1),
+      m_delayTicks(delayTicks),
+      m_socket(RELAY_BATCH),
+      m_codec(CreateMatchCodec()),
+      m_entityStates(SNAPSHOT_ENTITY_COUNT),
+      m_current(SNAPSHOT_ENTITY_COUNT),
+      m_keyframe(SNAPSHOT_ENTITY_COUNT),
+      m_keyframeTick(NO_SNAPSHOT_TICK),
+      m_framesSinceKeyframe(0),
+      m_pLatestKeyframe(nullptr),
+      m_releasedTick(NO_SNAPSHOT_TICK)
+{
+    // every frame the delay buffer can hold, the latest keyframe and the one
+    // being encoded
+    const unsigned int delayedFrames = m_delayTicks / m_frameInterval + 1;
+    m_frames.resize(delayedFrames + 2);
+    for (unsigned int i = 0; i < m_frames.size(); ++i)
+        m_freeFrames.push_back(&m_frames[i]);
+
+    m_spectators.reserve(m_maxSpectators);
+    m_indexOfAddress.reserve(m_maxSpectators);
+    ResetStats();
+}
+
+bool SpectatorRelay::Open(uint32_t ip, uint16_t port, UdpBackend backend)
+{
+    if (!m_socket.Open(ip, port, backend) &&
+        (backend == UDP_BACKEND_SINGLE || !m_socket.Open(ip, port, UDP_BACKEND_SINGLE)))
+        return false;
+    m_socket.GetSocket().SetBufferSizes(SOCKET_BUFFER_BYTES);
+    return true;
+}
+
+void SpectatorRelay::ResetStats()
+{
+    std::memset(&m_stats, 0, sizeof(m_stats));
+}
+
+size_t SpectatorRelay::GetMemoryBytes() const
+{
+    const size_t mapNode = sizeof(std::pair<const uint64_t, unsigned int>) + 2 * sizeof(void*);
+    return m_frames.size() * sizeof(SharedFrame) +
+           m_spectators.capacity() * sizeof(Spectator) +
+           m_indexOfAddress.bucket_count() * sizeof(void*) + m_indexOfAddress.size() * mapNode +
+           2 * RELAY_BATCH * BatchedUdpSocket::MAX_DATAGRAM +
+           (m_current.size() + m_keyframe.size()) * sizeof(NetEntity);
+}
+
+SpectatorRelay::SharedFrame* SpectatorRelay::AcquireFrame()
+{
+    if (m_freeFrames.empty())
+        return nullptr;
+    SharedFrame* pFrame = m_freeFrames.back();
+    m_freeFrames.pop_back();
+    pFrame->references = 1;
+    return pFrame;
+}
+
+void SpectatorRelay::AddReference(SharedFrame* pFrame)
+{
+    ++pFrame->references;
+}
+
+void SpectatorRelay::ReleaseFrame(SharedFrame* pFrame)
+{
+    if (--pFrame->references == 0)
+        m_freeFrames.push_back(pFrame);
+}
+
+void SpectatorRelay::Publish(const Match& rMatch)
+{
+    const uint32_t tick = rMatch.GetTick();
+    if (tick % m_frameInterval == 0)
+        EncodeFrame(rMatch);
+
+    while (!m_delayed.empty() && m_delayed.front()->tick + m_delayTicks <= tick)
+    {
+        SharedFrame* pFrame = m_delayed.front();
+        m_delayed.pop_front();
+        FanOut(*pFrame);
+
+        if (pFrame->keyframe)
+        {
+            if (m_pLatestKeyframe)
+                ReleaseFrame(m_pLatestKeyframe);
+            AddReference(pFrame);
+            m_pLatestKeyframe = pFrame;
+        }
+        m_releasedTick = pFrame->tick;
+        ReleaseFrame(pFrame);
+    }
+}
+
+void SpectatorRelay::EncodeFrame(const Match& rMatch)
+{
+    const Clock::time_point start = Clock::now();
+    SharedFrame* pFrame = AcquireFrame();
+    if (!pFrame)
+        return;
+
+    const uint32_t tick = rMatch.GetTick();
+    CaptureEntities(rMatch, &m_entityStates[0]);
+    m_codec.Quantise(&m_entityStates[0], &m_current[0]);
+
+    const bool keyframe = m_framesSinceKeyframe == 0 || m_keyframeTick == NO_SNAPSHOT_TICK;
+    SnapshotHeader header;
+    header.header.magic = SERVER_PACKET_MAGIC;
+    header.header.type = PACKET_BROADCAST;
+    header.header.player = (uint8_t)SERVER_NO_PLAYER;
+    header.header.reserved = 0;
+    header.tick = tick;
+    header.baselineTick = keyframe ? NO_SNAPSHOT_TICK : m_keyframeTick;
+    header.inputSequence = NO_INPUT_SEQUENCE;
+    header.reserved = 0;
+    header.stateHash = rMatch.GetStateHash();
+
+    const size_t payload = m_codec.Encode(&m_current[0], keyframe ? 0 : &m_keyframe[0], pFrame->data + sizeof(header),
+                                          sizeof(pFrame->data) - sizeof(header));
+    if (payload == 0)
+    {
+        ReleaseFrame(pFrame);
+        return;
+    }
+    std::memcpy(pFrame->data, &header, sizeof(header));
+    pFrame->tick = tick;
+    pFrame->keyframe = keyframe;
+    pFrame->size = (unsigned int)(sizeof(header) + payload);
+    m_delayed.push_back(pFrame);
+
+    if (keyframe)
+    {
+        m_keyframe = m_current;
+        m_keyframeTick = tick;
+        ++m_stats.keyframes;
+    }
+    m_framesSinceKeyframe = (m_framesSinceKeyframe + 1) % m_keyframeInterval;
+    ++m_stats.frames;
+    m_stats.bytesEncoded += pFrame->size;
+    m_stats.encodeMs += MsSince(start);
+}
+
+void SpectatorRelay::FanOut(SharedFrame& rFrame)
+{
+    const Clock::time_point start = Clock::now();
+    unsigned int sent = 0;
+    for (unsigned int i = 0; i < m_spectators.size(); ++i)
+    {
+        Spectator& rSpectator = m_spectators[i];
+        if (!rSpectator.synced && !rFrame.keyframe)
+            continue;
+        rSpectator.synced = true;
+        m_socket.SendShared(rSpectator.address, rFrame.data, rFrame.size);
+        ++sent;
+    }
+    // the frame may go back to the pool once this returns
+    m_socket.Flush();
+
+    m_stats.packetsSent += sent;
+    m_stats.bytesSent += (uint64_t)sent * rFrame.size;
+    m_stats.fanOutMs += MsSince(start);
+}
+
+void SpectatorRelay::Update(double nowMs)
+{
+    unsigned int count;
+    while ((count = m_socket.Receive()) > 0)
+    {
+        for (unsigned int i = 0; i < count; ++i)
+        {
+            unsigned int size;
+            NetAddress from;
+            const unsigned char* pData = m_socket.GetReceived(i, size, from);
+            HandlePacket(from, pData, size, nowMs);
+        }
+    }
+
+    for (unsigned int i = (unsigned int)m_spectators.size(); i-- > 0;)
+    {
+        if (nowMs - m_spectators[i].lastHeardMs > SPECTATOR_TIMEOUT_MS)
+        {
+            RemoveSpectator(i);
+            ++m_stats.spectatorsTimedOut;
+        }
+    }
+    m_socket.Flush();
+}
+
+void SpectatorRelay::HandlePacket(const NetAddress& rFrom, const unsigned char* pData, unsigned int size, double nowMs)
+{
+    if (size < sizeof(PacketHeader))
+        return;
+    PacketHeader header;
+    std::memcpy(&header, pData, sizeof(header));
+    if (header.magic != SERVER_PACKET_MAGIC)
+        return;
+
+    std::unordered_map<uint64_t, unsigned int>::const_iterator found = m_indexOfAddress.find(AddressKey(rFrom));
+    if (header.type == PACKET_SPECTATE)
+    {
+        if (found != m_indexOfAddress.end())
+            m_spectators[found->second].lastHeardMs = nowMs;
+        else
+            Join(rFrom, nowMs);
+    }
+    else if (header.type == PACKET_DISCONNECT && found != m_indexOfAddress.end())
+    {
+        RemoveSpectator(found->second);
+    }
+}
+
+void SpectatorRelay::Join(const NetAddress& rFrom, double nowMs)
+{
+    if (m_spectators.size() >= m_maxSpectators)
+    {
+        PacketHeader reject = { SERVER_PACKET_MAGIC, PACKET_REJECT, (uint8_t)SERVER_NO_PLAYER, 0 };
+        m_socket.Send(rFrom, &reject, sizeof(reject));
+        return;
+    }
+
+    Spectator spectator;
+    spectator.address = rFrom;
+    spectator.lastHeardMs = nowMs;
+    spectator.synced = false;
+
+    // a late joiner starts from the latest keyframe rather than waiting for the next
+    if (m_pLatestKeyframe)
+    {
+        m_socket.SendShared(rFrom, m_pLatestKeyframe->data, m_pLatestKeyframe->size);
+        spectator.synced = true;
+        ++m_stats.lateJoins;
+        ++m_stats.packetsSent;
+        m_stats.bytesSent += m_pLatestKeyframe->size;
+    }
+
+    m_indexOfAddress[AddressKey(rFrom)] = (unsigned int)m_spectators.size();
+    m_spectators.push_back(spectator);
+    ++m_stats.spectatorsJoined;
+}
+
+void SpectatorRelay::RemoveSpectator(unsigned int index)
+{
+    m_indexOfAddress.erase(AddressKey(m_spectators[index].address));
+    if (index + 1 < m_spectators.size())
+    {
+        m_spectators[index] = m_spectators.back();
+        m_indexOfAddress[AddressKey(m_spectators[index].address)] = index;
+    }
+    m_spectators.pop_back();
+}
@@ -0,0 +1,152 @@
+#pragma once
+
+#include "BatchedUdpSocket.h"
+#include "ServerProtocol.h"
+#include "SnapshotCodec.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <unordered_map>
+#include <vector>
+
+class Match;
+
+struct RelayStats
+{
+    unsigned int frames;             // encoded once each, whatever the audience
+    unsigned int keyframes;
+    uint64_t bytesEncoded;
+    double encodeMs;
+    double fanOutMs;                 // handing released frames to every spectator
+    uint64_t packetsSent;
+    uint64_t bytesSent;
+    unsigned int spectatorsJoined;
+    unsigned int spectatorsTimedOut;
+    unsigned int lateJoins;          // started from the latest keyframe
+};
+
+// Broadcasts one match to any number of spectators over UDP. Every
+// frameInterval ticks the match state is encoded once into a shared,
+// reference counted frame, delta coded against the newest keyframe, and every
+// keyframeInterval frames a keyframe is coded against nothing. Frames wait
+// delayTicks in a delay buffer before they are released; a released frame is
+// queued to every spectator as the same buffer, so fanning out costs no
+// encoding and no copy.
+//
+// Spectators join with PACKET_SPECTATE, which they repeat as a keepalive.
+// A spectator joining mid-match is sent the latest released keyframe at
+// once and decodes every later frame against it or a newer one; a lost
+// keyframe only costs frames until the next one.
+class SpectatorRelay
+{
+public:
+    SpectatorRelay(unsigned int maxSpectators, unsigned int frameInterval, unsigned int keyframeInterval,
+                   unsigned int delayTicks);
+
+    bool Open(uint32_t ip, uint16_t port, UdpBackend backend = UDP_BACKEND_MMSG);
+
+    NetAddress GetLocalAddress() const
+    {
+        return m_socket.GetLocalAddress();
+    }
+
+    UdpBackend GetBackend() const
+    {
+        return m_socket.GetBackend();
+    }
+
+    // Call after every tick of rMatch: encodes a frame when one is due and
+    // sends the frames whose delay has passed.
+    void Publish(const Match& rMatch);
+
+    // Takes joins, keepalives and leaves and drops silent spectators.
+    void Update(double nowMs);
+
+    unsigned int GetSpectatorCount() const
+    {
+        return (unsigned int)m_spectators.size();
+    }
+
+    unsigned int GetDelayTicks() const
+    {
+        return m_delayTicks;
+    }
+
+    // Tick of the newest frame sent to spectators, NO_SNAPSHOT_TICK before
+    // the first.
+    uint32_t GetReleasedTick() const
+    {
+        return m_releasedTick;
+    }
+
+    const RelayStats& GetStats() const
+    {
+        return m_stats;
+    }
+
+    void ResetStats();
+
+    // The relay's own memory: frame pool, spectator table and socket buffers.
+    size_t GetMemoryBytes() const;
+
+private:
+    SpectatorRelay(const SpectatorRelay&);
+    SpectatorRelay& operator=(const SpectatorRelay&);
+
+    // One encoded datagram, shared by the delay buffer, the latest keyframe
+    // and every send queued from it. The relay is used from one thread, so
+    // the count is a plain integer.
+    struct SharedFrame
+    {
+        unsigned int references;
+        uint32_t tick;
+        bool keyframe;
+        unsigned int size;
+        unsigned char data[SERVER_MAX_PACKET];
+    };
+
+    struct Spectator
+    {
+        NetAddress address;
+        double lastHeardMs;
+        bool synced;                 // has a keyframe the next frame can be decoded against
+    };
+
+    SharedFrame* AcquireFrame();
+    void AddReference(SharedFrame* pFrame);
+    void ReleaseFrame(SharedFrame* pFrame);
+
+    void EncodeFrame(const Match& rMatch);
+    void FanOut(SharedFrame& rFrame);
+    void HandlePacket(const NetAddress& rFrom, const unsigned char* pData, unsigned int size, double nowMs);
+    void Join(const NetAddress& rFrom, double nowMs);
+    void RemoveSpectator(unsigned int index);
+
+    static uint64_t AddressKey(const NetAddress& rAddress)
+    {
+        return (uint64_t)rAddress.ip << 16 | rAddress.port;
+    }
+
+    unsigned int m_maxSpectators;
+    unsigned int m_frameInterval;
+    unsigned int m_keyframeInterval;
+    unsigned int m_delayTicks;
+    BatchedUdpSocket m_socket;
+    SnapshotCodec m_codec;
+    std::vector<EntityState> m_entityStates;
+    std::vector<NetEntity> m_current;
+    std::vector<NetEntity> m_keyframe;       // baseline of the frames being encoded
+    uint32_t m_keyframeTick;
+    unsigned int m_framesSinceKeyframe;
+
+    std::vector<SharedFrame> m_frames;       // the pool, never resized
+    std::vector<SharedFrame*> m_freeFrames;
+    std::deque<SharedFrame*> m_delayed;      // oldest first
+    SharedFrame* m_pLatestKeyframe;          // newest released, for late joiners
+    uint32_t m_releasedTick;
+
+    std::vector<Spectator> m_spectators;
+    std::unordered_map<uint64_t, unsigned int> m_indexOfAddress;
+    RelayStats m_stats;
+};
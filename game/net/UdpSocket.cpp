@@ -0,0 +1,165 @@
+#include "UdpSocket.h"
+
+#ifdef _WIN32
+#include <winsock2.h>
+typedef int socklen_t;
+#else
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#include <cstring>
+
+namespace
+{
+#ifdef _WIN32
+    const uintptr_t NO_SOCKET = (uintptr_t)INVALID_SOCKET;
+
+    // Winsock is started with the first socket and stopped with the last.
+    unsigned int g_WinsockUsers = 0;
+#else
+    const int NO_SOCKET = -1;
+#endif
+
+    sockaddr_in ToSockAddr(const NetAddress& rAddress)
+    {
+        sockaddr_in address;
+        std::memset(&address, 0, sizeof(address));
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(rAddress.ip);
+        address.sin_port = htons(rAddress.port);
+        return address;
+    }
+
+    NetAddress FromSockAddr(const sockaddr_in& rAddress)
+    {
+        NetAddress address;
+        address.ip = ntohl(rAddress.sin_addr.s_addr);
+        address.port = ntohs(rAddress.sin_port);
+        return address;
+    }
+}
+
+UdpSocket::UdpSocket()
+    : m_socket(NO_SOCKET)
+#ifdef _WIN32
+    , m_usesWinsock(false)
+#endif
+{
+}
+
+UdpSocket::~UdpSocket()
+{
+    Close();
+}
+
+bool UdpSocket::Open(uint32_t ip, uint16_t port)
+{
+    Close();
+
+#ifdef _WIN32
+    if (g_WinsockUsers++ == 0)
+    {
+        WSADATA data;
+        WSAStartup(MAKEWORD(2, 2), &data);
+    }
+    m_usesWinsock = true;
+#endif
+
+    m_socket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (m_socket == NO_SOCKET)
+    {
+        Close();
+        return false;
+    }
+
+    NetAddress local = { ip, port };
+    sockaddr_in address = ToSockAddr(local);
+    if (bind(m_socket, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0)
+    {
+        Close();
+        return false;
+    }
+
+#ifdef _WIN32
+    u_long nonBlocking = 1;
+    bool ok = ioctlsocket(m_socket, FIONBIO, &nonBlocking) == 0;
+#else
+    bool ok = fcntl(m_socket, F_SETFL, fcntl(m_socket, F_GETFL, 0) | O_NONBLOCK) == 0;
+#endif
+    if (!ok)
+    {
+        Close();
+        return false;
+    }
+    return true;
+}
+
+void UdpSocket::Close()
+{
+#ifdef _WIN32
+    if (m_socket != NO_SOCKET)
+        closesocket(m_socket);
+    if (m_usesWinsock && --g_WinsockUsers == 0)
+        WSACleanup();
+    m_usesWinsock = false;
+#else
+    if (m_socket != NO_SOCKET)
+        close(m_socket);
+#endif
+    m_socket = NO_SOCKET;
+}
+
+bool UdpSocket::IsOpen() const
+{
+    return m_socket != NO_SOCKET;
+}
+
+NetAddress UdpSocket::GetLocalAddress() const
+{
+    sockaddr_in address;
+    socklen_t length = sizeof(address);
+    std::memset(&address, 0, sizeof(address));
+    getsockname(m_socket, reinterpret_cast<sockaddr*>(&address), &length);
+    return FromSockAddr(address);
+}
+
+bool UdpSocket::Send(const NetAddress& rTo, const void* pData, size_t size)
+{
+    sockaddr_in address = ToSockAddr(rTo);
+    return sendto(m_socket, static_cast<const char*>(pData), (int)size, 0,
+                  reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == (int)size;
+}
+
+int UdpSocket::Receive(void* pBuffer, size_t capacity, NetAddress& rFrom)
+{
+    sockaddr_in address;
+    socklen_t length = sizeof(address);
+    int received = (int)recvfrom(m_socket, static_cast<char*>(pBuffer), (int)capacity, 0,
+                                 reinterpret_cast<sockaddr*>(&address), &length);
+    if (received < 0)
+        return -1;
+    rFrom = FromSockAddr(address);
+    return received;
+}
+
+bool UdpSocket::Wait(unsigned int timeoutMs)
+{
+    fd_set readable;
+    FD_ZERO(&readable);
+    FD_SET(m_socket, &readable);
+    timeval timeout;
+    timeout.tv_sec = (long)(timeoutMs / 1000);
+    timeout.tv_usec = (long)(timeoutMs % 1000) * 1000;
+    return select((int)m_socket + 1, &readable, nullptr, nullptr, &timeout) > 0;
+}
+
+void UdpSocket::SetBufferSizes(int bytes)
+{
+    setsockopt(m_socket, SOL_SOCKET, SO_RCVBUF, reinterpret_cast<const char*>(&bytes), sizeof(bytes));
+    setsockopt(m_socket, SOL_SOCKET, SO_SNDBUF, reinterpret_cast<const char*>(&bytes), sizeof(bytes));
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// IPv4 address and port in host byte order.
+struct NetAddress
+{
+    uint32_t ip;
+    uint16_t port;
+
+    bool operator==(const NetAddress& rOther) const
+    {
+        return ip == rOther.ip && port == rOther.port;
+    }
+};
+
+const uint32_t NET_LOOPBACK = 0x7F000001u;
+
+// Non-blocking IPv4 UDP socket over BSD sockets or Winsock.
+class UdpSocket
+{
+public:
+    UdpSocket();
+    ~UdpSocket();
+
+    // Binds to ip:port; port 0 picks a free one, see GetLocalAddress().
+    bool Open(uint32_t ip, uint16_t port);
+    void Close();
+
+    bool IsOpen() const;
+    NetAddress GetLocalAddress() const;
+
+    bool Send(const NetAddress& rTo, const void* pData, size_t size);
+
+    // Returns the datagram size, or -1 when nothing is waiting.
+    int Receive(void* pBuffer, size_t capacity, NetAddress& rFrom);
+
+    // Blocks until a datagram is waiting or timeoutMs passed; true when one is.
+    bool Wait(unsigned int timeoutMs);
+
+    // Kernel receive and send buffer sizes, for servers taking bursts.
+    void SetBufferSizes(int bytes);
+
+#ifndef _WIN32
+    // For the batched system calls of BatchedUdpSocket.
+    int GetDescriptor() const
+    {
+        return m_socket;
+    }
+#endif
+
+private:
+    UdpSocket(const UdpSocket&);
+    UdpSocket& operator=(const UdpSocket&);
+
+#ifdef _WIN32
+    uintptr_t m_socket;
+    bool m_usesWinsock;
+#else
+    int m_socket;
+#endif
+};
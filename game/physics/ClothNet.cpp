@@ -0,0 +1,336 @@
+#include "ClothNet.h"
+#include "../core/Arena.h"
+#include "../core/Float4.h"
+#include "../core/WorkerPool.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+namespace
+{
+    const float GRAVITY = -9.81f;
+    const float VELOCITY_DAMPING = 0.98f;
+    const float NET_THICKNESS = 0.02f;
+    const float MIN_LENGTH = 1e-6f;
+
+    // A net whose particles all moved less than SLEEP_MOTION per step for
+    // SLEEP_FRAMES steps, with the ball away, stops simulating.
+    const float SLEEP_MOTION = 0.0005f;
+    const unsigned int SLEEP_FRAMES = 30;
+    const float WAKE_MARGIN = 0.25f;
+
+    unsigned int RoundUp4(unsigned int value)
+    {
+        return (value + 3u) & ~3u;
+    }
+}
+
+ClothNet::ClothNet(const glm::vec3& rTopLeft, const glm::vec3& rAcross, const glm::vec3& rDown,
+                   unsigned int columns, unsigned int rows, float spacing)
+    : m_columns(columns),
+      m_rows(rows),
+      m_halfStride(RoundUp4((columns + 1) / 2) + 4),
+      m_rowStride(2 * m_halfStride),
+      m_spacing(spacing),
+      m_iterations(4),
+      m_pStorage(nullptr),
+      m_boundsMin(rTopLeft),
+      m_boundsMax(rTopLeft),
+      m_sleeping(false),
+      m_dirty(true),
+      m_stillFrames(0)
+{
+    // Seven particle columns plus the lane ramp, one aligned block.
+    const unsigned int particleFloats = m_rows * m_rowStride;
+    const size_t bytes = (7 * particleFloats + m_halfStride) * sizeof(float);
+    m_pStorage = static_cast<unsigned char*>(AllocateAligned(bytes));
+    float* pCursor = reinterpret_cast<float*>(m_pStorage);
+    std::memset(pCursor, 0, bytes);
+
+    float** columnsOut[] = { &m_pPosX, &m_pPosY, &m_pPosZ, &m_pPrevX, &m_pPrevY, &m_pPrevZ, &m_pInvMass };
+    for (unsigned int i = 0; i < 7; ++i)
+    {
+        *columnsOut[i] = pCursor;
+        pCursor += particleFloats;
+    }
+    m_pLaneIndex = pCursor;
+    for (unsigned int k = 0; k < m_halfStride; ++k)
+    {
+        m_pLaneIndex[k] = (float)k;
+    }
+
+    glm::vec3 across = glm::normalize(rAcross) * spacing;
+    glm::vec3 down = glm::normalize(rDown) * spacing;
+    for (unsigned int row = 0; row < m_rows; ++row)
+    {
+        for (unsigned int column = 0; column < m_columns; ++column)
+        {
+            unsigned int i = Index(row, column);
+            glm::vec3 position = rTopLeft + across * (float)column + down * (float)row;
+            m_pPosX[i] = m_pPrevX[i] = position.x;
+            m_pPosY[i] = m_pPrevY[i] = position.y;
+            m_pPosZ[i] = m_pPrevZ[i] = position.z;
+
+            bool pinned = row == 0 || column == 0 || column + 1 == m_columns;
+            m_pInvMass[i] = pinned ? 0.0f : 1.0f;
+
+            m_boundsMin = glm::min(m_boundsMin, position);
+            m_boundsMax = glm::max(m_boundsMax, position);
+        }
+    }
+}
+
+ClothNet::~ClothNet()
+{
+    FreeAligned(m_pStorage);
+}
+
+bool ClothNet::ConsumeDirty()
+{
+    bool dirty = m_dirty;
+    m_dirty = false;
+    return dirty;
+}
+
+void ClothNet::Step(float dt, const glm::vec3& rBallCentre, float ballRadius)
+{
+    bool ballNear = BallIsNear(rBallCentre, ballRadius);
+    if (m_sleeping)
+    {
+        if (!ballNear)
+            return;
+        m_sleeping = false;
+        m_stillFrames = 0;
+    }
+
+    Integrate(dt);
+    for (unsigned int iteration = 0; iteration < m_iterations; ++iteration)
+    {
+        SolveConstraints();
+        Collide(rBallCentre, ballRadius + NET_THICKNESS);
+    }
+    m_dirty = true;
+
+    m_boundsMin = m_boundsMax = glm::vec3(m_pPosX[0], m_pPosY[0], m_pPosZ[0]);
+    for (unsigned int row = 0; row < m_rows; ++row)
+    {
+        for (unsigned int column = 0; column < m_columns; ++column)
+        {
+            unsigned int i = Index(row, column);
+            glm::vec3 position(m_pPosX[i], m_pPosY[i], m_pPosZ[i]);
+            m_boundsMin = glm::min(m_boundsMin, position);
+            m_boundsMax = glm::max(m_boundsMax, position);
+        }
+    }
+
+    if (!ballNear && MaxMotionSq() < SLEEP_MOTION * SLEEP_MOTION)
+    {
+        if (++m_stillFrames >= SLEEP_FRAMES)
+        {
+            // Drop the residual velocity so the net wakes up at rest.
+            const unsigned int count = m_rows * m_rowStride;
+            std::memcpy(m_pPrevX, m_pPosX, count * sizeof(float));
+            std::memcpy(m_pPrevY, m_pPosY, count * sizeof(float));
+            std::memcpy(m_pPrevZ, m_pPosZ, count * sizeof(float));
+            m_sleeping = true;
+        }
+    }
+    else
+    {
+        m_stillFrames = 0;
+    }
+}
+
+bool ClothNet::BallIsNear(const glm::vec3& rBallCentre, float ballRadius) const
+{
+    glm::vec3 reach(ballRadius + NET_THICKNESS + WAKE_MARGIN);
+    glm::vec3 nearest = glm::clamp(rBallCentre, m_boundsMin - reach, m_boundsMax + reach);
+    return nearest == rBallCentre;
+}
+
+void ClothNet::Integrate(float dt)
+{
+    const Float4 damping(VELOCITY_DAMPING);
+    const Float4 gravity(GRAVITY * dt * dt);
+    const Float4 zero(0.0f);
+
+    // Padding and pinned particles have zero inverse mass and stay put.
+    const unsigned int count = m_rows * m_rowStride;
+    for (unsigned int i = 0; i < count; i += 4)
+    {
+        Float4 movable = Less(zero, Float4::Load(m_pInvMass + i));
+        Float4 x = Float4::Load(m_pPosX + i);
+        Float4 y = Float4::Load(m_pPosY + i);
+        Float4 z = Float4::Load(m_pPosZ + i);
+        Float4 nextX = x + (x - Float4::Load(m_pPrevX + i)) * damping;
+        Float4 nextY = y + (y - Float4::Load(m_pPrevY + i)) * damping + gravity;
+        Float4 nextZ = z + (z - Float4::Load(m_pPrevZ + i)) * damping;
+        x.Store(m_pPrevX + i);
+        y.Store(m_pPrevY + i);
+        z.Store(m_pPrevZ + i);
+        Select(movable, nextX, x).Store(m_pPosX + i);
+        Select(movable, nextY, y).Store(m_pPosY + i);
+        Select(movable, nextZ, z).Store(m_pPosZ + i);
+    }
+}
+
+void ClothNet::SolvePairs(unsigned int rowA, Half halfA, unsigned int offsetA,
+                          unsigned int rowB, Half halfB, unsigned int offsetB,
+                          unsigned int count, float restLength)
+{
+    const unsigned int a = rowA * m_rowStride + halfA * m_halfStride + offsetA;
+    const unsigned int b = rowB * m_rowStride + halfB * m_halfStride + offsetB;
+    const Float4 rest(restLength);
+    const Float4 minLength(MIN_LENGTH);
+    const Float4 lanes((float)count);
+    const Float4 zero(0.0f);
+
+    for (unsigned int k = 0; k < count; k += 4)
+    {
+        Float4 active = Less(Float4::Load(m_pLaneIndex + k), lanes);
+
+        Float4 ax = Float4::LoadUnaligned(m_pPosX + a + k), ay = Float4::LoadUnaligned(m_pPosY + a + k), az = Float4::LoadUnaligned(m_pPosZ + a + k);
+        Float4 bx = Float4::LoadUnaligned(m_pPosX + b + k), by = Float4::LoadUnaligned(m_pPosY + b + k), bz = Float4::LoadUnaligned(m_pPosZ + b + k);
+        Float4 wa = Float4::LoadUnaligned(m_pInvMass + a + k);
+        Float4 wb = Float4::LoadUnaligned(m_pInvMass + b + k);
+
+        Float4 dx = bx - ax, dy = by - ay, dz = bz - az;
+        Float4 length = Max(Sqrt(dx * dx + dy * dy + dz * dz), minLength);
+        Float4 weight = Max(wa + wb, minLength);
+        Float4 correction = Select(active, (length - rest) / (length * weight), zero);
+
+        Float4 ca = correction * wa;
+        Float4 cb = correction * wb;
+        (ax + dx * ca).StoreUnaligned(m_pPosX + a + k);
+        (ay + dy * ca).StoreUnaligned(m_pPosY + a + k);
+        (az + dz * ca).StoreUnaligned(m_pPosZ + a + k);
+        (bx - dx * cb).StoreUnaligned(m_pPosX + b + k);
+        (by - dy * cb).StoreUnaligned(m_pPosY + b + k);
+        (bz - dz * cb).StoreUnaligned(m_pPosZ + b + k);
+    }
+}
+
+void ClothNet::SolveConstraints()
+{
+    // Constraints starting on an even column pair even[k] with odd[k]; those
+    // starting on an odd column pair odd[k] with even[k + 1].
+    const unsigned int evenCount = (m_columns + 1) / 2;
+    const unsigned int oddCount = m_columns / 2;
+    const unsigned int fromEven = m_columns / 2;
+    const unsigned int fromOdd = (m_columns - 1) / 2;
+    const float diagonal = m_spacing * 1.41421356f;
+
+    for (unsigned int row = 0; row < m_rows; ++row)
+    {
+        SolvePairs(row, Even, 0, row, Odd, 0, fromEven, m_spacing);
+        SolvePairs(row, Odd, 0, row, Even, 1, fromOdd, m_spacing);
+    }
+
+    for (unsigned int row = 0; row + 1 < m_rows; ++row)
+    {
+        // vertical
+        SolvePairs(row, Even, 0, row + 1, Even, 0, evenCount, m_spacing);
+        SolvePairs(row, Odd, 0, row + 1, Odd, 0, oddCount, m_spacing);
+        // shear, down-right: (row, c) - (row + 1, c + 1)
+        SolvePairs(row, Even, 0, row + 1, Odd, 0, fromEven, diagonal);
+        SolvePairs(row, Odd, 0, row + 1, Even, 1, fromOdd, diagonal);
+        // shear, down-left: (row, c + 1) - (row + 1, c)
+        SolvePairs(row, Odd, 0, row + 1, Even, 0, fromEven, diagonal);
+        SolvePairs(row, Even, 1, row + 1, Odd, 0, fromOdd, diagonal);
+    }
+}
+
+void ClothNet::Collide(const glm::vec3& rBallCentre, float radius)
+{
+    const Float4 centreX(rBallCentre.x), centreY(rBallCentre.y), centreZ(rBallCentre.z);
+    const Float4 radiusV(radius);
+    const Float4 radiusSq(radius * radius);
+    const Float4 minLength(MIN_LENGTH);
+    const Float4 zero(0.0f);
+
+    const unsigned int count = m_rows * m_rowStride;
+    for (unsigned int i = 0; i < count; i += 4)
+    {
+        Float4 movable = Less(zero, Float4::Load(m_pInvMass + i));
+        Float4 x = Float4::Load(m_pPosX + i);
+        Float4 y = Float4::Load(m_pPosY + i);
+        Float4 z = Float4::Load(m_pPosZ + i);
+
+        Float4 dx = x - centreX, dy = y - centreY, dz = z - centreZ;
+        Float4 distanceSq = dx * dx + dy * dy + dz * dz;
+        Float4 inside = Less(distanceSq, radiusSq);
+        Float4 scale = radiusV / Max(Sqrt(distanceSq), minLength);
+
+        Float4 pushX = Select(inside, centreX + dx * scale, x);
+        Float4 pushY = Max(Select(inside, centreY + dy * scale, y), zero);
+        Float4 pushZ = Select(inside, centreZ + dz * scale, z);
+        Select(movable, pushX, x).Store(m_pPosX + i);
+        Select(movable, pushY, y).Store(m_pPosY + i);
+        Select(movable, pushZ, z).Store(m_pPosZ + i);
+    }
+}
+
+float ClothNet::MaxMotionSq() const
+{
+    Float4 maxMotion(0.0f);
+    const unsigned int count = m_rows * m_rowStride;
+    for (unsigned int i = 0; i < count; i += 4)
+    {
+        Float4 dx = Float4::Load(m_pPosX + i) - Float4::Load(m_pPrevX + i);
+        Float4 dy = Float4::Load(m_pPosY + i) - Float4::Load(m_pPrevY + i);
+        Float4 dz = Float4::Load(m_pPosZ + i) - Float4::Load(m_pPrevZ + i);
+        maxMotion = Max(maxMotion, dx * dx + dy * dy + dz * dz);
+    }
+
+    float lanes[4];
+    maxMotion.StoreUnaligned(lanes);
+    return std::max(std::max(lanes[0], lanes[1]), std::max(lanes[2], lanes[3]));
+}
+
+void ClothNet::WriteVertices(float* pOut) const
+{
+    for (unsigned int row = 0; row < m_rows; ++row)
+    {
+        for (unsigned int column = 0; column < m_columns; ++column)
+        {
+            unsigned int i = Index(row, column);
+            *pOut++ = m_pPosX[i];
+            *pOut++ = m_pPosY[i];
+            *pOut++ = m_pPosZ[i];
+        }
+    }
+}
+
+void ClothNet::BuildLineIndices(std::vector<unsigned short>& rIndices) const
+{
+    rIndices.clear();
+    for (unsigned int row = 0; row < m_rows; ++row)
+    {
+        for (unsigned int column = 0; column < m_columns; ++column)
+        {
+            unsigned short vertex = (unsigned short)(row * m_columns + column);
+            if (column + 1 < m_columns)
+            {
+                rIndices.push_back(vertex);
+                rIndices.push_back((unsigned short)(vertex + 1));
+            }
+            if (row + 1 < m_rows)
+            {
+                rIndices.push_back(vertex);
+                rIndices.push_back((unsigned short)(vertex + m_columns));
+            }
+        }
+    }
+}
+
+void StepClothNets(std::vector<ClothNet*>& rNets, float dt, const glm::vec3& rBallCentre, float ballRadius, WorkerPool& rPool)
+{
+    rPool.ParallelFor((unsigned int)rNets.size(), [&](unsigned int begin, unsigned int end, unsigned int)
+    {
+        for (unsigned int i = begin; i < end; ++i)
+        {
+            rNets[i]->Step(dt, rBallCentre, ballRadius);
+        }
+    });
+}
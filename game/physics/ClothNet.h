@@ -0,0 +1,98 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <vector>
+
+class WorkerPool;
+
+// Verlet cloth for a goal net: a grid of particles held by structural
+// (horizontal, vertical) and shear (diagonal) distance constraints, pushed
+// out of the ball sphere and the ground.
+//
+// Every row is stored de-interleaved, even columns first and odd columns
+// second, each half padded to a multiple of four. With that layout every
+// constraint family of a row (or row pair) is a pair of contiguous arrays
+// whose lanes never share a particle, so it is relaxed four constraints at a
+// time with Float4.
+class ClothNet
+{
+public:
+    // rTopLeft is the first particle; columns run along rAcross and rows
+    // along rDown. The top row and both side columns hang on the goal frame.
+    ClothNet(const glm::vec3& rTopLeft, const glm::vec3& rAcross, const glm::vec3& rDown,
+             unsigned int columns, unsigned int rows, float spacing);
+    ~ClothNet();
+
+    // Does nothing while asleep unless the ball comes close enough to wake the net.
+    void Step(float dt, const glm::vec3& rBallCentre, float ballRadius);
+
+    bool IsSleeping() const
+    {
+        return m_sleeping;
+    }
+
+    // True when the particles moved since the last call; a sleeping net keeps
+    // its previous vertex upload.
+    bool ConsumeDirty();
+
+    unsigned int GetVertexCount() const
+    {
+        return m_columns * m_rows;
+    }
+
+    // Writes GetVertexCount() xyz triples in row-major grid order.
+    void WriteVertices(float* pOut) const;
+
+    // Line list over the structural constraints, indexing WriteVertices() output.
+    void BuildLineIndices(std::vector<unsigned short>& rIndices) const;
+
+private:
+    ClothNet(const ClothNet&);
+    ClothNet& operator=(const ClothNet&);
+
+    enum Half
+    {
+        Even = 0,
+        Odd = 1
+    };
+
+    unsigned int Index(unsigned int row, unsigned int column) const
+    {
+        return row * m_rowStride + (column & 1) * m_halfStride + (column >> 1);
+    }
+
+    void Integrate(float dt);
+    void SolvePairs(unsigned int rowA, Half halfA, unsigned int offsetA,
+                    unsigned int rowB, Half halfB, unsigned int offsetB,
+                    unsigned int count, float restLength);
+    void SolveConstraints();
+    void Collide(const glm::vec3& rBallCentre, float ballRadius);
+    bool BallIsNear(const glm::vec3& rBallCentre, float ballRadius) const;
+    float MaxMotionSq() const;
+
+    unsigned int m_columns;
+    unsigned int m_rows;
+    unsigned int m_halfStride;
+    unsigned int m_rowStride;
+    float m_spacing;
+    unsigned int m_iterations;
+
+    unsigned char* m_pStorage;
+    float* m_pPosX;
+    float* m_pPosY;
+    float* m_pPosZ;
+    float* m_pPrevX;
+    float* m_pPrevY;
+    float* m_pPrevZ;
+    float* m_pInvMass;     // 0 for pinned particles and row padding
+    float* m_pLaneIndex;   // 0, 1, 2, ... used to mask lanes past a family's constraint count
+
+    glm::vec3 m_boundsMin;
+    glm::vec3 m_boundsMax;
+    bool m_sleeping;
+    bool m_dirty;
+    unsigned int m_stillFrames;
+};
+
+// Steps every awake net, one net per worker.
+void StepClothNets(std::vector<ClothNet*>& rNets, float dt, const glm::vec3& rBallCentre, float ballRadius, WorkerPool& rPool);
@@ -0,0 +1,349 @@
+#include "ContactSolver.h"
+#include "../core/WorkerPool.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace
+{
+    const float BAUMGARTE = 0.2f;
+    const float PENETRATION_SLOP = 0.005f;
+    const float BOUNCE_THRESHOLD = 1.0f;
+
+    // Colour 63 collects constraints that did not fit into the first 63 colours.
+    // Its batch may touch a body twice, so it is always solved by a single thread.
+    const unsigned int OVERFLOW_COLOUR = 63;
+
+    typedef std::chrono::steady_clock Clock;
+
+    float MillisecondsSince(Clock::time_point start)
+    {
+        return std::chrono::duration<float, std::milli>(Clock::now() - start).count();
+    }
+
+    float Restitution(BodyKind kind)
+    {
+        return kind == BodyKind::Ball ? 0.7f : 0.1f;
+    }
+
+    unsigned int LowestFreeColour(unsigned long long usedMask)
+    {
+        for (unsigned int colour = 0; colour < OVERFLOW_COLOUR; ++colour)
+        {
+            if ((usedMask & (1ull << colour)) == 0)
+                return colour;
+        }
+        return OVERFLOW_COLOUR;
+    }
+
+    void SolveContact(BodyArrays& rBodies, Contact& rContact)
+    {
+        const unsigned int a = rContact.bodyA;
+        const unsigned int b = rContact.bodyB;
+        const glm::vec3& n = rContact.normal;
+
+        float invMassA = rBodies.pInvMass[a];
+        float invMassB = 0.0f;
+        glm::vec3 velA(rBodies.pVelX[a], rBodies.pVelY[a], rBodies.pVelZ[a]);
+        glm::vec3 velB(0.0f);
+        if (b != NO_BODY)
+        {
+            invMassB = rBodies.pInvMass[b];
+            velB = glm::vec3(rBodies.pVelX[b], rBodies.pVelY[b], rBodies.pVelZ[b]);
+        }
+
+        float invMassSum = invMassA + invMassB;
+        if (invMassSum <= 0.0f)
+            return;
+
+        float normalVelocity = glm::dot(velB - velA, n);
+        float delta = (rContact.targetVelocity - normalVelocity) / invMassSum;
+        float accumulated = std::max(rContact.normalImpulse + delta, 0.0f);
+        delta = accumulated - rContact.normalImpulse;
+        rContact.normalImpulse = accumulated;
+
+        glm::vec3 impulse = n * delta;
+        rBodies.pVelX[a] -= impulse.x * invMassA;
+        rBodies.pVelY[a] -= impulse.y * invMassA;
+        rBodies.pVelZ[a] -= impulse.z * invMassA;
+        if (b != NO_BODY)
+        {
+            rBodies.pVelX[b] += impulse.x * invMassB;
+            rBodies.pVelY[b] += impulse.y * invMassB;
+            rBodies.pVelZ[b] += impulse.z * invMassB;
+        }
+    }
+}
+
+ContactSolver::ContactSolver() : m_iterations(8), m_parallelIslandThreshold(48)
+{
+}
+
+unsigned int ContactSolver::FindRoot(unsigned int body)
+{
+    while (m_parent[body] != body)
+    {
+        m_parent[body] = m_parent[m_parent[body]];
+        body = m_parent[body];
+    }
+    return body;
+}
+
+void ContactSolver::BuildIslands(const BodyArrays& rBodies, std::vector<Contact>& rContacts)
+{
+    m_parent.resize(rBodies.awakeCount);
+    m_islandOfRoot.assign(rBodies.awakeCount, NO_BODY);
+    for (unsigned int i = 0; i < rBodies.awakeCount; ++i)
+    {
+        m_parent[i] = i;
+    }
+
+    // Walls are static and never join islands. The lower index always wins
+    // the union so the partition does not depend on contact order.
+    for (unsigned int i = 0; i < rContacts.size(); ++i)
+    {
+        if (rContacts[i].bodyB == NO_BODY)
+            continue;
+        unsigned int rootA = FindRoot(rContacts[i].bodyA);
+        unsigned int rootB = FindRoot(rContacts[i].bodyB);
+        if (rootA < rootB)
+            m_parent[rootB] = rootA;
+        else if (rootB < rootA)
+            m_parent[rootA] = rootB;
+    }
+
+    m_islands.clear();
+    for (unsigned int i = 0; i < rContacts.size(); ++i)
+    {
+        unsigned int root = FindRoot(rContacts[i].bodyA);
+        if (m_islandOfRoot[root] == NO_BODY)
+        {
+            Island island = { 0, 0, 0, 0, 0 };
+            m_islandOfRoot[root] = (unsigned int)m_islands.size();
+            m_islands.push_back(island);
+        }
+        rContacts[i].island = m_islandOfRoot[root];
+        ++m_islands[rContacts[i].island].contactCount;
+    }
+
+    for (unsigned int body = 0; body < rBodies.awakeCount; ++body)
+    {
+        unsigned int island = m_islandOfRoot[FindRoot(body)];
+        if (island != NO_BODY)
+            ++m_islands[island].bodyCount;
+    }
+
+    // Stable counting sort of the contacts by island.
+    unsigned int offset = 0;
+    for (unsigned int i = 0; i < m_islands.size(); ++i)
+    {
+        m_islands[i].firstContact = offset;
+        offset += m_islands[i].contactCount;
+    }
+    m_scratch.resize(rContacts.size());
+    std::vector<unsigned int> cursor(m_islands.size());
+    for (unsigned int i = 0; i < m_islands.size(); ++i)
+    {
+        cursor[i] = m_islands[i].firstContact;
+    }
+    for (unsigned int i = 0; i < rContacts.size(); ++i)
+    {
+        m_scratch[cursor[rContacts[i].island]++] = rContacts[i];
+    }
+    rContacts.swap(m_scratch);
+}
+
+void ContactSolver::ColourIsland(Island& rIsland, std::vector<Contact>& rContacts)
+{
+    const unsigned int first = rIsland.firstContact;
+    const unsigned int last = first + rIsland.contactCount;
+
+    for (unsigned int i = first; i < last; ++i)
+    {
+        m_bodyColours[rContacts[i].bodyA] = 0;
+        if (rContacts[i].bodyB != NO_BODY)
+            m_bodyColours[rContacts[i].bodyB] = 0;
+    }
+
+    unsigned int colourCounts[OVERFLOW_COLOUR + 1] = { 0 };
+    unsigned int colourCount = 0;
+    for (unsigned int i = first; i < last; ++i)
+    {
+        Contact& rContact = rContacts[i];
+        unsigned long long used = m_bodyColours[rContact.bodyA];
+        if (rContact.bodyB != NO_BODY)
+            used |= m_bodyColours[rContact.bodyB];
+
+        rContact.colour = LowestFreeColour(used);
+        unsigned long long bit = 1ull << rContact.colour;
+        m_bodyColours[rContact.bodyA] |= bit;
+        if (rContact.bodyB != NO_BODY)
+            m_bodyColours[rContact.bodyB] |= bit;
+
+        ++colourCounts[rContact.colour];
+        colourCount = std::max(colourCount, rContact.colour + 1);
+    }
+
+    // Stable counting sort of the island's contacts by colour; one batch per colour.
+    rIsland.firstBatch = (unsigned int)m_batches.size();
+    rIsland.batchCount = colourCount;
+    unsigned int cursor[OVERFLOW_COLOUR + 1];
+    unsigned int offset = first;
+    for (unsigned int colour = 0; colour < colourCount; ++colour)
+    {
+        Batch batch = { offset, colourCounts[colour], colour };
+        m_batches.push_back(batch);
+        cursor[colour] = offset;
+        offset += colourCounts[colour];
+    }
+    for (unsigned int i = first; i < last; ++i)
+    {
+        m_scratch[cursor[rContacts[i].colour]++] = rContacts[i];
+    }
+    std::copy(m_scratch.begin() + first, m_scratch.begin() + last, rContacts.begin() + first);
+}
+
+void ContactSolver::PrepareContacts(const BodyArrays& rBodies, std::vector<Contact>& rContacts, float dt)
+{
+    for (unsigned int i = 0; i < rContacts.size(); ++i)
+    {
+        Contact& rContact = rContacts[i];
+        const unsigned int a = rContact.bodyA;
+        const unsigned int b = rContact.bodyB;
+
+        glm::vec3 velA(rBodies.pVelX[a], rBodies.pVelY[a], rBodies.pVelZ[a]);
+        glm::vec3 velB(0.0f);
+        float restitution = Restitution(rBodies.pKind[a]);
+        if (b != NO_BODY)
+        {
+            velB = glm::vec3(rBodies.pVelX[b], rBodies.pVelY[b], rBodies.pVelZ[b]);
+            restitution = std::max(restitution, Restitution(rBodies.pKind[b]));
+        }
+
+        float normalVelocity = glm::dot(velB - velA, rContact.normal);
+        float bounce = normalVelocity < -BOUNCE_THRESHOLD ? -restitution * normalVelocity : 0.0f;
+        float bias = BAUMGARTE / dt * std::max(rContact.penetration - PENETRATION_SLOP, 0.0f);
+
+        rContact.targetVelocity = std::max(bounce, bias);
+        rContact.normalImpulse = 0.0f;
+    }
+}
+
+void ContactSolver::SolveIslandSerial(BodyArrays& rBodies, std::vector<Contact>& rContacts, const Island& rIsland, float* pColourMs)
+{
+    for (unsigned int iteration = 0; iteration < m_iterations; ++iteration)
+    {
+        for (unsigned int b = 0; b < rIsland.batchCount; ++b)
+        {
+            const Batch& rBatch = m_batches[rIsland.firstBatch + b];
+            Clock::time_point start = Clock::now();
+            for (unsigned int i = 0; i < rBatch.contactCount; ++i)
+            {
+                SolveContact(rBodies, rContacts[rBatch.firstContact + i]);
+            }
+            pColourMs[b] += MillisecondsSince(start);
+        }
+    }
+}
+
+void ContactSolver::SolveIslandParallel(BodyArrays& rBodies, std::vector<Contact>& rContacts, const Island& rIsland, WorkerPool& rPool, float* pColourMs)
+{
+    for (unsigned int iteration = 0; iteration < m_iterations; ++iteration)
+    {
+        for (unsigned int b = 0; b < rIsland.batchCount; ++b)
+        {
+            const Batch& rBatch = m_batches[rIsland.firstBatch + b];
+            Clock::time_point start = Clock::now();
+            if (rBatch.colour == OVERFLOW_COLOUR)
+            {
+                for (unsigned int i = 0; i < rBatch.contactCount; ++i)
+                {
+                    SolveContact(rBodies, rContacts[rBatch.firstContact + i]);
+                }
+            }
+            else
+            {
+                // Constraints of one colour share no dynamic body, so the slices
+                // write disjoint velocities and need no synchronisation.
+                rPool.ParallelFor(rBatch.contactCount, [&](unsigned int begin, unsigned int end, unsigned int)
+                {
+                    for (unsigned int i = begin; i < end; ++i)
+                    {
+                        SolveContact(rBodies, rContacts[rBatch.firstContact + i]);
+                    }
+                });
+            }
+            pColourMs[b] += MillisecondsSince(start);
+        }
+    }
+}
+
+void ContactSolver::Solve(BodyArrays& rBodies, std::vector<Contact>& rContacts, float dt, WorkerPool& rPool, SolverStats& rStats)
+{
+    Clock::time_point buildStart = Clock::now();
+
+    BuildIslands(rBodies, rContacts);
+
+    m_batches.clear();
+    m_bodyColours.resize(rBodies.awakeCount);
+    for (unsigned int i = 0; i < m_islands.size(); ++i)
+    {
+        ColourIsland(m_islands[i], rContacts);
+    }
+    PrepareContacts(rBodies, rContacts, dt);
+
+    rStats.islandBuildMs += MillisecondsSince(buildStart);
+
+    const unsigned int firstIsland = (unsigned int)rStats.islands.size();
+    const unsigned int firstColour = (unsigned int)rStats.colourMs.size();
+    rStats.islands.resize(firstIsland + m_islands.size());
+    rStats.colourMs.resize(firstColour + m_batches.size(), 0.0f);
+    float* pColourMs = rStats.colourMs.empty() ? nullptr : &rStats.colourMs[firstColour];
+
+    std::vector<unsigned int> serialIslands;
+    std::vector<unsigned int> parallelIslands;
+    for (unsigned int i = 0; i < m_islands.size(); ++i)
+    {
+        const Island& rIsland = m_islands[i];
+        IslandTiming& rTiming = rStats.islands[firstIsland + i];
+        rTiming.bodyCount = rIsland.bodyCount;
+        rTiming.constraintCount = rIsland.contactCount;
+        rTiming.colourCount = rIsland.batchCount;
+        rTiming.firstColourTiming = firstColour + rIsland.firstBatch;
+        rTiming.parallel = rPool.GetThreadCount() > 1 && rIsland.contactCount >= m_parallelIslandThreshold;
+        rTiming.subStep = 0;
+        rTiming.subStepCount = 1;
+        rTiming.solveMs = 0.0f;
+
+        if (rTiming.parallel)
+            parallelIslands.push_back(i);
+        else
+            serialIslands.push_back(i);
+    }
+
+    Clock::time_point solveStart = Clock::now();
+
+    // Islands never share a dynamic body, so whole islands go to separate workers.
+    rPool.ParallelFor((unsigned int)serialIslands.size(), [&](unsigned int begin, unsigned int end, unsigned int)
+    {
+        for (unsigned int i = begin; i < end; ++i)
+        {
+            const Island& rIsland = m_islands[serialIslands[i]];
+            Clock::time_point start = Clock::now();
+            SolveIslandSerial(rBodies, rContacts, rIsland, pColourMs + rIsland.firstBatch);
+            rStats.islands[firstIsland + serialIslands[i]].solveMs = MillisecondsSince(start);
+        }
+    });
+
+    for (unsigned int i = 0; i < parallelIslands.size(); ++i)
+    {
+        const Island& rIsland = m_islands[parallelIslands[i]];
+        Clock::time_point start = Clock::now();
+        SolveIslandParallel(rBodies, rContacts, rIsland, rPool, pColourMs + rIsland.firstBatch);
+        rStats.islands[firstIsland + parallelIslands[i]].solveMs = MillisecondsSince(start);
+    }
+
+    rStats.solveMs += MillisecondsSince(solveStart);
+    rStats.contactCount += (unsigned int)rContacts.size();
+    rStats.threadCount = rPool.GetThreadCount();
+}
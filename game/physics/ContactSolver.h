@@ -0,0 +1,68 @@
+#pragma once
+
+#include "PhysicsTypes.h"
+
+class WorkerPool;
+
+// Sequential-impulse contact solver.
+// Contacts are grouped into islands (sets of bodies connected through contacts)
+// and each island is greedily graph-coloured so that no two constraints of the
+// same colour touch the same dynamic body. Small islands are solved serially,
+// one island per worker; large pile-ups are solved colour by colour with every
+// colour batch spread across the pool. Neither path takes a lock, and the
+// result does not depend on the number of threads.
+class ContactSolver
+{
+public:
+    ContactSolver();
+
+    void SetIterations(unsigned int iterations)
+    {
+        m_iterations = iterations;
+    }
+
+    // Islands with at least this many constraints are solved in parallel batches.
+    void SetParallelIslandThreshold(unsigned int threshold)
+    {
+        m_parallelIslandThreshold = threshold;
+    }
+
+    // Reorders rContacts by island and colour and applies the impulses to rBodies.
+    // Only the awake rows of rBodies take part. Timings are appended to rStats,
+    // so one SolverStats can collect every sub-step of a tick.
+    void Solve(BodyArrays& rBodies, std::vector<Contact>& rContacts, float dt, WorkerPool& rPool, SolverStats& rStats);
+
+private:
+    struct Island
+    {
+        unsigned int firstContact;
+        unsigned int contactCount;
+        unsigned int bodyCount;
+        unsigned int firstBatch;
+        unsigned int batchCount;
+    };
+
+    struct Batch
+    {
+        unsigned int firstContact;
+        unsigned int contactCount;
+        unsigned int colour;
+    };
+
+    unsigned int FindRoot(unsigned int body);
+    void BuildIslands(const BodyArrays& rBodies, std::vector<Contact>& rContacts);
+    void ColourIsland(Island& rIsland, std::vector<Contact>& rContacts);
+    void PrepareContacts(const BodyArrays& rBodies, std::vector<Contact>& rContacts, float dt);
+    void SolveIslandSerial(BodyArrays& rBodies, std::vector<Contact>& rContacts, const Island& rIsland, float* pColourMs);
+    void SolveIslandParallel(BodyArrays& rBodies, std::vector<Contact>& rContacts, const Island& rIsland, WorkerPool& rPool, float* pColourMs);
+
+    unsigned int m_iterations;
+    unsigned int m_parallelIslandThreshold;
+
+    std::vector<unsigned int> m_parent;
+    std::vector<unsigned int> m_islandOfRoot;
+    std::vector<unsigned long long> m_bodyColours;
+    std::vector<Contact> m_scratch;
+    std::vector<Island> m_islands;
+    std::vector<Batch> m_batches;
+};
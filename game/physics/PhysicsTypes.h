@@ -0,0 +1,92 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <vector>
+
+// Shared plain data types of the collision world.
+
+enum class BodyKind : unsigned char
+{
+    Ball,
+    Player
+};
+
+// Static half-space: points with dot(normal, p) >= offset are inside the pitch.
+struct WallPlane
+{
+    glm::vec3 normal;
+    float offset;
+};
+
+// Structure-of-arrays view over the body storage of a PhysicsWorld.
+// Rows [0, awakeCount) are awake, the rest are asleep. Rows move when bodies
+// fall asleep or wake up; pHandle maps a row back to its stable body handle.
+struct BodyArrays
+{
+    float* pPosX;
+    float* pPosY;
+    float* pPosZ;
+    float* pVelX;
+    float* pVelY;
+    float* pVelZ;
+    float* pInvMass;
+    float* pRadius;
+    float* pSleepTimer;
+    unsigned int* pHandle;
+    unsigned int* pSleepGroup;
+    BodyKind* pKind;
+    unsigned int count;
+    unsigned int awakeCount;
+};
+
+const unsigned int NO_BODY = 0xFFFFFFFFu;
+
+// Non-penetration constraint between body A and either body B or wall.
+// The normal points from A towards B (or away from the wall into A, negated).
+struct Contact
+{
+    unsigned int bodyA;
+    unsigned int bodyB;
+    unsigned int wall;
+    glm::vec3 normal;
+    float penetration;
+    float targetVelocity;
+    float normalImpulse;
+    unsigned int island;
+    unsigned int colour;
+};
+
+struct IslandTiming
+{
+    unsigned int bodyCount;
+    unsigned int constraintCount;
+    unsigned int colourCount;
+    unsigned int firstColourTiming;   // index into SolverStats::colourMs
+    bool parallel;                    // solved colour by colour across the pool
+    unsigned int subStep;             // which sub-step of the tick produced this entry
+    unsigned int subStepCount;
+    float solveMs;
+};
+
+// Accumulated over all sub-steps of one tick.
+struct SolverStats
+{
+    unsigned int contactCount;
+    unsigned int threadCount;
+    float broadphaseMs;
+    float islandBuildMs;
+    float solveMs;
+    std::vector<IslandTiming> islands;
+    std::vector<float> colourMs;
+};
+
+struct SubStepStats
+{
+    unsigned int motionIslands;
+    unsigned int calmIslands;          // islands that kept a single step
+    unsigned int maxSubSteps;
+    unsigned int islandSubSteps;       // sum of sub-steps over all islands
+    unsigned int pipelineRuns;         // island groups sharing a sub-step count run together
+    unsigned int budgetCost;           // bodies x sub-steps actually spent
+    unsigned int clampedIslands;       // islands that got fewer sub-steps than requested
+};
@@ -0,0 +1,832 @@
+#include "PhysicsWorld.h"
+#include "../core/Arena.h"
+#include "../core/StateHash.h"
+#include "../core/StateStream.h"
+#include "../core/WorkerPool.h"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+namespace
+{
+    const float GRAVITY = -9.81f;
+    const float LINEAR_DAMPING = 0.2f;
+    const float WALL_HEIGHT = 1.0f;
+
+    // A body counts as resting below this speed; its island sleeps once every
+    // body in it has been resting for TIME_TO_SLEEP seconds.
+    const float SLEEP_SPEED = 0.05f;
+    const float TIME_TO_SLEEP = 0.5f;
+
+    // A sub-step may move a body at most this fraction of the smallest radius in its island.
+    const float MAX_TRAVEL_PER_SUB_STEP = 0.5f;
+    // Contacts between very different masses converge slowly under a fixed
+    // iteration count; every 16x of mass ratio asks for one more sub-step.
+    const float MASS_RATIO_PER_SUB_STEP = 16.0f;
+
+    const unsigned int FLOAT_COLUMNS = 9;
+    const unsigned int UINT_COLUMNS = 2;
+
+    // Every SoA column starts on a 16 byte boundary so SIMD loops can use aligned loads.
+    unsigned int AlignedColumnBytes(unsigned int capacity, unsigned int elementSize)
+    {
+        return (capacity * elementSize + 15u) & ~15u;
+    }
+
+    typedef std::chrono::steady_clock Clock;
+
+    template <typename T>
+    void PermuteColumn(T* pColumn, const std::vector<unsigned int>& rOrder, std::vector<unsigned char>& rScratch)
+    {
+        const unsigned int count = (unsigned int)rOrder.size();
+        rScratch.resize(count * sizeof(T));
+        T* pTemp = reinterpret_cast<T*>(&rScratch[0]);
+        for (unsigned int i = 0; i < count; ++i)
+        {
+            pTemp[i] = pColumn[rOrder[i]];
+        }
+        std::memcpy(pColumn, pTemp, count * sizeof(T));
+    }
+
+    float Speed(const BodyArrays& rBodies, unsigned int row)
+    {
+        return std::sqrt(rBodies.pVelX[row] * rBodies.pVelX[row]
+                       + rBodies.pVelY[row] * rBodies.pVelY[row]
+                       + rBodies.pVelZ[row] * rBodies.pVelZ[row]);
+    }
+}
+
+PhysicsWorld::PhysicsWorld(unsigned int capacity)
+    : m_capacity(capacity),
+      m_pStorage(nullptr),
+      m_pColumns(nullptr),
+      m_columnBytes(0),
+      m_sleepingEnabled(true),
+      m_subStepMode(SubStepPerIsland),
+      m_maxSubSteps(8),
+      m_subStepBudget(capacity * 4),
+      m_sleeperMaxRadius(0.0f),
+      m_sleepersDirty(false)
+{
+    const unsigned int floatColumn = AlignedColumnBytes(capacity, sizeof(float));
+    const unsigned int uintColumn = AlignedColumnBytes(capacity, sizeof(unsigned int));
+    const unsigned int kindColumn = AlignedColumnBytes(capacity, sizeof(BodyKind));
+    m_columnBytes = FLOAT_COLUMNS * floatColumn + UINT_COLUMNS * uintColumn + kindColumn;
+
+    // One aligned block for all columns, in the match's arena when it has one.
+    m_pStorage = static_cast<unsigned char*>(AllocateAligned(m_columnBytes));
+    m_pColumns = m_pStorage;
+    std::memset(m_pColumns, 0, m_columnBytes);
+    unsigned char* pCursor = m_pColumns;
+
+    float** floatColumns[FLOAT_COLUMNS] = { &m_bodies.pPosX, &m_bodies.pPosY, &m_bodies.pPosZ,
+                                            &m_bodies.pVelX, &m_bodies.pVelY, &m_bodies.pVelZ,
+                                            &m_bodies.pInvMass, &m_bodies.pRadius, &m_bodies.pSleepTimer };
+    for (unsigned int i = 0; i < FLOAT_COLUMNS; ++i)
+    {
+        *floatColumns[i] = reinterpret_cast<float*>(pCursor);
+        pCursor += floatColumn;
+    }
+    unsigned int** uintColumns[UINT_COLUMNS] = { &m_bodies.pHandle, &m_bodies.pSleepGroup };
+    for (unsigned int i = 0; i < UINT_COLUMNS; ++i)
+    {
+        *uintColumns[i] = reinterpret_cast<unsigned int*>(pCursor);
+        pCursor += uintColumn;
+    }
+    m_bodies.pKind = reinterpret_cast<BodyKind*>(pCursor);
+    m_bodies.count = 0;
+    m_bodies.awakeCount = 0;
+}
+
+PhysicsWorld::~PhysicsWorld()
+{
+    FreeAligned(m_pStorage);
+}
+
+unsigned int PhysicsWorld::AddBody(BodyKind kind, const glm::vec3& rPosition, float radius, float mass)
+{
+    assert(m_bodies.count < m_capacity);
+
+    // New bodies start awake: append, then swap into the end of the awake range.
+    unsigned int handle = m_bodies.count;
+    unsigned int row = m_bodies.count++;
+    m_rowOfHandle.push_back(row);
+
+    m_bodies.pPosX[row] = rPosition.x;
+    m_bodies.pPosY[row] = rPosition.y;
+    m_bodies.pPosZ[row] = rPosition.z;
+    m_bodies.pVelX[row] = 0.0f;
+    m_bodies.pVelY[row] = 0.0f;
+    m_bodies.pVelZ[row] = 0.0f;
+    m_bodies.pInvMass[row] = mass > 0.0f ? 1.0f / mass : 0.0f;
+    m_bodies.pRadius[row] = radius;
+    m_bodies.pSleepTimer[row] = 0.0f;
+    m_bodies.pHandle[row] = handle;
+    m_bodies.pSleepGroup[row] = NO_BODY;
+    m_bodies.pKind[row] = kind;
+
+    SwapRows(row, m_bodies.awakeCount);
+    ++m_bodies.awakeCount;
+    return handle;
+}
+
+void PhysicsWorld::AddWall(const glm::vec3& rNormal, float offset)
+{
+    WallPlane wall = { glm::normalize(rNormal), offset };
+    m_walls.push_back(wall);
+}
+
+void PhysicsWorld::AddPitchWalls(float halfLength, float halfWidth)
+{
+    AddWall(glm::vec3( 0.0f, 1.0f,  0.0f), 0.0f);
+    AddWall(glm::vec3( 1.0f, 0.0f,  0.0f), -halfLength);
+    AddWall(glm::vec3(-1.0f, 0.0f,  0.0f), -halfLength);
+    AddWall(glm::vec3( 0.0f, 0.0f,  1.0f), -halfWidth);
+    AddWall(glm::vec3( 0.0f, 0.0f, -1.0f), -halfWidth);
+}
+
+void PhysicsWorld::ApplyImpulse(unsigned int body, const glm::vec3& rImpulse)
+{
+    WakeBody(body);
+
+    unsigned int row = m_rowOfHandle[body];
+    float invMass = m_bodies.pInvMass[row];
+    m_bodies.pVelX[row] += rImpulse.x * invMass;
+    m_bodies.pVelY[row] += rImpulse.y * invMass;
+    m_bodies.pVelZ[row] += rImpulse.z * invMass;
+}
+
+void PhysicsWorld::WakeBody(unsigned int body)
+{
+    unsigned int row = m_rowOfHandle[body];
+    if (row >= m_bodies.awakeCount)
+        WakeGroup(m_bodies.pSleepGroup[row]);
+    m_bodies.pSleepTimer[m_rowOfHandle[body]] = 0.0f;
+}
+
+void PhysicsWorld::SetBodyState(unsigned int body, const glm::vec3& rPosition, const glm::vec3& rVelocity)
+{
+    WakeBody(body);
+
+    unsigned int row = m_rowOfHandle[body];
+    m_bodies.pPosX[row] = rPosition.x;
+    m_bodies.pPosY[row] = rPosition.y;
+    m_bodies.pPosZ[row] = rPosition.z;
+    m_bodies.pVelX[row] = rVelocity.x;
+    m_bodies.pVelY[row] = rVelocity.y;
+    m_bodies.pVelZ[row] = rVelocity.z;
+}
+
+glm::vec3 PhysicsWorld::GetPosition(unsigned int body) const
+{
+    return GetRowPosition(m_rowOfHandle[body]);
+}
+
+glm::vec3 PhysicsWorld::GetVelocity(unsigned int body) const
+{
+    unsigned int row = m_rowOfHandle[body];
+    return glm::vec3(m_bodies.pVelX[row], m_bodies.pVelY[row], m_bodies.pVelZ[row]);
+}
+
+float PhysicsWorld::GetRadius(unsigned int body) const
+{
+    return m_bodies.pRadius[m_rowOfHandle[body]];
+}
+
+BodyKind PhysicsWorld::GetKind(unsigned int body) const
+{
+    return m_bodies.pKind[m_rowOfHandle[body]];
+}
+
+bool PhysicsWorld::IsAwake(unsigned int body) const
+{
+    return m_rowOfHandle[body] < m_bodies.awakeCount;
+}
+
+void PhysicsWorld::SetSleepingEnabled(bool enabled)
+{
+    m_sleepingEnabled = enabled;
+    if (!enabled)
+    {
+        while (m_bodies.awakeCount < m_bodies.count)
+        {
+            WakeGroup(m_bodies.pSleepGroup[m_bodies.awakeCount]);
+        }
+    }
+}
+
+void PhysicsWorld::HashState(StateHash& rHash) const
+{
+    rHash.Add(m_bodies.count);
+    rHash.Add(m_bodies.awakeCount);
+    rHash.Add(m_pColumns, m_columnBytes);
+    rHash.Add(m_rowOfHandle);
+}
+
+void PhysicsWorld::SaveState(StateWriter& rOut) const
+{
+    const unsigned int count = m_bodies.count;
+    rOut.Write(count);
+    rOut.Write(m_bodies.awakeCount);
+
+    const float* floatColumns[FLOAT_COLUMNS] = { m_bodies.pPosX, m_bodies.pPosY, m_bodies.pPosZ,
+                                                 m_bodies.pVelX, m_bodies.pVelY, m_bodies.pVelZ,
+                                                 m_bodies.pInvMass, m_bodies.pRadius, m_bodies.pSleepTimer };
+    for (unsigned int i = 0; i < FLOAT_COLUMNS; ++i)
+        rOut.Write(floatColumns[i], count * sizeof(float));
+    rOut.Write(m_bodies.pHandle, count * sizeof(unsigned int));
+    rOut.Write(m_bodies.pSleepGroup, count * sizeof(unsigned int));
+    rOut.Write(m_bodies.pKind, count * sizeof(BodyKind));
+    rOut.Write(m_rowOfHandle);
+}
+
+void PhysicsWorld::LoadState(StateReader& rIn)
+{
+    unsigned int count = 0;
+    rIn.Read(count);
+    rIn.Read(m_bodies.awakeCount);
+    assert(count <= m_capacity);
+
+    float* floatColumns[FLOAT_COLUMNS] = { m_bodies.pPosX, m_bodies.pPosY, m_bodies.pPosZ,
+                                           m_bodies.pVelX, m_bodies.pVelY, m_bodies.pVelZ,
+                                           m_bodies.pInvMass, m_bodies.pRadius, m_bodies.pSleepTimer };
+    for (unsigned int i = 0; i < FLOAT_COLUMNS; ++i)
+    {
+        rIn.Read(floatColumns[i], count * sizeof(float));
+        // rows past the body count stay zero so HashState() sees the same block
+        if (count < m_bodies.count)
+            std::memset(floatColumns[i] + count, 0, (m_bodies.count - count) * sizeof(float));
+    }
+    rIn.Read(m_bodies.pHandle, count * sizeof(unsigned int));
+    rIn.Read(m_bodies.pSleepGroup, count * sizeof(unsigned int));
+    rIn.Read(m_bodies.pKind, count * sizeof(BodyKind));
+    if (count < m_bodies.count)
+    {
+        std::memset(m_bodies.pHandle + count, 0, (m_bodies.count - count) * sizeof(unsigned int));
+        std::memset(m_bodies.pSleepGroup + count, 0, (m_bodies.count - count) * sizeof(unsigned int));
+        std::memset(m_bodies.pKind + count, 0, (m_bodies.count - count) * sizeof(BodyKind));
+    }
+    m_bodies.count = count;
+    rIn.Read(m_rowOfHandle);
+    m_sleepersDirty = true;
+}
+
+size_t PhysicsWorld::GetMaxStateSize() const
+{
+    const size_t bytesPerBody = FLOAT_COLUMNS * sizeof(float) + 2 * sizeof(unsigned int) + sizeof(BodyKind) + sizeof(unsigned int);
+    return 3 * sizeof(unsigned int) + m_capacity * bytesPerBody;
+}
+
+glm::vec3 PhysicsWorld::GetRowPosition(unsigned int row) const
+{
+    return glm::vec3(m_bodies.pPosX[row], m_bodies.pPosY[row], m_bodies.pPosZ[row]);
+}
+
+void PhysicsWorld::SwapRows(unsigned int a, unsigned int b)
+{
+    if (a == b)
+        return;
+
+    float* floatColumns[FLOAT_COLUMNS] = { m_bodies.pPosX, m_bodies.pPosY, m_bodies.pPosZ,
+                                           m_bodies.pVelX, m_bodies.pVelY, m_bodies.pVelZ,
+                                           m_bodies.pInvMass, m_bodies.pRadius, m_bodies.pSleepTimer };
+    for (unsigned int i = 0; i < FLOAT_COLUMNS; ++i)
+    {
+        std::swap(floatColumns[i][a], floatColumns[i][b]);
+    }
+    std::swap(m_bodies.pHandle[a], m_bodies.pHandle[b]);
+    std::swap(m_bodies.pSleepGroup[a], m_bodies.pSleepGroup[b]);
+    std::swap(m_bodies.pKind[a], m_bodies.pKind[b]);
+
+    m_rowOfHandle[m_bodies.pHandle[a]] = a;
+    m_rowOfHandle[m_bodies.pHandle[b]] = b;
+    m_sleepersDirty = true;
+}
+
+void PhysicsWorld::WakeGroup(unsigned int group)
+{
+    for (unsigned int row = m_bodies.awakeCount; row < m_bodies.count; ++row)
+    {
+        if (m_bodies.pSleepGroup[row] != group)
+            continue;
+
+        m_bodies.pSleepGroup[row] = NO_BODY;
+        m_bodies.pSleepTimer[row] = 0.0f;
+        SwapRows(row, m_bodies.awakeCount);
+        ++m_bodies.awakeCount;
+        // SwapRows() leaves the flag alone when the row is already in place
+        m_sleepersDirty = true;
+    }
+}
+
+void PhysicsWorld::WakeTouchedSleepers(float dt)
+{
+    if (m_bodies.awakeCount == m_bodies.count)
+        return;
+
+    if (m_sleepersDirty)
+    {
+        m_sleeperOrder.clear();
+        m_sleeperMaxRadius = 0.0f;
+        for (unsigned int row = m_bodies.awakeCount; row < m_bodies.count; ++row)
+        {
+            m_sleeperOrder.push_back(row);
+            m_sleeperMaxRadius = std::max(m_sleeperMaxRadius, m_bodies.pRadius[row]);
+        }
+        const BodyArrays& rBodies = m_bodies;
+        std::sort(m_sleeperOrder.begin(), m_sleeperOrder.end(), [&rBodies](unsigned int a, unsigned int b)
+        {
+            float minA = rBodies.pPosX[a] - rBodies.pRadius[a];
+            float minB = rBodies.pPosX[b] - rBodies.pRadius[b];
+            return minA < minB || (minA == minB && a < b);
+        });
+        m_sleeperMin.resize(m_sleeperOrder.size());
+        for (unsigned int i = 0; i < m_sleeperOrder.size(); ++i)
+        {
+            unsigned int row = m_sleeperOrder[i];
+            m_sleeperMin[i] = m_bodies.pPosX[row] - m_bodies.pRadius[row];
+        }
+        m_sleepersDirty = false;
+    }
+
+    // Only awake bodies are walked; sleepers are found by binary search. The
+    // awake body is inflated by the distance it can cover this tick so a fast
+    // ball wakes a sleeper before it could pass through it.
+    m_groupsToWake.clear();
+    for (unsigned int a = 0; a < m_bodies.awakeCount; ++a)
+    {
+        const float radius = m_bodies.pRadius[a] + Speed(m_bodies, a) * dt;
+        const float minX = m_bodies.pPosX[a] - radius - 2.0f * m_sleeperMaxRadius;
+        const float maxX = m_bodies.pPosX[a] + radius;
+        glm::vec3 position = GetRowPosition(a);
+
+        unsigned int i = (unsigned int)(std::lower_bound(m_sleeperMin.begin(), m_sleeperMin.end(), minX) - m_sleeperMin.begin());
+        for (; i < m_sleeperOrder.size() && m_sleeperMin[i] <= maxX; ++i)
+        {
+            unsigned int b = m_sleeperOrder[i];
+            glm::vec3 delta = GetRowPosition(b) - position;
+            float radii = radius + m_bodies.pRadius[b];
+            if (glm::dot(delta, delta) < radii * radii)
+                m_groupsToWake.push_back(m_bodies.pSleepGroup[b]);
+        }
+    }
+
+    for (unsigned int i = 0; i < m_groupsToWake.size(); ++i)
+    {
+        WakeGroup(m_groupsToWake[i]);
+    }
+}
+
+unsigned int PhysicsWorld::FindRoot(unsigned int row)
+{
+    while (m_parent[row] != row)
+    {
+        m_parent[row] = m_parent[m_parent[row]];
+        row = m_parent[row];
+    }
+    return row;
+}
+
+void PhysicsWorld::BuildMotionIslands(float dt)
+{
+    const unsigned int awakeCount = m_bodies.awakeCount;
+
+    // Sweep and prune with every body inflated by its travel this tick: bodies
+    // whose swept spheres overlap may collide during one of the sub-steps.
+    m_parent.resize(awakeCount);
+    m_bodyMassRatio.assign(awakeCount, 1.0f);
+    m_sweepOrder.resize(awakeCount);
+    m_sweepMin.resize(awakeCount);
+    std::vector<float>& rReach = m_islandReach;
+    rReach.resize(awakeCount);
+    for (unsigned int i = 0; i < awakeCount; ++i)
+    {
+        m_parent[i] = i;
+        m_sweepOrder[i] = i;
+        rReach[i] = m_bodies.pRadius[i] + Speed(m_bodies, i) * dt;
+        m_sweepMin[i] = m_bodies.pPosX[i] - rReach[i];
+    }
+    const std::vector<float>& rMin = m_sweepMin;
+    std::sort(m_sweepOrder.begin(), m_sweepOrder.end(), [&rMin](unsigned int a, unsigned int b)
+    {
+        return rMin[a] < rMin[b] || (rMin[a] == rMin[b] && a < b);
+    });
+
+    for (unsigned int i = 0; i < awakeCount; ++i)
+    {
+        const unsigned int a = m_sweepOrder[i];
+        const float maxX = m_bodies.pPosX[a] + rReach[a];
+        glm::vec3 posA = GetRowPosition(a);
+
+        for (unsigned int j = i + 1; j < awakeCount; ++j)
+        {
+            const unsigned int b = m_sweepOrder[j];
+            if (m_sweepMin[b] > maxX)
+                break;
+
+            glm::vec3 delta = GetRowPosition(b) - posA;
+            float reach = rReach[a] + rReach[b];
+            if (glm::dot(delta, delta) >= reach * reach)
+                continue;
+
+            float invMassA = m_bodies.pInvMass[a];
+            float invMassB = m_bodies.pInvMass[b];
+            if (invMassA > 0.0f && invMassB > 0.0f)
+            {
+                float ratio = std::max(invMassA, invMassB) / std::min(invMassA, invMassB);
+                m_bodyMassRatio[a] = std::max(m_bodyMassRatio[a], ratio);
+                m_bodyMassRatio[b] = std::max(m_bodyMassRatio[b], ratio);
+            }
+
+            unsigned int rootA = FindRoot(a);
+            unsigned int rootB = FindRoot(b);
+            if (rootA < rootB)
+                m_parent[rootB] = rootA;
+            else if (rootB < rootA)
+                m_parent[rootA] = rootB;
+        }
+    }
+
+    // Islands are numbered in row order of their first body.
+    m_islandOfRoot.assign(awakeCount, NO_BODY);
+    m_motionIslands.clear();
+    for (unsigned int row = 0; row < awakeCount; ++row)
+    {
+        unsigned int root = FindRoot(row);
+        if (m_islandOfRoot[root] == NO_BODY)
+        {
+            MotionIsland island = { 0, 0, 1, 0.0f, m_bodies.pRadius[row], 1.0f };
+            m_islandOfRoot[root] = (unsigned int)m_motionIslands.size();
+            m_motionIslands.push_back(island);
+        }
+
+        MotionIsland& rIsland = m_motionIslands[m_islandOfRoot[root]];
+        ++rIsland.bodyCount;
+        rIsland.maxSpeed = std::max(rIsland.maxSpeed, Speed(m_bodies, row));
+        rIsland.minRadius = std::min(rIsland.minRadius, m_bodies.pRadius[row]);
+        rIsland.maxMassRatio = std::max(rIsland.maxMassRatio, m_bodyMassRatio[row]);
+    }
+}
+
+void PhysicsWorld::ChooseSubSteps(float dt)
+{
+    unsigned int worst = 1;
+    for (unsigned int i = 0; i < m_motionIslands.size(); ++i)
+    {
+        MotionIsland& rIsland = m_motionIslands[i];
+        unsigned int subSteps = 1;
+        if (m_subStepMode != SubStepFixed)
+        {
+            float travel = rIsland.maxSpeed * dt / (MAX_TRAVEL_PER_SUB_STEP * std::max(rIsland.minRadius, 1e-3f));
+            unsigned int forSpeed = (unsigned int)std::ceil(travel);
+            unsigned int forStiffness = 1;
+            for (float ratio = rIsland.maxMassRatio; ratio >= MASS_RATIO_PER_SUB_STEP; ratio /= MASS_RATIO_PER_SUB_STEP)
+            {
+                ++forStiffness;
+            }
+            subSteps = std::min(std::max(std::max(forSpeed, forStiffness), 1u), m_maxSubSteps);
+        }
+        rIsland.subSteps = subSteps;
+        worst = std::max(worst, subSteps);
+    }
+
+    if (m_subStepMode == SubStepWholeWorld)
+    {
+        for (unsigned int i = 0; i < m_motionIslands.size(); ++i)
+        {
+            m_motionIslands[i].subSteps = worst;
+        }
+    }
+
+    m_subStepStats.clampedIslands = 0;
+    unsigned int cost = 0;
+    for (unsigned int i = 0; i < m_motionIslands.size(); ++i)
+    {
+        cost += m_motionIslands[i].bodyCount * m_motionIslands[i].subSteps;
+    }
+
+    // Over budget: take one sub-step at a time from the most demanding island
+    // (lowest index on ties) until the tick fits or everything is at one step.
+    while (cost > m_subStepBudget)
+    {
+        unsigned int victim = NO_BODY;
+        for (unsigned int i = 0; i < m_motionIslands.size(); ++i)
+        {
+            if (m_motionIslands[i].subSteps > 1 && (victim == NO_BODY || m_motionIslands[i].subSteps > m_motionIslands[victim].subSteps))
+                victim = i;
+        }
+        if (victim == NO_BODY)
+            break;
+        --m_motionIslands[victim].subSteps;
+        cost -= m_motionIslands[victim].bodyCount;
+        ++m_subStepStats.clampedIslands;
+    }
+    m_subStepStats.budgetCost = cost;
+}
+
+void PhysicsWorld::SortRowsByIsland()
+{
+    const unsigned int awakeCount = m_bodies.awakeCount;
+
+    // Stable order by (sub-steps, island): islands become contiguous row
+    // ranges and islands with equal sub-step counts end up next to each other.
+    std::vector<unsigned int> islandOrder(m_motionIslands.size());
+    for (unsigned int i = 0; i < islandOrder.size(); ++i)
+    {
+        islandOrder[i] = i;
+    }
+    const std::vector<MotionIsland>& rIslands = m_motionIslands;
+    std::stable_sort(islandOrder.begin(), islandOrder.end(), [&rIslands](unsigned int a, unsigned int b)
+    {
+        return rIslands[a].subSteps < rIslands[b].subSteps;
+    });
+
+    unsigned int firstRow = 0;
+    for (unsigned int i = 0; i < islandOrder.size(); ++i)
+    {
+        m_motionIslands[islandOrder[i]].firstRow = firstRow;
+        firstRow += m_motionIslands[islandOrder[i]].bodyCount;
+    }
+
+    m_rowOrder.resize(awakeCount);
+    std::vector<unsigned int> cursor(m_motionIslands.size());
+    for (unsigned int i = 0; i < m_motionIslands.size(); ++i)
+    {
+        cursor[i] = m_motionIslands[i].firstRow;
+    }
+    for (unsigned int row = 0; row < awakeCount; ++row)
+    {
+        m_rowOrder[cursor[m_islandOfRoot[FindRoot(row)]]++] = row;
+    }
+
+    float* floatColumns[FLOAT_COLUMNS] = { m_bodies.pPosX, m_bodies.pPosY, m_bodies.pPosZ,
+                                           m_bodies.pVelX, m_bodies.pVelY, m_bodies.pVelZ,
+                                           m_bodies.pInvMass, m_bodies.pRadius, m_bodies.pSleepTimer };
+    for (unsigned int i = 0; i < FLOAT_COLUMNS; ++i)
+    {
+        PermuteColumn(floatColumns[i], m_rowOrder, m_scratchColumn);
+    }
+    PermuteColumn(m_bodies.pHandle, m_rowOrder, m_scratchColumn);
+    PermuteColumn(m_bodies.pSleepGroup, m_rowOrder, m_scratchColumn);
+    PermuteColumn(m_bodies.pKind, m_rowOrder, m_scratchColumn);
+
+    for (unsigned int row = 0; row < awakeCount; ++row)
+    {
+        m_rowOfHandle[m_bodies.pHandle[row]] = row;
+    }
+
+    // Keep the island list in row order too.
+    std::vector<MotionIsland> sorted(m_motionIslands.size());
+    for (unsigned int i = 0; i < islandOrder.size(); ++i)
+    {
+        sorted[i] = m_motionIslands[islandOrder[i]];
+    }
+    m_motionIslands.swap(sorted);
+}
+
+BodyArrays PhysicsWorld::GetRowRange(unsigned int firstRow, unsigned int count) const
+{
+    BodyArrays view = m_bodies;
+    view.pPosX += firstRow;
+    view.pPosY += firstRow;
+    view.pPosZ += firstRow;
+    view.pVelX += firstRow;
+    view.pVelY += firstRow;
+    view.pVelZ += firstRow;
+    view.pInvMass += firstRow;
+    view.pRadius += firstRow;
+    view.pSleepTimer += firstRow;
+    view.pHandle += firstRow;
+    view.pSleepGroup += firstRow;
+    view.pKind += firstRow;
+    view.count = count;
+    view.awakeCount = count;
+    return view;
+}
+
+void PhysicsWorld::Step(float dt, WorkerPool& rPool)
+{
+    Clock::time_point start = Clock::now();
+
+    m_stats.contactCount = 0;
+    m_stats.broadphaseMs = 0.0f;
+    m_stats.islandBuildMs = 0.0f;
+    m_stats.solveMs = 0.0f;
+    m_stats.islands.clear();
+    m_stats.colourMs.clear();
+
+    WakeTouchedSleepers(dt);
+    BuildMotionIslands(dt);
+    ChooseSubSteps(dt);
+    SortRowsByIsland();
+
+    m_stats.broadphaseMs += std::chrono::duration<float, std::milli>(Clock::now() - start).count();
+
+    m_subStepStats.motionIslands = (unsigned int)m_motionIslands.size();
+    m_subStepStats.calmIslands = 0;
+    m_subStepStats.maxSubSteps = 0;
+    m_subStepStats.islandSubSteps = 0;
+    m_subStepStats.pipelineRuns = 0;
+
+    // Islands sharing a sub-step count are adjacent rows and do not interact
+    // this tick, so each such group runs through the pipeline as one range.
+    unsigned int island = 0;
+    while (island < m_motionIslands.size())
+    {
+        const unsigned int subSteps = m_motionIslands[island].subSteps;
+        const unsigned int firstRow = m_motionIslands[island].firstRow;
+        unsigned int rowCount = 0;
+        for (; island < m_motionIslands.size() && m_motionIslands[island].subSteps == subSteps; ++island)
+        {
+            rowCount += m_motionIslands[island].bodyCount;
+            m_subStepStats.islandSubSteps += subSteps;
+            if (subSteps == 1)
+                ++m_subStepStats.calmIslands;
+        }
+        m_subStepStats.maxSubSteps = std::max(m_subStepStats.maxSubSteps, subSteps);
+        ++m_subStepStats.pipelineRuns;
+
+        BodyArrays view = GetRowRange(firstRow, rowCount);
+        const float subDt = dt / (float)subSteps;
+        for (unsigned int subStep = 0; subStep < subSteps; ++subStep)
+        {
+            Clock::time_point contactStart = Clock::now();
+            IntegrateVelocities(view, subDt);
+            FindContacts(view);
+            m_stats.broadphaseMs += std::chrono::duration<float, std::milli>(Clock::now() - contactStart).count();
+
+            const unsigned int firstTiming = (unsigned int)m_stats.islands.size();
+            m_solver.Solve(view, m_contacts, subDt, rPool, m_stats);
+            for (unsigned int i = firstTiming; i < m_stats.islands.size(); ++i)
+            {
+                m_stats.islands[i].subStep = subStep;
+                m_stats.islands[i].subStepCount = subSteps;
+            }
+            IntegratePositions(view, subDt);
+        }
+    }
+
+    if (m_sleepingEnabled)
+        UpdateSleeping(dt);
+}
+
+void PhysicsWorld::IntegrateVelocities(BodyArrays& rView, float dt)
+{
+    const float damping = 1.0f / (1.0f + LINEAR_DAMPING * dt);
+    for (unsigned int i = 0; i < rView.awakeCount; ++i)
+    {
+        if (rView.pInvMass[i] == 0.0f)
+            continue;
+        rView.pVelY[i] += GRAVITY * dt;
+        rView.pVelX[i] *= damping;
+        rView.pVelY[i] *= damping;
+        rView.pVelZ[i] *= damping;
+    }
+}
+
+void PhysicsWorld::FindContacts(const BodyArrays& rView)
+{
+    m_contacts.clear();
+
+    // Sweep and prune along x over the view's rows. Ties are broken by row so
+    // the contact order, and therefore the solver result, is fully reproducible.
+    const unsigned int count = rView.awakeCount;
+    m_sweepOrder.resize(count);
+    m_sweepMin.resize(count);
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        m_sweepOrder[i] = i;
+        m_sweepMin[i] = rView.pPosX[i] - rView.pRadius[i];
+    }
+    const std::vector<float>& rMin = m_sweepMin;
+    std::sort(m_sweepOrder.begin(), m_sweepOrder.end(), [&rMin](unsigned int a, unsigned int b)
+    {
+        return rMin[a] < rMin[b] || (rMin[a] == rMin[b] && a < b);
+    });
+
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        const unsigned int a = m_sweepOrder[i];
+        const float maxX = rView.pPosX[a] + rView.pRadius[a];
+        glm::vec3 posA(rView.pPosX[a], rView.pPosY[a], rView.pPosZ[a]);
+
+        for (unsigned int j = i + 1; j < count; ++j)
+        {
+            const unsigned int b = m_sweepOrder[j];
+            if (m_sweepMin[b] > maxX)
+                break;
+
+            glm::vec3 delta = glm::vec3(rView.pPosX[b], rView.pPosY[b], rView.pPosZ[b]) - posA;
+            float radii = rView.pRadius[a] + rView.pRadius[b];
+            float distanceSq = glm::dot(delta, delta);
+            if (distanceSq >= radii * radii)
+                continue;
+
+            float distance = std::sqrt(distanceSq);
+            Contact contact;
+            contact.bodyA = std::min(a, b);
+            contact.bodyB = std::max(a, b);
+            contact.wall = NO_BODY;
+            contact.normal = distance > 1e-6f ? delta / distance : glm::vec3(0.0f, 1.0f, 0.0f);
+            if (contact.bodyA != a)
+                contact.normal = -contact.normal;
+            contact.penetration = radii - distance;
+            contact.normalImpulse = 0.0f;
+            m_contacts.push_back(contact);
+        }
+    }
+
+    for (unsigned int body = 0; body < count; ++body)
+    {
+        if (rView.pInvMass[body] == 0.0f)
+            continue;
+
+        glm::vec3 position(rView.pPosX[body], rView.pPosY[body], rView.pPosZ[body]);
+        for (unsigned int w = 0; w < m_walls.size(); ++w)
+        {
+            const WallPlane& rWall = m_walls[w];
+            // Side walls only stop what is below their top edge.
+            if (rWall.normal.y == 0.0f && position.y > WALL_HEIGHT)
+                continue;
+
+            float separation = glm::dot(rWall.normal, position) - rWall.offset - rView.pRadius[body];
+            if (separation >= 0.0f)
+                continue;
+
+            Contact contact;
+            contact.bodyA = body;
+            contact.bodyB = NO_BODY;
+            contact.wall = w;
+            contact.normal = -rWall.normal;
+            contact.penetration = -separation;
+            contact.normalImpulse = 0.0f;
+            m_contacts.push_back(contact);
+        }
+    }
+}
+
+void PhysicsWorld::IntegratePositions(BodyArrays& rView, float dt)
+{
+    for (unsigned int i = 0; i < rView.awakeCount; ++i)
+    {
+        rView.pPosX[i] += rView.pVelX[i] * dt;
+        rView.pPosY[i] += rView.pVelY[i] * dt;
+        rView.pPosZ[i] += rView.pVelZ[i] * dt;
+    }
+}
+
+void PhysicsWorld::UpdateSleeping(float dt)
+{
+    const unsigned int awakeCount = m_bodies.awakeCount;
+
+    m_fallingAsleep.assign(awakeCount, 0);
+    bool anyFallingAsleep = false;
+
+    // Motion islands are contiguous rows at this point and can only sleep as a whole.
+    for (unsigned int i = 0; i < m_motionIslands.size(); ++i)
+    {
+        const MotionIsland& rIsland = m_motionIslands[i];
+        const unsigned int lastRow = rIsland.firstRow + rIsland.bodyCount;
+        float minTimer = TIME_TO_SLEEP;
+        for (unsigned int row = rIsland.firstRow; row < lastRow; ++row)
+        {
+            if (Speed(m_bodies, row) < SLEEP_SPEED)
+                m_bodies.pSleepTimer[row] += dt;
+            else
+                m_bodies.pSleepTimer[row] = 0.0f;
+            minTimer = std::min(minTimer, m_bodies.pSleepTimer[row]);
+        }
+        if (minTimer < TIME_TO_SLEEP)
+            continue;
+
+        const unsigned int group = m_bodies.pHandle[rIsland.firstRow];
+        for (unsigned int row = rIsland.firstRow; row < lastRow; ++row)
+        {
+            m_fallingAsleep[row] = 1;
+            m_bodies.pSleepGroup[row] = group;
+            m_bodies.pVelX[row] = 0.0f;
+            m_bodies.pVelY[row] = 0.0f;
+            m_bodies.pVelZ[row] = 0.0f;
+        }
+        anyFallingAsleep = true;
+    }
+    if (!anyFallingAsleep)
+        return;
+
+    // Walking down keeps the rows above the cursor settled: anything swapped in
+    // from the end of the awake range has already been visited.
+    for (unsigned int row = awakeCount; row-- > 0;)
+    {
+        if (!m_fallingAsleep[row])
+            continue;
+        unsigned int last = m_bodies.awakeCount - 1;
+        std::swap(m_fallingAsleep[row], m_fallingAsleep[last]);
+        SwapRows(row, last);
+        --m_bodies.awakeCount;
+    }
+    m_sleepersDirty = true;
+}
@@ -0,0 +1,183 @@
+#pragma once
+
+#include "ContactSolver.h"
+#include "PhysicsTypes.h"
+
+#include <cstddef>
+#include <glm/glm.hpp>
+#include <vector>
+
+class StateHash;
+class StateReader;
+class StateWriter;
+class WorkerPool;
+
+// Minimal collision world for the pitch: the ball and the players are spheres,
+// the walls and the ground are static planes.
+// Bodies live in one contiguous structure-of-arrays block of fixed capacity.
+// Islands whose bodies stay slow for long enough fall asleep and are moved
+// behind the awake range, so integration, contact search and solving only walk
+// awake rows. Bodies are addressed by stable handles because rows move.
+//
+// Each tick the awake bodies are grouped into motion islands (bodies that may
+// touch during the tick) and every island picks its own number of sub-steps
+// from its fastest body relative to its smallest shape and from the mass ratio
+// of its contacts. Awake rows are sorted so islands sharing a sub-step count
+// are contiguous and run through the pipeline together.
+class PhysicsWorld
+{
+public:
+    enum SubStepMode
+    {
+        SubStepPerIsland,
+        SubStepWholeWorld,   // every island takes the sub-step count of the worst one
+        SubStepFixed         // always one step per tick
+    };
+
+    explicit PhysicsWorld(unsigned int capacity);
+    ~PhysicsWorld();
+
+    unsigned int AddBody(BodyKind kind, const glm::vec3& rPosition, float radius, float mass);
+    void AddWall(const glm::vec3& rNormal, float offset);
+
+    // Adds the ground plane and the four side walls of a pitch centred on the origin.
+    void AddPitchWalls(float halfLength, float halfWidth);
+
+    // Wakes the body's island before applying the impulse.
+    void ApplyImpulse(unsigned int body, const glm::vec3& rImpulse);
+    void WakeBody(unsigned int body);
+    // Moves a body without integrating, e.g. to an authoritative state. Wakes it.
+    void SetBodyState(unsigned int body, const glm::vec3& rPosition, const glm::vec3& rVelocity);
+    void Step(float dt, WorkerPool& rPool);
+
+    glm::vec3 GetPosition(unsigned int body) const;
+    glm::vec3 GetVelocity(unsigned int body) const;
+    float GetRadius(unsigned int body) const;
+    BodyKind GetKind(unsigned int body) const;
+    bool IsAwake(unsigned int body) const;
+
+    void SetSleepingEnabled(bool enabled);
+
+    // Adds every body column, the handle map and the row counts. Walls and
+    // settings are fixed after setup and are not included.
+    void HashState(StateHash& rHash) const;
+
+    // Body rows and the handle map, the same state HashState() covers.
+    // LoadState() expects the walls and settings of the world that saved it.
+    void SaveState(StateWriter& rOut) const;
+    void LoadState(StateReader& rIn);
+    size_t GetMaxStateSize() const;
+
+    void SetSubStepMode(SubStepMode mode)
+    {
+        m_subStepMode = mode;
+    }
+
+    void SetMaxSubSteps(unsigned int maxSubSteps)
+    {
+        m_maxSubSteps = maxSubSteps == 0 ? 1 : maxSubSteps;
+    }
+
+    // Upper bound on bodies x sub-steps per tick. When exceeded, the islands
+    // asking for the most sub-steps are cut back first; none goes below one.
+    void SetSubStepBudget(unsigned int bodySubSteps)
+    {
+        m_subStepBudget = bodySubSteps;
+    }
+
+    unsigned int GetBodyCount() const
+    {
+        return m_bodies.count;
+    }
+
+    unsigned int GetAwakeCount() const
+    {
+        return m_bodies.awakeCount;
+    }
+
+    unsigned int GetSleepingCount() const
+    {
+        return m_bodies.count - m_bodies.awakeCount;
+    }
+
+    const SolverStats& GetSolverStats() const
+    {
+        return m_stats;
+    }
+
+    const SubStepStats& GetSubStepStats() const
+    {
+        return m_subStepStats;
+    }
+
+    ContactSolver& GetSolver()
+    {
+        return m_solver;
+    }
+
+private:
+    PhysicsWorld(const PhysicsWorld&);
+    PhysicsWorld& operator=(const PhysicsWorld&);
+
+    struct MotionIsland
+    {
+        unsigned int firstRow;
+        unsigned int bodyCount;
+        unsigned int subSteps;
+        float maxSpeed;
+        float minRadius;
+        float maxMassRatio;
+    };
+
+    glm::vec3 GetRowPosition(unsigned int row) const;
+    void SwapRows(unsigned int a, unsigned int b);
+    void WakeGroup(unsigned int group);
+    void WakeTouchedSleepers(float dt);
+
+    unsigned int FindRoot(unsigned int row);
+    void BuildMotionIslands(float dt);
+    void ChooseSubSteps(float dt);
+    void SortRowsByIsland();
+    BodyArrays GetRowRange(unsigned int firstRow, unsigned int count) const;
+
+    void IntegrateVelocities(BodyArrays& rView, float dt);
+    void FindContacts(const BodyArrays& rView);
+    void IntegratePositions(BodyArrays& rView, float dt);
+    void UpdateSleeping(float dt);
+
+    unsigned int m_capacity;
+    unsigned char* m_pStorage;
+    unsigned char* m_pColumns;
+    unsigned int m_columnBytes;
+    BodyArrays m_bodies;
+    std::vector<unsigned int> m_rowOfHandle;
+    bool m_sleepingEnabled;
+
+    std::vector<WallPlane> m_walls;
+    std::vector<Contact> m_contacts;
+    std::vector<unsigned int> m_sweepOrder;
+    std::vector<float> m_sweepMin;
+    std::vector<unsigned int> m_groupsToWake;
+    std::vector<unsigned char> m_fallingAsleep;
+
+    SubStepMode m_subStepMode;
+    unsigned int m_maxSubSteps;
+    unsigned int m_subStepBudget;
+    std::vector<unsigned int> m_parent;
+    std::vector<float> m_bodyMassRatio;
+    std::vector<float> m_islandReach;
+    std::vector<unsigned int> m_islandOfRoot;
+    std::vector<MotionIsland> m_motionIslands;
+    std::vector<unsigned int> m_rowOrder;
+    std::vector<unsigned char> m_scratchColumn;
+
+    // Sleeping rows sorted by their minimum x, rebuilt whenever rows move.
+    std::vector<unsigned int> m_sleeperOrder;
+    std::vector<float> m_sleeperMin;
+    float m_sleeperMaxRadius;
+    bool m_sleepersDirty;
+
+    ContactSolver m_solver;
+    SolverStats m_stats;
+    SubStepStats m_subStepStats;
+};
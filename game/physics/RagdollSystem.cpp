@@ -0,0 +1,352 @@
+#include "RagdollSystem.h"
+#include "../core/Arena.h"
+#include "../core/Float4.h"
+#include "../core/StateHash.h"
+#include "../core/StateStream.h"
+#include "../core/WorkerPool.h"
+
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+namespace
+{
+    const float GRAVITY = -9.81f;
+    const float VELOCITY_DAMPING = 0.99f;
+    const float GROUND_FRICTION = 0.5f;
+    const float PARTICLE_RADIUS = 0.02f;
+    const float MIN_LENGTH = 1e-5f;
+
+    // Standing pose of a 1 m tall player, feet on the origin.
+    const glm::vec3 POSE[RagdollSystem::PARTICLE_COUNT] = {
+        glm::vec3( 0.00f, 0.50f, 0.0f),   // Pelvis
+        glm::vec3( 0.00f, 0.77f, 0.0f),   // Chest
+        glm::vec3( 0.00f, 0.97f, 0.0f),   // Head
+        glm::vec3(-0.16f, 0.62f, 0.0f),   // LeftElbow
+        glm::vec3(-0.18f, 0.48f, 0.0f),   // LeftHand
+        glm::vec3( 0.16f, 0.62f, 0.0f),   // RightElbow
+        glm::vec3( 0.18f, 0.48f, 0.0f),   // RightHand
+        glm::vec3(-0.08f, 0.26f, 0.0f),   // LeftKnee
+        glm::vec3(-0.08f, 0.02f, 0.0f),   // LeftFoot
+        glm::vec3( 0.08f, 0.26f, 0.0f),   // RightKnee
+        glm::vec3( 0.08f, 0.02f, 0.0f)    // RightFoot
+    };
+
+    // Lengths are given as a fraction of the distance between the two
+    // particles in the standing pose. Bones come first and are rigid.
+    struct ConstraintDef
+    {
+        unsigned int a;
+        unsigned int b;
+        float minScale;
+        float maxScale;
+    };
+
+    const ConstraintDef CONSTRAINTS[RagdollSystem::CONSTRAINT_COUNT] = {
+        { RagdollSystem::Pelvis,     RagdollSystem::Chest,      1.0f,  1.0f },
+        { RagdollSystem::Chest,      RagdollSystem::Head,       1.0f,  1.0f },
+        { RagdollSystem::Chest,      RagdollSystem::LeftElbow,  1.0f,  1.0f },
+        { RagdollSystem::LeftElbow,  RagdollSystem::LeftHand,   1.0f,  1.0f },
+        { RagdollSystem::Chest,      RagdollSystem::RightElbow, 1.0f,  1.0f },
+        { RagdollSystem::RightElbow, RagdollSystem::RightHand,  1.0f,  1.0f },
+        { RagdollSystem::Pelvis,     RagdollSystem::LeftKnee,   1.0f,  1.0f },
+        { RagdollSystem::LeftKnee,   RagdollSystem::LeftFoot,   1.0f,  1.0f },
+        { RagdollSystem::Pelvis,     RagdollSystem::RightKnee,  1.0f,  1.0f },
+        { RagdollSystem::RightKnee,  RagdollSystem::RightFoot,  1.0f,  1.0f },
+        // joint limits
+        { RagdollSystem::Pelvis,     RagdollSystem::Head,       0.75f, 1.0f },   // spine bend
+        { RagdollSystem::Chest,      RagdollSystem::LeftHand,   0.35f, 1.1f },   // left elbow
+        { RagdollSystem::Chest,      RagdollSystem::RightHand,  0.35f, 1.1f },   // right elbow
+        { RagdollSystem::Pelvis,     RagdollSystem::LeftFoot,   0.45f, 1.0f },   // left knee
+        { RagdollSystem::Pelvis,     RagdollSystem::RightFoot,  0.45f, 1.0f },   // right knee
+        { RagdollSystem::LeftKnee,   RagdollSystem::RightKnee,  0.5f,  3.0f }    // hip spread
+    };
+}
+
+RagdollSystem::RagdollSystem(unsigned int capacity)
+    : m_capacity(capacity),
+      m_blockCount((capacity + 3) / 4),
+      m_pStorage(nullptr),
+      m_pBlocks(nullptr),
+      m_activeCount(0),
+      m_iterations(6),
+      m_halfLength(1000.0f),
+      m_halfWidth(1000.0f),
+      m_lastStepMs(0.0f)
+{
+    // Blocks hold __m128 sized rows, so the array needs aligned storage.
+    const size_t bytes = sizeof(Block) * m_blockCount;
+    m_pStorage = static_cast<unsigned char*>(AllocateAligned(bytes));
+    m_pBlocks = reinterpret_cast<Block*>(m_pStorage);
+    std::memset(m_pBlocks, 0, bytes);
+
+    m_slotOfRagdoll.assign(capacity, NO_RAGDOLL);
+    m_ragdollOfSlot.assign(capacity, NO_RAGDOLL);
+    for (unsigned int i = capacity; i-- > 0;)
+    {
+        m_freeRagdolls.push_back(i);
+    }
+}
+
+RagdollSystem::~RagdollSystem()
+{
+    FreeAligned(m_pStorage);
+}
+
+unsigned int RagdollSystem::Spawn(const glm::vec3& rFeet, const glm::vec3& rVelocity, float height)
+{
+    if (m_freeRagdolls.empty())
+        return NO_RAGDOLL;
+
+    unsigned int ragdoll = m_freeRagdolls.back();
+    m_freeRagdolls.pop_back();
+
+    const unsigned int slot = m_activeCount++;
+    m_slotOfRagdoll[ragdoll] = slot;
+    m_ragdollOfSlot[slot] = ragdoll;
+
+    Block& rBlock = m_pBlocks[slot / 4];
+    const unsigned int lane = slot % 4;
+
+    // A block coming back into use is cleared, so the unused lanes the kernel
+    // steps along with it never carry leftovers of older ragdolls. That keeps
+    // the active blocks a pure function of the match, which SaveState() and
+    // HashState() rely on.
+    if (lane == 0)
+        std::memset(&rBlock, 0, sizeof(Block));
+
+    // Verlet keeps velocity implicitly; one 60 Hz step of history is enough.
+    const glm::vec3 travel = rVelocity * (1.0f / 60.0f);
+    for (unsigned int p = 0; p < PARTICLE_COUNT; ++p)
+    {
+        glm::vec3 position = rFeet + POSE[p] * height;
+        rBlock.posX[p][lane] = position.x;
+        rBlock.posY[p][lane] = position.y;
+        rBlock.posZ[p][lane] = position.z;
+        rBlock.prevX[p][lane] = position.x - travel.x;
+        rBlock.prevY[p][lane] = position.y - travel.y;
+        rBlock.prevZ[p][lane] = position.z - travel.z;
+    }
+    for (unsigned int c = 0; c < CONSTRAINT_COUNT; ++c)
+    {
+        float length = glm::length(POSE[CONSTRAINTS[c].b] - POSE[CONSTRAINTS[c].a]) * height;
+        rBlock.minLength[c][lane] = length * CONSTRAINTS[c].minScale;
+        rBlock.maxLength[c][lane] = length * CONSTRAINTS[c].maxScale;
+    }
+    return ragdoll;
+}
+
+void RagdollSystem::Despawn(unsigned int ragdoll)
+{
+    unsigned int slot = m_slotOfRagdoll[ragdoll];
+    assert(slot != NO_RAGDOLL);
+
+    // Keep the active slots packed: the last ragdoll moves into the hole.
+    unsigned int last = --m_activeCount;
+    if (slot != last)
+    {
+        CopySlot(last, slot);
+        unsigned int moved = m_ragdollOfSlot[last];
+        m_ragdollOfSlot[slot] = moved;
+        m_slotOfRagdoll[moved] = slot;
+    }
+    m_ragdollOfSlot[last] = NO_RAGDOLL;
+    m_slotOfRagdoll[ragdoll] = NO_RAGDOLL;
+    m_freeRagdolls.push_back(ragdoll);
+}
+
+void RagdollSystem::CopySlot(unsigned int from, unsigned int to)
+{
+    const Block& rFrom = m_pBlocks[from / 4];
+    Block& rTo = m_pBlocks[to / 4];
+    const unsigned int fromLane = from % 4;
+    const unsigned int toLane = to % 4;
+
+    for (unsigned int p = 0; p < PARTICLE_COUNT; ++p)
+    {
+        rTo.posX[p][toLane] = rFrom.posX[p][fromLane];
+        rTo.posY[p][toLane] = rFrom.posY[p][fromLane];
+        rTo.posZ[p][toLane] = rFrom.posZ[p][fromLane];
+        rTo.prevX[p][toLane] = rFrom.prevX[p][fromLane];
+        rTo.prevY[p][toLane] = rFrom.prevY[p][fromLane];
+        rTo.prevZ[p][toLane] = rFrom.prevZ[p][fromLane];
+    }
+    for (unsigned int c = 0; c < CONSTRAINT_COUNT; ++c)
+    {
+        rTo.minLength[c][toLane] = rFrom.minLength[c][fromLane];
+        rTo.maxLength[c][toLane] = rFrom.maxLength[c][fromLane];
+    }
+}
+
+void RagdollSystem::SetPitchBounds(float halfLength, float halfWidth)
+{
+    m_halfLength = halfLength;
+    m_halfWidth = halfWidth;
+}
+
+void RagdollSystem::Step(float dt, WorkerPool& rPool)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    const unsigned int activeBlocks = (m_activeCount + 3) / 4;
+    rPool.ParallelFor(activeBlocks, [this, dt](unsigned int begin, unsigned int end, unsigned int)
+    {
+        for (unsigned int b = begin; b < end; ++b)
+        {
+            StepBlock(m_pBlocks[b], dt);
+        }
+    });
+
+    m_lastStepMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void RagdollSystem::StepBlock(Block& rBlock, float dt) const
+{
+    const Float4 damping(VELOCITY_DAMPING);
+    const Float4 gravity(GRAVITY * dt * dt);
+    const Float4 ground(PARTICLE_RADIUS);
+    const Float4 friction(GROUND_FRICTION);
+    const Float4 minX(-m_halfLength), maxX(m_halfLength);
+    const Float4 minZ(-m_halfWidth), maxZ(m_halfWidth);
+    const Float4 half(0.5f);
+    const Float4 minLength(MIN_LENGTH);
+
+    // Verlet integration: x' = x + (x - prev) * damping + g * dt^2
+    for (unsigned int p = 0; p < PARTICLE_COUNT; ++p)
+    {
+        Float4 x = Float4::Load(rBlock.posX[p]);
+        Float4 y = Float4::Load(rBlock.posY[p]);
+        Float4 z = Float4::Load(rBlock.posZ[p]);
+        Float4 nextX = x + (x - Float4::Load(rBlock.prevX[p])) * damping;
+        Float4 nextY = y + (y - Float4::Load(rBlock.prevY[p])) * damping + gravity;
+        Float4 nextZ = z + (z - Float4::Load(rBlock.prevZ[p])) * damping;
+        x.Store(rBlock.prevX[p]);
+        y.Store(rBlock.prevY[p]);
+        z.Store(rBlock.prevZ[p]);
+        nextX.Store(rBlock.posX[p]);
+        nextY.Store(rBlock.posY[p]);
+        nextZ.Store(rBlock.posZ[p]);
+    }
+
+    for (unsigned int iteration = 0; iteration < m_iterations; ++iteration)
+    {
+        for (unsigned int c = 0; c < CONSTRAINT_COUNT; ++c)
+        {
+            const unsigned int a = CONSTRAINTS[c].a;
+            const unsigned int b = CONSTRAINTS[c].b;
+
+            Float4 ax = Float4::Load(rBlock.posX[a]), ay = Float4::Load(rBlock.posY[a]), az = Float4::Load(rBlock.posZ[a]);
+            Float4 bx = Float4::Load(rBlock.posX[b]), by = Float4::Load(rBlock.posY[b]), bz = Float4::Load(rBlock.posZ[b]);
+            Float4 dx = bx - ax, dy = by - ay, dz = bz - az;
+            Float4 length = Max(Sqrt(dx * dx + dy * dy + dz * dz), minLength);
+            Float4 target = Min(Max(length, Float4::Load(rBlock.minLength[c])), Float4::Load(rBlock.maxLength[c]));
+
+            // Equal particle masses: each end moves half of the error.
+            Float4 correction = (length - target) / length * half;
+            (ax + dx * correction).Store(rBlock.posX[a]);
+            (ay + dy * correction).Store(rBlock.posY[a]);
+            (az + dz * correction).Store(rBlock.posZ[a]);
+            (bx - dx * correction).Store(rBlock.posX[b]);
+            (by - dy * correction).Store(rBlock.posY[b]);
+            (bz - dz * correction).Store(rBlock.posZ[b]);
+        }
+
+        for (unsigned int p = 0; p < PARTICLE_COUNT; ++p)
+        {
+            Float4 x = Float4::Load(rBlock.posX[p]);
+            Float4 y = Float4::Load(rBlock.posY[p]);
+            Float4 z = Float4::Load(rBlock.posZ[p]);
+
+            // Particles pushed out of the ground lose part of their sliding velocity.
+            Float4 onGround = Less(y, ground);
+            Float4 prevX = Float4::Load(rBlock.prevX[p]);
+            Float4 prevZ = Float4::Load(rBlock.prevZ[p]);
+            Select(onGround, x - (x - prevX) * friction, prevX).Store(rBlock.prevX[p]);
+            Select(onGround, z - (z - prevZ) * friction, prevZ).Store(rBlock.prevZ[p]);
+
+            Max(y, ground).Store(rBlock.posY[p]);
+            Min(Max(x, minX), maxX).Store(rBlock.posX[p]);
+            Min(Max(z, minZ), maxZ).Store(rBlock.posZ[p]);
+        }
+    }
+}
+
+void RagdollSystem::WriteBoneMatrices(float* pOut) const
+{
+    for (unsigned int slot = 0; slot < m_activeCount; ++slot)
+    {
+        const Block& rBlock = m_pBlocks[slot / 4];
+        const unsigned int lane = slot % 4;
+
+        for (unsigned int bone = 0; bone < BONE_COUNT; ++bone)
+        {
+            const unsigned int a = CONSTRAINTS[bone].a;
+            const unsigned int b = CONSTRAINTS[bone].b;
+            glm::vec3 origin(rBlock.posX[a][lane], rBlock.posY[a][lane], rBlock.posZ[a][lane]);
+            glm::vec3 tip(rBlock.posX[b][lane], rBlock.posY[b][lane], rBlock.posZ[b][lane]);
+
+            glm::vec3 axisY = tip - origin;
+            float length = glm::length(axisY);
+            axisY = length > MIN_LENGTH ? axisY / length : glm::vec3(0.0f, 1.0f, 0.0f);
+            glm::vec3 reference = std::fabs(axisY.z) < 0.9f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(1.0f, 0.0f, 0.0f);
+            glm::vec3 axisX = glm::normalize(glm::cross(axisY, reference));
+            glm::vec3 axisZ = glm::cross(axisX, axisY);
+
+            float* pMatrix = pOut + (slot * BONE_COUNT + bone) * FLOATS_PER_BONE;
+            pMatrix[0]  = axisX.x;  pMatrix[1]  = axisX.y;  pMatrix[2]  = axisX.z;  pMatrix[3]  = 0.0f;
+            pMatrix[4]  = axisY.x;  pMatrix[5]  = axisY.y;  pMatrix[6]  = axisY.z;  pMatrix[7]  = 0.0f;
+            pMatrix[8]  = axisZ.x;  pMatrix[9]  = axisZ.y;  pMatrix[10] = axisZ.z;  pMatrix[11] = 0.0f;
+            pMatrix[12] = origin.x; pMatrix[13] = origin.y; pMatrix[14] = origin.z; pMatrix[15] = 1.0f;
+        }
+    }
+}
+
+void RagdollSystem::HashState(StateHash& rHash) const
+{
+    rHash.Add(m_activeCount);
+    rHash.Add(m_pBlocks, sizeof(Block) * ((m_activeCount + 3) / 4));
+    rHash.Add(m_slotOfRagdoll);
+    rHash.Add(m_ragdollOfSlot);
+    rHash.Add(m_freeRagdolls);
+}
+
+// Only the active blocks are saved; a block beyond them is always rewritten
+// by Spawn() before it is read.
+void RagdollSystem::SaveState(StateWriter& rOut) const
+{
+    rOut.Write(m_activeCount);
+    rOut.Write(m_pBlocks, sizeof(Block) * ((m_activeCount + 3) / 4));
+    rOut.Write(m_slotOfRagdoll);
+    rOut.Write(m_ragdollOfSlot);
+    rOut.Write(m_freeRagdolls);
+}
+
+void RagdollSystem::LoadState(StateReader& rIn)
+{
+    rIn.Read(m_activeCount);
+    assert(m_activeCount <= m_capacity);
+    rIn.Read(m_pBlocks, sizeof(Block) * ((m_activeCount + 3) / 4));
+    rIn.Read(m_slotOfRagdoll);
+    rIn.Read(m_ragdollOfSlot);
+    rIn.Read(m_freeRagdolls);
+}
+
+size_t RagdollSystem::GetMaxStateSize() const
+{
+    return sizeof(unsigned int) + sizeof(Block) * m_blockCount + 3 * sizeof(unsigned int) * (m_capacity + 1);
+}
+
+float RagdollSystem::GetBoneLength(unsigned int slot, unsigned int bone) const
+{
+    return m_pBlocks[slot / 4].minLength[bone][slot % 4];
+}
+
+glm::vec3 RagdollSystem::GetParticle(unsigned int ragdoll, Particle particle) const
+{
+    unsigned int slot = m_slotOfRagdoll[ragdoll];
+    const Block& rBlock = m_pBlocks[slot / 4];
+    const unsigned int lane = slot % 4;
+    return glm::vec3(rBlock.posX[particle][lane], rBlock.posY[particle][lane], rBlock.posZ[particle][lane]);
+}
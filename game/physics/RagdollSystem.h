@@ -0,0 +1,118 @@
+#pragma once
+
+#include <cstddef>
+#include <glm/glm.hpp>
+#include <vector>
+
+class StateHash;
+class StateReader;
+class StateWriter;
+class WorkerPool;
+
+// Position-based Verlet ragdolls for knocked-out players.
+// Every ragdoll shares one skeleton, so ragdolls are stored in blocks of four:
+// each particle coordinate and constraint length is a four-lane array, and a
+// single SIMD kernel integrates and relaxes four ragdolls at once. Bones are
+// rigid distance constraints; joint limits are min/max distance constraints
+// between the two ends of a joint. Ragdolls stay packed in the lowest slots so
+// only ceil(count / 4) blocks are ever touched.
+class RagdollSystem
+{
+public:
+    enum Particle
+    {
+        Pelvis,
+        Chest,
+        Head,
+        LeftElbow,
+        LeftHand,
+        RightElbow,
+        RightHand,
+        LeftKnee,
+        LeftFoot,
+        RightKnee,
+        RightFoot,
+        PARTICLE_COUNT
+    };
+
+    // The first BONE_COUNT constraints are the bones that get a matrix.
+    static const unsigned int BONE_COUNT = 10;
+    static const unsigned int CONSTRAINT_COUNT = 16;
+    static const unsigned int FLOATS_PER_BONE = 16;
+
+    explicit RagdollSystem(unsigned int capacity);
+    ~RagdollSystem();
+
+    // Starts a ragdoll standing with its feet at rFeet, scaled to the given
+    // height and moving with rVelocity. Returns NO_RAGDOLL when full.
+    unsigned int Spawn(const glm::vec3& rFeet, const glm::vec3& rVelocity, float height);
+    void Despawn(unsigned int ragdoll);
+
+    // Particles are kept inside |x| <= halfLength, |z| <= halfWidth and above the ground.
+    void SetPitchBounds(float halfLength, float halfWidth);
+    void SetIterations(unsigned int iterations)
+    {
+        m_iterations = iterations;
+    }
+
+    void Step(float dt, WorkerPool& rPool);
+
+    // Writes GetActiveCount() * BONE_COUNT column-major 4x4 matrices in slot
+    // order, ready for glBufferSubData into a uniform or texture buffer. Each
+    // matrix is rigid: origin at the bone's parent joint, +Y along the bone.
+    void WriteBoneMatrices(float* pOut) const;
+
+    // Adds the particle blocks and the slot bookkeeping.
+    void HashState(StateHash& rHash) const;
+    void SaveState(StateWriter& rOut) const;
+    void LoadState(StateReader& rIn);
+    size_t GetMaxStateSize() const;
+
+    float GetBoneLength(unsigned int slot, unsigned int bone) const;
+    glm::vec3 GetParticle(unsigned int ragdoll, Particle particle) const;
+
+    unsigned int GetActiveCount() const
+    {
+        return m_activeCount;
+    }
+
+    float GetLastStepMs() const
+    {
+        return m_lastStepMs;
+    }
+
+    static const unsigned int NO_RAGDOLL = 0xFFFFFFFFu;
+
+private:
+    RagdollSystem(const RagdollSystem&);
+    RagdollSystem& operator=(const RagdollSystem&);
+
+    struct Block
+    {
+        float posX[PARTICLE_COUNT][4];
+        float posY[PARTICLE_COUNT][4];
+        float posZ[PARTICLE_COUNT][4];
+        float prevX[PARTICLE_COUNT][4];
+        float prevY[PARTICLE_COUNT][4];
+        float prevZ[PARTICLE_COUNT][4];
+        float minLength[CONSTRAINT_COUNT][4];
+        float maxLength[CONSTRAINT_COUNT][4];
+    };
+
+    void StepBlock(Block& rBlock, float dt) const;
+    void CopySlot(unsigned int from, unsigned int to);
+
+    unsigned int m_capacity;
+    unsigned int m_blockCount;
+    unsigned char* m_pStorage;
+    Block* m_pBlocks;
+    unsigned int m_activeCount;
+    unsigned int m_iterations;
+    float m_halfLength;
+    float m_halfWidth;
+    float m_lastStepMs;
+
+    std::vector<unsigned int> m_slotOfRagdoll;
+    std::vector<unsigned int> m_ragdollOfSlot;
+    std::vector<unsigned int> m_freeRagdolls;
+};
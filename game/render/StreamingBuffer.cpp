@@ -0,0 +1,56 @@
+#include "StreamingBuffer.h"
+
+StreamingBuffer::StreamingBuffer(GLenum target, size_t regionBytes)
+    : m_target(target),
+      m_regionBytes(regionBytes),
+      m_buffer(0),
+      m_region(REGION_COUNT - 1)
+{
+    for (unsigned int i = 0; i < REGION_COUNT; ++i)
+        m_fences[i] = 0;
+
+    glGenBuffers(1, &m_buffer);
+    glBindBuffer(m_target, m_buffer);
+    glBufferData(m_target, m_regionBytes * REGION_COUNT, NULL, GL_STREAM_DRAW);
+}
+
+StreamingBuffer::~StreamingBuffer()
+{
+    for (unsigned int i = 0; i < REGION_COUNT; ++i)
+    {
+        if (m_fences[i])
+            glDeleteSync(m_fences[i]);
+    }
+    glDeleteBuffers(1, &m_buffer);
+}
+
+void* StreamingBuffer::Map()
+{
+    m_region = (m_region + 1) % REGION_COUNT;
+
+    GLsync fence = m_fences[m_region];
+    if (fence)
+    {
+        // Normally signalled long ago: the region was last drawn REGION_COUNT frames back.
+        GLenum result = glClientWaitSync(fence, 0, 0);
+        while (result != GL_ALREADY_SIGNALED && result != GL_CONDITION_SATISFIED && result != GL_WAIT_FAILED)
+            result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+        glDeleteSync(fence);
+        m_fences[m_region] = 0;
+    }
+
+    return glMapBufferRange(m_target, GetOffset(), m_regionBytes,
+                            GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+}
+
+void StreamingBuffer::Unmap()
+{
+    glUnmapBuffer(m_target);
+}
+
+void StreamingBuffer::Fence()
+{
+    if (m_fences[m_region])
+        glDeleteSync(m_fences[m_region]);
+    m_fences[m_region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
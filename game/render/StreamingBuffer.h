@@ -0,0 +1,48 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <cstddef>
+
+// One GL buffer allocated once and split into a ring of regions, refilled
+// through glMapBufferRange instead of re-specifying storage with glBufferData
+// every frame. Each region is fenced after the frame that drew from it, and
+// mapping waits on that fence, so the CPU never writes memory the GPU is
+// still reading and the driver never has to orphan or copy the buffer.
+class StreamingBuffer
+{
+public:
+    static const unsigned int REGION_COUNT = 3;
+
+    StreamingBuffer(GLenum target, size_t regionBytes);
+    ~StreamingBuffer();
+
+    GLuint GetBuffer() const
+    {
+        return m_buffer;
+    }
+
+    // Advances to the next region and maps it for writing. The buffer must be
+    // bound to the target given at construction.
+    void* Map();
+    void Unmap();
+
+    // Byte offset of the region filled by the last Map()/Unmap() pair, which
+    // stays valid for drawing until the next Map().
+    size_t GetOffset() const
+    {
+        return m_region * m_regionBytes;
+    }
+
+    // Call after the last draw that reads the current region this frame.
+    void Fence();
+
+private:
+    StreamingBuffer(const StreamingBuffer&);
+    StreamingBuffer& operator=(const StreamingBuffer&);
+
+    GLenum m_target;
+    size_t m_regionBytes;
+    GLuint m_buffer;
+    unsigned int m_region;
+    GLsync m_fences[REGION_COUNT];
+};
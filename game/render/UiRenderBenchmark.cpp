@@ -0,0 +1,156 @@
+#include "UiRenderBenchmark.h"
+#include "imgui/imgui.h"
+#include "imgui/imgui_impl_glfw_gl3.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+namespace
+{
+    const char* const MODE_NAMES[UiRenderBenchmark::MODE_COUNT] = {
+        "Reference (per list, state backup)",
+        "Batched (one upload, persistent VAO)",
+        "Batched + declared host state"
+    };
+
+    const unsigned int COLUMNS = 20;
+    const float WINDOW_WIDTH = 150.0f;
+    const float WINDOW_HEIGHT = 110.0f;
+}
+
+UiRenderBenchmark::UiRenderBenchmark()
+    : m_running(false),
+      m_mode(MODE_REFERENCE),
+      m_selectedMode(MODE_BATCHED_HOST_STATE),
+      m_frame(0)
+{
+    for (unsigned int i = 0; i < WINDOW_COUNT; ++i)
+    {
+        m_sliders[i] = (float)(i % 10) / 10.0f;
+        m_checks[i] = (i % 2) == 0;
+    }
+    for (unsigned int mode = 0; mode < MODE_COUNT; ++mode)
+        m_results[mode] = Result();
+}
+
+void UiRenderBenchmark::Start()
+{
+    m_running = true;
+    m_mode = MODE_REFERENCE;
+    m_frame = 0;
+    for (unsigned int mode = 0; mode < MODE_COUNT; ++mode)
+        m_results[mode] = Result();
+}
+
+UiRenderBenchmark::Mode UiRenderBenchmark::GetMode() const
+{
+    return (Mode)(m_running ? m_mode : m_selectedMode);
+}
+
+void UiRenderBenchmark::ShowStressWindows()
+{
+    if (!m_running)
+        return;
+
+    // windows overlap in a grid, each with its own draw list
+    char title[32];
+    for (unsigned int i = 0; i < WINDOW_COUNT; ++i)
+    {
+        const float x = 10.0f + (i % COLUMNS) * WINDOW_WIDTH * 0.33f;
+        const float y = 10.0f + (i / COLUMNS) * WINDOW_HEIGHT * 0.5f;
+        std::snprintf(title, sizeof(title), "Stress %u", i);
+        ImGui::SetNextWindowPos(ImVec2(x, y), ImGuiCond_Always);
+        ImGui::SetNextWindowSize(ImVec2(WINDOW_WIDTH, WINDOW_HEIGHT), ImGuiCond_Always);
+        ImGui::Begin(title, 0, ImGuiWindowFlags_NoFocusOnAppearing | ImGuiWindowFlags_NoSavedSettings);
+        ImGui::Text("Frame %u", m_frame);
+        ImGui::SliderFloat(IM_HASHED("value"), &m_sliders[i], 0.0f, 1.0f);
+        ImGui::Checkbox(IM_HASHED("enabled"), &m_checks[i]);
+        ImGui::SameLine();
+        ImGui::Button(IM_HASHED("apply"));
+        ImGui::ProgressBar(0.5f + 0.5f * std::sin(m_frame * 0.05f + i), ImVec2(-1.0f, 0.0f));
+        ImGui::End();
+    }
+}
+
+void UiRenderBenchmark::AddFrame(double renderMs)
+{
+    if (!m_running)
+        return;
+
+    ++m_frame;
+    if (m_frame <= WARMUP_FRAMES)
+        return;
+
+    Result& rResult = m_results[m_mode];
+    rResult.totalMs += renderMs;
+    rResult.maxMs = std::max(rResult.maxMs, renderMs);
+    ++rResult.frames;
+
+    ImGui_ImplGlfwGL3_RenderStats stats;
+    ImGui_ImplGlfwGL3_GetRenderStats(&stats);
+    rResult.drawLists = stats.DrawLists;
+    rResult.drawCalls = stats.DrawCalls;
+    rResult.bufferUploads = stats.BufferUploads;
+    rResult.uploadBytes = stats.UploadBytes;
+    rResult.stateQueries = stats.StateQueries;
+    rResult.stateChanges = stats.StateChanges;
+
+    if (rResult.frames >= FRAMES_PER_MODE)
+    {
+        m_frame = 0;
+        if (++m_mode == MODE_COUNT)
+            m_running = false;
+    }
+}
+
+void UiRenderBenchmark::ShowResultsWindow()
+{
+    ImGui::Begin("UI render benchmark");
+    if (m_running)
+    {
+        ImGui::Text("Measuring %s: %u of %u frames", MODE_NAMES[m_mode], m_results[m_mode].frames, FRAMES_PER_MODE);
+    }
+    else
+    {
+        for (int mode = 0; mode < MODE_COUNT; ++mode)
+            ImGui::RadioButton(MODE_NAMES[mode], &m_selectedMode, mode);
+        if (ImGui::Button(IM_HASHED("Run with 200 windows")))
+            Start();
+    }
+
+    ImGui::Separator();
+    ImGui::Columns(8, "uibench");
+    ImGui::Text("Mode"); ImGui::NextColumn();
+    ImGui::Text("Avg ms"); ImGui::NextColumn();
+    ImGui::Text("Max ms"); ImGui::NextColumn();
+    ImGui::Text("Lists"); ImGui::NextColumn();
+    ImGui::Text("Draws"); ImGui::NextColumn();
+    ImGui::Text("Uploads"); ImGui::NextColumn();
+    ImGui::Text("Queries"); ImGui::NextColumn();
+    ImGui::Text("Changes"); ImGui::NextColumn();
+    ImGui::Separator();
+    for (unsigned int mode = 0; mode < MODE_COUNT; ++mode)
+    {
+        const Result& rResult = m_results[mode];
+        ImGui::Text("%u", mode); ImGui::NextColumn();
+        if (rResult.frames == 0)
+        {
+            for (unsigned int column = 1; column < 8; ++column)
+            {
+                ImGui::Text("-");
+                ImGui::NextColumn();
+            }
+            continue;
+        }
+        ImGui::Text("%.3f", rResult.totalMs / rResult.frames); ImGui::NextColumn();
+        ImGui::Text("%.3f", rResult.maxMs); ImGui::NextColumn();
+        ImGui::Text("%d", rResult.drawLists); ImGui::NextColumn();
+        ImGui::Text("%d", rResult.drawCalls); ImGui::NextColumn();
+        ImGui::Text("%d (%d KB)", rResult.bufferUploads, rResult.uploadBytes / 1024); ImGui::NextColumn();
+        ImGui::Text("%d", rResult.stateQueries); ImGui::NextColumn();
+        ImGui::Text("%d", rResult.stateChanges); ImGui::NextColumn();
+    }
+    ImGui::Columns(1);
+    ImGui::End();
+}
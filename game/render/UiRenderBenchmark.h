@@ -0,0 +1,67 @@
+#pragma once
+
+// Times ImGui_ImplGlfwGL3_RenderDrawData() over 200 windows of widgets in
+// each backend mode in turn: the reference path uploading every draw list
+// on its own with a new VAO and a full state backup, the batched path with
+// one upload and a persistent VAO, and the batched path with the host's
+// state declared instead of read back. Needs a GL context, so it runs in
+// the game rather than in DeathBallBench.
+class UiRenderBenchmark
+{
+public:
+    enum Mode
+    {
+        MODE_REFERENCE,
+        MODE_BATCHED,
+        MODE_BATCHED_HOST_STATE,
+        MODE_COUNT
+    };
+
+    static const unsigned int WINDOW_COUNT = 200;
+    static const unsigned int WARMUP_FRAMES = 30;
+    static const unsigned int FRAMES_PER_MODE = 300;
+
+    UiRenderBenchmark();
+
+    void Start();
+
+    bool IsRunning() const
+    {
+        return m_running;
+    }
+
+    // The mode the next render is to use: the one being measured while
+    // running, otherwise the one picked in the results window.
+    Mode GetMode() const;
+
+    // Call between ImGui::NewFrame() and ImGui::Render(); draws the stress
+    // windows while running.
+    void ShowStressWindows();
+
+    // Call after the render with its CPU time.
+    void AddFrame(double renderMs);
+
+    void ShowResultsWindow();
+
+private:
+    struct Result
+    {
+        double totalMs;
+        double maxMs;
+        unsigned int frames;
+        int drawLists;
+        int drawCalls;
+        int bufferUploads;
+        int uploadBytes;
+        int stateQueries;
+        int stateChanges;
+    };
+
+    bool m_running;
+    int m_mode;
+    int m_selectedMode;
+    unsigned int m_frame;
+    float m_sliders[WINDOW_COUNT];
+    bool m_checks[WINDOW_COUNT];
+    Result m_results[MODE_COUNT];
+};
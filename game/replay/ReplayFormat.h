@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+
+// On-disk layout of a DeathBall replay, little-endian, written by
+// ReplayRecorder and memory-mapped by ReplayPlayer:
+//
+//   ReplayHeader
+//   for every recorded tick:
+//     keyframe, on every keyframeInterval-th tick:
+//       uint32 tick, uint32 stateSize, Match::SaveState() bytes,
+//       PlayerInput[playerCount] of the previous tick (the delta base)
+//     uint32 mask of players whose input changed, then their PlayerInputs
+//   zero padding to an 8 byte boundary
+//   ReplayIndexEntry[keyframeCount]
+//   ReplayFooter
+//
+// Seeking finds the keyframe through the index, restores it and replays the
+// few tick records after it.
+
+struct ReplayHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t playerCount;
+    uint32_t tickRate;
+    uint32_t keyframeInterval;
+    uint32_t firstTick;
+};
+
+struct ReplayIndexEntry
+{
+    uint32_t tick;
+    uint32_t reserved;
+    uint64_t offset;
+};
+
+struct ReplayFooter
+{
+    uint64_t indexOffset;
+    uint32_t keyframeCount;
+    uint32_t tickCount;
+    char magic[4];
+    uint32_t reserved;
+};
+
+const char REPLAY_MAGIC[4] = { 'D', 'B', 'R', 'P' };
+const char REPLAY_INDEX_MAGIC[4] = { 'D', 'B', 'R', 'I' };
+const uint32_t REPLAY_VERSION = 1;
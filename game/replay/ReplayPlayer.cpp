@@ -0,0 +1,179 @@
+#include "ReplayPlayer.h"
+#include "../Match.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+ReplayPlayer::ReplayPlayer()
+    : m_pIndex(nullptr),
+      m_cursor(0),
+      m_cursorTick(0)
+{
+    std::memset(&m_header, 0, sizeof(m_header));
+    std::memset(&m_footer, 0, sizeof(m_footer));
+}
+
+bool ReplayPlayer::Open(const char* pPath)
+{
+    Close();
+    if (!m_file.Open(pPath))
+        return false;
+
+    const unsigned char* pData = m_file.GetData();
+    const size_t size = m_file.GetSize();
+    bool valid = size >= sizeof(ReplayHeader) + sizeof(ReplayFooter);
+    if (valid)
+    {
+        std::memcpy(&m_header, pData, sizeof(m_header));
+        std::memcpy(&m_footer, pData + size - sizeof(m_footer), sizeof(m_footer));
+        valid = std::memcmp(m_header.magic, REPLAY_MAGIC, sizeof(m_header.magic)) == 0
+             && std::memcmp(m_footer.magic, REPLAY_INDEX_MAGIC, sizeof(m_footer.magic)) == 0
+             && m_header.version == REPLAY_VERSION
+             && m_header.playerCount == Match::PLAYER_COUNT
+             && m_header.tickRate == Match::TICK_RATE
+             && m_header.keyframeInterval > 0
+             && m_footer.keyframeCount > 0
+             && m_footer.indexOffset % 8 == 0
+             && m_footer.indexOffset >= sizeof(ReplayHeader)
+             && m_footer.indexOffset <= size
+             && m_footer.indexOffset + m_footer.keyframeCount * sizeof(ReplayIndexEntry) + sizeof(ReplayFooter) == size;
+    }
+    if (valid)
+    {
+        m_pIndex = reinterpret_cast<const ReplayIndexEntry*>(pData + m_footer.indexOffset);
+        valid = ValidateRecords();
+    }
+    if (!valid)
+    {
+        Close();
+        return false;
+    }
+
+    m_inputs.assign(Match::PLAYER_COUNT, PlayerInput());
+    m_cursor = sizeof(ReplayHeader);
+    m_cursorTick = m_header.firstTick;
+    return true;
+}
+
+// Walks the tick records once, reading only their sizes: every keyframe
+// where its index entry says, every record inside the data before the
+// index. Seek() and Advance() then read the file without checking.
+bool ReplayPlayer::ValidateRecords() const
+{
+    const unsigned char* pData = m_file.GetData();
+    const size_t end = (size_t)m_footer.indexOffset;
+    const size_t inputsSize = Match::PLAYER_COUNT * sizeof(PlayerInput);
+    size_t cursor = sizeof(ReplayHeader);
+    unsigned int keyframe = 0;
+    for (unsigned int t = 0; t < m_footer.tickCount; ++t)
+    {
+        if (t % m_header.keyframeInterval == 0)
+        {
+            if (keyframe >= m_footer.keyframeCount
+                || m_pIndex[keyframe].offset != cursor
+                || m_pIndex[keyframe].tick != m_header.firstTick + t
+                || end - cursor < 2 * sizeof(uint32_t))
+                return false;
+            ++keyframe;
+
+            uint32_t recordTick = 0;
+            uint32_t stateSize = 0;
+            std::memcpy(&recordTick, pData + cursor, sizeof(recordTick));
+            std::memcpy(&stateSize, pData + cursor + sizeof(uint32_t), sizeof(stateSize));
+            cursor += 2 * sizeof(uint32_t);
+            if (recordTick != m_header.firstTick + t || end - cursor < stateSize || end - cursor - stateSize < inputsSize)
+                return false;
+            cursor += stateSize + inputsSize;
+        }
+
+        if (end - cursor < sizeof(uint32_t))
+            return false;
+        uint32_t changed = 0;
+        std::memcpy(&changed, pData + cursor, sizeof(changed));
+        cursor += sizeof(changed);
+        if (changed >> Match::PLAYER_COUNT)
+            return false;
+        size_t changedSize = 0;
+        for (; changed; changed &= changed - 1)
+            changedSize += sizeof(PlayerInput);
+        if (end - cursor < changedSize)
+            return false;
+        cursor += changedSize;
+    }
+    // only the padding before the index is left
+    return keyframe == m_footer.keyframeCount && end - cursor < 8;
+}
+
+void ReplayPlayer::Close()
+{
+    m_file.Close();
+    m_pIndex = nullptr;
+    std::memset(&m_header, 0, sizeof(m_header));
+    std::memset(&m_footer, 0, sizeof(m_footer));
+}
+
+void ReplayPlayer::Seek(Match& rMatch, unsigned int tick, WorkerPool& rPool)
+{
+    assert(IsOpen());
+    tick = std::max(GetFirstTick(), std::min(tick, GetEndTick()));
+
+    const ReplayIndexEntry* pKeyframe = FindKeyframe(tick);
+    const unsigned char* pRecord = m_file.GetData() + pKeyframe->offset;
+    uint32_t stateSize = 0;
+    std::memcpy(&stateSize, pRecord + sizeof(uint32_t), sizeof(stateSize));
+    rMatch.LoadState(pRecord + 2 * sizeof(uint32_t), stateSize);
+
+    // Advance() reads the keyframe record again for its delta base inputs.
+    m_cursor = (size_t)pKeyframe->offset;
+    m_cursorTick = pKeyframe->tick;
+    while (m_cursorTick < tick)
+        Advance(rMatch, rPool);
+}
+
+bool ReplayPlayer::Advance(Match& rMatch, WorkerPool& rPool)
+{
+    if (!IsOpen() || m_cursorTick >= GetEndTick())
+        return false;
+    assert(rMatch.GetTick() == m_cursorTick);
+
+    ReadTickRecord();
+    rMatch.Tick(&m_inputs[0], rPool);
+    ++m_cursorTick;
+    return true;
+}
+
+const ReplayIndexEntry* ReplayPlayer::FindKeyframe(unsigned int tick) const
+{
+    // Last keyframe at or before tick; the first one is at the first tick.
+    const ReplayIndexEntry* pEnd = m_pIndex + m_footer.keyframeCount;
+    const ReplayIndexEntry* pFound = std::upper_bound(m_pIndex, pEnd, tick,
+        [](unsigned int value, const ReplayIndexEntry& rEntry) { return value < rEntry.tick; });
+    return pFound == m_pIndex ? m_pIndex : pFound - 1;
+}
+
+void ReplayPlayer::ReadTickRecord()
+{
+    const unsigned char* pData = m_file.GetData();
+
+    if ((m_cursorTick - m_header.firstTick) % m_header.keyframeInterval == 0)
+    {
+        uint32_t stateSize = 0;
+        std::memcpy(&stateSize, pData + m_cursor + sizeof(uint32_t), sizeof(stateSize));
+        m_cursor += 2 * sizeof(uint32_t) + stateSize;
+        std::memcpy(&m_inputs[0], pData + m_cursor, m_inputs.size() * sizeof(PlayerInput));
+        m_cursor += m_inputs.size() * sizeof(PlayerInput);
+    }
+
+    uint32_t changed = 0;
+    std::memcpy(&changed, pData + m_cursor, sizeof(changed));
+    m_cursor += sizeof(changed);
+    for (unsigned int i = 0; i < m_inputs.size(); ++i)
+    {
+        if (changed & (1u << i))
+        {
+            std::memcpy(&m_inputs[i], pData + m_cursor, sizeof(PlayerInput));
+            m_cursor += sizeof(PlayerInput);
+        }
+    }
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "../IControl.h"
+#include "../core/MappedFile.h"
+#include "ReplayFormat.h"
+
+#include <vector>
+
+class Match;
+class WorkerPool;
+
+// Plays a replay file back into a Match. The file is memory-mapped. Opening
+// checks its layout against the file size by walking the record sizes once,
+// and a seek touches only the pages of one keyframe and the tick records
+// after it: restoring the nearest earlier keyframe and re-simulating at most
+// keyframeInterval - 1 ticks.
+class ReplayPlayer
+{
+public:
+    ReplayPlayer();
+
+    bool Open(const char* pPath);
+    void Close();
+
+    bool IsOpen() const
+    {
+        return m_file.IsOpen();
+    }
+
+    // Recorded ticks are [GetFirstTick(), GetEndTick()).
+    unsigned int GetFirstTick() const
+    {
+        return m_header.firstTick;
+    }
+
+    unsigned int GetEndTick() const
+    {
+        return m_header.firstTick + m_footer.tickCount;
+    }
+
+    // Leaves rMatch at the start of the given tick, clamped to the recording.
+    void Seek(Match& rMatch, unsigned int tick, WorkerPool& rPool);
+
+    // Runs the next recorded tick on rMatch, which must be where the last
+    // Seek() or Advance() left it. False at the end of the replay.
+    bool Advance(Match& rMatch, WorkerPool& rPool);
+
+    // Inputs of the last tick played.
+    const PlayerInput* GetInputs() const
+    {
+        return &m_inputs[0];
+    }
+
+private:
+    ReplayPlayer(const ReplayPlayer&);
+    ReplayPlayer& operator=(const ReplayPlayer&);
+
+    bool ValidateRecords() const;
+    const ReplayIndexEntry* FindKeyframe(unsigned int tick) const;
+    void ReadTickRecord();
+
+    MappedFile m_file;
+    ReplayHeader m_header;
+    ReplayFooter m_footer;
+    const ReplayIndexEntry* m_pIndex;
+    size_t m_cursor;
+    unsigned int m_cursorTick;
+    std::vector<PlayerInput> m_inputs;
+};
@@ -0,0 +1,119 @@
+#include "ReplayRecorder.h"
+#include "../Match.h"
+
+#include <cstring>
+
+static_assert(Match::PLAYER_COUNT <= 32, "Replay tick records keep a 32-bit mask of changed inputs");
+
+namespace
+{
+    const size_t FILE_BUFFER_BYTES = 1 << 20;
+}
+
+ReplayRecorder::ReplayRecorder(unsigned int keyframeInterval)
+    : m_keyframeInterval(keyframeInterval == 0 ? 1 : keyframeInterval),
+      m_pFile(nullptr),
+      m_offset(0),
+      m_tickCount(0)
+{
+}
+
+ReplayRecorder::~ReplayRecorder()
+{
+    End();
+}
+
+bool ReplayRecorder::Begin(const char* pPath, const Match& rMatch)
+{
+    End();
+
+    m_pFile = std::fopen(pPath, "wb");
+    if (!m_pFile)
+        return false;
+    m_fileBuffer.resize(FILE_BUFFER_BYTES);
+    std::setvbuf(m_pFile, &m_fileBuffer[0], _IOFBF, m_fileBuffer.size());
+
+    m_offset = 0;
+    m_tickCount = 0;
+    m_index.clear();
+    m_stateBuffer.resize(rMatch.GetMaxStateSize());
+    m_lastInputs.assign(Match::PLAYER_COUNT, PlayerInput());
+
+    ReplayHeader header;
+    std::memcpy(header.magic, REPLAY_MAGIC, sizeof(header.magic));
+    header.version = REPLAY_VERSION;
+    header.playerCount = Match::PLAYER_COUNT;
+    header.tickRate = Match::TICK_RATE;
+    header.keyframeInterval = m_keyframeInterval;
+    header.firstTick = rMatch.GetTick();
+    Write(&header, sizeof(header));
+    return true;
+}
+
+void ReplayRecorder::RecordTick(const Match& rMatch, const PlayerInput* pInputs)
+{
+    if (!m_pFile)
+        return;
+
+    if (m_tickCount % m_keyframeInterval == 0)
+        WriteKeyframe(rMatch);
+
+    uint32_t changed = 0;
+    for (unsigned int i = 0; i < Match::PLAYER_COUNT; ++i)
+    {
+        if (std::memcmp(&pInputs[i], &m_lastInputs[i], sizeof(PlayerInput)) != 0)
+            changed |= 1u << i;
+    }
+    Write(&changed, sizeof(changed));
+    for (unsigned int i = 0; i < Match::PLAYER_COUNT; ++i)
+    {
+        if (changed & (1u << i))
+        {
+            Write(&pInputs[i], sizeof(PlayerInput));
+            m_lastInputs[i] = pInputs[i];
+        }
+    }
+    ++m_tickCount;
+}
+
+void ReplayRecorder::WriteKeyframe(const Match& rMatch)
+{
+    ReplayIndexEntry entry;
+    entry.tick = rMatch.GetTick();
+    entry.reserved = 0;
+    entry.offset = m_offset;
+    m_index.push_back(entry);
+
+    uint32_t stateSize = (uint32_t)rMatch.SaveState(&m_stateBuffer[0]);
+    Write(&entry.tick, sizeof(entry.tick));
+    Write(&stateSize, sizeof(stateSize));
+    Write(&m_stateBuffer[0], stateSize);
+    Write(&m_lastInputs[0], m_lastInputs.size() * sizeof(PlayerInput));
+}
+
+void ReplayRecorder::End()
+{
+    if (!m_pFile)
+        return;
+
+    ReplayFooter footer;
+    footer.keyframeCount = (uint32_t)m_index.size();
+    footer.tickCount = m_tickCount;
+    std::memcpy(footer.magic, REPLAY_INDEX_MAGIC, sizeof(footer.magic));
+    footer.reserved = 0;
+    const char padding[8] = { 0 };
+    Write(padding, (size_t)(-m_offset & 7));
+    footer.indexOffset = m_offset;
+    if (!m_index.empty())
+        Write(&m_index[0], m_index.size() * sizeof(ReplayIndexEntry));
+    Write(&footer, sizeof(footer));
+
+    std::fclose(m_pFile);
+    m_pFile = nullptr;
+}
+
+void ReplayRecorder::Write(const void* pData, size_t bytes)
+{
+    std::fwrite(pData, 1, bytes, m_pFile);
+    m_offset += bytes;
+}
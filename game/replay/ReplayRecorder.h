@@ -0,0 +1,65 @@
+#pragma once
+
+#include "../IControl.h"
+#include "ReplayFormat.h"
+
+#include <cstdio>
+#include <vector>
+
+class Match;
+
+// Streams a match to a replay file: per tick only the inputs that changed,
+// plus a full keyframe every keyframeInterval ticks. Writes go through a
+// large stdio buffer and keyframes reuse one preallocated state buffer, so
+// recording costs a few bytes of copying per tick.
+class ReplayRecorder
+{
+public:
+    explicit ReplayRecorder(unsigned int keyframeInterval = 90);
+    ~ReplayRecorder();
+
+    // Starts recording from rMatch's current tick.
+    bool Begin(const char* pPath, const Match& rMatch);
+
+    // Call right before rMatch.Tick(pInputs).
+    void RecordTick(const Match& rMatch, const PlayerInput* pInputs);
+
+    // Writes the keyframe index and closes the file.
+    void End();
+
+    bool IsRecording() const
+    {
+        return m_pFile != nullptr;
+    }
+
+    unsigned int GetTickCount() const
+    {
+        return m_tickCount;
+    }
+
+    unsigned int GetKeyframeCount() const
+    {
+        return (unsigned int)m_index.size();
+    }
+
+    uint64_t GetBytesWritten() const
+    {
+        return m_offset;
+    }
+
+private:
+    ReplayRecorder(const ReplayRecorder&);
+    ReplayRecorder& operator=(const ReplayRecorder&);
+
+    void Write(const void* pData, size_t bytes);
+    void WriteKeyframe(const Match& rMatch);
+
+    unsigned int m_keyframeInterval;
+    std::FILE* m_pFile;
+    uint64_t m_offset;
+    unsigned int m_tickCount;
+    std::vector<char> m_fileBuffer;
+    std::vector<unsigned char> m_stateBuffer;
+    std::vector<PlayerInput> m_lastInputs;
+    std::vector<ReplayIndexEntry> m_index;
+};
@@ -0,0 +1,380 @@
+#include "Match.h"
+#include "core/Percentile.h"
+#include "core/WorkerPool.h"
+#include "net/BotClient.h"
+#include "net/GameServer.h"
+#include "net/MatchHost.h"
+#include "net/SpectatorRelay.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    const double REPORT_INTERVAL_MS = 5000.0;
+
+    const unsigned int RELAY_MAX_SPECTATORS = 20000;
+    const unsigned int RELAY_KEYFRAME_INTERVAL = 30;    // frames
+    const double RELAY_MAX_DELAY = 600.0;               // seconds
+
+    typedef std::chrono::steady_clock Clock;
+
+    struct Options
+    {
+        unsigned int port;
+        unsigned int threads;
+        unsigned int snapshotInterval;
+        unsigned int bots;
+        unsigned int matches;
+        unsigned int relayPort;
+        double relayDelay;
+        unsigned int interestBudget;
+        double seconds;
+        UdpBackend backend;
+    };
+
+    bool ParseOptions(int argc, char** argv, Options& rOptions)
+    {
+        rOptions.port = SERVER_DEFAULT_PORT;
+        rOptions.threads = 1;
+        rOptions.snapshotInterval = 2;
+        rOptions.bots = 0;
+        rOptions.matches = 1;
+        rOptions.relayPort = 0;
+        rOptions.relayDelay = 0.0;
+        rOptions.interestBudget = 0;
+        rOptions.seconds = 0.0;
+        rOptions.backend = UDP_BACKEND_MMSG;
+        for (int arg = 1; arg + 1 < argc; arg += 2)
+        {
+            const char* pValue = argv[arg + 1];
+            if (std::strcmp(argv[arg], "--port") == 0)
+                rOptions.port = (unsigned int)std::atoi(pValue);
+            else if (std::strcmp(argv[arg], "--threads") == 0)
+                rOptions.threads = (unsigned int)std::atoi(pValue);
+            else if (std::strcmp(argv[arg], "--snapshot-interval") == 0)
+                rOptions.snapshotInterval = (unsigned int)std::atoi(pValue);
+            else if (std::strcmp(argv[arg], "--bots") == 0)
+                rOptions.bots = (unsigned int)std::atoi(pValue);
+            else if (std::strcmp(argv[arg], "--matches") == 0)
+                rOptions.matches = (unsigned int)std::atoi(pValue);
+            else if (std::strcmp(argv[arg], "--relay-port") == 0)
+                rOptions.relayPort = (unsigned int)std::atoi(pValue);
+            else if (std::strcmp(argv[arg], "--relay-delay") == 0)
+                rOptions.relayDelay = std::atof(pValue);
+            else if (std::strcmp(argv[arg], "--interest-budget") == 0)
+                rOptions.interestBudget = (unsigned int)std::atoi(pValue);
+            else if (std::strcmp(argv[arg], "--seconds") == 0)
+                rOptions.seconds = std::atof(pValue);
+            else if (std::strcmp(argv[arg], "--io") == 0 && std::strcmp(pValue, "single") == 0)
+                rOptions.backend = UDP_BACKEND_SINGLE;
+            else if (std::strcmp(argv[arg], "--io") == 0 && std::strcmp(pValue, "mmsg") == 0)
+                rOptions.backend = UDP_BACKEND_MMSG;
+            else if (std::strcmp(argv[arg], "--io") == 0 && std::strcmp(pValue, "io_uring") == 0)
+                rOptions.backend = UDP_BACKEND_IO_URING;
+            else
+                return false;
+        }
+        return (argc % 2) == 1 && rOptions.threads > 0 && rOptions.matches > 0 &&
+               rOptions.relayDelay >= 0.0 && rOptions.relayDelay <= RELAY_MAX_DELAY;
+    }
+
+    void PrintReport(GameServer& rServer, double seconds)
+    {
+        const ServerStats& rStats = rServer.GetStats();
+        std::vector<float> tickMs(rStats.tickMs);
+        const float p50 = Percentile(tickMs, 0.50f);
+        const float p90 = Percentile(tickMs, 0.90f);
+        const float p99 = Percentile(tickMs, 0.99f);
+        const float max = Percentile(tickMs, 1.0f);
+        const unsigned int clients = rServer.GetClientCount();
+
+        std::printf("%u ticks in %.1f s, %u clients (%u joined, %u timed out)\n",
+                    rStats.ticks, seconds, clients, rStats.clientsConnected, rStats.clientsTimedOut);
+        std::printf("  tick ms: p50 %.3f  p90 %.3f  p99 %.3f  max %.3f  (budget %.3f)\n",
+                    p50, p90, p99, max, 1000.0f / Match::TICK_RATE);
+        std::printf("  packets/s: %.0f out, %.0f in\n", rStats.packetsSent / seconds, rStats.packetsReceived / seconds);
+        if (clients > 0)
+        {
+            std::printf("  per client: %.1f kbit/s down, %.1f kbit/s up\n",
+                        rStats.bytesSent * 8.0 / 1000.0 / seconds / clients,
+                        rStats.bytesReceived * 8.0 / 1000.0 / seconds / clients);
+        }
+        if (rServer.GetInterestBudget() > 0 && rStats.packetsSent > 0)
+        {
+            std::printf("  interest: budget %u entities, %.1f sent per snapshot per client, %.3f ms per second choosing\n",
+                        rServer.GetInterestBudget(), (double)rStats.entitiesSent / rStats.packetsSent,
+                        rStats.relevancyMs / seconds);
+        }
+        if (rStats.attacks > 0)
+        {
+            std::printf("  charges: %u checked, %u hit, rewind %.1f ticks avg %u max, %.2f us per check\n",
+                        rStats.attacks, rStats.hits, (double)rStats.rewoundTicks / rStats.attacks,
+                        rStats.maxRewindTicks, rStats.attackCheckMs * 1000.0 / rStats.attacks);
+        }
+    }
+
+    void PrintRelayReport(SpectatorRelay& rRelay, double seconds)
+    {
+        const RelayStats& rStats = rRelay.GetStats();
+        std::printf("  spectators: %u watching (%u joined, %u late from a keyframe, %u timed out), %.1f s delay\n",
+                    rRelay.GetSpectatorCount(), rStats.spectatorsJoined, rStats.lateJoins, rStats.spectatorsTimedOut,
+                    (double)rRelay.GetDelayTicks() / Match::TICK_RATE);
+        if (rStats.frames > 0)
+        {
+            std::printf("  relay: %u frames encoded once, %.3f ms each, fan-out %.1f%% of a core, %.0f packets/s, %.0f KB\n",
+                        rStats.frames, rStats.encodeMs / rStats.frames, rStats.fanOutMs / (seconds * 10.0),
+                        rStats.packetsSent / seconds, rRelay.GetMemoryBytes() / 1024.0);
+        }
+    }
+
+    void RunBots(std::vector<BotClient*>& rBots, const std::atomic<bool>& rRunning, Clock::time_point start)
+    {
+        while (rRunning)
+        {
+            const double nowMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+            for (unsigned int i = 0; i < rBots.size(); ++i)
+                rBots[i]->Update(nowMs);
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        for (unsigned int i = 0; i < rBots.size(); ++i)
+            rBots[i]->Disconnect();
+    }
+
+    void PrintHostReport(MatchHost& rHost, double seconds)
+    {
+        unsigned int ticks = 0;
+        unsigned int missed = 0;
+        unsigned int clients = 0;
+        for (unsigned int i = 0; i < rHost.GetMatchCount(); ++i)
+        {
+            const MatchTickStats stats = rHost.GetTickStats(i);
+            std::printf("  match %2u port %5u: %2u clients, %u ticks, tick ms p50 %.3f  p90 %.3f  p99 %.3f  max %.3f, "
+                        "%u missed, latest start %.2f ms\n",
+                        i, rHost.GetLocalAddress(i).port, stats.clients, stats.ticks, stats.p50Ms, stats.p90Ms,
+                        stats.p99Ms, stats.maxMs, stats.missedDeadlines, stats.maxLatenessMs);
+            ticks += stats.ticks;
+            missed += stats.missedDeadlines;
+            clients += stats.clients;
+        }
+        std::printf("%u matches, %u ticks in %.1f s, %u clients, %u deadlines missed (budget %.3f ms)\n",
+                    rHost.GetMatchCount(), ticks, seconds, clients, missed, 1000.0f / Match::TICK_RATE);
+    }
+
+    // --matches: every match on its own port from the given one up, ticked
+    // by a MatchHost with --threads workers, and --bots bots in each.
+    int RunMatches(const Options& rOptions)
+    {
+        MatchHost host(rOptions.matches, rOptions.threads, rOptions.snapshotInterval);
+        if (!host.Open(0, (uint16_t)rOptions.port, rOptions.backend))
+        {
+            std::printf("cannot bind UDP ports %u to %u\n", rOptions.port, rOptions.port + rOptions.matches - 1);
+            return 1;
+        }
+
+        std::vector<BotClient*> bots;
+        for (unsigned int match = 0; match < rOptions.matches; ++match)
+        {
+            const NetAddress address = { NET_LOOPBACK, host.GetLocalAddress(match).port };
+            for (unsigned int i = 0; i < rOptions.bots; ++i)
+            {
+                bots.push_back(new BotClient(match * rOptions.bots + i + 1));
+                bots.back()->Open(address);
+            }
+        }
+
+        const Clock::time_point start = Clock::now();
+        host.Start();
+        std::printf("DeathBallServer hosting %u matches on ports %u to %u, %u Hz, %u workers (%u pinned), "
+                    "snapshot every %u ticks, %s datagram I/O\n",
+                    host.GetMatchCount(), host.GetLocalAddress(0).port,
+                    host.GetLocalAddress(host.GetMatchCount() - 1).port, Match::TICK_RATE, host.GetWorkerCount(),
+                    host.GetPinnedCount(), rOptions.snapshotInterval, BatchedUdpSocket::GetBackendName(host.GetBackend()));
+
+        std::atomic<bool> running(true);
+        std::thread botThread;
+        if (!bots.empty())
+            botThread = std::thread(RunBots, std::ref(bots), std::cref(running), start);
+
+        Clock::time_point reportStart = start;
+        for (;;)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            const Clock::time_point now = Clock::now();
+            if (rOptions.seconds > 0.0 && now - start >= std::chrono::duration<double>(rOptions.seconds))
+                break;
+
+            const double reportMs = std::chrono::duration<double, std::milli>(now - reportStart).count();
+            if (rOptions.seconds == 0.0 && reportMs >= REPORT_INTERVAL_MS)
+            {
+                PrintHostReport(host, reportMs / 1000.0);
+                host.ResetStats();
+                reportStart = now;
+            }
+        }
+
+        running = false;
+        if (botThread.joinable())
+            botThread.join();
+        host.Stop();
+
+        PrintHostReport(host, std::chrono::duration<double>(Clock::now() - reportStart).count());
+        for (unsigned int i = 0; i < bots.size(); ++i)
+            delete bots[i];
+        return 0;
+    }
+}
+
+// DeathBallServer [--port N] [--threads N] [--snapshot-interval TICKS] [--bots N] [--seconds S]
+//                 [--io single|mmsg|io_uring] [--matches N] [--relay-port N] [--relay-delay S]
+//                 [--interest-budget N]
+//
+// Runs one match headless at Match::TICK_RATE for networked clients. With
+// --bots the given number of BotClients play from a thread of this process
+// over loopback; with --seconds the server stops after that long and prints
+// a final report, otherwise it reports every few seconds until killed.
+// --io picks how datagrams reach the kernel, batched with recvmmsg/sendmmsg
+// by default. --matches hosts that many matches on consecutive ports instead,
+// with --threads pinned workers sharing their ticks and --bots in each, and
+// reports every match's tick times. --relay-port broadcasts the one match to
+// spectators on that port through a SpectatorRelay, --relay-delay seconds
+// behind, up to ten minutes. --interest-budget sends each client only that
+// many entities per snapshot, the most relevant to it. Both apply to the one
+// match only and are refused with --matches.
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!ParseOptions(argc, argv, options))
+    {
+        std::printf("usage: DeathBallServer [--port N] [--threads N] [--snapshot-interval TICKS] [--bots N] [--seconds S] "
+                    "[--io single|mmsg|io_uring] [--matches N] [--relay-port N] [--relay-delay S] [--interest-budget N]\n");
+        return 1;
+    }
+    if (options.matches > 1)
+    {
+        if (options.relayPort != 0 || options.interestBudget != 0)
+        {
+            std::printf("--relay-port and --interest-budget cannot be used with --matches\n");
+            return 1;
+        }
+        return RunMatches(options);
+    }
+
+    WorkerPool pool(options.threads);
+    Match match;
+    GameServer server(match, options.snapshotInterval);
+    server.SetInterestBudget(options.interestBudget);
+    if (!server.Open(0, (uint16_t)options.port, options.backend))
+    {
+        std::printf("cannot bind UDP port %u\n", options.port);
+        return 1;
+    }
+    std::printf("DeathBallServer on port %u, %u Hz, snapshot every %u ticks, %s datagram I/O\n",
+                server.GetLocalAddress().port, Match::TICK_RATE, options.snapshotInterval,
+                BatchedUdpSocket::GetBackendName(server.GetBackend()));
+
+    SpectatorRelay* pRelay = nullptr;
+    if (options.relayPort != 0)
+    {
+        pRelay = new SpectatorRelay(RELAY_MAX_SPECTATORS, options.snapshotInterval, RELAY_KEYFRAME_INTERVAL,
+                                    (unsigned int)(options.relayDelay * Match::TICK_RATE + 0.5));
+        if (!pRelay->Open(0, (uint16_t)options.relayPort, options.backend))
+        {
+            std::printf("cannot bind UDP port %u for spectators\n", options.relayPort);
+            delete pRelay;
+            return 1;
+        }
+        std::printf("spectator relay on port %u, %.1f s delay\n", pRelay->GetLocalAddress().port, options.relayDelay);
+    }
+
+    // sockets are opened here rather than on the bot thread
+    NetAddress serverAddress = { NET_LOOPBACK, server.GetLocalAddress().port };
+    std::vector<BotClient*> bots;
+    for (unsigned int i = 0; i < options.bots; ++i)
+    {
+        bots.push_back(new BotClient(i + 1));
+        bots.back()->Open(serverAddress);
+    }
+
+    const Clock::time_point start = Clock::now();
+    std::atomic<bool> running(true);
+    std::thread botThread;
+    if (!bots.empty())
+        botThread = std::thread(RunBots, std::ref(bots), std::cref(running), start);
+
+    const Clock::duration tickDuration = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(1.0 / Match::TICK_RATE));
+    Clock::time_point nextTick = start;
+    Clock::time_point reportStart = start;
+    for (;;)
+    {
+        const Clock::time_point now = Clock::now();
+        const double nowMs = std::chrono::duration<double, std::milli>(now - start).count();
+        if (options.seconds > 0.0 && nowMs >= options.seconds * 1000.0)
+            break;
+
+        server.Update(pool, nowMs);
+        if (pRelay != nullptr)
+        {
+            pRelay->Publish(match);
+            pRelay->Update(nowMs);
+        }
+
+        const double reportMs = std::chrono::duration<double, std::milli>(now - reportStart).count();
+        if (options.seconds == 0.0 && reportMs >= REPORT_INTERVAL_MS)
+        {
+            PrintReport(server, reportMs / 1000.0);
+            server.ResetStats();
+            if (pRelay != nullptr)
+            {
+                PrintRelayReport(*pRelay, reportMs / 1000.0);
+                pRelay->ResetStats();
+            }
+            reportStart = now;
+        }
+
+        // fixed cadence; after an overrun the schedule restarts rather than bursting
+        nextTick += tickDuration;
+        if (nextTick < Clock::now())
+            nextTick = Clock::now();
+        std::this_thread::sleep_until(nextTick);
+    }
+
+    running = false;
+    if (botThread.joinable())
+        botThread.join();
+
+    const double reportSeconds = std::chrono::duration<double>(Clock::now() - reportStart).count();
+    PrintReport(server, reportSeconds);
+    if (pRelay != nullptr)
+    {
+        PrintRelayReport(*pRelay, reportSeconds);
+        delete pRelay;
+    }
+    if (!bots.empty())
+    {
+        unsigned int connected = 0;
+        unsigned int rejected = 0;
+        unsigned int snapshots = 0;
+        unsigned int decodeFailures = 0;
+        uint64_t bytesReceived = 0;
+        for (unsigned int i = 0; i < bots.size(); ++i)
+        {
+            connected += bots[i]->GetSnapshotsReceived() > 0;
+            rejected += bots[i]->WasRejected();
+            snapshots += bots[i]->GetSnapshotsReceived();
+            decodeFailures += bots[i]->GetDecodeFailures();
+            bytesReceived += bots[i]->GetBytesReceived();
+            delete bots[i];
+        }
+        std::printf("  bots: %u played, %u rejected, %.1f snapshots and %.1f KB received each, %u undecodable\n",
+                    connected, rejected, connected ? (double)snapshots / connected : 0.0,
+                    connected ? bytesReceived / 1024.0 / connected : 0.0, decodeFailures);
+    }
+    return 0;
+}